@@ -0,0 +1,281 @@
+/*! \file */
+/*!
+ * benchmark.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: On-target microbenchmarks for the display, formatting and
+ *              protocol hot paths.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "msp.h"
+#include "benchmark.h"
+#include "clockManager.h"
+#include "lcd.h"
+#include "uart.h"
+#include "songLists.h"
+#include "dsp.h"
+#include "pitch.h"
+
+/* Time and LCD bus bytes so far: DWT cycles and the LCD monitor's count on
+ *  the target. BENCH_HOST (host/Makefile's bench target) times with the
+ *  host's monotonic clock and counts what the HD44780 model latched */
+#ifdef BENCH_HOST
+#include <time.h>
+#include "hd44780.h"
+
+static uint32_t hostNs(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
+
+#define BENCH_NOW()         hostNs()
+#define BENCH_UNIT          "ns"
+#define BENCH_LCD_BYTES()   hd44780Writes()
+#else
+#define BENCH_NOW()         (DWT->CYCCNT)
+#define BENCH_UNIT          "cycles"
+#if LCD_MONITOR
+#define BENCH_LCD_BYTES()   lcdGetBusWrites()
+#endif
+#endif
+
+typedef enum _BenchCase {
+    BENCH_DISPLAY,          // lcdDisplayTitleArtist over the real catalog
+    BENCH_DISPLAY_LONG,     // lcdDisplayTitleArtist, synthetic long entry
+    BENCH_SCROLL,           // scrollText on a long line
+    BENCH_CENTER,           // centerText on a short line
+    BENCH_PRINT_WRAP,       // lcdPrintString across both lines
+    BENCH_STATUS,           // sendPlaybackStatus formatting
+    BENCH_RECENT,           // recentTouch over a SONG_LIST_MAX catalog
+    BENCH_FAVORITE,         // favoriteNext over a sparse SONG_LIST_MAX set
+    BENCH_BLOCK,            // dspBlockStats over one BENCH_BLOCK_SIZE block
+    BENCH_BLOCK_REF,        // dspBlockStatsReference, same block
+    BENCH_SQDIFF,           // dspSquaredDifference, one YIN lag
+    BENCH_SQDIFF_REF,       // dspSquaredDifferenceReference, same lag
+    BENCH_PITCH,            // pitchDetect on a BENCH_TONE_HZ tone
+    BENCH_PITCH_NOISE,      // pitchDetect on noise, every lag searched
+    BENCH_COUNT
+} BenchCase;
+
+typedef struct _BenchResult {
+    uint32_t runs;
+    uint32_t min;
+    uint32_t total;
+    uint32_t lcdBytes;
+} BenchResult;
+
+static const char * const benchNames[BENCH_COUNT] = {
+    "display", "display_long", "scroll", "center", "print_wrap", "status",
+    "recent", "favorite", "block", "block_ref",
+    "sqdiff", "sqdiff_ref", "pitch", "pitch_noise"
+};
+
+static BenchResult results[BENCH_COUNT];
+static char longEntry[BENCH_LONG_TITLE + 1];
+
+/* Scratch lists, the machine's own lists are left alone */
+static RecentList benchRecent;
+static FavoriteSet benchFavorites;
+
+/* Synthetic microphone block, word storage for the SIMD kernel */
+static uint32_t benchBlockWords[BENCH_BLOCK_SIZE / 2];
+static uint32_t benchToneWords[BENCH_BLOCK_SIZE / 2];
+static uint8_t blockMismatches;
+
+static uint32_t busWrites(void) {
+#ifdef BENCH_LCD_BYTES
+    return BENCH_LCD_BYTES();
+#else
+    return 0;
+#endif
+}
+
+static void record(BenchCase id, uint32_t cycles, uint32_t lcdBytes) {
+    BenchResult *result = &results[id];
+
+    result->runs++;
+    result->total += cycles;
+    result->lcdBytes += lcdBytes;
+    if (cycles < result->min) {
+        result->min = cycles;
+    }
+}
+
+static void buildBlock(uint8_t run) {
+    uint16_t *samples = (uint16_t *)benchBlockWords;
+    uint32_t noise = 0x1234567u + run;
+    uint16_t i;
+
+    // full scale noise with both rails present, a fresh pattern every run
+    for (i = 0; i < BENCH_BLOCK_SIZE; i++) {
+        noise = noise * 1664525u + 1013904223u;
+        samples[i] = (uint16_t)(noise >> 17) & 0x3FFF;
+    }
+    samples[run % BENCH_BLOCK_SIZE] = 0;
+    samples[(run * 7 + 3) % BENCH_BLOCK_SIZE] = DSP_SAMPLE_MAX;
+}
+
+static void buildTone(void) {
+    uint16_t *samples = (uint16_t *)benchToneWords;
+    float x = 1.0f, y = 0.0f, next;
+    uint16_t i;
+
+    // rotating phasor for the fundamental, cos(2wt) = x^2 - y^2 adds an
+    //  octave harmonic at half amplitude
+    for (i = 0; i < BENCH_BLOCK_SIZE; i++) {
+        samples[i] = (uint16_t)(8192.0f + 3000.0f * x
+                                + 1500.0f * (x * x - y * y));
+        next = BENCH_TONE_COS * x - BENCH_TONE_SIN * y;
+        y = BENCH_TONE_SIN * x + BENCH_TONE_COS * y;
+        x = next;
+    }
+}
+
+static uint8_t sameStats(const DspBlockStats *a, const DspBlockStats *b) {
+    return a->sum == b->sum && a->sumSquares == b->sumSquares
+            && a->min == b->min && a->max == b->max && a->count == b->count;
+}
+
+static void buildLongEntry(void) {
+    uint8_t i;
+
+    // "Title words ...-Artist" with a title far wider than the display
+    for (i = 0; i < BENCH_LONG_TITLE - 8; i++) {
+        longEntry[i] = (i % 6 == 5) ? ' ' : 'a' + (i % 26);
+    }
+    strcpy(&longEntry[i], "-Artist");
+}
+
+void runBenchmarks(const char * const *catalog, uint8_t count) {
+    char line[LCD_WIDTH + 1];
+    char status[25];
+    char buffer[96];
+    DspBlockStats stats, reference;
+    PitchEstimate pitch, noise;
+    uint64_t difference, referenceDifference;
+    uint32_t start, writes;
+    uint8_t run, i;
+    BenchCase id;
+
+    for (id = (BenchCase)0; id < BENCH_COUNT; id++) {
+        results[id].runs = 0;
+        results[id].min = 0xFFFFFFFF;
+        results[id].total = 0;
+        results[id].lcdBytes = 0;
+    }
+    buildLongEntry();
+    recentClear(&benchRecent);
+    favoriteClear(&benchFavorites);
+    favoriteToggle(&benchFavorites, 3);     // worst case: one far away favorite
+    blockMismatches = 0;
+    buildTone();
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    for (run = 0; run < BENCH_RUNS; run++) {
+        for (i = 0; i < count; i++) {
+            writes = busWrites();
+            start = BENCH_NOW();
+            lcdDisplayTitleArtist(catalog[i]);
+            record(BENCH_DISPLAY, BENCH_NOW() - start, busWrites() - writes);
+        }
+
+        writes = busWrites();
+        start = BENCH_NOW();
+        lcdDisplayTitleArtist(longEntry);
+        record(BENCH_DISPLAY_LONG, BENCH_NOW() - start, busWrites() - writes);
+
+        start = BENCH_NOW();
+        scrollText(line, longEntry, BENCH_LONG_TITLE - 1, run, LCD_WIDTH);
+        record(BENCH_SCROLL, BENCH_NOW() - start, 0);
+
+        start = BENCH_NOW();
+        centerText(line, "Yellow", 6, LCD_WIDTH);
+        record(BENCH_CENTER, BENCH_NOW() - start, 0);
+
+        writes = busWrites();
+        start = BENCH_NOW();
+        lcdSetCursor(0, 0);
+        lcdPrintString("Benchmark line 1Benchmark line 2");
+        record(BENCH_PRINT_WRAP, BENCH_NOW() - start, busWrites() - writes);
+
+        start = BENCH_NOW();
+        formatPlaybackStatus(status, run & 1, run, 0);
+        record(BENCH_STATUS, BENCH_NOW() - start, 0);
+
+        // hits, misses and evictions spread over the whole index range
+        start = BENCH_NOW();
+        recentTouch(&benchRecent, (uint8_t)(run * 37 + 11));
+        record(BENCH_RECENT, BENCH_NOW() - start, 0);
+
+        start = BENCH_NOW();
+        favoriteNext(&benchFavorites, 4);
+        record(BENCH_FAVORITE, BENCH_NOW() - start, 0);
+
+        // odd runs use an odd length for the kernel's tail sample
+        buildBlock(run);
+        start = BENCH_NOW();
+        dspBlockStats((const uint16_t *)benchBlockWords,
+                      BENCH_BLOCK_SIZE - (run & 1), &stats);
+        record(BENCH_BLOCK, BENCH_NOW() - start, 0);
+
+        start = BENCH_NOW();
+        dspBlockStatsReference((const uint16_t *)benchBlockWords,
+                               BENCH_BLOCK_SIZE - (run & 1), &reference);
+        record(BENCH_BLOCK_REF, BENCH_NOW() - start, 0);
+        if (!sameStats(&stats, &reference)) {
+            blockMismatches++;
+        }
+
+        // even lag, so both operands are sample pairs
+        start = BENCH_NOW();
+        difference = dspSquaredDifference((const int16_t *)benchBlockWords,
+                (const int16_t *)benchBlockWords + 2 * (run + 1),
+                BENCH_BLOCK_SIZE - PITCH_MAX_LAG - 1);
+        record(BENCH_SQDIFF, BENCH_NOW() - start, 0);
+
+        start = BENCH_NOW();
+        referenceDifference = dspSquaredDifferenceReference(
+                (const int16_t *)benchBlockWords,
+                (const int16_t *)benchBlockWords + 2 * (run + 1),
+                BENCH_BLOCK_SIZE - PITCH_MAX_LAG - 1);
+        record(BENCH_SQDIFF_REF, BENCH_NOW() - start, 0);
+        if (referenceDifference != difference) {
+            blockMismatches++;
+        }
+
+        start = BENCH_NOW();
+        pitchDetect((const uint16_t *)benchToneWords, BENCH_BLOCK_SIZE, &pitch);
+        record(BENCH_PITCH, BENCH_NOW() - start, 0);
+
+        start = BENCH_NOW();
+        pitchDetect((const uint16_t *)benchBlockWords, BENCH_BLOCK_SIZE, &noise);
+        record(BENCH_PITCH_NOISE, BENCH_NOW() - start, 0);
+    }
+    pitchDetect((const uint16_t *)benchToneWords, BENCH_BLOCK_SIZE, &pitch);
+
+    sprintf(buffer, "K:{\"mclk\":%lu,\"unit\":\"" BENCH_UNIT "\",\"simd\":%u,"
+            "\"mismatch\":%u,\"cents\":%u,\"b\":[",
+            (unsigned long)getMCLKFrequency(), DSP_USE_SIMD, blockMismatches,
+            pitch.cents);
+    sendString(buffer);
+    for (id = (BenchCase)0; id < BENCH_COUNT; id++) {
+        BenchResult *result = &results[id];
+
+        sprintf(buffer, "%s{\"n\":\"%s\",\"runs\":%lu,\"min\":%lu,\"avg\":%lu,\"lcd\":%ld}",
+                id ? "," : "", benchNames[id],
+                (unsigned long)result->runs, (unsigned long)result->min,
+                (unsigned long)(result->total / result->runs),
+#ifdef BENCH_LCD_BYTES
+                (long)(result->lcdBytes / result->runs));
+#else
+                -1L);
+#endif
+        sendString(buffer);
+    }
+    sendString("]}\n");
+}
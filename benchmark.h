@@ -0,0 +1,66 @@
+/*! \file */
+/*!
+ * benchmark.h
+ * ECE230 Winter 2024-2025
+ *
+ * Description: On-target microbenchmarks for the display, formatting and
+ *              protocol hot paths. Each case runs a fixed number of times
+ *              and reports DWT cycles and LCD bus bytes per operation.
+ */
+
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+#define BENCH_RUNS          16
+#define BENCH_LONG_TITLE    96      // synthetic catalog entry length
+#define BENCH_BLOCK_SIZE    256     // samples, one microphone block
+#define BENCH_TONE_COS      0.98579751f // 220Hz at 8192Hz, expect 5700 cents
+#define BENCH_TONE_SIN      0.16793829f
+
+/*!
+ * \brief This function runs all benchmarks and reports them over UART
+ *
+ * Draws on the LCD while running; the caller should redraw afterwards.
+ *  Reports one JSON line:
+ *  K:{"mclk":<Hz>,"unit":"cycles","simd":<0|1>,"mismatch":<n>,
+ *  "cents":<pitch>,"b":[{"n":"<case>","runs":<n>,"min":<cycles>,
+ *  "avg":<cycles>,"lcd":<bytes per op>},...]}
+ *  Minimum is the best estimate of the cost without interrupts. "mismatch"
+ *  counts kernel results that differ from their reference, "simd" tells
+ *  whether the kernels were built with the DSP instructions and "cents" is
+ *  the pitch detected in the 220Hz test tone (5700 expected). LCD bytes
+ *  are -1 when the LCD monitor is compiled out. Built with BENCH_HOST
+ *  for host/karaokeBench, times are host nanoseconds ("unit":"ns") and LCD
+ *  bytes are counted by the HD44780 model; that program also checks that
+ *  none of the measured paths use the heap.
+ *
+ * \param catalog is the song list to run the display cases over
+ * \param count is the number of entries in \b catalog
+ *
+ * \return None
+ */
+extern void runBenchmarks(const char * const *catalog, uint8_t count);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BENCHMARK_H_ */
@@ -0,0 +1,124 @@
+/*! \file */
+/*!
+ * clockManager.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Owns the CS (clock system) configuration for MSP432P4111.
+ *              No other module writes CS registers; drivers that derive
+ *              timing from a clock register a listener instead.
+ */
+
+#include "msp.h"
+#include "clockManager.h"
+#include "csHFXT.h"
+#include "csLFXT.h"
+
+/* Reset state: MCLK = SMCLK = 3MHz DCO, ACLK = 32kHz REFO */
+static ClockProfile currentProfile = CLOCK_PROFILE_DCO_12MHZ;
+static uint32_t mclkFrequency = 3000000;
+static uint32_t smclkFrequency = 3000000;
+static uint32_t aclkFrequency = REFO_FREQUENCY;
+
+static uint8_t clockConfigured = 0;
+static uint8_t lfxtRunning = 0;
+
+static ClockListener listeners[CLOCK_MAX_LISTENERS];
+static uint8_t listenerCount = 0;
+
+static void notifyListeners(ClockEvent event) {
+    uint8_t i;
+    for (i = 0; i < listenerCount; i++) {
+        listeners[i](event);
+    }
+}
+
+uint8_t clockRegisterListener(ClockListener listener) {
+    uint8_t i;
+    for (i = 0; i < listenerCount; i++) {
+        if (listeners[i] == listener) {
+            return 1;
+        }
+    }
+    if (listenerCount >= CLOCK_MAX_LISTENERS) {
+        return 0;
+    }
+    listeners[listenerCount++] = listener;
+    return 1;
+}
+
+void clockSetProfile(ClockProfile profile) {
+    if (clockConfigured && profile == currentProfile) {
+        return;
+    }
+    notifyListeners(CLOCK_PRE_CHANGE);
+
+    switch (profile) {
+    case CLOCK_PROFILE_HFXT_48MHZ:
+        // VCORE1, 3 flash wait states, MCLK = HFXT, SMCLK = HFXT / 2
+        configHFXT();
+        mclkFrequency = HFXT_FREQUENCY;
+        smclkFrequency = HFXT_FREQUENCY / 2;
+        break;
+    default:
+        profile = CLOCK_PROFILE_DCO_12MHZ;
+        CS->KEY = CS_KEY_VAL;         // Unlock CS registers
+        CS->CTL0 = CS_CTL0_DCORSEL_3; // Set DCO to 12MHz
+        CS->CTL1 = (CS->CTL1 & ~(CS_CTL1_SELM_MASK | CS_CTL1_DIVM_MASK
+                    | CS_CTL1_SELS_MASK | CS_CTL1_DIVS_MASK | CS_CTL1_DIVHS_MASK))
+                    | CS_CTL1_SELM__DCOCLK          // MCLK = DCO
+                    | CS_CTL1_SELS__DCOCLK          // SMCLK = DCO
+                    | CS_CTL1_DIVM__1
+                    | CS_CTL1_DIVS__1;
+        CS->KEY = 0;                  // Lock CS registers
+
+        // with the clock down, relax flash wait states and drop to VCORE0
+        //  (12MHz is within the VCORE0 limits for CPU and peripherals)
+        FLCTL_A->BANK0_RDCTL = (FLCTL_A->BANK0_RDCTL & ~(FLCTL_A_BANK0_RDCTL_WAIT_MASK)) |
+                FLCTL_A_BANK0_RDCTL_WAIT_1;
+        FLCTL_A->BANK1_RDCTL = (FLCTL_A->BANK1_RDCTL & ~(FLCTL_A_BANK1_RDCTL_WAIT_MASK)) |
+                FLCTL_A_BANK1_RDCTL_WAIT_1;
+        PCM->CTL0 = PCM_CTL0_KEY_VAL | PCM_CTL0_AMR_0;
+        while ((PCM->CTL1 & PCM_CTL1_PMR_BUSY));
+        mclkFrequency = DCO_12MHZ_FREQUENCY;
+        smclkFrequency = DCO_12MHZ_FREQUENCY;
+        break;
+    }
+    // ACLK = 32kHz LFXT once started, REFO otherwise, in every profile
+    CS->KEY = CS_KEY_VAL;
+    CS->CTL1 = (CS->CTL1 & ~(CS_CTL1_SELA_MASK | CS_CTL1_DIVA_MASK))
+                | (lfxtRunning ? CS_CTL1_SELA__LFXTCLK : CS_CTL1_SELA__REFOCLK)
+                | CS_CTL1_DIVA__1;
+    CS->KEY = 0;
+    currentProfile = profile;
+    clockConfigured = 1;
+    SystemCoreClock = mclkFrequency;
+
+    notifyListeners(CLOCK_POST_CHANGE);
+}
+
+void clockStartLFXT(void) {
+    if (lfxtRunning) {
+        return;
+    }
+    notifyListeners(CLOCK_PRE_CHANGE);
+    configLFXT();                       // ACLK = LFXT, also feeds RTC_C
+    lfxtRunning = 1;
+    aclkFrequency = LFXT_FREQUENCY;
+    notifyListeners(CLOCK_POST_CHANGE);
+}
+
+ClockProfile clockGetProfile(void) {
+    return currentProfile;
+}
+
+uint32_t getMCLKFrequency(void) {
+    return mclkFrequency;
+}
+
+uint32_t getSMCLKFrequency(void) {
+    return smclkFrequency;
+}
+
+uint32_t getACLKFrequency(void) {
+    return aclkFrequency;
+}
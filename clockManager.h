@@ -0,0 +1,110 @@
+/*! \file */
+/*!
+ * clockManager.h
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Owns the CS (clock system) configuration for MSP432P4111.
+ *              Every clock change goes through clockSetProfile(), which
+ *              keeps the current MCLK/SMCLK/ACLK frequencies and notifies
+ *              registered drivers (delays, UART baud, Timer32, Timer_A3) so
+ *              their timing stays correct at any clock setting.
+ */
+
+#ifndef CLOCKMANAGER_H_
+#define CLOCKMANAGER_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+#define CLOCK_MAX_LISTENERS     8
+#define REFO_FREQUENCY          32768
+#define DCO_12MHZ_FREQUENCY     12000000
+#define HFXT_FREQUENCY          48000000
+#define LFXT_FREQUENCY          32768
+
+typedef enum _ClockProfile {
+    CLOCK_PROFILE_DCO_12MHZ,    // VCORE0, MCLK = SMCLK = 12MHz DCO
+    CLOCK_PROFILE_HFXT_48MHZ    // VCORE1, MCLK = 48MHz HFXT, SMCLK = 24MHz
+} ClockProfile;
+
+typedef enum _ClockEvent {
+    CLOCK_PRE_CHANGE,           // clocks about to change, finish transfers
+    CLOCK_POST_CHANGE           // new frequencies are in effect
+} ClockEvent;
+
+typedef void (*ClockListener)(ClockEvent event);
+
+/*!
+ * \brief This function switches the clock tree to a profile
+ *
+ * This function notifies listeners with CLOCK_PRE_CHANGE, reprograms CS
+ *  (including PCM core voltage and flash wait states when needed), updates
+ *  SystemCoreClock and then notifies listeners with CLOCK_POST_CHANGE.
+ *  Going up, core voltage and wait states are raised before the clock;
+ *  going down, the clock is lowered first. HFXT is left running in the
+ *  DCO profile so switching back up does not wait for crystal startup.
+ *  Does nothing if \b profile is already active.
+ *
+ * Modified CS, PCM and FLCTL peripheral registers.
+ *
+ * \param profile is the clock configuration to switch to
+ *
+ * \return None
+ */
+extern void clockSetProfile(ClockProfile profile);
+
+/*!
+ * \brief This function starts the 32kHz LFXT crystal and selects it for ACLK
+ *
+ * LFXT keeps running in LPM3 and is the RTC_C clock. Blocks until the
+ *  crystal has started. ACLK stays on LFXT across later profile changes.
+ *
+ * \return None
+ */
+extern void clockStartLFXT(void);
+
+/*!
+ * \brief This function returns the active clock profile
+ *
+ * \return current ClockProfile
+ */
+extern ClockProfile clockGetProfile(void);
+
+/*!
+ * \brief This function registers a driver for clock change notifications
+ *
+ * Registering the same function twice has no effect.
+ *
+ * \param listener is called before and after every clock change
+ *
+ * \return 1 on success, 0 if the listener table is full
+ */
+extern uint8_t clockRegisterListener(ClockListener listener);
+
+/*!
+ * \brief These functions return the current clock frequencies in Hz
+ */
+extern uint32_t getMCLKFrequency(void);
+extern uint32_t getSMCLKFrequency(void);
+extern uint32_t getACLKFrequency(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CLOCKMANAGER_H_ */
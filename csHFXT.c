@@ -74,13 +74,15 @@ void configHFXT(void)
     while(CS->IFG & CS_IFG_HFXTIFG)
         CS->CLRIFG |= CS_CLRIFG_CLR_HFXTIFG;
 
-    /* Select clock source for MCLK & HSMCLK = HFXT, no divider */
+    /* Select clock source for MCLK & HSMCLK = HFXT. MCLK undivided; SMCLK
+     *   and HSMCLK divided by 2 to stay within the 24MHz peripheral limit */
     CS->CTL1 = (CS->CTL1 & ~(CS_CTL1_SELM_MASK | CS_CTL1_DIVM_MASK
-                | CS_CTL1_SELS_MASK | CS_CTL1_DIVHS_MASK))      // clear fields
+                | CS_CTL1_SELS_MASK | CS_CTL1_DIVS_MASK | CS_CTL1_DIVHS_MASK))  // clear fields
                 | CS_CTL1_SELM__HFXTCLK         // select MCLK source HFXTCLK
                 | CS_CTL1_SELS__HFXTCLK         // select SMCLK source HFXTCLK
                 | CS_CTL1_DIVM__1               // set MCLK divider /1
-                | CS_CTL1_DIVS__1;              // set SMCLK divider /1
+                | CS_CTL1_DIVHS__2              // set HSMCLK divider /2
+                | CS_CTL1_DIVS__2;              // set SMCLK divider /2
 
     CS->KEY = 0;                        // Lock CS module from unintended accesses
 
@@ -29,7 +29,8 @@ extern "C"
  * \brief This function configures HFXT as clock source for MCLK and SMCLK
  *
  * This function configures PJ.2 and PJ.3 for external oscillator and configures
- *  HFXT as clock source for MCLK and SMCLK with frequency set to 48MHz.
+ *  HFXT as clock source for MCLK (48MHz) and SMCLK (48MHz / 2 = 24MHz).
+ *  Called by clockSetProfile(); use that instead so drivers are notified.
  *
  * Modified bits 2 and 3 of \b PJSEL register. Modified CS, PCM, and FLCTL
  *  peripheral registers.
@@ -0,0 +1,19 @@
+/*! \file */
+/*!
+ * dma.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Shared uDMA control table for MSP432P4111.
+ */
+
+#include "msp.h"
+#include "dma.h"
+
+/* Controller requires the table aligned to its size (8 channels x 2 x 16) */
+#pragma DATA_ALIGN(dmaControlTable, 256)
+DmaControl dmaControlTable[2 * DMA_CHANNEL_COUNT];
+
+void initDMA(void) {
+    DMA_Control->CFG = DMA_CFG_MASTEN;
+    DMA_Control->CTLBASE = (uint32_t)dmaControlTable;
+}
@@ -0,0 +1,95 @@
+/*! \file */
+/*!
+ * dma.h
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Shared uDMA control table for MSP432P4111. Modules that use
+ *              a DMA channel fill in its primary/alternate control entries
+ *              with the DMA_CTL_* fields below; initDMA() only has to run
+ *              once before any channel is enabled.
+ */
+
+#ifndef DMA_H_
+#define DMA_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+#define DMA_CHANNEL_COUNT       8
+
+/* Channel assignments, see device datasheet DMA source table */
+#define DMA_CH_STEPPER          6       // source 6: TA3CCR0
+#define DMA_SRC_STEPPER         6
+#define DMA_CH_ADC              7       // source 7: ADC14
+#define DMA_SRC_ADC             7
+
+/* Channel control word fields */
+#define DMA_CTL_DST_INC_8       (0u << 30)
+#define DMA_CTL_DST_INC_16      (1u << 30)
+#define DMA_CTL_DST_INC_32      (2u << 30)
+#define DMA_CTL_DST_INC_NONE    (3u << 30)
+#define DMA_CTL_DST_SIZE_8      (0u << 28)
+#define DMA_CTL_DST_SIZE_16     (1u << 28)
+#define DMA_CTL_DST_SIZE_32     (2u << 28)
+#define DMA_CTL_SRC_INC_8       (0u << 26)
+#define DMA_CTL_SRC_INC_16      (1u << 26)
+#define DMA_CTL_SRC_INC_32      (2u << 26)
+#define DMA_CTL_SRC_INC_NONE    (3u << 26)
+#define DMA_CTL_SRC_SIZE_8      (0u << 24)
+#define DMA_CTL_SRC_SIZE_16     (1u << 24)
+#define DMA_CTL_SRC_SIZE_32     (2u << 24)
+#define DMA_CTL_ARB_1           (0u << 14)  // re-arbitrate after every item
+#define DMA_CTL_N_OFS           4
+#define DMA_CTL_N_MASK          (0x3FFu << DMA_CTL_N_OFS)
+#define DMA_CTL_N(count)        ((uint32_t)((count) - 1) << DMA_CTL_N_OFS)
+#define DMA_CTL_MODE_MASK       (7u)
+#define DMA_CTL_MODE_STOP       (0u)
+#define DMA_CTL_MODE_BASIC      (1u)
+#define DMA_CTL_MODE_PINGPONG   (3u)
+
+/* One channel control structure */
+typedef struct _DmaControl {
+    volatile const void *srcEnd;        // address of last source item
+    volatile void *dstEnd;              // address of last destination item
+    volatile uint32_t control;
+    uint32_t spare;
+} DmaControl;
+
+/* Primary structures for channels 0-7 followed by the alternates */
+extern DmaControl dmaControlTable[2 * DMA_CHANNEL_COUNT];
+
+#define DMA_PRIMARY(channel)    (&dmaControlTable[(channel)])
+#define DMA_ALTERNATE(channel)  (&dmaControlTable[DMA_CHANNEL_COUNT + (channel)])
+
+/*!
+ * \brief This function enables the uDMA controller
+ *
+ * This function points the controller at dmaControlTable and enables it.
+ *  Safe to call more than once.
+ *
+ * Modified \b DMA_CFG, \b DMA_CTLBASE registers.
+ *
+ * \return None
+ */
+extern void initDMA(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DMA_H_ */
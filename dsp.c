@@ -0,0 +1,186 @@
+/*! \file */
+/*!
+ * dsp.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Fixed-point block kernels, see dsp.h.
+ */
+
+#include "dsp.h"
+
+#if DSP_USE_SIMD
+#include <msp.h>        // CMSIS __SMLAD, __SMLALD, __SSUB16
+#endif
+
+/* Both halves of a word weighted by one, SMLAD with it adds the halves */
+#define PAIR_ONES           0x00010001u
+
+void dspBlockStats(const uint16_t *samples, uint16_t count,
+                   DspBlockStats *stats) {
+#if DSP_USE_SIMD
+    const uint32_t *pairs = (const uint32_t *)samples;
+    uint32_t sum = 0;
+    uint64_t sumSquares = 0;
+    uint32_t pair;
+    uint16_t low, high;
+    uint16_t min = 0xFFFF;
+    uint16_t max = 0;
+    uint16_t i;
+
+    // samples fit in int16, so the signed dual MACs give the unsigned sums
+    for (i = 0; i < count / 2; i++) {
+        pair = pairs[i];
+        sum = __SMLAD(pair, PAIR_ONES, sum);                 // x0 + x1
+        sumSquares = __SMLALD(pair, pair, sumSquares);       // x0^2 + x1^2
+        low = (uint16_t)pair;
+        high = (uint16_t)(pair >> 16);
+        if (low < min) min = low;
+        if (low > max) max = low;
+        if (high < min) min = high;
+        if (high > max) max = high;
+    }
+    if (count & 1) {
+        low = samples[count - 1];
+        sum += low;
+        sumSquares += (uint32_t)low * low;
+        if (low < min) min = low;
+        if (low > max) max = low;
+    }
+
+    stats->sum = sum;
+    stats->sumSquares = sumSquares;
+    stats->min = min;
+    stats->max = max;
+    stats->count = count;
+#else
+    dspBlockStatsReference(samples, count, stats);
+#endif
+}
+
+void dspBlockStatsReference(const uint16_t *samples, uint16_t count,
+                            DspBlockStats *stats) {
+    uint32_t sum = 0;
+    uint64_t sumSquares = 0;
+    uint16_t min = 0xFFFF;
+    uint16_t max = 0;
+    uint16_t i;
+
+    for (i = 0; i < count; i++) {
+        sum += samples[i];
+        sumSquares += (uint32_t)samples[i] * samples[i];
+        if (samples[i] < min) min = samples[i];
+        if (samples[i] > max) max = samples[i];
+    }
+
+    stats->sum = sum;
+    stats->sumSquares = sumSquares;
+    stats->min = min;
+    stats->max = max;
+    stats->count = count;
+}
+
+uint64_t dspSquaredDifference(const int16_t *a, const int16_t *b,
+                              uint16_t count) {
+#if DSP_USE_SIMD
+    const uint32_t *pairsA = (const uint32_t *)a;
+    const uint32_t *pairsB = (const uint32_t *)b;
+    uint64_t total = 0;
+    uint32_t difference;
+    int32_t tail;
+    uint16_t i;
+
+    // differences of in-range samples fit in 16 bits, no saturation needed
+    for (i = 0; i < count / 2; i++) {
+        difference = __SSUB16(pairsA[i], pairsB[i]);
+        total = __SMLALD(difference, difference, total);
+    }
+    if (count & 1) {
+        tail = a[count - 1] - b[count - 1];
+        total += (uint32_t)(tail * tail);
+    }
+    return total;
+#else
+    return dspSquaredDifferenceReference(a, b, count);
+#endif
+}
+
+uint64_t dspSquaredDifferenceReference(const int16_t *a, const int16_t *b,
+                                       uint16_t count) {
+    uint64_t total = 0;
+    int32_t difference;
+    uint16_t i;
+
+    for (i = 0; i < count; i++) {
+        difference = a[i] - b[i];
+        total += (uint32_t)(difference * difference);
+    }
+    return total;
+}
+
+uint16_t dspRms(const DspBlockStats *stats) {
+    uint64_t spread;
+
+    if (stats->count == 0) {
+        return 0;
+    }
+    // n^2 * variance = n * sum(x^2) - sum(x)^2, never negative
+    spread = stats->sumSquares * stats->count
+            - (uint64_t)stats->sum * stats->sum;
+    return (uint16_t)(dspSqrt(spread) / stats->count);
+}
+
+uint16_t dspPeak(const DspBlockStats *stats) {
+    uint16_t mean;
+
+    if (stats->count == 0) {
+        return 0;
+    }
+    mean = (uint16_t)(stats->sum / stats->count);
+    return (stats->max - mean > mean - stats->min)
+            ? stats->max - mean : mean - stats->min;
+}
+
+uint32_t dspSqrt(uint64_t value) {
+    uint64_t root = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+
+    // digit by digit, one result bit per iteration
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)root;
+}
+
+uint32_t dspLog2Q16(uint32_t value) {
+    uint64_t mantissa;
+    uint32_t result = 0;
+    uint8_t i;
+
+    if (value == 0) {
+        value = 1;
+    }
+    while (value >> (result + 1)) {
+        result++;
+    }
+    // mantissa in [1, 2) with 30 fractional bits; squaring it doubles the
+    //  logarithm, so each pass yields one fraction bit
+    mantissa = ((uint64_t)value << 30) >> result;
+    result <<= 16;
+    for (i = 0; i < 16; i++) {
+        mantissa = (mantissa * mantissa) >> 30;
+        if (mantissa >= ((uint64_t)2 << 30)) {
+            mantissa >>= 1;
+            result |= (uint32_t)1 << (15 - i);
+        }
+    }
+    return result;
+}
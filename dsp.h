@@ -0,0 +1,165 @@
+/*! \file */
+/*!
+ * dsp.h
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Fixed-point kernels for blocks of ADC samples. The block
+ *              statistics and squared difference kernels use the Cortex-M4
+ *              dual 16-bit instructions (SSUB16, SMLAD, SMLALD) to handle
+ *              two samples per instruction; plain C reference kernels
+ *              produce bit-identical results and are kept for checking and
+ *              timing.
+ *
+ *              No hardware access.
+ */
+
+#ifndef DSP_H_
+#define DSP_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/* 1 to use the DSP extension intrinsics, 0 for portable C only */
+#ifndef DSP_USE_SIMD
+#if defined(__TI_ARM_V7M4__) || defined(__ARM_FEATURE_DSP)
+#define DSP_USE_SIMD        1
+#else
+#define DSP_USE_SIMD        0
+#endif
+#endif
+
+#define DSP_SAMPLE_MAX      0x7FFF  // samples are non-negative int16 values
+
+/* Sums over one block, enough for mean, RMS and peak */
+typedef struct _DspBlockStats {
+    uint32_t sum;                   // sum of samples
+    uint64_t sumSquares;            // sum of squared samples
+    uint16_t min;
+    uint16_t max;
+    uint16_t count;
+} DspBlockStats;
+
+/*!
+ * \brief This function computes the sums of a block of samples
+ *
+ * This function fills \b stats with the sum, sum of squares, minimum and
+ *  maximum of \b samples. With DSP_USE_SIMD each sample pair is loaded as one
+ *  word and accumulated with one SMLAD and one SMLALD, so \b samples must be
+ *  word aligned. Results are identical to dspBlockStatsReference.
+ *
+ * \param samples is the block, each value 0 to DSP_SAMPLE_MAX
+ * \param count is the number of samples (1 to 65535)
+ * \param stats receives the sums
+ *
+ * \return None
+ */
+extern void dspBlockStats(const uint16_t *samples, uint16_t count,
+                          DspBlockStats *stats);
+
+/*!
+ * \brief This function computes the sums of a block one sample at a time
+ *
+ * Portable C version of dspBlockStats, the reference its results and cycle
+ *  counts are compared against.
+ *
+ * \param samples is the block, each value 0 to DSP_SAMPLE_MAX
+ * \param count is the number of samples (1 to 65535)
+ * \param stats receives the sums
+ *
+ * \return None
+ */
+extern void dspBlockStatsReference(const uint16_t *samples, uint16_t count,
+                                   DspBlockStats *stats);
+
+/*!
+ * \brief This function returns the squared distance between two blocks
+ *
+ * This function returns the sum of (a[i] - b[i])^2, the YIN difference
+ *  function when \b b is \b a delayed by the lag. With DSP_USE_SIMD both
+ *  blocks are read as sample pairs, so both must be word aligned; callers
+ *  keep a copy shifted by one sample for odd lags. Results are identical to
+ *  dspSquaredDifferenceReference.
+ *
+ * \param a is the first block, each value -16384 to 16383
+ * \param b is the second block, same range
+ * \param count is the number of samples (1 to 65535)
+ *
+ * \return sum of squared differences
+ */
+extern uint64_t dspSquaredDifference(const int16_t *a, const int16_t *b,
+                                     uint16_t count);
+
+/*!
+ * \brief This function returns the squared distance one sample at a time
+ *
+ * Portable C version of dspSquaredDifference.
+ *
+ * \param a is the first block, each value -16384 to 16383
+ * \param b is the second block, same range
+ * \param count is the number of samples (1 to 65535)
+ *
+ * \return sum of squared differences
+ */
+extern uint64_t dspSquaredDifferenceReference(const int16_t *a,
+                                              const int16_t *b,
+                                              uint16_t count);
+
+/*!
+ * \brief This function returns the AC RMS of a block
+ *
+ * This function removes the block mean and returns the root mean square of
+ *  what is left, rounded down, using integer arithmetic only.
+ *
+ * \param stats is the output of dspBlockStats
+ *
+ * \return RMS in ADC counts
+ */
+extern uint16_t dspRms(const DspBlockStats *stats);
+
+/*!
+ * \brief This function returns the peak deviation of a block from its mean
+ *
+ * \param stats is the output of dspBlockStats
+ *
+ * \return largest distance of min or max from the mean, in ADC counts
+ */
+extern uint16_t dspPeak(const DspBlockStats *stats);
+
+/*!
+ * \brief This function returns the integer square root
+ *
+ * \param value is the radicand
+ *
+ * \return floor(sqrt(value))
+ */
+extern uint32_t dspSqrt(uint64_t value);
+
+/*!
+ * \brief This function returns the base 2 logarithm in fixed point
+ *
+ * \param value is the argument, 0 is treated as 1
+ *
+ * \return log2(value) with 16 fractional bits, accurate to 1 LSB
+ */
+extern uint32_t dspLog2Q16(uint32_t value);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP_H_ */
@@ -2,7 +2,20 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdio.h>
-#include "csHFXT.h"
+#include <string.h>
+#include "clockManager.h"
+#include "powerManager.h"
+#include "profiler.h"
+#include "trace.h"
+#include "stackMonitor.h"
+#include "benchmark.h"
+#include "songQueue.h"
+#include "flashStore.h"
+#include "songLists.h"
+#include "shuffle.h"
+#include "microphone.h"
+#include "pitch.h"
+#include "score.h"
 #include "csLFXT.h"
 #include "stepperMotor.h"
 #include "lcd.h"
@@ -19,11 +32,13 @@
 #define SwitchSelect      0b00001000      // P3.3
 #define SwitchToggle         0b00100000      // P3.5
 #define SwitchReset         0b01000000      // P3.6
+#define SwitchAll       (SwitchNext | SwitchSelect | SwitchToggle | SwitchReset)
 
 #define LED_FLASHING_PERIOD 200         // milliseconds
+#define SCORE_REFRESH_MS    1000        // fastest score redraw
+#define QUEUE_FULL_MS       2000        // "Full" tag after a rejected song
 #define SYSTEM_CLOCK_FREQUENCY 3000     // kHz
 #define SINGLE_LOOP_CYCLES  88
-#define CLK_FREQUENCY       48000000    // MCLK using 48MHz HFXT
 
 // Delay for debouncing
 #define DEBOUNCE_DELAY_CYCLES 5000
@@ -43,6 +58,24 @@ ScreenState currentState = START_SCREEN;
 uint8_t currentSong = 0;
 uint8_t isPlaying = 0;
 uint8_t isReset = 0;
+uint8_t playingSong = 0;    // song sent to the ESP32, currentSong is browsed
+uint8_t songLoaded = 0;     // a song is playing or paused
+
+// Which list Next steps through in the select screen
+typedef enum _BrowseMode {
+    BROWSE_ALL, BROWSE_RECENT, BROWSE_FAVORITES, BROWSE_SHUFFLE
+} BrowseMode;
+
+BrowseMode browseMode = BROWSE_ALL;
+RecentList recentSongs;
+FavoriteSet favoriteSongs;
+ShuffleIterator shuffleOrder;   // keeps playing shuffled songs when idle
+
+uint32_t songStartBlock = 0;    // microphone block count at the song start
+uint8_t shownScore = 0;         // score in the status tag
+uint32_t scoreDrawTime = 0;
+uint8_t queueFullShown = 0;     // playlist rejected a song, tag says "Full"
+uint32_t queueFullTime = 0;
 
 //song list
 const char *songList[] = {
@@ -75,9 +108,17 @@ const char *songList[] = {
     "We Are The Champions-Queen"
 };
 
+//song tempo in beats per minute, same order as songList
+const uint8_t songTempo[] = {
+    96, 100, 160, 116, 123, 104, 117, 48, 127, 126, 95, 80, 129, 87,
+    104, 110, 186, 95, 110, 84, 120, 170, 86, 87, 105, 75, 64
+};
+
 //song count
 #define SONG_COUNT (sizeof(songList) / sizeof(songList[0]))
 
+uint16_t currentTempo = 0;  // beats per minute x100, catalog or UART "B:"
+
 // Function prototypes
 void InitializeSwitches(void);
 SwitchState CheckSwitchNext(void);
@@ -88,118 +129,723 @@ void debounce(void);
 void handleButtonPress(void);
 extern void play_serial_audio_stereo(void);
 void InitializePlaybackLED(void);
+void updateStepperForPlayback(void);
+void handleUartCommand(const char *command);
+uint16_t parseTempo(const char *text);
+uint8_t parseReference(const char *text, uint32_t *ms, uint8_t *note);
 
 volatile uint8_t updateLCD = 0;
 
+// Events that drive the UI state machine
+typedef enum _UiEvent {
+    UI_EVENT_NONE, UI_EVENT_NEXT, UI_EVENT_SELECT, UI_EVENT_TOGGLE,
+    UI_EVENT_RESET, UI_EVENT_SONG_END
+} UiEvent;
+
+#define UI_ANY_STATE    0xFF    // transition applies in every state
+
+// One row of the transition table, action may be NULL
+typedef struct _UiTransition {
+    uint8_t state;              // ScreenState or UI_ANY_STATE
+    UiEvent event;
+    void (*action)(void);
+    uint8_t next;               // ScreenState entered after the action
+} UiTransition;
+
+static void actionReset(void);
+static void actionNextSong(void);
+static void actionQueueSong(void);
+static void actionTogglePlayback(void);
+static void actionSongEnd(void);
+static void actionBrowseMode(void);
+static void actionFavorite(void);
+
+// (state, event) -> (action, next state), first match wins
+static const UiTransition uiTransitions[] = {
+    { UI_ANY_STATE,   UI_EVENT_RESET,    actionReset,          START_SCREEN },
+    { START_SCREEN,   UI_EVENT_NEXT,     NULL,                 SELECT_SCREEN },
+    { START_SCREEN,   UI_EVENT_SELECT,   NULL,                 SELECT_SCREEN },
+    { SELECT_SCREEN,  UI_EVENT_NEXT,     actionNextSong,       SELECT_SCREEN },
+    { SELECT_SCREEN,  UI_EVENT_SELECT,   actionQueueSong,      PLAYING_SCREEN },
+    { SELECT_SCREEN,  UI_EVENT_TOGGLE,   actionBrowseMode,     SELECT_SCREEN },
+    { SELECT_SCREEN,  UI_EVENT_SONG_END, actionSongEnd,        SELECT_SCREEN },
+    { PLAYING_SCREEN, UI_EVENT_TOGGLE,   actionTogglePlayback, PLAYING_SCREEN },
+    { PLAYING_SCREEN, UI_EVENT_NEXT,     NULL,                 SELECT_SCREEN },
+    { PLAYING_SCREEN, UI_EVENT_SELECT,   actionFavorite,       PLAYING_SCREEN },
+    { PLAYING_SCREEN, UI_EVENT_SONG_END, actionSongEnd,        PLAYING_SCREEN },
+};
+
+#define UI_TRANSITION_COUNT (sizeof(uiTransitions) / sizeof(uiTransitions[0]))
+
+/* Screen needs one redraw, set on any change. A tag-only change on the song
+ *  already shown rewrites just the changed cells */
+#define UI_DIRTY_FRAME  0x01    // both rows
+#define UI_DIRTY_TAG    0x02    // status tag, or the title under a hidden bar
+static uint8_t uiDirty = UI_DIRTY_FRAME;
+
+// Resume state kept in INFO flash, a layout change must change its size,
+// 52 bytes of the STORE_PAYLOAD_MAX
+typedef struct _ResumeState {
+    uint32_t favorites[FAVORITE_WORDS];
+    uint8_t currentSong;
+    uint8_t queueLength;
+    uint8_t queuePosition;
+    uint8_t queue[SONG_QUEUE_SIZE];
+    uint8_t recentCount;
+    uint8_t recent[RECENT_SIZE];    // most recent first
+} ResumeState;
+
+static void saveResumeState(void);
+static void restoreResumeState(void);
+
+// Boot work still pending in the main loop
+typedef enum _BootStage {
+    BOOT_STAGE_LCD, BOOT_STAGE_FRAME, BOOT_STAGE_DONE
+} BootStage;
+
+static BootStage bootStage = BOOT_STAGE_LCD;
+
+static void bootStep(void);
+static void updateScore(void);
+
 // Global variables
 LEDcolors CurrentLED = NONE;
 
 //main function
 int main(void)
 {
+    char uartCommand[UART_LINE_MAX + 1];
     WDT_A->CTL = WDT_A_CTL_PW | WDT_A_CTL_HOLD;  // Stop watchdog timer
+    stackPaint();   // before anything deep runs, for the high-water mark
 
     //initializing everything
-    configHFXT();
+    profileBootStart();
+    clockSetProfile(CLOCK_PROFILE_HFXT_48MHZ);  // MCLK 48MHz, SMCLK 24MHz
+    profileBootMark(BOOT_CLOCK);
     Timer32_Init();
+    configLCD(getMCLKFrequency());
+    lcdInitStart();     // LCD power-up wait runs while the rest is set up
+    initProfiler();
+    initTrace();
+    initFlashStore();
+    restoreResumeState();
     InitializePlaybackLED();
     InitializeSwitches();
-    initStepperMotor();
-    enableStepperMotor();
-    configLCD(CLK_FREQUENCY);
-    initLCD();
+    initStepperMotor();     // idle until a song plays, see updateStepperForPlayback
+    initMicrophone();
     initUART();
+    profileBootMark(BOOT_INIT);
+    isReset = 1;
+    sendPlaybackStatus(isPlaying, currentSong, isReset); // tells the ESP32 we restarted
+    isReset = 0;
+    profileBootMark(BOOT_FIRST_STATUS);
 
     //while loop
     while (1) {
+        if (uartReadLine(uartCommand, sizeof(uartCommand))) {
+            powerActivity();
+            TRACE(TRACE_UART_LINE, (uint8_t)uartCommand[0]);
+            PROFILE_BEGIN(PROF_UART_CMD);
+            handleUartCommand(uartCommand); // commands from the ESP32
+            PROFILE_END(PROF_UART_CMD);
+        }
+        if ((SwitchPort->IN & SwitchAll) != SwitchAll) {
+            powerActivity();    // full clock while a button is handled
+        }
+        if (bootStage != BOOT_STAGE_DONE) {
+            bootStep();         // LCD sequence, then the RTC after the first frame
+        }
         handleButtonPress();
-        if (updateLCD) {
+        if (queueFullShown && getSystemTime() - queueFullTime >= QUEUE_FULL_MS) {
+            queueFullShown = 0;
+            uiDirty |= UI_DIRTY_TAG;    // back to the playlist position
+        }
+        powerUpdate();      // drop to low power after idle timeout
+        storeUpdate();      // batched flash writes, never blocks for an erase
+        if (micUpdate()) {
+            updateScore();      // only once the ESP32 sent a reference track
+            if (isPlaying && currentState == PLAYING_SCREEN
+                    && bootStage != BOOT_STAGE_LCD && !uiDirty) {
+                lcdSetLevelBar(micGetLevel(LCD_BAR_LEVELS));    // changed cells only
+            }
+        }
+        if (bootStage == BOOT_STAGE_DONE && !isPlaying && !updateLCD
+                && !isStepperRunning(STEPPER_MAIN) && uartIsIdle() && storeIsIdle()
+                && (SwitchPort->IN & SwitchAll) == SwitchAll) {
+            powerSleep();   // LPM3 until a switch press or the RTC second
+        }
+        if (updateLCD && bootStage != BOOT_STAGE_LCD) {
+            PROFILE_BEGIN(PROF_DISPLAY);
             updateLCD = 0;  // Reset flag
             lcdDisplayTitleArtist(songList[currentSong]); //calls the updating scrolling lcd text function
+            PROFILE_END(PROF_DISPLAY);
         }
+#if PROFILER_ENABLED
+        profileCheckAlarms();   // report budget overruns
+#endif
         __no_operation();
     }
 
 }
 
-//main state machine, handles button presses and other important features
-void handleButtonPress() {
-    static ScreenState lastState = (ScreenState)(-1);
+// Browse list letter, favorite star and playlist position, e.g. "R*2/5"
+static void buildStatusTag(char *tag, size_t size)
+{
+    uint8_t length = 0;
 
-    if (CheckSwitchReset() == Pressed) { //reset button
-        currentState = START_SCREEN;
-        currentSong = 0;
-        isPlaying = 0;
-        isReset = 1;
-        sendPlaybackStatus(isPlaying, currentSong, isReset); // sends uart command
-        isReset = 0;
-        PLAYBACK_LED_PORT->OUT &= ~PLAYBACK_LED_PIN; //toggles led off
+    if (currentState == SELECT_SCREEN && browseMode != BROWSE_ALL) {
+        tag[length++] = browseMode == BROWSE_RECENT ? 'R'
+                        : browseMode == BROWSE_FAVORITES ? 'F' : 'S';
+    }
+    if (favoriteContains(&favoriteSongs, currentSong)) {
+        tag[length++] = '*';
+    }
+    tag[length] = '\0';
+    if (queueFullShown) {
+        strcpy(tag, "Full");    // replaces the whole tag for a moment
+    } else if (currentState == PLAYING_SCREEN && scoreIsActive()) {
+        shownScore = scoreGet();    // "100%" replaces the playlist position
+        scoreDrawTime = getSystemTime();
+        snprintf(tag + length, size - length, "%u%%", shownScore);
+    } else if (queueLength()) {    // at most "8/8"
+        // a position that does not fit is left out rather than cut in half
+        if (snprintf(tag + length, size - length, "%u/%u",
+                     queuePosition(), queueLength())
+                >= (int)(size - length)) {
+            tag[length] = '\0';
+        }
+    }
+}
+
+// Render the current screen, called once per logical change
+static void renderScreen(void)
+{
+    char tag[LCD_TAG_MAX + 1] = "";
+
+    if (currentState != PLAYING_SCREEN || !isPlaying) {
+        lcdSetLevelBar(LCD_BAR_OFF);    // the next block brings it back
+    }
+    switch (currentState) {
+    case START_SCREEN: //starting state, puts welcome message
+        lcdSetStatusTag(tag);
+        lcdClearDisplay();
+        lcdSetCursor(0, 0);
+        lcdPrintString(" Karaoke Machine");
+        lcdSetCursor(1, 0);
+        lcdPrintString("  Press \"Next\"");
+#if LCD_MONITOR
+        lcdCaptureFrame();
+#endif
+        break;
+    case SELECT_SCREEN: // selection state, displays current song and artist
+    case PLAYING_SCREEN: // playing state, displays current song and artist
+        buildStatusTag(tag, sizeof(tag));
+        lcdSetStatusTag(tag);
+        // clears only when the text changed, otherwise overwrites both rows
+        lcdDisplayTitleArtist(songList[currentSong]);
+        break;
+    }
+}
+
+// Redraw for UI_DIRTY_TAG alone, the same song stays on screen
+static void renderStatusTag(void)
+{
+    char tag[LCD_TAG_MAX + 1] = "";
+
+    if (currentState == START_SCREEN) {
+        renderScreen();     // no tag on the start screen
+        return;
+    }
+    if (currentState != PLAYING_SCREEN || !isPlaying) {
+        lcdSetLevelBar(LCD_BAR_OFF);
+    }
+    buildStatusTag(tag, sizeof(tag));
+    lcdUpdateStatusTag(tag);    // changed cells only
+}
+
+// Returns the next debounced button event, waits for the button to release
+static UiEvent readButtonEvent(void)
+{
+    if (CheckSwitchReset() == Pressed) {
         while (CheckSwitchReset() == Pressed) {}
+        return UI_EVENT_RESET;
+    }
+    if (CheckSwitchSelect() == Pressed) {
+        while (CheckSwitchSelect() == Pressed) {}
+        return UI_EVENT_SELECT;
+    }
+    if (CheckSwitchNext() == Pressed) {
+        while (CheckSwitchNext() == Pressed) {}
+        return UI_EVENT_NEXT;
+    }
+    if (CheckSwitchToggle() == Pressed) {
+        while (CheckSwitchToggle() == Pressed) {}
+        return UI_EVENT_TOGGLE;
+    }
+    return UI_EVENT_NONE;
+}
+
+// Looks up an event in the transition table and runs the first match
+static void uiDispatch(UiEvent event)
+{
+    const UiTransition *transition;
+    uint8_t i;
+
+    for (i = 0; i < UI_TRANSITION_COUNT; i++) {
+        transition = &uiTransitions[i];
+        if (transition->event != event
+                || (transition->state != UI_ANY_STATE
+                    && transition->state != currentState)) {
+            continue;
+        }
+        if (transition->action) {
+            transition->action();
+        }
+        if (transition->next != currentState) {
+            currentState = (ScreenState)transition->next;
+            uiDirty |= UI_DIRTY_FRAME;
+        }
+        break;  // first match wins
+    }
+}
+
+//main state machine, feeds button events to the transition table
+void handleButtonPress() {
+    UiEvent event = readButtonEvent();  // not profiled, waits out the hold
+    PROFILE_BEGIN(PROF_STATE_MACHINE);
+
+    if (event != UI_EVENT_NONE) {
+        uiDispatch(event);
+    }
+
+    if (uiDirty && bootStage != BOOT_STAGE_LCD) {
+        TRACE(TRACE_STATE, currentState);
+        if (uiDirty & UI_DIRTY_FRAME) {
+            renderScreen();
+        } else {
+            renderStatusTag();
+        }
+        uiDirty = 0;
+        profileBootMark(BOOT_FIRST_FRAME);
+        saveResumeState();  // staged only, written once things settle
+    }
+    PROFILE_END(PROF_STATE_MACHINE);
+}
+
+// Parts of the boot that run from the main loop, one step per pass
+static void bootStep(void)
+{
+    switch (bootStage) {
+    case BOOT_STAGE_LCD: // issue the LCD sequence as its hold times run out
+        if (lcdInitPoll()) {
+            profileBootMark(BOOT_LCD_READY);
+            bootStage = BOOT_STAGE_FRAME;
+        }
+        break;
+    case BOOT_STAGE_FRAME: // LFXT start spins, keep it behind the first frame
+        if (!uiDirty) {
+            initPowerManager();
+            profileBootMark(BOOT_RTC);
+            bootStage = BOOT_STAGE_DONE;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+// Scores the newest microphone block against the reference track
+static void updateScore(void)
+{
+    PitchEstimate pitch;
+    const uint16_t *samples;
+    uint32_t block;
+
+    if (!scoreHasTrack()) {
         return;
     }
+    powerActivity();    // the detector's cycle budget is set at 48MHz
+    samples = micLastBlock(&block);
+    PROFILE_BEGIN(PROF_PITCH);
+    pitchDetect(samples, MIC_BLOCK_SIZE, &pitch);
+    scoreBlock(MIC_BLOCKS_TO_MS(block - songStartBlock), pitch.cents);
+    PROFILE_END(PROF_PITCH);
+
+    if (currentState == PLAYING_SCREEN && scoreGet() != shownScore
+            && getSystemTime() - scoreDrawTime >= SCORE_REFRESH_MS) {
+        uiDirty |= UI_DIRTY_TAG;    // new score in the status tag
+    }
+}
+
+// Stages the song and playlist for the flash store
+static void saveResumeState(void)
+{
+    ResumeState resume;
+    uint8_t i;
+
+    resume.currentSong = currentSong;
+    resume.queueLength = queueLength();
+    resume.queuePosition = queuePosition();
+    for (i = 0; i < SONG_QUEUE_SIZE; i++) {
+        resume.queue[i] = i < resume.queueLength ? queueAt(i) : 0;
+    }
+    memset(resume.recent, 0, sizeof(resume.recent));
+    resume.recentCount = recentExport(&recentSongs, resume.recent);
+    memcpy(resume.favorites, favoriteSongs.bits, sizeof(resume.favorites));
+    storeSave(&resume, sizeof(resume));
+}
+
+// Picks up where the last power cycle left off, in the select screen
+static void restoreResumeState(void)
+{
+    ResumeState resume;
+    uint8_t song;
+    uint8_t i;
+
+    recentClear(&recentSongs);
+    favoriteClear(&favoriteSongs);
+    if (!storeLoad(&resume, sizeof(resume))
+            || resume.currentSong >= SONG_COUNT
+            || resume.queueLength > SONG_QUEUE_SIZE
+            || resume.queuePosition > resume.queueLength
+            || resume.recentCount > RECENT_SIZE) {
+        return;
+    }
+    favoriteRestore(&favoriteSongs, resume.favorites);
+    for (i = resume.recentCount; i > 0; i--) {
+        if (resume.recent[i - 1] < SONG_COUNT) {
+            recentTouch(&recentSongs, resume.recent[i - 1]);   // oldest first
+        }
+    }
+    queueClear();
+    for (i = 0; i < resume.queueLength; i++) {
+        if (resume.queue[i] < SONG_COUNT) {
+            queueAdd(resume.queue[i]);
+        }
+    }
+    for (i = 0; i < resume.queuePosition; i++) {
+        queueAdvance(&song);    // finished before the power cycle
+    }
+    currentSong = resume.currentSong;
+    currentState = SELECT_SCREEN;
+}
+
+// Playback LED follows isPlaying
+static void updatePlaybackLED(void)
+{
+    if (isPlaying) {
+        PLAYBACK_LED_PORT->OUT |= PLAYBACK_LED_PIN;  // LED ON when playing
+    } else {
+        PLAYBACK_LED_PORT->OUT &= ~PLAYBACK_LED_PIN; // LED OFF when paused
+    }
+}
+
+// Level meter runs while a song plays, the bar goes away with it
+static void updateMicForPlayback(void)
+{
+    if (isPlaying) {
+        micStart();
+    } else {
+        micStop();
+        uiDirty |= UI_DIRTY_TAG;    // title back under the level bar
+    }
+}
+
+// Starts the next playlist entry, returns 0 if the playlist is exhausted
+static uint8_t startNextSong(void)
+{
+    uint8_t song;
+
+    if (!queueAdvance(&song)) {
+        return 0;
+    }
+    playingSong = song;
+    songLoaded = 1;
+    isPlaying = 1;
+    sendPlaybackStatus(isPlaying, playingSong, isReset); // ESP32 first, no dead air
+    TRACE(TRACE_QUEUE, song);
+    scoreReset();       // the ESP32 streams the new song's track
+    songStartBlock = micBlockCount();
+    shownScore = 0xFF;  // first scored block redraws the tag
+    recentTouch(&recentSongs, song);
+    currentTempo = songTempo[song] * 100;
+    updatePlaybackLED();
+    updateStepperForPlayback();
+    updateMicForPlayback();
+    return 1;
+}
+
+// Reset button, back to the first song, stopped, empty playlist
+static void actionReset(void)
+{
+    queueClear();
+    scoreReset();
+    currentSong = 0;
+    playingSong = 0;
+    songLoaded = 0;
+    browseMode = BROWSE_ALL;
+    isPlaying = 0;
+    isReset = 1;
+    sendPlaybackStatus(isPlaying, currentSong, isReset); // sends uart command
+    isReset = 0;
+    updatePlaybackLED();
+    updateStepperForPlayback();
+    updateMicForPlayback();
+}
+
+// Next in the select screen, step through the list being browsed
+static void actionNextSong(void)
+{
+    int16_t next;
+
+    switch (browseMode) {
+    case BROWSE_RECENT:
+        next = recentOlder(&recentSongs, currentSong);
+        break;
+    case BROWSE_FAVORITES:
+        next = favoriteNext(&favoriteSongs, currentSong);
+        break;
+    case BROWSE_SHUFFLE:
+        next = (int16_t)shuffleNext(&shuffleOrder);
+        break;
+    default:
+        next = -1;
+        break;
+    }
+    if (next < 0 || next >= (int16_t)SONG_COUNT) {
+        next = (currentSong + 1) % SONG_COUNT;  // Increase song index and wrap
+    }
+    currentSong = (uint8_t)next;
+    uiDirty |= UI_DIRTY_FRAME;  // same screen, new content
+}
+
+// Toggle in the select screen, browse all songs, recent ones, favorites or
+// a shuffled order
+static void actionBrowseMode(void)
+{
+    int16_t first = -1;
+    uint8_t shown = currentSong;
 
-    if (currentState != lastState) {
-        lastState = currentState;
-        switch (currentState) {
-        case START_SCREEN: //starting state, puts welcome message
-            lcdClearDisplay();
-            lcdSetCursor(0, 0);
-            lcdPrintString(" Karaoke Machine");
-            lcdSetCursor(1, 0);
-            lcdPrintString("  Press \"Next\"");
-            break;
-        case SELECT_SCREEN: // selection state, displays current song and artist
-            lcdClearDisplay();
-            lcdDisplayTitleArtist(songList[currentSong]);  // Show song title and artist
-            break;
-        case PLAYING_SCREEN:// playing state, displays current song and artist
-            lcdClearDisplay();
-            lcdDisplayTitleArtist(songList[currentSong]);  // Show song title and artist
-            break;
+    do {
+        browseMode = (BrowseMode)((browseMode + 1) % (BROWSE_SHUFFLE + 1));
+        if (browseMode == BROWSE_RECENT) {
+            first = recentNewest(&recentSongs);
+        } else if (browseMode == BROWSE_FAVORITES) {
+            first = favoriteContains(&favoriteSongs, currentSong)
+                    ? currentSong : favoriteNext(&favoriteSongs, currentSong);
+        } else if (browseMode == BROWSE_SHUFFLE) {
+            // button timing picks the order
+            shuffleInit(&shuffleOrder, SONG_COUNT, DWT->CYCCNT);
+            first = (int16_t)shuffleNext(&shuffleOrder);
         }
+    } while (browseMode != BROWSE_ALL && first < 0);    // skip empty lists
+
+    if (first >= 0 && first < (int16_t)SONG_COUNT) {
+        currentSong = (uint8_t)first;
     }
+    uiDirty |= (currentSong == shown) ? UI_DIRTY_TAG : UI_DIRTY_FRAME;
+}
 
-    switch (currentState) {
-    case START_SCREEN: // changes to select if select or next is pressed
-        if (CheckSwitchSelect() == Pressed || CheckSwitchNext() == Pressed) {
-            currentState = SELECT_SCREEN;
-            while (CheckSwitchSelect() == Pressed || CheckSwitchNext() == Pressed) {}
+// Select while playing, add or remove the song from the favorites
+static void actionFavorite(void)
+{
+    favoriteToggle(&favoriteSongs, playingSong);
+    uiDirty |= UI_DIRTY_TAG;    // favorite star in the status tag
+}
+
+// Select in the select screen, queue the song and start it if idle
+static void actionQueueSong(void)
+{
+    if (!queueAdd(currentSong)) {
+        queueFullShown = 1;     // nothing played yet can make room
+        queueFullTime = getSystemTime();
+    }
+    if (!songLoaded) {
+        startNextSong();
+    }
+    currentSong = playingSong;  // playing screen shows what is playing
+    uiDirty |= UI_DIRTY_FRAME;
+}
+
+// Toggle while playing, pause or resume, replays a finished song
+static void actionTogglePlayback(void)
+{
+    isPlaying = !isPlaying; // toggles playing
+    songLoaded = 1;
+    if (isPlaying) {
+        recentTouch(&recentSongs, playingSong);
+    }
+    sendPlaybackStatus(isPlaying, playingSong, isReset); // sends uart command
+    updatePlaybackLED();
+    updateStepperForPlayback();
+    updateMicForPlayback();
+}
+
+// ESP32 reported the end of the song, start the next one right away
+static void actionSongEnd(void)
+{
+    ShuffleIterator shuffle;
+
+    if (scoreIsActive()) {
+        scoreReport(playingSong);   // final score of the song
+    }
+    if (browseMode == BROWSE_SHUFFLE && !queuePending()) {
+        shuffle = shuffleOrder;     // the song stays next if it does not fit
+        if (!queueAdd((uint8_t)shuffleNext(&shuffle))) {
+            queueFullShown = 1;
+            queueFullTime = getSystemTime();
+        } else {
+            shuffleOrder = shuffle;     // shuffle play
+        }
+    }
+    if (!startNextSong()) {
+        songLoaded = 0;
+        isPlaying = 0;
+        sendPlaybackStatus(isPlaying, playingSong, isReset); // sends uart command
+        updatePlaybackLED();
+        updateStepperForPlayback();
+        updateMicForPlayback();
+    }
+    if (currentState == PLAYING_SCREEN) {
+        currentSong = playingSong;
+    }
+    uiDirty |= UI_DIRTY_FRAME;  // song or playlist position changed
+}
+
+// Stepper follows the song tempo while playing, ramps to a stop otherwise.
+// It stays on the Timer_A3 interrupt, DMA stepping cannot keep the beat
+void updateStepperForPlayback(void)
+{
+    if (isPlaying && currentTempo) {
+        stepperFollowTempo(STEPPER_MAIN, currentTempo);
+    } else {
+        stepperRequestStop(STEPPER_MAIN);
+    }
+}
+
+// Handles one command line received from the ESP32
+void handleUartCommand(const char *command)
+{
+    uint16_t tempo;
+    uint32_t ms;
+    uint8_t note;
+
+    switch (command[0]) {
+    case 'B': // "B:<bpm>" tempo of the current song, e.g. B:120 or B:120.5
+        tempo = parseTempo(command + 2);
+        if (command[1] == ':' && tempo) {
+            currentTempo = tempo;
+            updateStepperForPlayback();
         }
         break;
-    case SELECT_SCREEN: // changes to playing if select is pressed
-        if (CheckSwitchSelect() == Pressed) {
-            currentState = PLAYING_SCREEN;
-            isPlaying = !isPlaying; // toggles playing
-            sendPlaybackStatus(isPlaying, currentSong, isReset); // sends uart command
-            if (isPlaying) {
-                PLAYBACK_LED_PORT->OUT |= PLAYBACK_LED_PIN;  // LED ON when playing
-            } else {
-                PLAYBACK_LED_PORT->OUT &= ~PLAYBACK_LED_PIN; // LED OFF when paused
-            }
-            lastState = (ScreenState)(-1);
-            while (CheckSwitchSelect() == Pressed) {}
-        } else if (CheckSwitchNext() == Pressed) {
-            currentSong = (currentSong + 1) % SONG_COUNT;  // Increase song index and wrap
-            lcdClearDisplay();
-            lcdDisplayTitleArtist(songList[currentSong]);  // Update display immediately
-            lastState = (ScreenState)(-1);  // Force a UI update
-            while (CheckSwitchNext() == Pressed) {}
+    case 'R': // "R:<ms>:<note>" reference pitch track event, note 0 is a rest
+        if (command[1] == ':' && parseReference(command + 2, &ms, &note)) {
+            scoreAddReference(ms, note);
         }
         break;
-    case PLAYING_SCREEN: // Handles playback button presses
-        if (CheckSwitchToggle() == Pressed) {
-            isPlaying = !isPlaying; // toggles playing variable
-            sendPlaybackStatus(isPlaying, currentSong, isReset); // sends uart command
-            if (isPlaying) {
-                PLAYBACK_LED_PORT->OUT |= PLAYBACK_LED_PIN;  // LED ON when playing
-            } else {
-                PLAYBACK_LED_PORT->OUT &= ~PLAYBACK_LED_PIN; // LED OFF when paused
-            }
-            lastState = (ScreenState)(-1);
-            while (CheckSwitchToggle() == Pressed) {}
+    case 'G': // running score of the playing song
+        scoreReport(playingSong);
+        break;
+    case 'E': // end of song, auto-advance through the playlist
+        uiDispatch(UI_EVENT_SONG_END);
+        break;
+    case 'P': // CPU budget report, "PR" also clears the figures
+        profileReport();
+        if (command[1] == 'R') {
+            profileReset();
+        }
+        break;
+    case 'T': // per-task budget figures
+        profileReportBudgets();
+        break;
+    case 'X': // event trace dump
+        traceDump();
+        break;
+    case 'S': // flash store statistics
+        storeReport();
+        break;
+    case 'N': // microphone level and block statistics
+        micReport();
+        break;
+    case 'M': // stack high-water mark
+        stackReport();
+        break;
+    case 'K': // display and protocol microbenchmarks, then redraw
+        if (bootStage != BOOT_STAGE_LCD) {
+            runBenchmarks(songList, SONG_COUNT);
+            uiDirty |= UI_DIRTY_FRAME;
         }
         break;
+    case 'O': // boot milestones
+        profileReportBoot();
+        break;
+    case 'V': // DVFS statistics request
+        powerReportStats();
+        break;
+    case 'W': // LPM3 sleep statistics request
+        powerReportSleepStats();
+        break;
+#if LCD_MONITOR
+    case 'F': // LCD frame history request
+        lcdReportFrames();
+        break;
+    case 'L': // LCD bus statistics request
+        lcdReportStats();
+        break;
+#endif
+    default:
+        break;
+    }
+}
+
+// Parses "<bpm>[.<fraction>]" into beats per minute x100, 0 if invalid
+uint16_t parseTempo(const char *text)
+{
+    uint32_t value = 0;
+    uint32_t scale = 100;
+
+    while (*text >= '0' && *text <= '9' && value < 1000) {
+        value = value * 10 + (*text++ - '0');
+    }
+    value *= 100;
+    if (*text == '.') {
+        text++;
+        while (*text >= '0' && *text <= '9' && scale > 1) {
+            scale /= 10;
+            value += (*text++ - '0') * scale;
+        }
+    }
+    if (value == 0 || value > 0xFFFF) {
+        return 0;
     }
+    return (uint16_t)value;
+}
+
+// Parses "<ms>:<note>", returns 0 if invalid
+uint8_t parseReference(const char *text, uint32_t *ms, uint8_t *note)
+{
+    uint32_t value = 0;
+    uint8_t digits = 0;
+
+    while (*text >= '0' && *text <= '9' && digits < 9) {
+        value = value * 10 + (*text++ - '0');
+        digits++;
+    }
+    if (!digits || *text++ != ':') {
+        return 0;
+    }
+    *ms = value;
+    value = 0;
+    digits = 0;
+    while (*text >= '0' && *text <= '9' && digits < 3) {
+        value = value * 10 + (*text++ - '0');
+        digits++;
+    }
+    if (!digits || value > 127) {
+        return 0;
+    }
+    *note = (uint8_t)value;
+    return 1;
 }
 
 // Debounce function to avoid switch bouncing issues
@@ -265,4 +911,18 @@ void InitializeSwitches(void)
     SwitchPort->DIR &= ~(SwitchNext | SwitchSelect | SwitchToggle | SwitchReset);  // Set as input
     SwitchPort->REN |= (SwitchNext | SwitchSelect | SwitchToggle | SwitchReset);   // Enable pull resistors
     SwitchPort->OUT |= (SwitchNext | SwitchSelect | SwitchToggle | SwitchReset);   // Set pull-up mode
+
+    // Falling edge interrupts wake the CPU from LPM3
+    SwitchPort->IES |= SwitchAll;
+    SwitchPort->IFG &= ~SwitchAll;
+    SwitchPort->IE |= SwitchAll;
+    NVIC_EnableIRQ(PORT3_IRQn);
+}
+
+// Switch press while asleep, polling in handleButtonPress does the rest
+void PORT3_IRQHandler(void)
+{
+    TRACE(TRACE_BUTTON, SwitchPort->IFG & SwitchAll);
+    SwitchPort->IFG &= ~SwitchAll;
+    powerMarkWake();
 }
@@ -0,0 +1,233 @@
+/*! \file */
+/*!
+ * flashStore.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Wear-leveled record store in INFO flash bank 1. Flash only
+ *              goes from 1 to 0 when programmed, so a slot is written once
+ *              and a sector is erased as a whole before it is reused.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "msp.h"
+#include "flashStore.h"
+#include "timer32.h"
+#include "uart.h"
+
+#define STORE_MAGIC         0x5AC3
+#define STORE_ERASED        0xFFFF
+#define INFO_FLASH_START    0x00200000
+#define SLOTS_PER_SECTOR    (STORE_SECTOR_SIZE / STORE_RECORD_SIZE)
+#define WORDS_PER_LINE      4           // 128-bit flash word
+
+typedef struct _StoreRecord {
+    uint16_t magic;                     // first word programmed
+    uint16_t sequence;                  // newer records compare greater
+    uint16_t length;                    // payload bytes
+    uint16_t crc;                       // over sequence, length and payload
+    uint8_t payload[STORE_PAYLOAD_MAX];
+} StoreRecord;
+
+/* Word access for programming */
+typedef union _StoreBuffer {
+    StoreRecord record;
+    uint32_t words[STORE_RECORD_SIZE / 4];
+} StoreBuffer;
+
+typedef enum _StoreState {
+    STORE_IDLE, STORE_ERASING
+} StoreState;
+
+static const StoreRecord *newest = 0;       // newest valid record in flash
+static uint8_t sector = STORE_SECTORS - 1;  // sector being written
+static uint8_t slot = SLOTS_PER_SECTOR;     // full, first save erases sector 0
+static uint16_t sequence = 0;
+static StoreState state = STORE_IDLE;
+
+static StoreBuffer staged;
+static uint8_t pending = 0;
+static uint32_t stagedTime = 0;
+
+static uint32_t erases = 0;
+static uint32_t writes = 0;
+
+static const StoreRecord *recordAt(uint8_t sectorIndex, uint8_t slotIndex) {
+    return (const StoreRecord *)(STORE_BASE + sectorIndex * STORE_SECTOR_SIZE
+                                 + slotIndex * STORE_RECORD_SIZE);
+}
+
+// CRC-16-CCITT, polynomial 0x1021
+static uint16_t crc16(uint16_t crc, const uint8_t *data, uint16_t length) {
+    uint8_t bit;
+
+    while (length--) {
+        crc ^= (uint16_t)*data++ << 8;
+        for (bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static uint16_t recordCrc(const StoreRecord *record) {
+    uint16_t crc = crc16(0xFFFF, (const uint8_t *)&record->sequence, 4);
+    return crc16(crc, record->payload, record->length);
+}
+
+static uint8_t recordValid(const StoreRecord *record) {
+    return record->magic == STORE_MAGIC
+            && record->length <= STORE_PAYLOAD_MAX
+            && record->crc == recordCrc(record);
+}
+
+// Newest valid record at or before slot - 1 of the current sector
+static const StoreRecord *findNewest(void) {
+    uint8_t previous = (sector + STORE_SECTORS - 1) % STORE_SECTORS;
+    int i;
+
+    for (i = slot - 1; i >= 0; i--) {
+        if (recordValid(recordAt(sector, i))) {
+            return recordAt(sector, i);
+        }
+    }
+    // torn write at the start of a sector, the previous one is still intact
+    for (i = SLOTS_PER_SECTOR - 1; i >= 0; i--) {
+        if (recordValid(recordAt(previous, i))) {
+            return recordAt(previous, i);
+        }
+    }
+    return 0;
+}
+
+void initFlashStore(void) {
+    const StoreRecord *first;
+    uint8_t best = STORE_SECTORS;
+    uint8_t i;
+
+    // the sector with the newest valid first record is being written
+    for (i = 0; i < STORE_SECTORS; i++) {
+        first = recordAt(i, 0);
+        if (recordValid(first) && (best == STORE_SECTORS
+                || (int16_t)(first->sequence - recordAt(best, 0)->sequence) > 0)) {
+            best = i;
+        }
+    }
+    if (best == STORE_SECTORS) {
+        return;     // blank store
+    }
+
+    sector = best;
+    for (slot = 0; slot < SLOTS_PER_SECTOR
+            && recordAt(sector, slot)->magic != STORE_ERASED; slot++) {}
+    sequence = recordAt(sector, slot - 1)->sequence;
+    newest = findNewest();
+}
+
+uint8_t storeLoad(void *payload, uint8_t length) {
+    if (!newest || newest->length != length) {
+        return 0;
+    }
+    memcpy(payload, newest->payload, length);
+    return 1;
+}
+
+void storeSave(const void *payload, uint8_t length) {
+    const StoreRecord *compare = pending ? &staged.record : newest;
+
+    if (length > STORE_PAYLOAD_MAX) {
+        return;
+    }
+    if (compare && compare->length == length
+            && memcmp(compare->payload, payload, length) == 0) {
+        return;     // nothing new, keep the batch timer running
+    }
+    memset(&staged, 0xFF, sizeof(staged));
+    staged.record.length = length;
+    memcpy(staged.record.payload, payload, length);
+    pending = 1;
+    stagedTime = getSystemTime();
+}
+
+static void programRecord(void) {
+    volatile uint32_t *destination = (volatile uint32_t *)recordAt(sector, slot);
+    uint8_t i;
+
+    staged.record.magic = STORE_MAGIC;
+    staged.record.sequence = ++sequence;
+    staged.record.crc = recordCrc(&staged.record);
+
+    FLCTL_A->BANK1_INFO_WEPROT &= ~(FLCTL_A_BANK1_INFO_WEPROT_PROT0 << sector);
+    // full word mode, each 128-bit line is programmed once
+    FLCTL_A->PRG_CTLSTAT |= FLCTL_A_PRG_CTLSTAT_MODE | FLCTL_A_PRG_CTLSTAT_ENABLE;
+    for (i = 0; i < STORE_RECORD_SIZE / 4; i++) {
+        destination[i] = staged.words[i];
+        if (i % WORDS_PER_LINE == WORDS_PER_LINE - 1) {
+            while (FLCTL_A->PRG_CTLSTAT & FLCTL_A_PRG_CTLSTAT_STATUS_MASK) {}
+        }
+    }
+    FLCTL_A->PRG_CTLSTAT &= ~FLCTL_A_PRG_CTLSTAT_ENABLE;
+    FLCTL_A->BANK1_INFO_WEPROT |= FLCTL_A_BANK1_INFO_WEPROT_PROT0 << sector;
+}
+
+static void startErase(void) {
+    FLCTL_A->BANK1_INFO_WEPROT &= ~(FLCTL_A_BANK1_INFO_WEPROT_PROT0 << sector);
+    FLCTL_A->ERASE_CTLSTAT = (FLCTL_A->ERASE_CTLSTAT
+            & ~(FLCTL_A_ERASE_CTLSTAT_MODE | FLCTL_A_ERASE_CTLSTAT_TYPE_MASK))
+            | FLCTL_A_ERASE_CTLSTAT_TYPE_1;     // one sector of INFO memory
+    // INFO sector addresses are offsets from the start of INFO memory
+    FLCTL_A->ERASE_SECTADDR = STORE_BASE + sector * STORE_SECTOR_SIZE
+                              - INFO_FLASH_START;
+    FLCTL_A->ERASE_CTLSTAT |= FLCTL_A_ERASE_CTLSTAT_START;
+}
+
+static uint8_t eraseDone(void) {
+    uint32_t status = FLCTL_A->ERASE_CTLSTAT & FLCTL_A_ERASE_CTLSTAT_STATUS_MASK;
+
+    if (status == FLCTL_A_ERASE_CTLSTAT_STATUS_1
+            || status == FLCTL_A_ERASE_CTLSTAT_STATUS_2) {
+        return 0;   // triggered or in progress
+    }
+    FLCTL_A->ERASE_CTLSTAT |= FLCTL_A_ERASE_CTLSTAT_CLR_STAT;
+    FLCTL_A->BANK1_INFO_WEPROT |= FLCTL_A_BANK1_INFO_WEPROT_PROT0 << sector;
+    return 1;
+}
+
+void storeUpdate(void) {
+    if (state == STORE_ERASING) {
+        if (!eraseDone()) {
+            return;
+        }
+        state = STORE_IDLE;
+        slot = 0;
+    }
+    if (!pending || getSystemTime() - stagedTime < STORE_BATCH_MS) {
+        return;
+    }
+    if (slot == SLOTS_PER_SECTOR) {
+        // compaction: move on to the next sector, the newest record stays
+        // readable in this one until the first write lands there
+        sector = (sector + 1) % STORE_SECTORS;
+        startErase();
+        erases++;
+        state = STORE_ERASING;
+        return;
+    }
+    programRecord();
+    newest = recordAt(sector, slot);
+    slot++;
+    writes++;
+    pending = 0;
+}
+
+uint8_t storeIsIdle(void) {
+    return !pending && state == STORE_IDLE;
+}
+
+void storeReport(void) {
+    char buffer[64];
+
+    sprintf(buffer, "S:A%u N%u Q%u E%lu W%lu\n", sector, slot, sequence,
+            (unsigned long)erases, (unsigned long)writes);
+    sendString(buffer);
+}
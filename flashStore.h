@@ -0,0 +1,119 @@
+/*! \file */
+/*!
+ * flashStore.h
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Wear-leveled record store in INFO flash bank 1. Every save
+ *              appends a complete CRC-checked snapshot to a log that walks
+ *              round-robin through the four 4KB sectors at 0x204000, so
+ *              each sector is erased once per STORE_SECTORS full sectors
+ *              of saves. Only the newest record is live; compaction is
+ *              starting the next sector, the old one is erased first and
+ *              the live record is written to it.
+ *
+ *              Saves are staged in RAM and programmed by storeUpdate() from
+ *              the main loop once no change has arrived for STORE_BATCH_MS.
+ *              Erases run in the background, the CPU keeps executing from
+ *              main flash bank 0.
+ *
+ *              INFO bank 0 holds the flash mailbox, TLV and BSL and is
+ *              never touched.
+ */
+
+#ifndef FLASHSTORE_H_
+#define FLASHSTORE_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+#define STORE_BASE          0x00204000  // INFO bank 1, sector 0
+#define STORE_SECTORS       4
+#define STORE_SECTOR_SIZE   4096
+#define STORE_RECORD_SIZE   64          // multiple of the 16 byte flash word
+#define STORE_PAYLOAD_MAX   (STORE_RECORD_SIZE - 8)
+#define STORE_BATCH_MS      2000        // quiet time before programming
+
+/*!
+ * \brief This function finds the newest valid record
+ *
+ * One bounded scan: the first slot of each sector picks the newest
+ *  sector, then that sector is scanned up to its first erased slot. A
+ *  record with a bad CRC (torn write) falls back to the one before it.
+ *
+ * \return None
+ */
+extern void initFlashStore(void);
+
+/*!
+ * \brief This function copies the newest record
+ *
+ * \param payload receives the record contents
+ * \param length is the expected payload size in bytes
+ *
+ * \return 1 if a valid record of \b length bytes was found, 0 otherwise
+ */
+extern uint8_t storeLoad(void *payload, uint8_t length);
+
+/*!
+ * \brief This function stages a record for writing
+ *
+ * Returns immediately. Saving the same contents again is free, and a
+ *  burst of changes ends up as a single flash write.
+ *
+ * \param payload is the record contents
+ * \param length is the payload size, at most STORE_PAYLOAD_MAX bytes
+ *
+ * \return None
+ */
+extern void storeSave(const void *payload, uint8_t length);
+
+/*!
+ * \brief This function advances pending flash work
+ *
+ * Call from the main loop. Programs a staged record (four 128-bit flash
+ *  words) after STORE_BATCH_MS of quiet, or starts and polls the erase of
+ *  the next sector when the current one is full.
+ *
+ * \return None
+ */
+extern void storeUpdate(void);
+
+/*!
+ * \brief This function tells whether the store has nothing left to do
+ *
+ * \return 1 if no record is staged and no erase is running
+ */
+extern uint8_t storeIsIdle(void);
+
+/*!
+ * \brief This function sends store statistics over UART
+ *
+ * Format: "S:A<sector> N<slot> Q<sequence> E<erases> W<writes>\n"
+ *      A the sector being written, N the next free slot in it, Q the
+ *      sequence number of the newest record, E and W the sector erases and
+ *      record writes since reset.
+ *
+ * \return None
+ */
+extern void storeReport(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLASHSTORE_H_ */
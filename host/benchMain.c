@@ -0,0 +1,153 @@
+/*! \file */
+/*!
+ * benchMain.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Runs the 'K' microbenchmarks on the virtual MSP432. The
+ *              firmware boots, is sent "K" like the ESP32 would, and its
+ *              benchmark.c is built with BENCH_HOST: each case is timed in
+ *              host nanoseconds per operation, simulator register traffic
+ *              included, and LCD bytes per operation are what the HD44780
+ *              model latched. malloc, calloc and realloc are wrapped at
+ *              link time to count the firmware's heap allocations while the
+ *              benchmarks run.
+ *
+ *              Prints a table on stderr and one JSON line, the firmware's
+ *              K: object with "allocs" and "alloc_bytes" added, on stdout
+ *              or to a file. Exits 1 if the reply is missing, a kernel
+ *              disagreed with its reference, the heap was used or a
+ *              hardware rule was broken.
+ *
+ *              Usage: karaokeBench [-o file]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+#include "hd44780.h"
+
+#define REPLY_MAX               4096
+#define BOOT_MS                 1000    // past the splash, 'K' is ignored before
+#define TIMEOUT_MS              60000
+
+static FILE *output;
+static char reply[REPLY_MAX];
+static uint16_t replyLength = 0;
+static uint8_t counting = 0;
+static uint32_t allocations = 0;
+static uint64_t allocatedBytes = 0;
+
+extern int firmwareMain(void);
+
+/* The real allocator behind the --wrap link flags in host/Makefile */
+extern void *__real_malloc(size_t size);
+extern void *__real_calloc(size_t count, size_t size);
+extern void *__real_realloc(void *pointer, size_t size);
+
+static void countAllocation(size_t size) {
+    if (counting) {
+        allocations++;
+        allocatedBytes += size;
+    }
+}
+
+void *__wrap_malloc(size_t size) {
+    countAllocation(size);
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    countAllocation(count * size);
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *pointer, size_t size) {
+    countAllocation(size);
+    return __real_realloc(pointer, size);
+}
+
+// One line per case from the "b" array of the reply
+static void printTable(const char *unit) {
+    const char *entry = strstr(reply, "\"b\":[");
+    char name[24];
+    unsigned long runs, min, average;
+    long lcd;
+
+    fprintf(stderr, "  %-14s %5s %10s %10s %8s\n", "case", "runs", "min", "avg",
+            "lcd/op");
+    while (entry && (entry = strstr(entry, "{\"n\":")) != 0) {
+        if (sscanf(entry, "{\"n\":\"%23[^\"]\",\"runs\":%lu,\"min\":%lu,\"avg\":%lu,"
+                   "\"lcd\":%ld}", name, &runs, &min, &average, &lcd) == 5) {
+            fprintf(stderr, "  %-14s %5lu %7lu %s %7lu %s %8ld\n", name, runs, min,
+                    unit, average, unit, lcd);
+        }
+        entry++;
+    }
+}
+
+static void finish(void) {
+    uint8_t failed = !strstr(reply, "\"mismatch\":0,") || allocations
+            || simViolationCount();
+
+    printTable("ns");
+    fprintf(stderr, "  %lu heap allocations, %llu bytes, %lu violations\n",
+            (unsigned long)allocations, (unsigned long long)allocatedBytes,
+            (unsigned long)simViolationCount());
+    fprintf(output, "{\"allocs\":%lu,\"alloc_bytes\":%llu,%s\n",
+            (unsigned long)allocations, (unsigned long long)allocatedBytes,
+            reply + strlen("K:{"));
+    fflush(output);
+    exit(failed);
+}
+
+// Keeps the K: line, the firmware's other lines are dropped
+static void uartReceived(uint8_t data) {
+    if (data == '\r') {
+        return;
+    }
+    if (data != '\n') {
+        if (replyLength < REPLY_MAX - 1) {
+            reply[replyLength++] = (char)data;
+        }
+        return;
+    }
+    reply[replyLength] = '\0';
+    if (!strncmp(reply, "K:{", 3)) {
+        counting = 0;
+        finish();
+    }
+    replyLength = 0;
+}
+
+static void requestBenchmarks(void *arg) {
+    (void)arg;
+    counting = 1;
+    simUartSend((const uint8_t *)"K\n", 2);
+}
+
+static void timeout(void *arg) {
+    (void)arg;
+    fprintf(stderr, "no K: reply in %u ms\n", TIMEOUT_MS);
+    exit(1);
+}
+
+int main(int argc, char **argv) {
+    output = stdout;
+    if (argc == 3 && !strcmp(argv[1], "-o")) {
+        output = fopen(argv[2], "w");
+        if (!output) {
+            fprintf(stderr, "cannot write %s\n", argv[2]);
+            return 2;
+        }
+    } else if (argc != 1) {
+        fprintf(stderr, "usage: %s [-o file]\n", argv[0]);
+        return 2;
+    }
+    hd44780Attach();
+    simUartSetSink(uartReceived);
+    simSchedule((uint64_t)BOOT_MS * SIM_PS_PER_MS, requestBenchmarks, 0);
+    simSchedule((uint64_t)TIMEOUT_MS * SIM_PS_PER_MS, timeout, 0);
+    firmwareMain();
+    return 0;
+}
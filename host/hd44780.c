@@ -0,0 +1,142 @@
+/*! \file */
+/*!
+ * hd44780.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: HD44780 model, see hd44780.h. Timing is from the data sheet
+ *              at 270kHz: clear display and return home take 1.52ms, the
+ *              other instructions 37us; E must stay high for 230ns.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "hd44780.h"
+#include "sim.h"
+
+#define DB_PORT                 4
+#define CTRL_PORT               6
+#define RS_PIN                  0x80
+#define E_PIN                   0x40
+
+#define POWER_UP_PS             (15000 * SIM_PS_PER_US)
+#define EXEC_SHORT_PS           (37 * SIM_PS_PER_US)
+#define EXEC_LONG_PS            (1520 * SIM_PS_PER_US)
+#define E_HIGH_MIN_PS           230000ULL
+#define LINE_LENGTH             40
+
+static uint8_t ddram[HD44780_ROWS][LINE_LENGTH];
+static uint8_t address = 0;
+static uint8_t cgramSelected = 0;
+static uint8_t decrement = 0;
+static uint64_t busyUntil = POWER_UP_PS;
+static uint64_t risingAt = 0;
+static uint32_t writes = 0;
+static uint32_t clears = 0;
+
+static void step(void) {
+    uint8_t row = (address & 0x40) ? 1 : 0;
+    int8_t column = address & 0x3F;
+
+    if (cgramSelected) {
+        address = (address + (decrement ? -1 : 1)) & 0x3F;
+        return;
+    }
+    column += decrement ? -1 : 1;
+    if (column >= LINE_LENGTH) {
+        column = 0;
+        row ^= 1;
+    } else if (column < 0) {
+        column = LINE_LENGTH - 1;
+        row ^= 1;
+    }
+    address = (row ? 0x40 : 0) | column;
+}
+
+static void instruction(uint8_t code) {
+    if (code & 0x80) {
+        address = code & 0x7F;
+        cgramSelected = 0;
+    } else if (code & 0x40) {
+        address = code & 0x3F;
+        cgramSelected = 1;
+    } else if (code & 0x20) {
+        if (!(code & 0x10)) {
+            simViolation("LCD set to a 4-bit interface, the board wires 8 bits");
+        }
+    } else if (code & 0x04 && !(code & 0x18)) {
+        decrement = !(code & 0x02);
+    } else if (code == 0x01) {
+        clears++;
+        memset(ddram, ' ', sizeof(ddram));
+        address = 0;
+        cgramSelected = 0;
+        decrement = 0;
+    } else if ((code & 0xFE) == 0x02) {
+        address = 0;
+        cgramSelected = 0;
+    }
+}
+
+static void latch(uint8_t rs, uint8_t data) {
+    uint64_t now = simNow();
+
+    if (now < busyUntil) {
+        simViolation("LCD written %.1fus before it was ready",
+                     (double)(busyUntil - now) / SIM_PS_PER_US);
+    }
+    if (now - risingAt < E_HIGH_MIN_PS) {
+        simViolation("LCD E pulse %lluns, needs 230ns",
+                     (unsigned long long)((now - risingAt) / 1000));
+    }
+    writes++;
+    if (rs) {
+        if (!cgramSelected) {
+            ddram[(address & 0x40) ? 1 : 0][address & 0x3F] = data;
+        }
+        step();
+        busyUntil = now + EXEC_SHORT_PS;
+    } else {
+        instruction(data);
+        busyUntil = now + ((data & 0xFC) == 0 ? EXEC_LONG_PS : EXEC_SHORT_PS);
+    }
+}
+
+static void controlChanged(uint8_t port, uint8_t out, uint8_t previousOut) {
+    (void)port;
+    if ((out & E_PIN) && !(previousOut & E_PIN)) {
+        risingAt = simNow();
+    } else if (!(out & E_PIN) && (previousOut & E_PIN)) {
+        latch(out & RS_PIN, simGpioOut(DB_PORT));
+    }
+}
+
+void hd44780Attach(void) {
+    memset(ddram, ' ', sizeof(ddram));
+    simGpioWatch(CTRL_PORT, controlChanged);
+}
+
+void hd44780Row(uint8_t row, char *text) {
+    uint8_t column;
+
+    for (column = 0; column < HD44780_COLUMNS; column++) {
+        text[column] = ddram[row][column] < ' ' ? '=' : (char)ddram[row][column];
+    }
+    text[HD44780_COLUMNS] = '\0';
+}
+
+uint32_t hd44780Writes(void) {
+    return writes;
+}
+
+uint32_t hd44780Clears(void) {
+    return clears;
+}
+
+void hd44780Print(void) {
+    char top[HD44780_COLUMNS + 1];
+    char bottom[HD44780_COLUMNS + 1];
+
+    hd44780Row(0, top);
+    hd44780Row(1, bottom);
+    printf("%12.3f ms  |%s|\n%12s     |%s|\n", simNowMs(), top, "", bottom);
+}
@@ -0,0 +1,81 @@
+/*! \file */
+/*!
+ * hd44780.h
+ * ECE230 Winter 2024-2025
+ *
+ * Description: HD44780 character LCD on the simulated board, wired as in
+ *              lcd.h: DB on P4, RS on P6.7, E on P6.6, R/W tied low. Each
+ *              falling edge of E latches one 8-bit instruction or data
+ *              byte. The model keeps the DDRAM and checks the write
+ *              against the execution time of the previous one.
+ */
+
+#ifndef HD44780_H_
+#define HD44780_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+#define HD44780_COLUMNS         16
+#define HD44780_ROWS            2
+
+/*!
+ * \brief This function connects the LCD to P4 and P6
+ *
+ * \return None
+ */
+extern void hd44780Attach(void);
+
+/*!
+ * \brief This function returns the visible text of a row
+ *
+ * Codes below ' ' (custom characters) read as '=', like lcdCaptureFrame.
+ *
+ * \param row is 0 or 1
+ * \param text receives HD44780_COLUMNS characters and a terminator
+ *
+ * \return None
+ */
+extern void hd44780Row(uint8_t row, char *text);
+
+/*!
+ * \brief This function counts the bytes latched since power-on
+ *
+ * \return instructions plus data bytes
+ */
+extern uint32_t hd44780Writes(void);
+
+/*!
+ * \brief This function counts the clear display instructions since power-on
+ *
+ * \return clear display instructions, each one a full redraw
+ */
+extern uint32_t hd44780Clears(void);
+
+/*!
+ * \brief This function prints both rows with the virtual time
+ *
+ * \return None
+ */
+extern void hd44780Print(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HD44780_H_ */
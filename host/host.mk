@@ -0,0 +1,24 @@
+# Host build of the firmware against the simulated MSP432, see sim.h.
+# Included by host/Makefile and tests/Makefile with HOST_DIR and FW_DIR set.
+
+CC       ?= gcc
+HOST_CFLAGS := -std=gnu11 -O2 -g -Wall -Wno-unknown-pragmas \
+               -Wno-int-to-pointer-cast -Wno-pointer-to-int-cast \
+               -fno-pie -I$(HOST_DIR) -I$(FW_DIR)
+# The DSP kernels take the target's dual 16-bit path, msp.h supplies the
+#  SMLAD, SMLALD and SSUB16 intrinsics
+HOST_CFLAGS += -DDSP_USE_SIMD=1
+# The firmware keeps addresses in 32-bit registers (DMA, flash), so the image
+# and the simulated flash and SRAM have to sit below 4GB.
+HOST_LDFLAGS := -no-pie \
+    -Wl,--defsym,__stack=0x2003F800,--defsym,__STACK_END=0x20040000 \
+    -Wl,--defsym,__STACK_SIZE=0x800,--defsym,__SYSMEM_SIZE=0x400
+HOST_LDLIBS := -lm
+
+SIM_SRCS := $(HOST_DIR)/sim.c $(HOST_DIR)/hd44780.c
+SIM_HDRS := $(HOST_DIR)/msp.h $(HOST_DIR)/sim.h $(HOST_DIR)/hd44780.h
+
+# Everything but the CCS start-up code, which the simulator replaces
+FW_SRCS := $(filter-out $(FW_DIR)/startup_msp432p4111_ccs.c \
+                        $(FW_DIR)/system_msp432p4111.c, $(wildcard $(FW_DIR)/*.c))
+FW_HDRS := $(wildcard $(FW_DIR)/*.h)
@@ -0,0 +1,754 @@
+/*! \file */
+/*!
+ * msp.h
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Host stand-in for the TI MSP432P4111 device header, used by
+ *              the simulator build in this directory. It keeps the register
+ *              names, bit names and CMSIS helpers the firmware uses, but
+ *              every peripheral base macro goes through simAccess(), which
+ *              advances the virtual clock, lets the models in sim.c react to
+ *              what the firmware wrote since the last access, and delivers
+ *              any interrupt that became due. Only the registers and bits
+ *              this firmware touches are declared; the layouts are not the
+ *              device's and must not be relied on.
+ */
+
+#ifndef MSP_H_
+#define MSP_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+#define __I     volatile const
+#define __O     volatile
+#define __IO    volatile
+
+#define __NVIC_PRIO_BITS        3
+
+/******************************************************************************
+* Peripherals the simulator models, the argument of simAccess                 *
+******************************************************************************/
+typedef enum _SimDevice {
+    SIM_DEV_NONE = 0,
+    SIM_DEV_PJ,
+    SIM_DEV_P1, SIM_DEV_P2, SIM_DEV_P3, SIM_DEV_P4, SIM_DEV_P5,
+    SIM_DEV_P6, SIM_DEV_P7, SIM_DEV_P8, SIM_DEV_P9, SIM_DEV_P10,
+    SIM_DEV_TIMER_A0, SIM_DEV_TIMER_A1, SIM_DEV_TIMER_A2, SIM_DEV_TIMER_A3,
+    SIM_DEV_TIMER32_1, SIM_DEV_TIMER32_2,
+    SIM_DEV_EUSCI_A0,
+    SIM_DEV_CS,
+    SIM_DEV_PCM,
+    SIM_DEV_FLCTL_A,
+    SIM_DEV_RTC_C,
+    SIM_DEV_DMA_CHANNEL,
+    SIM_DEV_DMA_CONTROL,
+    SIM_DEV_ADC14,
+    SIM_DEV_WDT_A,
+    SIM_DEV_SYSCTL_A,
+    SIM_DEV_SYSTICK,
+    SIM_DEV_SCB,
+    SIM_DEV_NVIC,
+    SIM_DEV_DWT,
+    SIM_DEV_COREDEBUG,
+    SIM_DEV_COUNT
+} SimDevice;
+
+/*!
+ * \brief This function synchronizes the models with one register access
+ *
+ * Advances the virtual clock by the cost of an access, applies what the
+ *  firmware wrote since the previous access, runs any interrupt handler that
+ *  is due and refreshes the live registers of \b device.
+ *
+ * \param device is the peripheral about to be accessed
+ *
+ * \return the register block of \b device
+ */
+extern void *simAccess(SimDevice device);
+
+#define SIM_REG(type, device)   ((type *)simAccess(device))
+
+/******************************************************************************
+* Interrupt numbers                                                           *
+******************************************************************************/
+typedef enum IRQn {
+    SysTick_IRQn        = -1,
+    PSS_IRQn            = 0,
+    CS_IRQn             = 1,
+    PCM_IRQn            = 2,
+    WDT_A_IRQn          = 3,
+    FPU_IRQn            = 4,
+    FLCTL_A_IRQn        = 5,
+    COMP_E0_IRQn        = 6,
+    COMP_E1_IRQn        = 7,
+    TA0_0_IRQn          = 8,
+    TA0_N_IRQn          = 9,
+    TA1_0_IRQn          = 10,
+    TA1_N_IRQn          = 11,
+    TA2_0_IRQn          = 12,
+    TA2_N_IRQn          = 13,
+    TA3_0_IRQn          = 14,
+    TA3_N_IRQn          = 15,
+    EUSCIA0_IRQn        = 16,
+    EUSCIA1_IRQn        = 17,
+    EUSCIA2_IRQn        = 18,
+    EUSCIA3_IRQn        = 19,
+    EUSCIB0_IRQn        = 20,
+    EUSCIB1_IRQn        = 21,
+    EUSCIB2_IRQn        = 22,
+    EUSCIB3_IRQn        = 23,
+    ADC14_IRQn          = 24,
+    T32_INT1_IRQn       = 25,
+    T32_INT2_IRQn       = 26,
+    T32_INTC_IRQn       = 27,
+    AES256_IRQn         = 28,
+    RTC_C_IRQn          = 29,
+    DMA_ERR_IRQn        = 30,
+    DMA_INT3_IRQn       = 31,
+    DMA_INT2_IRQn       = 32,
+    DMA_INT1_IRQn       = 33,
+    DMA_INT0_IRQn       = 34,
+    PORT1_IRQn          = 35,
+    PORT2_IRQn          = 36,
+    PORT3_IRQn          = 37,
+    PORT4_IRQn          = 38,
+    PORT5_IRQn          = 39,
+    PORT6_IRQn          = 40,
+    LCD_F_IRQn          = 41
+} IRQn_Type;
+
+/******************************************************************************
+* Register blocks                                                             *
+******************************************************************************/
+typedef struct {
+    __I  uint8_t IN;
+    __IO uint8_t OUT;
+    __IO uint8_t DIR;
+    __IO uint8_t REN;
+    __IO uint8_t DS;
+    __IO uint8_t SEL0;
+    __IO uint8_t SEL1;
+    __IO uint8_t SELC;
+    __IO uint8_t IES;
+    __IO uint8_t IE;
+    __IO uint8_t IFG;
+    __I  uint16_t IV;
+} DIO_PORT_Interruptable_Type;
+
+typedef DIO_PORT_Interruptable_Type DIO_PORT_Odd_Interruptable_Type;
+typedef DIO_PORT_Interruptable_Type DIO_PORT_Even_Interruptable_Type;
+typedef DIO_PORT_Interruptable_Type DIO_PORT_Not_Interruptable_Type;
+
+typedef struct {
+    __IO uint16_t CTL;
+    __IO uint16_t CCTL[7];
+    __IO uint16_t R;
+    __IO uint16_t CCR[7];
+    __IO uint16_t EX0;
+    __I  uint16_t IV;
+} Timer_A_Type;
+
+typedef struct {
+    __IO uint32_t LOAD;
+    __I  uint32_t VALUE;
+    __IO uint32_t CONTROL;
+    __O  uint32_t INTCLR;
+    __I  uint32_t RIS;
+    __I  uint32_t MIS;
+    __IO uint32_t BGLOAD;
+} Timer32_Type;
+
+typedef struct {
+    __IO uint16_t CTLW0;
+    __IO uint16_t CTLW1;
+    __IO uint16_t BRW;
+    __IO uint16_t MCTLW;
+    __IO uint16_t STATW;
+    __I  uint16_t RXBUF;
+    __IO uint16_t TXBUF;
+    __IO uint16_t ABCTL;
+    __IO uint16_t IRCTL;
+    __IO uint16_t IE;
+    __IO uint16_t IFG;
+    __I  uint16_t IV;
+} EUSCI_A_Type;
+
+typedef struct {
+    __IO uint32_t KEY;
+    __IO uint32_t CTL0;
+    __IO uint32_t CTL1;
+    __IO uint32_t CTL2;
+    __IO uint32_t CTL3;
+    __IO uint32_t CLKEN;
+    __I  uint32_t STAT;
+    __IO uint32_t IE;
+    __I  uint32_t IFG;
+    __O  uint32_t CLRIFG;
+    __O  uint32_t SETIFG;
+    __IO uint32_t DCOERCAL0;
+    __IO uint32_t DCOERCAL1;
+} CS_Type;
+
+typedef struct {
+    __IO uint32_t CTL0;
+    __IO uint32_t CTL1;
+    __IO uint32_t IE;
+    __I  uint32_t IFG;
+    __O  uint32_t CLRIFG;
+} PCM_Type;
+
+typedef struct {
+    __I  uint32_t POWER_STAT;
+    __IO uint32_t BANK0_RDCTL;
+    __IO uint32_t BANK1_RDCTL;
+    __IO uint32_t PRG_CTLSTAT;
+    __IO uint32_t ERASE_CTLSTAT;
+    __IO uint32_t ERASE_SECTADDR;
+    __IO uint32_t BANK0_INFO_WEPROT;
+    __IO uint32_t BANK1_INFO_WEPROT;
+    __I  uint32_t IFG;
+    __IO uint32_t IE;
+    __O  uint32_t CLRIFG;
+} FLCTL_A_Type;
+
+typedef struct {
+    __IO uint16_t CTL0;
+    __IO uint16_t CTL13;
+    __IO uint16_t OCAL;
+    __IO uint16_t TCMP;
+    __IO uint16_t PS0CTL;
+    __IO uint16_t PS1CTL;
+    __IO uint16_t PS;
+    __I  uint16_t IV;
+    __IO uint16_t TIM0;
+    __IO uint16_t TIM1;
+    __IO uint16_t DATE;
+    __IO uint16_t YEAR;
+} RTC_C_Type;
+
+typedef struct {
+    __I  uint32_t DEVICE_CFG;
+    __IO uint32_t SW_CHTRIG;
+    __IO uint32_t CH_SRCCFG[32];
+    __IO uint32_t INT1_SRCCFG;
+    __IO uint32_t INT2_SRCCFG;
+    __IO uint32_t INT3_SRCCFG;
+    __I  uint32_t INT0_SRCFLG;
+    __O  uint32_t INT0_CLRFLG;
+} DMA_Channel_Type;
+
+typedef struct {
+    __I  uint32_t STAT;
+    __O  uint32_t CFG;
+    __IO uint32_t CTLBASE;
+    __I  uint32_t ALTBASE;
+    __IO uint32_t USEBURSTSET;
+    __O  uint32_t USEBURSTCLR;
+    __IO uint32_t REQMASKSET;
+    __O  uint32_t REQMASKCLR;
+    __IO uint32_t ENASET;
+    __O  uint32_t ENACLR;
+    __IO uint32_t ALTSET;
+    __O  uint32_t ALTCLR;
+    __IO uint32_t PRIOSET;
+    __O  uint32_t PRIOCLR;
+    __IO uint32_t ERRCLR;
+} DMA_Control_Type;
+
+typedef struct {
+    __IO uint32_t CTL0;
+    __IO uint32_t CTL1;
+    __IO uint32_t MCTL[32];
+    __I  uint32_t MEM[32];
+    __IO uint32_t IER0;
+    __I  uint32_t IFGR0;
+    __O  uint32_t CLRIFGR0;
+} ADC14_Type;
+
+typedef struct {
+    __IO uint16_t CTL;
+} WDT_A_Type;
+
+typedef struct {
+    __IO uint32_t NMI_CTLSTAT;
+} SYSCTL_A_Type;
+
+typedef struct {
+    __IO uint32_t CTRL;
+    __IO uint32_t LOAD;
+    __IO uint32_t VAL;
+    __I  uint32_t CALIB;
+} SysTick_Type;
+
+typedef struct {
+    __IO uint32_t SCR;
+    __IO uint8_t SHP[12];
+    __IO uint32_t CPACR;
+} SCB_Type;
+
+typedef struct {
+    __IO uint32_t ISER[8];
+    __IO uint32_t ICER[8];
+    __IO uint32_t ISPR[8];
+    __IO uint32_t ICPR[8];
+    __IO uint8_t IP[64];
+} NVIC_Type;
+
+typedef struct {
+    __IO uint32_t CTRL;
+    __IO uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct {
+    __IO uint32_t DHCSR;
+    __IO uint32_t DEMCR;
+} CoreDebug_Type;
+
+/******************************************************************************
+* Peripheral declarations                                                     *
+******************************************************************************/
+#define PJ          SIM_REG(DIO_PORT_Not_Interruptable_Type, SIM_DEV_PJ)
+#define P1          SIM_REG(DIO_PORT_Odd_Interruptable_Type, SIM_DEV_P1)
+#define P2          SIM_REG(DIO_PORT_Even_Interruptable_Type, SIM_DEV_P2)
+#define P3          SIM_REG(DIO_PORT_Odd_Interruptable_Type, SIM_DEV_P3)
+#define P4          SIM_REG(DIO_PORT_Even_Interruptable_Type, SIM_DEV_P4)
+#define P5          SIM_REG(DIO_PORT_Odd_Interruptable_Type, SIM_DEV_P5)
+#define P6          SIM_REG(DIO_PORT_Even_Interruptable_Type, SIM_DEV_P6)
+#define P7          SIM_REG(DIO_PORT_Odd_Interruptable_Type, SIM_DEV_P7)
+#define P8          SIM_REG(DIO_PORT_Even_Interruptable_Type, SIM_DEV_P8)
+#define P9          SIM_REG(DIO_PORT_Odd_Interruptable_Type, SIM_DEV_P9)
+#define P10         SIM_REG(DIO_PORT_Even_Interruptable_Type, SIM_DEV_P10)
+#define TIMER_A0    SIM_REG(Timer_A_Type, SIM_DEV_TIMER_A0)
+#define TIMER_A1    SIM_REG(Timer_A_Type, SIM_DEV_TIMER_A1)
+#define TIMER_A2    SIM_REG(Timer_A_Type, SIM_DEV_TIMER_A2)
+#define TIMER_A3    SIM_REG(Timer_A_Type, SIM_DEV_TIMER_A3)
+#define TIMER32_1   SIM_REG(Timer32_Type, SIM_DEV_TIMER32_1)
+#define TIMER32_2   SIM_REG(Timer32_Type, SIM_DEV_TIMER32_2)
+#define EUSCI_A0    SIM_REG(EUSCI_A_Type, SIM_DEV_EUSCI_A0)
+#define CS          SIM_REG(CS_Type, SIM_DEV_CS)
+#define PCM         SIM_REG(PCM_Type, SIM_DEV_PCM)
+#define FLCTL_A     SIM_REG(FLCTL_A_Type, SIM_DEV_FLCTL_A)
+#define RTC_C       SIM_REG(RTC_C_Type, SIM_DEV_RTC_C)
+#define DMA_Channel SIM_REG(DMA_Channel_Type, SIM_DEV_DMA_CHANNEL)
+#define DMA_Control SIM_REG(DMA_Control_Type, SIM_DEV_DMA_CONTROL)
+#define ADC14       SIM_REG(ADC14_Type, SIM_DEV_ADC14)
+#define WDT_A       SIM_REG(WDT_A_Type, SIM_DEV_WDT_A)
+#define SYSCTL_A    SIM_REG(SYSCTL_A_Type, SIM_DEV_SYSCTL_A)
+#define SysTick     SIM_REG(SysTick_Type, SIM_DEV_SYSTICK)
+#define SCB         SIM_REG(SCB_Type, SIM_DEV_SCB)
+#define NVIC        SIM_REG(NVIC_Type, SIM_DEV_NVIC)
+#define DWT         SIM_REG(DWT_Type, SIM_DEV_DWT)
+#define CoreDebug   SIM_REG(CoreDebug_Type, SIM_DEV_COREDEBUG)
+
+/******************************************************************************
+* Bit definitions                                                             *
+******************************************************************************/
+#define BIT0    (uint16_t)(0x0001)
+#define BIT1    (uint16_t)(0x0002)
+#define BIT2    (uint16_t)(0x0004)
+#define BIT3    (uint16_t)(0x0008)
+#define BIT4    (uint16_t)(0x0010)
+#define BIT5    (uint16_t)(0x0020)
+#define BIT6    (uint16_t)(0x0040)
+#define BIT7    (uint16_t)(0x0080)
+#define BIT8    (uint16_t)(0x0100)
+#define BIT9    (uint16_t)(0x0200)
+#define BITA    (uint16_t)(0x0400)
+#define BITB    (uint16_t)(0x0800)
+#define BITC    (uint16_t)(0x1000)
+#define BITD    (uint16_t)(0x2000)
+#define BITE    (uint16_t)(0x4000)
+#define BITF    (uint16_t)(0x8000)
+
+/* Timer_A */
+#define TIMER_A_CTL_IFG                 ((uint16_t)0x0001)
+#define TIMER_A_CTL_IE                  ((uint16_t)0x0002)
+#define TIMER_A_CTL_CLR                 ((uint16_t)0x0004)
+#define TIMER_A_CTL_MC_OFS              (4)
+#define TIMER_A_CTL_MC_MASK             ((uint16_t)0x0030)
+#define TIMER_A_CTL_MC__STOP            ((uint16_t)0x0000)
+#define TIMER_A_CTL_MC__UP              ((uint16_t)0x0010)
+#define TIMER_A_CTL_MC__CONTINUOUS      ((uint16_t)0x0020)
+#define TIMER_A_CTL_MC__UPDOWN          ((uint16_t)0x0030)
+#define TIMER_A_CTL_ID_OFS              (6)
+#define TIMER_A_CTL_ID_MASK             ((uint16_t)0x00C0)
+#define TIMER_A_CTL_ID__1               ((uint16_t)0x0000)
+#define TIMER_A_CTL_ID__2               ((uint16_t)0x0040)
+#define TIMER_A_CTL_ID__4               ((uint16_t)0x0080)
+#define TIMER_A_CTL_ID__8               ((uint16_t)0x00C0)
+#define TIMER_A_CTL_SSEL_OFS            (8)
+#define TIMER_A_CTL_SSEL_MASK           ((uint16_t)0x0300)
+#define TIMER_A_CTL_SSEL__TACLK         ((uint16_t)0x0000)
+#define TIMER_A_CTL_SSEL__ACLK          ((uint16_t)0x0100)
+#define TIMER_A_CTL_SSEL__SMCLK         ((uint16_t)0x0200)
+#define TIMER_A_CTL_SSEL__INCLK         ((uint16_t)0x0300)
+#define TIMER_A_CCTLN_CCIFG             ((uint16_t)0x0001)
+#define TIMER_A_CCTLN_COV               ((uint16_t)0x0002)
+#define TIMER_A_CCTLN_OUT               ((uint16_t)0x0004)
+#define TIMER_A_CCTLN_CCIE              ((uint16_t)0x0010)
+#define TIMER_A_CCTLN_OUTMOD_OFS        (5)
+#define TIMER_A_CCTLN_OUTMOD_MASK       ((uint16_t)0x00E0)
+#define TIMER_A_CCTLN_OUTMOD_0          ((uint16_t)0x0000)
+#define TIMER_A_CCTLN_OUTMOD_1          ((uint16_t)0x0020)
+#define TIMER_A_CCTLN_OUTMOD_2          ((uint16_t)0x0040)
+#define TIMER_A_CCTLN_OUTMOD_3          ((uint16_t)0x0060)
+#define TIMER_A_CCTLN_OUTMOD_4          ((uint16_t)0x0080)
+#define TIMER_A_CCTLN_OUTMOD_5          ((uint16_t)0x00A0)
+#define TIMER_A_CCTLN_OUTMOD_6          ((uint16_t)0x00C0)
+#define TIMER_A_CCTLN_OUTMOD_7          ((uint16_t)0x00E0)
+#define TIMER_A_CCTLN_CAP               ((uint16_t)0x0100)
+#define TIMER_A_EX0_IDEX_MASK           ((uint16_t)0x0007)
+#define TIMER_A_EX0_IDEX__1             ((uint16_t)0x0000)
+#define TIMER_A_EX0_IDEX__2             ((uint16_t)0x0001)
+#define TIMER_A_EX0_IDEX__3             ((uint16_t)0x0002)
+#define TIMER_A_EX0_IDEX__4             ((uint16_t)0x0003)
+#define TIMER_A_EX0_IDEX__5             ((uint16_t)0x0004)
+#define TIMER_A_EX0_IDEX__6             ((uint16_t)0x0005)
+#define TIMER_A_EX0_IDEX__7             ((uint16_t)0x0006)
+#define TIMER_A_EX0_IDEX__8             ((uint16_t)0x0007)
+
+/* Timer32 */
+#define TIMER32_CONTROL_ONESHOT         ((uint32_t)0x00000001)
+#define TIMER32_CONTROL_SIZE            ((uint32_t)0x00000002)
+#define TIMER32_CONTROL_PRESCALE_OFS    (2)
+#define TIMER32_CONTROL_PRESCALE_MASK   ((uint32_t)0x0000000C)
+#define TIMER32_CONTROL_PRESCALE_0      ((uint32_t)0x00000000)
+#define TIMER32_CONTROL_PRESCALE_1      ((uint32_t)0x00000004)
+#define TIMER32_CONTROL_PRESCALE_2      ((uint32_t)0x00000008)
+#define TIMER32_CONTROL_IE              ((uint32_t)0x00000020)
+#define TIMER32_CONTROL_MODE            ((uint32_t)0x00000040)
+#define TIMER32_CONTROL_ENABLE          ((uint32_t)0x00000080)
+#define TIMER32_RIS_RAW_IFG             ((uint32_t)0x00000001)
+#define TIMER32_MIS_IFG                 ((uint32_t)0x00000001)
+
+/* eUSCI_A */
+#define EUSCI_A_CTLW0_SWRST             ((uint16_t)0x0001)
+#define EUSCI_A_CTLW0_SSEL_MASK         ((uint16_t)0x00C0)
+#define EUSCI_A_CTLW0_SSEL__UCLK        ((uint16_t)0x0000)
+#define EUSCI_A_CTLW0_SSEL__ACLK        ((uint16_t)0x0040)
+#define EUSCI_A_CTLW0_SSEL__SMCLK       ((uint16_t)0x0080)
+#define EUSCI_A_MCTLW_OS16              ((uint16_t)0x0001)
+#define EUSCI_A_MCTLW_BRF_OFS           (4)
+#define EUSCI_A_MCTLW_BRF_MASK          ((uint16_t)0x00F0)
+#define EUSCI_A_MCTLW_BRS_OFS           (8)
+#define EUSCI_A_MCTLW_BRS_MASK          ((uint16_t)0xFF00)
+#define EUSCI_A_STATW_BUSY              ((uint16_t)0x0001)
+#define EUSCI_A_STATW_OE                ((uint16_t)0x0020)
+#define EUSCI_A_IE_RXIE                 ((uint16_t)0x0001)
+#define EUSCI_A_IE_TXIE                 ((uint16_t)0x0002)
+#define EUSCI_A_IFG_RXIFG               ((uint16_t)0x0001)
+#define EUSCI_A_IFG_TXIFG               ((uint16_t)0x0002)
+
+/* CS */
+#define CS_KEY_VAL                      ((uint32_t)0x0000695A)
+#define CS_CTL0_DCOTUNE_OFS             (0)
+#define CS_CTL0_DCOTUNE_MASK            ((uint32_t)0x000003FF)
+#define CS_CTL0_DCORSEL_OFS             (16)
+#define CS_CTL0_DCORSEL_MASK            ((uint32_t)0x00070000)
+#define CS_CTL0_DCORSEL_0               ((uint32_t)0x00000000)
+#define CS_CTL0_DCORSEL_1               ((uint32_t)0x00010000)
+#define CS_CTL0_DCORSEL_2               ((uint32_t)0x00020000)
+#define CS_CTL0_DCORSEL_3               ((uint32_t)0x00030000)
+#define CS_CTL0_DCORSEL_4               ((uint32_t)0x00040000)
+#define CS_CTL0_DCORSEL_5               ((uint32_t)0x00050000)
+#define CS_CTL0_DCORES_OFS              (22)
+#define CS_CTL0_DCORES                  ((uint32_t)0x00400000)
+#define CS_CTL0_DCOEN                   ((uint32_t)0x00800000)
+#define CS_CTL1_SELM_OFS                (0)
+#define CS_CTL1_SELM_MASK               ((uint32_t)0x00000007)
+#define CS_CTL1_SELM__LFXTCLK           ((uint32_t)0x00000000)
+#define CS_CTL1_SELM__VLOCLK            ((uint32_t)0x00000001)
+#define CS_CTL1_SELM__REFOCLK           ((uint32_t)0x00000002)
+#define CS_CTL1_SELM__DCOCLK            ((uint32_t)0x00000003)
+#define CS_CTL1_SELM__MODOSC            ((uint32_t)0x00000004)
+#define CS_CTL1_SELM__HFXTCLK           ((uint32_t)0x00000005)
+#define CS_CTL1_SELM_3                  ((uint32_t)0x00000003)
+#define CS_CTL1_SELS_OFS                (4)
+#define CS_CTL1_SELS_MASK               ((uint32_t)0x00000070)
+#define CS_CTL1_SELS__LFXTCLK           ((uint32_t)0x00000000)
+#define CS_CTL1_SELS__VLOCLK            ((uint32_t)0x00000010)
+#define CS_CTL1_SELS__REFOCLK           ((uint32_t)0x00000020)
+#define CS_CTL1_SELS__DCOCLK            ((uint32_t)0x00000030)
+#define CS_CTL1_SELS__MODOSC            ((uint32_t)0x00000040)
+#define CS_CTL1_SELS__HFXTCLK           ((uint32_t)0x00000050)
+#define CS_CTL1_SELS_3                  ((uint32_t)0x00000030)
+#define CS_CTL1_SELA_OFS                (8)
+#define CS_CTL1_SELA_MASK               ((uint32_t)0x00000700)
+#define CS_CTL1_SELA__LFXTCLK           ((uint32_t)0x00000000)
+#define CS_CTL1_SELA__VLOCLK            ((uint32_t)0x00000100)
+#define CS_CTL1_SELA__REFOCLK           ((uint32_t)0x00000200)
+#define CS_CTL1_SELA_2                  ((uint32_t)0x00000200)
+#define CS_CTL1_DIVM_OFS                (16)
+#define CS_CTL1_DIVM_MASK               ((uint32_t)0x00070000)
+#define CS_CTL1_DIVM__1                 ((uint32_t)0x00000000)
+#define CS_CTL1_DIVM__2                 ((uint32_t)0x00010000)
+#define CS_CTL1_DIVHS_OFS               (20)
+#define CS_CTL1_DIVHS_MASK              ((uint32_t)0x00700000)
+#define CS_CTL1_DIVHS__1                ((uint32_t)0x00000000)
+#define CS_CTL1_DIVHS__2                ((uint32_t)0x00100000)
+#define CS_CTL1_DIVA_OFS                (24)
+#define CS_CTL1_DIVA_MASK               ((uint32_t)0x07000000)
+#define CS_CTL1_DIVA__1                 ((uint32_t)0x00000000)
+#define CS_CTL1_DIVS_OFS                (28)
+#define CS_CTL1_DIVS_MASK               ((uint32_t)0x70000000)
+#define CS_CTL1_DIVS__1                 ((uint32_t)0x00000000)
+#define CS_CTL1_DIVS__2                 ((uint32_t)0x10000000)
+#define CS_CTL2_LFXTDRIVE_MASK          ((uint32_t)0x00000003)
+#define CS_CTL2_LFXT_EN                 ((uint32_t)0x00000100)
+#define CS_CTL2_HFXTDRIVE               ((uint32_t)0x00010000)
+#define CS_CTL2_HFXTFREQ_OFS            (20)
+#define CS_CTL2_HFXTFREQ_MASK           ((uint32_t)0x00700000)
+#define CS_CTL2_HFXTFREQ_6              ((uint32_t)0x00600000)
+#define CS_CTL2_HFXT_EN                 ((uint32_t)0x01000000)
+#define CS_CLKEN_REFOFSEL_OFS           (15)
+#define CS_CLKEN_REFOFSEL               ((uint32_t)0x00008000)
+#define CS_IFG_LFXTIFG_OFS              (0)
+#define CS_IFG_LFXTIFG                  ((uint32_t)0x00000001)
+#define CS_IFG_HFXTIFG_OFS              (1)
+#define CS_IFG_HFXTIFG                  ((uint32_t)0x00000002)
+#define CS_IFG_DCOR_OPNIFG              ((uint32_t)0x00000040)
+#define CS_IFG_FCNTLFIFG                ((uint32_t)0x00000100)
+#define CS_CLRIFG_CLR_LFXTIFG           ((uint32_t)0x00000001)
+#define CS_CLRIFG_CLR_HFXTIFG           ((uint32_t)0x00000002)
+#define CS_CLRIFG_CLR_DCOR_OPNIFG       ((uint32_t)0x00000040)
+#define CS_CLRIFG_CLR_FCNTLFIFG         ((uint32_t)0x00000100)
+
+/* PCM */
+#define PCM_CTL0_AMR_OFS                (0)
+#define PCM_CTL0_AMR_MASK               ((uint32_t)0x0000000F)
+#define PCM_CTL0_AMR_0                  ((uint32_t)0x00000000)
+#define PCM_CTL0_AMR_1                  ((uint32_t)0x00000001)
+#define PCM_CTL0_LPMR_OFS               (4)
+#define PCM_CTL0_LPMR_MASK              ((uint32_t)0x000000F0)
+#define PCM_CTL0_LPMR__LPM3             ((uint32_t)0x00000000)
+#define PCM_CTL0_LPMR__LPM35            ((uint32_t)0x000000A0)
+#define PCM_CTL0_LPMR__LPM45            ((uint32_t)0x000000C0)
+#define PCM_CTL0_CPM_OFS                (8)
+#define PCM_CTL0_CPM_MASK               ((uint32_t)0x00003F00)
+#define PCM_CTL0_CPM_0                  ((uint32_t)0x00000000)
+#define PCM_CTL0_CPM_1                  ((uint32_t)0x00000100)
+#define PCM_CTL0_KEY_OFS                (16)
+#define PCM_CTL0_KEY_MASK               ((uint32_t)0xFFFF0000)
+#define PCM_CTL0_KEY_VAL                ((uint32_t)0x695A0000)
+#define PCM_CTL1_PMR_BUSY               ((uint32_t)0x00000100)
+#define PCM_IFG_AM_INVALID_TR_IFG       ((uint32_t)0x00000004)
+
+/* FLCTL_A */
+#define FLCTL_A_BANK0_RDCTL_BUFI        ((uint32_t)0x00000010)
+#define FLCTL_A_BANK0_RDCTL_BUFD        ((uint32_t)0x00000020)
+#define FLCTL_A_BANK0_RDCTL_WAIT_OFS    (12)
+#define FLCTL_A_BANK0_RDCTL_WAIT_MASK   ((uint32_t)0x0000F000)
+#define FLCTL_A_BANK0_RDCTL_WAIT_0      ((uint32_t)0x00000000)
+#define FLCTL_A_BANK0_RDCTL_WAIT_1      ((uint32_t)0x00001000)
+#define FLCTL_A_BANK0_RDCTL_WAIT_2      ((uint32_t)0x00002000)
+#define FLCTL_A_BANK0_RDCTL_WAIT_3      ((uint32_t)0x00003000)
+#define FLCTL_A_BANK1_RDCTL_BUFI        ((uint32_t)0x00000010)
+#define FLCTL_A_BANK1_RDCTL_BUFD        ((uint32_t)0x00000020)
+#define FLCTL_A_BANK1_RDCTL_WAIT_OFS    (12)
+#define FLCTL_A_BANK1_RDCTL_WAIT_MASK   ((uint32_t)0x0000F000)
+#define FLCTL_A_BANK1_RDCTL_WAIT_0      ((uint32_t)0x00000000)
+#define FLCTL_A_BANK1_RDCTL_WAIT_1      ((uint32_t)0x00001000)
+#define FLCTL_A_BANK1_RDCTL_WAIT_2      ((uint32_t)0x00002000)
+#define FLCTL_A_BANK1_RDCTL_WAIT_3      ((uint32_t)0x00003000)
+#define FLCTL_A_PRG_CTLSTAT_ENABLE      ((uint32_t)0x00000001)
+#define FLCTL_A_PRG_CTLSTAT_MODE        ((uint32_t)0x00000002)
+#define FLCTL_A_PRG_CTLSTAT_STATUS_OFS  (16)
+#define FLCTL_A_PRG_CTLSTAT_STATUS_MASK ((uint32_t)0x00030000)
+#define FLCTL_A_PRG_CTLSTAT_STATUS_1    ((uint32_t)0x00010000)
+#define FLCTL_A_ERASE_CTLSTAT_START     ((uint32_t)0x00000001)
+#define FLCTL_A_ERASE_CTLSTAT_MODE      ((uint32_t)0x00000002)
+#define FLCTL_A_ERASE_CTLSTAT_TYPE_OFS  (2)
+#define FLCTL_A_ERASE_CTLSTAT_TYPE_MASK ((uint32_t)0x0000000C)
+#define FLCTL_A_ERASE_CTLSTAT_TYPE_0    ((uint32_t)0x00000000)
+#define FLCTL_A_ERASE_CTLSTAT_TYPE_1    ((uint32_t)0x00000004)
+#define FLCTL_A_ERASE_CTLSTAT_STATUS_OFS (16)
+#define FLCTL_A_ERASE_CTLSTAT_STATUS_MASK ((uint32_t)0x00030000)
+#define FLCTL_A_ERASE_CTLSTAT_STATUS_0  ((uint32_t)0x00000000)
+#define FLCTL_A_ERASE_CTLSTAT_STATUS_1  ((uint32_t)0x00010000)
+#define FLCTL_A_ERASE_CTLSTAT_STATUS_2  ((uint32_t)0x00020000)
+#define FLCTL_A_ERASE_CTLSTAT_STATUS_3  ((uint32_t)0x00030000)
+#define FLCTL_A_ERASE_CTLSTAT_ADDR_ERR  ((uint32_t)0x00040000)
+#define FLCTL_A_ERASE_CTLSTAT_CLR_STAT  ((uint32_t)0x00080000)
+#define FLCTL_A_BANK1_INFO_WEPROT_PROT0 ((uint32_t)0x00000001)
+#define FLCTL_A_BANK1_INFO_WEPROT_PROT1 ((uint32_t)0x00000002)
+#define FLCTL_A_BANK1_INFO_WEPROT_PROT2 ((uint32_t)0x00000004)
+#define FLCTL_A_BANK1_INFO_WEPROT_PROT3 ((uint32_t)0x00000008)
+
+/* RTC_C */
+#define RTC_C_KEY                       ((uint16_t)0xA500)
+#define RTC_C_CTL0_KEY_OFS              (8)
+#define RTC_C_CTL0_KEY_MASK             ((uint16_t)0xFF00)
+#define RTC_C_CTL0_RDYIFG               ((uint16_t)0x0001)
+#define RTC_C_CTL0_AIFG                 ((uint16_t)0x0002)
+#define RTC_C_CTL0_TEVIFG               ((uint16_t)0x0004)
+#define RTC_C_CTL0_OFIFG                ((uint16_t)0x0008)
+#define RTC_C_CTL0_RDYIE                ((uint16_t)0x0010)
+#define RTC_C_CTL0_AIE                  ((uint16_t)0x0020)
+#define RTC_C_CTL0_TEVIE                ((uint16_t)0x0040)
+#define RTC_C_CTL0_OFIE                 ((uint16_t)0x0080)
+#define RTC_C_CTL13_RDY                 ((uint16_t)0x0010)
+#define RTC_C_CTL13_MODE                ((uint16_t)0x0020)
+#define RTC_C_CTL13_HOLD                ((uint16_t)0x0040)
+#define RTC_C_CTL13_BCD                 ((uint16_t)0x0080)
+#define RTC_C_IV_NONE                   ((uint16_t)0x0000)
+#define RTC_C_IV_RTCOFIFG               ((uint16_t)0x0002)
+#define RTC_C_IV_RTCRDYIFG              ((uint16_t)0x0004)
+#define RTC_C_IV_RTCTEVIFG              ((uint16_t)0x0006)
+#define RTC_C_IV_RTCAIFG                ((uint16_t)0x0008)
+#define RTC_C_TIM0_SEC_OFS              (0)
+#define RTC_C_TIM0_MIN_OFS              (8)
+#define RTC_C_TIM1_HOUR_OFS             (0)
+#define RTC_C_TIM1_DOW_OFS              (8)
+#define RTC_C_DATE_DAY_OFS              (0)
+#define RTC_C_DATE_MON_OFS              (8)
+
+/* DMA */
+#define DMA_STAT_MASTEN                 ((uint32_t)0x00000001)
+#define DMA_CFG_MASTEN                  ((uint32_t)0x00000001)
+#define DMA_INT1_SRCCFG_INT_SRC_MASK    ((uint32_t)0x0000001F)
+#define DMA_INT1_SRCCFG_EN              ((uint32_t)0x00000020)
+#define DMA_INT2_SRCCFG_INT_SRC_MASK    ((uint32_t)0x0000001F)
+#define DMA_INT2_SRCCFG_EN              ((uint32_t)0x00000020)
+#define DMA_INT3_SRCCFG_INT_SRC_MASK    ((uint32_t)0x0000001F)
+#define DMA_INT3_SRCCFG_EN              ((uint32_t)0x00000020)
+
+/* ADC14 */
+#define ADC14_CTL0_SC                   ((uint32_t)0x00000001)
+#define ADC14_CTL0_ENC                  ((uint32_t)0x00000002)
+#define ADC14_CTL0_ON                   ((uint32_t)0x00000010)
+#define ADC14_CTL0_MSC                  ((uint32_t)0x00000080)
+#define ADC14_CTL0_SHT0_OFS             (8)
+#define ADC14_CTL0_SHT0_MASK            ((uint32_t)0x00000F00)
+#define ADC14_CTL0_SHT0_0               ((uint32_t)0x00000000)
+#define ADC14_CTL0_SHT0_1               ((uint32_t)0x00000100)
+#define ADC14_CTL0_SHT0_2               ((uint32_t)0x00000200)
+#define ADC14_CTL0_BUSY                 ((uint32_t)0x00010000)
+#define ADC14_CTL0_CONSEQ_OFS           (17)
+#define ADC14_CTL0_CONSEQ_MASK          ((uint32_t)0x00060000)
+#define ADC14_CTL0_CONSEQ_0             ((uint32_t)0x00000000)
+#define ADC14_CTL0_CONSEQ_1             ((uint32_t)0x00020000)
+#define ADC14_CTL0_CONSEQ_2             ((uint32_t)0x00040000)
+#define ADC14_CTL0_CONSEQ_3             ((uint32_t)0x00060000)
+#define ADC14_CTL0_SSEL_MASK            ((uint32_t)0x00380000)
+#define ADC14_CTL0_SSEL__MODCLK         ((uint32_t)0x00000000)
+#define ADC14_CTL0_SHP                  ((uint32_t)0x04000000)
+#define ADC14_CTL0_SHS_OFS              (27)
+#define ADC14_CTL0_SHS_MASK             ((uint32_t)0x38000000)
+#define ADC14_CTL0_SHS_0                ((uint32_t)0x00000000)
+#define ADC14_CTL0_SHS_1                ((uint32_t)0x08000000)
+#define ADC14_CTL1_RES_OFS              (4)
+#define ADC14_CTL1_RES_MASK             ((uint32_t)0x00000030)
+#define ADC14_CTL1_RES__14BIT           ((uint32_t)0x00000030)
+#define ADC14_MCTLN_INCH_MASK           ((uint32_t)0x0000001F)
+#define ADC14_MCTLN_INCH_0              ((uint32_t)0x00000000)
+#define ADC14_MCTLN_VRSEL_MASK          ((uint32_t)0x00000F00)
+#define ADC14_MCTLN_VRSEL_0             ((uint32_t)0x00000000)
+#define ADC14_IFGR0_IFG0                ((uint32_t)0x00000001)
+
+/* WDT_A */
+#define WDT_A_CTL_HOLD                  ((uint16_t)0x0080)
+#define WDT_A_CTL_PW                    ((uint16_t)0x5A00)
+
+/* SYSCTL_A */
+#define SYSCTL_A_NMI_CTLSTAT_CS_SRC     ((uint32_t)0x00000001)
+#define SYSCTL_A_NMI_CTLSTAT_CS_FLG     ((uint32_t)0x00010000)
+
+/* Core */
+#define SysTick_CTRL_ENABLE_Msk         (1UL << 0)
+#define SysTick_CTRL_TICKINT_Msk        (1UL << 1)
+#define SysTick_CTRL_CLKSOURCE_Msk      (1UL << 2)
+#define SysTick_CTRL_COUNTFLAG_Msk      (1UL << 16)
+#define SysTick_LOAD_RELOAD_Msk         (0xFFFFFFUL)
+#define SysTick_VAL_CURRENT_Msk         (0xFFFFFFUL)
+#define SCB_SCR_SLEEPONEXIT_Msk         (1UL << 1)
+#define SCB_SCR_SLEEPDEEP_Msk           (1UL << 2)
+#define CoreDebug_DEMCR_TRCENA_Msk      (1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk          (1UL << 0)
+
+/******************************************************************************
+* CMSIS core functions                                                        *
+******************************************************************************/
+extern uint32_t SystemCoreClock;
+
+extern void __enable_irq(void);
+extern void __disable_irq(void);
+extern uint32_t __get_PRIMASK(void);
+extern void __set_PRIMASK(uint32_t priMask);
+extern uint32_t __get_MSP(void);
+extern void __wfi(void);
+extern void __no_operation(void);
+
+static inline void NVIC_EnableIRQ(IRQn_Type IRQn) {
+    NVIC->ISER[(uint32_t)IRQn >> 5] = 1UL << ((uint32_t)IRQn & 0x1F);
+}
+
+static inline void NVIC_DisableIRQ(IRQn_Type IRQn) {
+    NVIC->ICER[(uint32_t)IRQn >> 5] = 1UL << ((uint32_t)IRQn & 0x1F);
+}
+
+static inline void NVIC_SetPendingIRQ(IRQn_Type IRQn) {
+    NVIC->ISPR[(uint32_t)IRQn >> 5] = 1UL << ((uint32_t)IRQn & 0x1F);
+}
+
+static inline void NVIC_ClearPendingIRQ(IRQn_Type IRQn) {
+    NVIC->ICPR[(uint32_t)IRQn >> 5] = 1UL << ((uint32_t)IRQn & 0x1F);
+}
+
+static inline void NVIC_SetPriority(IRQn_Type IRQn, uint32_t priority) {
+    if ((int32_t)IRQn < 0) {
+        SCB->SHP[((uint32_t)IRQn & 0xF) - 4] =
+                (uint8_t)(priority << (8 - __NVIC_PRIO_BITS));
+    } else {
+        NVIC->IP[(uint32_t)IRQn] = (uint8_t)(priority << (8 - __NVIC_PRIO_BITS));
+    }
+}
+
+/******************************************************************************
+* CMSIS SIMD intrinsics, the Cortex-M4 DSP instructions in plain C. Results   *
+* match the instructions bit for bit; the Q and GE flags are not modeled      *
+******************************************************************************/
+/* Dual signed 16x16 multiply, both products added to acc, wraps at 32 bits */
+static inline uint32_t __SMLAD(uint32_t x, uint32_t y, uint32_t acc) {
+    int32_t low = (int32_t)(int16_t)x * (int16_t)y;
+    int32_t high = (int32_t)(int16_t)(x >> 16) * (int16_t)(y >> 16);
+
+    return acc + (uint32_t)low + (uint32_t)high;
+}
+
+/* Dual signed 16x16 multiply, both products added to a 64-bit acc */
+static inline uint64_t __SMLALD(uint32_t x, uint32_t y, uint64_t acc) {
+    int64_t low = (int32_t)(int16_t)x * (int16_t)y;
+    int64_t high = (int32_t)(int16_t)(x >> 16) * (int16_t)(y >> 16);
+
+    return acc + (uint64_t)(low + high);
+}
+
+/* Halfword-wise signed x - y, each result wraps at 16 bits */
+static inline uint32_t __SSUB16(uint32_t x, uint32_t y) {
+    uint16_t low = (uint16_t)((int16_t)x - (int16_t)y);
+    uint16_t high = (uint16_t)((int16_t)(x >> 16) - (int16_t)(y >> 16));
+
+    return ((uint32_t)high << 16) | low;
+}
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MSP_H_ */
@@ -0,0 +1,2140 @@
+/*! \file */
+/*!
+ * sim.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Virtual MSP432P4111, see sim.h. Each register block has a
+ *              shadow copy; the firmware's writes are found by comparing the
+ *              two at the next access and handed to the block's model.
+ *              Registers that only ever get written (TXBUF, INTCLR, the DMA
+ *              clear registers) are parked on a value the firmware never
+ *              writes, so a repeated byte still shows up as a write. Flags
+ *              the hardware clears on a read (RXBUF, RTCIV) are cleared when
+ *              the handler that reads them returns.
+ *
+ *              The information flash lives at its real address and is
+ *              write-protected; a store from the firmware faults, the page
+ *              is opened and the change is checked against the program
+ *              rules at the next access.
+ */
+
+#define _GNU_SOURCE
+#include <math.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "msp.h"
+#include "sim.h"
+#include "dma.h"
+
+#define PS_PER_S                1000000000000ULL
+
+/* Assumed oscillator start-up and flash timing, within the datasheet ranges */
+#define HFXT_START_US           1000
+#define LFXT_START_US           200000
+#define FLASH_PROGRAM_US        10      // per 128-bit flash word
+#define FLASH_ERASE_US          10000   // per sector
+
+#define DCO_BASE_HZ             1500000 // DCORSEL_0 centre, doubles per step
+#define HFXT_HZ                 48000000
+#define XT32_HZ                 32768
+#define VLO_HZ                  9400
+#define MODOSC_HZ               25000000
+#define SYSOSC_HZ               5000000 // fail-safe source for a faulty HFXT
+
+#define SCHEDULE_SIZE           512
+#define RX_QUEUE_SIZE           4096    // power of 2
+#define HOOKS_PER_PORT          4
+#define IRQ_SYSTICK             63      // bit of SysTick in the pending masks
+#define THREAD_PRIORITY         0x100
+
+#define TXBUF_IDLE              0xFFFF
+#define INTCLR_IDLE             0xFFFFFFFF
+
+typedef enum _ClockId {
+    CLK_MCLK, CLK_SMCLK, CLK_ACLK, CLK_RTC, CLK_COUNT
+} ClockId;
+
+typedef struct _SimClock {
+    uint64_t hz;
+    uint64_t originPs;
+    uint64_t originTicks;
+} SimClock;
+
+typedef struct _DeviceInfo {
+    void *regs;
+    void *shadow;
+    uint16_t size;
+    void (*written)(SimDevice device, const void *before);
+    void (*publish)(SimDevice device);
+} DeviceInfo;
+
+typedef struct _ScheduledCall {
+    uint64_t ps;
+    SimCallback callback;
+    void *arg;
+} ScheduledCall;
+
+typedef struct _CountState {
+    uint32_t value;
+    uint64_t base;          // clock tick the count started at
+    uint64_t done;          // prescaled ticks already counted
+    uint8_t running;
+} CountState;
+
+/******************************************************************************
+* Handlers, whichever the firmware defines                                    *
+******************************************************************************/
+#define WEAK_HANDLER(name)  extern void name(void) __attribute__((weak));
+WEAK_HANDLER(SysTick_Handler)
+WEAK_HANDLER(PSS_IRQHandler)
+WEAK_HANDLER(CS_IRQHandler)
+WEAK_HANDLER(PCM_IRQHandler)
+WEAK_HANDLER(WDT_A_IRQHandler)
+WEAK_HANDLER(FLCTL_A_IRQHandler)
+WEAK_HANDLER(TA0_0_IRQHandler)
+WEAK_HANDLER(TA0_N_IRQHandler)
+WEAK_HANDLER(TA1_0_IRQHandler)
+WEAK_HANDLER(TA1_N_IRQHandler)
+WEAK_HANDLER(TA2_0_IRQHandler)
+WEAK_HANDLER(TA2_N_IRQHandler)
+WEAK_HANDLER(TA3_0_IRQHandler)
+WEAK_HANDLER(TA3_N_IRQHandler)
+WEAK_HANDLER(EUSCIA0_IRQHandler)
+WEAK_HANDLER(ADC14_IRQHandler)
+WEAK_HANDLER(T32_INT1_IRQHandler)
+WEAK_HANDLER(T32_INT2_IRQHandler)
+WEAK_HANDLER(T32_INTC_IRQHandler)
+WEAK_HANDLER(RTC_C_IRQHandler)
+WEAK_HANDLER(DMA_INT3_IRQHandler)
+WEAK_HANDLER(DMA_INT2_IRQHandler)
+WEAK_HANDLER(DMA_INT1_IRQHandler)
+WEAK_HANDLER(DMA_INT0_IRQHandler)
+WEAK_HANDLER(PORT1_IRQHandler)
+WEAK_HANDLER(PORT2_IRQHandler)
+WEAK_HANDLER(PORT3_IRQHandler)
+WEAK_HANDLER(PORT4_IRQHandler)
+WEAK_HANDLER(PORT5_IRQHandler)
+WEAK_HANDLER(PORT6_IRQHandler)
+
+static void (*const vectors[64])(void) = {
+    [PSS_IRQn] = PSS_IRQHandler,            [CS_IRQn] = CS_IRQHandler,
+    [PCM_IRQn] = PCM_IRQHandler,            [WDT_A_IRQn] = WDT_A_IRQHandler,
+    [FLCTL_A_IRQn] = FLCTL_A_IRQHandler,
+    [TA0_0_IRQn] = TA0_0_IRQHandler,        [TA0_N_IRQn] = TA0_N_IRQHandler,
+    [TA1_0_IRQn] = TA1_0_IRQHandler,        [TA1_N_IRQn] = TA1_N_IRQHandler,
+    [TA2_0_IRQn] = TA2_0_IRQHandler,        [TA2_N_IRQn] = TA2_N_IRQHandler,
+    [TA3_0_IRQn] = TA3_0_IRQHandler,        [TA3_N_IRQn] = TA3_N_IRQHandler,
+    [EUSCIA0_IRQn] = EUSCIA0_IRQHandler,    [ADC14_IRQn] = ADC14_IRQHandler,
+    [T32_INT1_IRQn] = T32_INT1_IRQHandler,  [T32_INT2_IRQn] = T32_INT2_IRQHandler,
+    [T32_INTC_IRQn] = T32_INTC_IRQHandler,  [RTC_C_IRQn] = RTC_C_IRQHandler,
+    [DMA_INT3_IRQn] = DMA_INT3_IRQHandler,  [DMA_INT2_IRQn] = DMA_INT2_IRQHandler,
+    [DMA_INT1_IRQn] = DMA_INT1_IRQHandler,  [DMA_INT0_IRQn] = DMA_INT0_IRQHandler,
+    [PORT1_IRQn] = PORT1_IRQHandler,        [PORT2_IRQn] = PORT2_IRQHandler,
+    [PORT3_IRQn] = PORT3_IRQHandler,        [PORT4_IRQn] = PORT4_IRQHandler,
+    [PORT5_IRQn] = PORT5_IRQHandler,        [PORT6_IRQn] = PORT6_IRQHandler,
+    [IRQ_SYSTICK] = SysTick_Handler,
+};
+
+/* Stack placement from the linker, see Makefile; absent in unit tests */
+extern uint32_t __stack __attribute__((weak));
+extern uint32_t __STACK_END __attribute__((weak));
+
+uint32_t SystemCoreClock = 3000000;
+
+/******************************************************************************
+* Register blocks and their shadows                                           *
+******************************************************************************/
+static DIO_PORT_Interruptable_Type port[SIM_PORT_COUNT], portShadow[SIM_PORT_COUNT];
+static Timer_A_Type timerA[4], timerAShadow[4];
+static Timer32_Type timer32[2], timer32Shadow[2];
+static EUSCI_A_Type uart, uartShadow;
+static CS_Type cs, csShadow;
+static PCM_Type pcm, pcmShadow;
+static FLCTL_A_Type flctl, flctlShadow;
+static RTC_C_Type rtc, rtcShadow;
+static DMA_Channel_Type dmaChannel, dmaChannelShadow;
+static DMA_Control_Type dmaControl, dmaControlShadow;
+static ADC14_Type adc, adcShadow;
+static WDT_A_Type wdt, wdtShadow;
+static SYSCTL_A_Type sysctl, sysctlShadow;
+static SysTick_Type sysTick, sysTickShadow;
+static SCB_Type scb, scbShadow;
+static NVIC_Type nvic, nvicShadow;
+static DWT_Type dwt, dwtShadow;
+static CoreDebug_Type coreDebug, coreDebugShadow;
+
+static DeviceInfo devices[SIM_DEV_COUNT];
+
+/* Room for the copy of any block, see syncDevice */
+typedef union _AnyBlock {
+    DIO_PORT_Interruptable_Type port;
+    Timer_A_Type timerA;
+    Timer32_Type timer32;
+    EUSCI_A_Type uart;
+    CS_Type cs;
+    PCM_Type pcm;
+    FLCTL_A_Type flctl;
+    RTC_C_Type rtc;
+    DMA_Channel_Type dmaChannel;
+    DMA_Control_Type dmaControl;
+    ADC14_Type adc;
+    WDT_A_Type wdt;
+    SYSCTL_A_Type sysctl;
+    SysTick_Type sysTick;
+    SCB_Type scb;
+    NVIC_Type nvic;
+    DWT_Type dwt;
+    CoreDebug_Type coreDebug;
+} AnyBlock;
+
+/******************************************************************************
+* Core state                                                                  *
+******************************************************************************/
+static uint64_t now = 0;
+static SimClock clocks[CLK_COUNT];
+static uint64_t mclkRunHz = 3000000;   // MCLK outside LPM3, prices accesses
+static uint64_t accessPs = 0;
+static uint64_t accessCount = 0;
+static SimDevice lastDevice = SIM_DEV_NONE;
+
+static uint64_t nextEventPs = 0;
+static uint8_t eventsDirty = 1;
+static uint8_t linesDirty = 1;
+
+static uint64_t irqEnabled = 1ULL << IRQ_SYSTICK;
+static uint64_t irqPending = 0;
+static uint32_t executionPriority = THREAD_PRIORITY;
+static uint8_t primask = 0;
+static uint32_t irqCounts[64];
+
+static uint8_t sleeping = 0;
+static uint64_t sleepPs = 0;
+
+static ScheduledCall schedule[SCHEDULE_SIZE];
+static uint16_t scheduleCount = 0;
+
+static uint32_t violations = 0;
+static uint8_t violationsQuiet = 0;
+
+static void advanceTo(uint64_t target);
+static void dispatch(void);
+static void syncWrites(void);
+static void csApply(void);
+static void dmaTrigger(uint8_t channel, uint8_t source);
+static void adcTrigger(void);
+
+/******************************************************************************
+* Clock domains                                                               *
+******************************************************************************/
+static uint64_t clockTicks(ClockId id) {
+    const SimClock *c = &clocks[id];
+
+    if (!c->hz) {
+        return c->originTicks;
+    }
+    return c->originTicks
+            + (uint64_t)((unsigned __int128)(now - c->originPs) * c->hz / PS_PER_S);
+}
+
+// Virtual time at which a clock reaches a tick count, SIM_NEVER if stopped
+static uint64_t clockTime(ClockId id, uint64_t ticks) {
+    const SimClock *c = &clocks[id];
+
+    if (!c->hz) {
+        return SIM_NEVER;
+    }
+    if (ticks <= c->originTicks) {
+        return c->originPs;
+    }
+    return c->originPs + (uint64_t)(((unsigned __int128)(ticks - c->originTicks)
+                                     * PS_PER_S + c->hz - 1) / c->hz);
+}
+
+static void clockSet(ClockId id, uint64_t hz) {
+    SimClock *c = &clocks[id];
+
+    if (c->hz == hz) {
+        return;
+    }
+    c->originTicks = clockTicks(id);
+    c->originPs = now;
+    c->hz = hz;
+}
+
+static uint64_t cyclesToPs(uint32_t cycles) {
+    return (uint64_t)cycles * PS_PER_S / mclkRunHz;
+}
+
+/******************************************************************************
+* Bookkeeping                                                                 *
+******************************************************************************/
+static void invalidate(void) {
+    eventsDirty = 1;
+    linesDirty = 1;
+}
+
+static void touch(SimDevice device) {
+    memcpy(devices[device].shadow, devices[device].regs, devices[device].size);
+}
+
+static void touchAll(void) {
+    int d;
+
+    for (d = SIM_DEV_NONE + 1; d < SIM_DEV_COUNT; d++) {
+        touch((SimDevice)d);
+    }
+}
+
+static void pend(int irq) {
+    irqPending |= 1ULL << irq;
+    linesDirty = 1;
+}
+
+static uint64_t earliest(uint64_t a, uint64_t b) {
+    return a < b ? a : b;
+}
+
+void simViolation(const char *format, ...) {
+    va_list args;
+
+    violations++;
+    if (violationsQuiet) {
+        return;
+    }
+    va_start(args, format);
+    printf("%12.3f ms  !!  ", simNowMs());
+    vprintf(format, args);
+    printf("\n");
+    va_end(args);
+}
+
+uint32_t simViolationCount(void) {
+    return violations;
+}
+
+void simViolationQuiet(uint8_t quiet) {
+    violationsQuiet = quiet;
+}
+
+/* Counts a prescaled down-counter by n ticks; reaching 0 reloads on the
+ *  following tick. Returns 1 if the count reached 0. */
+static uint8_t countDown(CountState *s, uint32_t reload, uint64_t n, uint8_t oneShot) {
+    uint64_t period = (uint64_t)reload + 1;
+    uint8_t hit = 0;
+
+    while (n) {
+        if (s->value == 0) {
+            if (oneShot) {
+                s->running = 0;
+                return hit;
+            }
+            s->value = reload;
+            n--;
+            continue;
+        }
+        if (n < s->value) {
+            s->value -= (uint32_t)n;
+            return hit;
+        }
+        n -= s->value;
+        s->value = 0;
+        hit = 1;
+        if (!oneShot && n > period) {
+            n %= period;
+        }
+    }
+    return hit;
+}
+
+static uint64_t countTicksPending(const CountState *s, ClockId clk, uint32_t prescale) {
+    return (clockTicks(clk) - s->base) / prescale - s->done;
+}
+
+static void countRestart(CountState *s, ClockId clk) {
+    s->base = clockTicks(clk);
+    s->done = 0;
+}
+
+/******************************************************************************
+* GPIO                                                                        *
+******************************************************************************/
+static uint8_t portDriven[SIM_PORT_COUNT];
+static uint8_t portLevel[SIM_PORT_COUNT];
+static SimPortHook portHooks[SIM_PORT_COUNT][HOOKS_PER_PORT];
+
+static void portInputs(uint8_t p) {
+    DIO_PORT_Interruptable_Type *r = &port[p];
+    uint8_t in = (r->OUT & r->DIR)
+            | (portLevel[p] & portDriven[p] & ~r->DIR)
+            | (r->OUT & r->REN & ~r->DIR & ~portDriven[p]);
+    uint8_t old = r->IN;
+
+    if (p >= 1 && p <= 6 && in != old) {
+        r->IFG |= (~in & old & r->IES) | (in & ~old & ~r->IES);
+        linesDirty = 1;
+    }
+    *(uint8_t *)&r->IN = in;
+}
+
+static void portWritten(SimDevice device, const void *before) {
+    const DIO_PORT_Interruptable_Type *old = before;
+    uint8_t p = device - SIM_DEV_PJ;
+    DIO_PORT_Interruptable_Type *r = &port[p];
+    uint8_t i;
+
+    portInputs(p);
+    if (r->OUT != old->OUT || r->DIR != old->DIR) {
+        for (i = 0; i < HOOKS_PER_PORT && portHooks[p][i]; i++) {
+            portHooks[p][i](p, r->OUT, old->OUT);
+        }
+    }
+}
+
+static uint64_t portLines(void) {
+    uint64_t lines = 0;
+    uint8_t p;
+
+    for (p = 1; p <= 6; p++) {
+        if (port[p].IFG & port[p].IE) {
+            lines |= 1ULL << (PORT1_IRQn + p - 1);
+        }
+    }
+    return lines;
+}
+
+static void syncDevice(SimDevice device);
+
+static void syncPorts(void) {
+    int d;
+
+    if (!memcmp(port, portShadow, sizeof(port))) {
+        return;     // nothing written, the usual case on every access
+    }
+    for (d = SIM_DEV_PJ; d <= SIM_DEV_P10; d++) {
+        syncDevice((SimDevice)d);
+    }
+}
+
+void simGpioDrive(uint8_t p, uint8_t mask, uint8_t level) {
+    syncPorts();
+    portDriven[p] |= mask;
+    portLevel[p] = level ? portLevel[p] | mask : portLevel[p] & ~mask;
+    portInputs(p);
+    touch((SimDevice)(SIM_DEV_PJ + p));
+    invalidate();
+}
+
+void simGpioRelease(uint8_t p, uint8_t mask) {
+    syncPorts();
+    portDriven[p] &= ~mask;
+    portInputs(p);
+    touch((SimDevice)(SIM_DEV_PJ + p));
+    invalidate();
+}
+
+uint8_t simGpioOut(uint8_t p) {
+    return port[p].OUT;
+}
+
+uint8_t simGpioWatch(uint8_t p, SimPortHook hook) {
+    uint8_t i;
+
+    for (i = 0; i < HOOKS_PER_PORT; i++) {
+        if (!portHooks[p][i]) {
+            portHooks[p][i] = hook;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/******************************************************************************
+* Timer32                                                                     *
+******************************************************************************/
+static CountState t32State[2];
+
+static uint32_t t32Prescale(const Timer32_Type *r) {
+    switch (r->CONTROL & TIMER32_CONTROL_PRESCALE_MASK) {
+    case TIMER32_CONTROL_PRESCALE_1:
+        return 16;
+    case TIMER32_CONTROL_PRESCALE_2:
+        return 256;
+    default:
+        return 1;
+    }
+}
+
+static uint32_t t32Max(const Timer32_Type *r) {
+    return (r->CONTROL & TIMER32_CONTROL_SIZE) ? 0xFFFFFFFF : 0xFFFF;
+}
+
+static uint32_t t32Reload(const Timer32_Type *r) {
+    return (r->CONTROL & TIMER32_CONTROL_MODE) ? (r->LOAD & t32Max(r)) : t32Max(r);
+}
+
+// Counts timer i up to now with the configuration in cfg
+static void t32Advance(uint8_t i, const Timer32_Type *cfg) {
+    CountState *s = &t32State[i];
+    uint64_t n;
+
+    if (!s->running) {
+        return;
+    }
+    n = countTicksPending(s, CLK_MCLK, t32Prescale(cfg));
+    if (!n) {
+        return;
+    }
+    s->done += n;
+    if (countDown(s, t32Reload(cfg), n, cfg->CONTROL & TIMER32_CONTROL_ONESHOT)) {
+        *(uint32_t *)&timer32[i].RIS = TIMER32_RIS_RAW_IFG;
+        linesDirty = 1;
+    }
+}
+
+static void t32Update(void) {
+    t32Advance(0, &timer32[0]);
+    t32Advance(1, &timer32[1]);
+}
+
+static uint64_t t32Next(void) {
+    uint64_t next = SIM_NEVER;
+    uint64_t ticks;
+    uint8_t i;
+
+    for (i = 0; i < 2; i++) {
+        const CountState *s = &t32State[i];
+        const Timer32_Type *r = &timer32[i];
+
+        if (!s->running || r->RIS) {
+            continue;
+        }
+        ticks = s->value ? s->value : (uint64_t)t32Reload(r) + 1;
+        next = earliest(next, clockTime(CLK_MCLK,
+                        s->base + (s->done + ticks) * t32Prescale(r)));
+    }
+    return next;
+}
+
+static void t32Written(SimDevice device, const void *before) {
+    const Timer32_Type *old = before;
+    uint8_t i = device - SIM_DEV_TIMER32_1;
+    Timer32_Type *r = &timer32[i];
+    CountState *s = &t32State[i];
+
+    t32Advance(i, old);
+    if (r->LOAD != old->LOAD) {
+        s->value = r->LOAD & t32Max(r);
+        r->BGLOAD = r->LOAD;
+    } else if (r->BGLOAD != old->BGLOAD) {
+        r->LOAD = r->BGLOAD;
+    }
+    if ((r->CONTROL ^ old->CONTROL) & (TIMER32_CONTROL_ENABLE
+            | TIMER32_CONTROL_PRESCALE_MASK | TIMER32_CONTROL_SIZE)) {
+        s->running = (r->CONTROL & TIMER32_CONTROL_ENABLE) != 0;
+        s->value &= t32Max(r);
+        countRestart(s, CLK_MCLK);
+    }
+    if (r->INTCLR != INTCLR_IDLE) {
+        *(uint32_t *)&r->RIS = 0;
+        *(uint32_t *)&r->INTCLR = INTCLR_IDLE;
+    }
+}
+
+static void t32Publish(SimDevice device) {
+    uint8_t i = device - SIM_DEV_TIMER32_1;
+    Timer32_Type *r = &timer32[i];
+
+    t32Advance(i, r);
+    *(uint32_t *)&r->VALUE = t32State[i].value;
+    *(uint32_t *)&r->MIS = (r->CONTROL & TIMER32_CONTROL_IE) ? r->RIS : 0;
+}
+
+static uint64_t t32Lines(void) {
+    uint64_t lines = 0;
+
+    if (timer32[0].RIS && (timer32[0].CONTROL & TIMER32_CONTROL_IE)) {
+        lines |= (1ULL << T32_INT1_IRQn) | (1ULL << T32_INTC_IRQn);
+    }
+    if (timer32[1].RIS && (timer32[1].CONTROL & TIMER32_CONTROL_IE)) {
+        lines |= (1ULL << T32_INT2_IRQn) | (1ULL << T32_INTC_IRQn);
+    }
+    return lines;
+}
+
+/******************************************************************************
+* Timer_A, up and continuous modes (up/down counts as up)                     *
+******************************************************************************/
+typedef struct _TimerAState {
+    uint16_t r;
+    uint64_t base;
+    uint64_t done;
+} TimerAState;
+
+static TimerAState taState[4];
+
+static uint8_t taRunning(const Timer_A_Type *cfg) {
+    uint16_t ssel = cfg->CTL & TIMER_A_CTL_SSEL_MASK;
+
+    if (!(cfg->CTL & TIMER_A_CTL_MC_MASK)
+            || (ssel != TIMER_A_CTL_SSEL__ACLK && ssel != TIMER_A_CTL_SSEL__SMCLK)) {
+        return 0;
+    }
+    return (cfg->CTL & TIMER_A_CTL_MC_MASK) == TIMER_A_CTL_MC__CONTINUOUS
+            || cfg->CCR[0] != 0;
+}
+
+static ClockId taClock(const Timer_A_Type *cfg) {
+    return (cfg->CTL & TIMER_A_CTL_SSEL_MASK) == TIMER_A_CTL_SSEL__ACLK
+            ? CLK_ACLK : CLK_SMCLK;
+}
+
+static uint32_t taDivider(const Timer_A_Type *cfg) {
+    return (1u << ((cfg->CTL & TIMER_A_CTL_ID_MASK) >> TIMER_A_CTL_ID_OFS))
+            * ((cfg->EX0 & TIMER_A_EX0_IDEX_MASK) + 1);
+}
+
+static uint8_t taUpMode(const Timer_A_Type *cfg) {
+    return (cfg->CTL & TIMER_A_CTL_MC_MASK) != TIMER_A_CTL_MC__CONTINUOUS;
+}
+
+// Ticks until the counter next equals v, 0 if it never will
+static uint32_t taDistance(const Timer_A_Type *cfg, uint16_t r, uint16_t v) {
+    uint16_t top = cfg->CCR[0];
+
+    if (!taUpMode(cfg)) {
+        return v > r ? (uint32_t)(v - r) : 0x10000u - r + v;
+    }
+    if (v > top) {
+        return 0;
+    }
+    if (r >= top) {
+        return 1u + v;      // rolls to zero first
+    }
+    return v > r ? (uint32_t)(v - r) : (uint32_t)(top - r) + 1 + v;
+}
+
+static uint16_t taFreeRun(const Timer_A_Type *cfg, uint16_t r, uint64_t n) {
+    uint64_t period = (uint64_t)cfg->CCR[0] + 1;
+
+    if (!taUpMode(cfg)) {
+        return (uint16_t)(r + n);
+    }
+    if (r > cfg->CCR[0]) {
+        if (!n) {
+            return r;
+        }
+        n--;
+        r = 0;
+    }
+    return (uint16_t)((r + n) % period);
+}
+
+// Whether reaching CCRk changes anything: a flag to set or a trigger
+static uint8_t taCompareMatters(uint8_t i, const Timer_A_Type *cfg, uint8_t k) {
+    if (cfg->CCTL[k] & TIMER_A_CCTLN_CAP) {
+        return 0;
+    }
+    if (!(cfg->CCTL[k] & TIMER_A_CCTLN_CCIFG)) {
+        return 1;
+    }
+    if (i == 3 && k == 0) {
+        return 1;           // DMA request source 6
+    }
+    if (i == 0 && (cfg->CCTL[1] & TIMER_A_CCTLN_OUTMOD_MASK) == TIMER_A_CCTLN_OUTMOD_7
+            && k == 0) {
+        return 1;           // TA0.1 rising edge triggers ADC14
+    }
+    if (i == 0 && (cfg->CCTL[1] & TIMER_A_CCTLN_OUTMOD_MASK) == TIMER_A_CCTLN_OUTMOD_3
+            && k == 1) {
+        return 1;
+    }
+    return 0;
+}
+
+static uint32_t taNextPoint(uint8_t i, const Timer_A_Type *cfg, uint16_t r) {
+    uint32_t best = 0;
+    uint32_t d;
+    uint8_t k;
+
+    for (k = 0; k < 7; k++) {
+        if (taCompareMatters(i, cfg, k)) {
+            d = taDistance(cfg, r, cfg->CCR[k]);
+            if (d && (!best || d < best)) {
+                best = d;
+            }
+        }
+    }
+    if (!(cfg->CTL & TIMER_A_CTL_IFG)) {
+        d = taDistance(cfg, r, 0);
+        if (d && (!best || d < best)) {
+            best = d;
+        }
+    }
+    return best;
+}
+
+static void taArrive(uint8_t i, Timer_A_Type *t, uint16_t r) {
+    uint16_t top = taUpMode(t) ? t->CCR[0] : 0xFFFF;
+    uint8_t k;
+
+    for (k = 0; k < 7; k++) {
+        if (!(t->CCTL[k] & TIMER_A_CCTLN_CAP) && t->CCR[k] == r && t->CCR[k] <= top) {
+            t->CCTL[k] |= TIMER_A_CCTLN_CCIFG;
+            if (i == 3 && k == 0) {
+                dmaTrigger(DMA_CH_STEPPER, DMA_SRC_STEPPER);
+            }
+            if (i == 0 && ((k == 0 && (t->CCTL[1] & TIMER_A_CCTLN_OUTMOD_MASK)
+                                == TIMER_A_CCTLN_OUTMOD_7)
+                    || (k == 1 && (t->CCTL[1] & TIMER_A_CCTLN_OUTMOD_MASK)
+                                == TIMER_A_CCTLN_OUTMOD_3))) {
+                adcTrigger();
+            }
+        }
+    }
+    if (r == 0) {
+        t->CTL |= TIMER_A_CTL_IFG;
+    }
+    linesDirty = 1;
+}
+
+static void taAdvance(uint8_t i, const Timer_A_Type *cfg) {
+    TimerAState *s = &taState[i];
+    uint64_t n;
+    uint32_t d;
+
+    if (!taRunning(cfg)) {
+        return;
+    }
+    n = (clockTicks(taClock(cfg)) - s->base) / taDivider(cfg) - s->done;
+    s->done += n;
+    while (n) {
+        d = taNextPoint(i, cfg, s->r);
+        if (!d || d > n) {
+            s->r = taFreeRun(cfg, s->r, n);
+            break;
+        }
+        s->r = taFreeRun(cfg, s->r, d);
+        n -= d;
+        taArrive(i, &timerA[i], s->r);
+    }
+}
+
+static void taUpdate(void) {
+    uint8_t i;
+
+    for (i = 0; i < 4; i++) {
+        taAdvance(i, &timerA[i]);
+    }
+}
+
+static uint64_t taNext(void) {
+    uint64_t next = SIM_NEVER;
+    uint32_t d;
+    uint8_t i;
+
+    for (i = 0; i < 4; i++) {
+        const Timer_A_Type *t = &timerA[i];
+        const TimerAState *s = &taState[i];
+
+        if (!taRunning(t)) {
+            continue;
+        }
+        d = taNextPoint(i, t, s->r);
+        if (d) {
+            next = earliest(next, clockTime(taClock(t),
+                            s->base + (s->done + d) * taDivider(t)));
+        }
+    }
+    return next;
+}
+
+static void taWritten(SimDevice device, const void *before) {
+    const Timer_A_Type *old = before;
+    uint8_t i = device - SIM_DEV_TIMER_A0;
+    Timer_A_Type *t = &timerA[i];
+    TimerAState *s = &taState[i];
+    uint16_t config = TIMER_A_CTL_MC_MASK | TIMER_A_CTL_SSEL_MASK | TIMER_A_CTL_ID_MASK;
+
+    taAdvance(i, old);
+    if (t->R != old->R) {
+        s->r = t->R;
+    }
+    if ((t->CTL & TIMER_A_CTL_CLR) || ((t->CTL ^ old->CTL) & config)
+            || t->EX0 != old->EX0 || taRunning(t) != taRunning(old)) {
+        if (t->CTL & TIMER_A_CTL_CLR) {
+            s->r = 0;
+            t->CTL &= ~TIMER_A_CTL_CLR;
+        }
+        s->base = clockTicks(taClock(t));
+        s->done = 0;
+    }
+}
+
+static void taPublish(SimDevice device) {
+    uint8_t i = device - SIM_DEV_TIMER_A0;
+    Timer_A_Type *t = &timerA[i];
+    uint16_t iv = 0;
+    uint8_t k;
+
+    taAdvance(i, t);
+    t->R = taState[i].r;
+    for (k = 1; k < 7 && !iv; k++) {
+        if ((t->CCTL[k] & (TIMER_A_CCTLN_CCIFG | TIMER_A_CCTLN_CCIE))
+                == (TIMER_A_CCTLN_CCIFG | TIMER_A_CCTLN_CCIE)) {
+            iv = 2 * k;
+        }
+    }
+    if (!iv && (t->CTL & TIMER_A_CTL_IFG) && (t->CTL & TIMER_A_CTL_IE)) {
+        iv = 0x0E;
+    }
+    *(uint16_t *)&t->IV = iv;
+}
+
+static uint64_t taLines(void) {
+    uint64_t lines = 0;
+    uint8_t i, k;
+
+    for (i = 0; i < 4; i++) {
+        const Timer_A_Type *t = &timerA[i];
+
+        if ((t->CCTL[0] & TIMER_A_CCTLN_CCIFG) && (t->CCTL[0] & TIMER_A_CCTLN_CCIE)) {
+            lines |= 1ULL << (TA0_0_IRQn + 2 * i);
+        }
+        for (k = 1; k < 7; k++) {
+            if ((t->CCTL[k] & TIMER_A_CCTLN_CCIFG) && (t->CCTL[k] & TIMER_A_CCTLN_CCIE)) {
+                lines |= 1ULL << (TA0_N_IRQn + 2 * i);
+            }
+        }
+        if ((t->CTL & TIMER_A_CTL_IFG) && (t->CTL & TIMER_A_CTL_IE)) {
+            lines |= 1ULL << (TA0_N_IRQn + 2 * i);
+        }
+    }
+    return lines;
+}
+
+/******************************************************************************
+* SysTick, always from MCLK                                                   *
+******************************************************************************/
+static CountState sysTickState;
+static uint8_t countFlag = 0;
+
+static void sysTickAdvance(const SysTick_Type *cfg) {
+    uint64_t n;
+
+    if (!(cfg->CTRL & SysTick_CTRL_ENABLE_Msk)) {
+        return;
+    }
+    n = countTicksPending(&sysTickState, CLK_MCLK, 1);
+    if (!n) {
+        return;
+    }
+    sysTickState.done += n;
+    if (countDown(&sysTickState, cfg->LOAD & SysTick_LOAD_RELOAD_Msk, n, 0)) {
+        countFlag = 1;
+        if (cfg->CTRL & SysTick_CTRL_TICKINT_Msk) {
+            pend(IRQ_SYSTICK);
+        }
+    }
+}
+
+static void sysTickUpdate(void) {
+    sysTickAdvance(&sysTick);
+}
+
+static uint64_t sysTickNext(void) {
+    uint64_t ticks;
+
+    if (!(sysTick.CTRL & SysTick_CTRL_ENABLE_Msk)
+            || (countFlag && !(sysTick.CTRL & SysTick_CTRL_TICKINT_Msk))) {
+        return SIM_NEVER;
+    }
+    ticks = sysTickState.value ? sysTickState.value
+            : (uint64_t)(sysTick.LOAD & SysTick_LOAD_RELOAD_Msk) + 1;
+    return clockTime(CLK_MCLK, sysTickState.base + sysTickState.done + ticks);
+}
+
+static void sysTickWritten(SimDevice device, const void *before) {
+    const SysTick_Type *old = before;
+
+    (void)device;
+    sysTickAdvance(old);
+    if (sysTick.VAL != old->VAL) {
+        sysTickState.value = 0;     // any write clears
+        countFlag = 0;
+    }
+    if ((sysTick.CTRL & SysTick_CTRL_ENABLE_Msk)
+            && !(old->CTRL & SysTick_CTRL_ENABLE_Msk)) {
+        countRestart(&sysTickState, CLK_MCLK);
+    }
+}
+
+static void sysTickPublish(SimDevice device) {
+    (void)device;
+    sysTickAdvance(&sysTick);
+    sysTick.VAL = sysTickState.value;
+    sysTick.CTRL = (sysTick.CTRL & ~SysTick_CTRL_COUNTFLAG_Msk)
+            | (countFlag ? SysTick_CTRL_COUNTFLAG_Msk : 0);
+    countFlag = 0;                  // this access is the read that clears it
+}
+
+/******************************************************************************
+* eUSCI_A0 in UART mode                                                       *
+******************************************************************************/
+static SimUartSink uartSink = 0;
+static uint64_t txDoneAt = 0;           // end of the byte in the shifter, 0 idle
+static uint8_t txShift;
+static int16_t txBuffered = -1;
+static uint8_t rxQueue[RX_QUEUE_SIZE];
+static uint16_t rxHead = 0;
+static uint16_t rxTail = 0;
+static uint64_t rxDoneAt = 0;           // end of the byte on the line, 0 idle
+static uint32_t rxSequence = 0;
+static uint32_t rxSequenceAtEntry = 0;
+static uint32_t rxLost = 0;             // bytes that overlapped LPM3
+static uint64_t wokeAt = 0;             // end of the last LPM3
+static uint8_t baudReported = 0;
+
+#define RX_BIT_PS       (PS_PER_S / SIM_UART_BAUD)
+
+static uint64_t uartBitPs(void) {
+    uint64_t hz = (uart.CTLW0 & EUSCI_A_CTLW0_SSEL_MASK) == EUSCI_A_CTLW0_SSEL__ACLK
+            ? clocks[CLK_ACLK].hz : clocks[CLK_SMCLK].hz;
+    double bitClocks;
+
+    if (!hz || !uart.BRW) {
+        return 0;
+    }
+    // BRS modulation adds one clock to the bits it marks, eight bits a pattern
+    bitClocks = __builtin_popcount(uart.MCTLW >> EUSCI_A_MCTLW_BRS_OFS) / 8.0;
+    if (uart.MCTLW & EUSCI_A_MCTLW_OS16) {
+        bitClocks += 16.0 * uart.BRW
+                + ((uart.MCTLW & EUSCI_A_MCTLW_BRF_MASK) >> EUSCI_A_MCTLW_BRF_OFS);
+    } else {
+        bitClocks += uart.BRW;
+    }
+    return (uint64_t)(bitClocks * PS_PER_S / hz);
+}
+
+static void uartStartByte(uint8_t data, uint64_t start) {
+    uint64_t bitPs = uartBitPs();
+    double error;
+
+    if (!bitPs) {
+        simViolation("UART byte 0x%02X sent with its clock stopped", data);
+        bitPs = PS_PER_S / SIM_UART_BAUD;
+    }
+    error = (double)(PS_PER_S / SIM_UART_BAUD) / bitPs - 1.0;
+    if ((error > 0.02 || error < -0.02) && !baudReported) {
+        simViolation("UART at %.0f baud, %+.1f%% from %u", SIM_UART_BAUD * (1.0 + error),
+                     100 * error, SIM_UART_BAUD);
+        baudReported = 1;
+    }
+    txShift = data;
+    txDoneAt = start + 10 * bitPs;
+}
+
+static void uartUpdate(void) {
+    while (txDoneAt && txDoneAt <= now) {
+        uint64_t end = txDoneAt;
+
+        txDoneAt = 0;
+        if (uartSink) {
+            uartSink(txShift);
+        }
+        if (txBuffered >= 0) {
+            uartStartByte((uint8_t)txBuffered, end);
+            txBuffered = -1;
+            uart.IFG |= EUSCI_A_IFG_TXIFG;
+            linesDirty = 1;
+        }
+    }
+    while (rxDoneAt && rxDoneAt <= now) {
+        uint8_t data = rxQueue[rxTail];
+
+        rxTail = (rxTail + 1) & (RX_QUEUE_SIZE - 1);
+        if (sleeping || wokeAt >= rxDoneAt - 10 * RX_BIT_PS) {
+            rxLost++;       // SMCLK stopped for part of the byte
+        } else if (!(uart.CTLW0 & EUSCI_A_CTLW0_SWRST)) {
+            if (uart.IFG & EUSCI_A_IFG_RXIFG) {
+                uart.STATW |= EUSCI_A_STATW_OE;
+                simViolation("UART overrun, 0x%02X lost", (uint8_t)uart.RXBUF);
+            }
+            *(uint16_t *)&uart.RXBUF = data;
+            uart.IFG |= EUSCI_A_IFG_RXIFG;
+            rxSequence++;
+            linesDirty = 1;
+        }
+        rxDoneAt = rxHead != rxTail ? rxDoneAt + 10 * RX_BIT_PS : 0;
+    }
+}
+
+/* RX pin P1.2: idle high, low for the start bit of the byte on the line.
+ *  Data bits are not driven, so only the start bit edge reaches the port
+ *  (all a wake source needs). Call with the ports synced. */
+static void uartRxPin(void) {
+    uint8_t level = (rxDoneAt && now < rxDoneAt - 9 * RX_BIT_PS) ? 0 : BIT2;
+
+    if ((portLevel[1] & BIT2) != level) {
+        portLevel[1] = (portLevel[1] & ~BIT2) | level;
+        portInputs(1);
+    }
+}
+
+static uint64_t uartNext(void) {
+    uint64_t rxNext = SIM_NEVER;
+
+    if (rxDoneAt) {
+        rxNext = rxDoneAt - 9 * RX_BIT_PS > now ? rxDoneAt - 9 * RX_BIT_PS : rxDoneAt;
+    }
+    return earliest(txDoneAt ? txDoneAt : SIM_NEVER, rxNext);
+}
+
+static void uartWritten(SimDevice device, const void *before) {
+    const EUSCI_A_Type *old = before;
+
+    (void)device;
+    uartUpdate();
+    if ((uart.CTLW0 & EUSCI_A_CTLW0_SWRST) && !(old->CTLW0 & EUSCI_A_CTLW0_SWRST)) {
+        uart.IE = 0;
+        uart.IFG = EUSCI_A_IFG_TXIFG;
+        uart.STATW = 0;
+        txDoneAt = 0;
+        txBuffered = -1;
+    }
+    if (uart.BRW != old->BRW || uart.MCTLW != old->MCTLW || uart.CTLW0 != old->CTLW0) {
+        baudReported = 0;
+    }
+    if (uart.TXBUF != TXBUF_IDLE) {
+        uint8_t data = (uint8_t)uart.TXBUF;
+
+        uart.TXBUF = TXBUF_IDLE;
+        if (uart.CTLW0 & EUSCI_A_CTLW0_SWRST) {
+            simViolation("UART TXBUF written in reset");
+        } else if (!txDoneAt) {
+            uartStartByte(data, now);
+        } else {
+            if (txBuffered >= 0) {
+                simViolation("UART TXBUF overwritten, 0x%02X lost", (uint8_t)txBuffered);
+            }
+            txBuffered = data;
+            uart.IFG &= ~EUSCI_A_IFG_TXIFG;
+        }
+    }
+}
+
+static void uartPublish(SimDevice device) {
+    (void)device;
+    uartUpdate();
+    uart.STATW = (uart.STATW & ~EUSCI_A_STATW_BUSY)
+            | (txDoneAt || rxDoneAt ? EUSCI_A_STATW_BUSY : 0);
+    *(uint16_t *)&uart.IV = (uart.IFG & uart.IE & EUSCI_A_IFG_RXIFG) ? 2
+            : (uart.IFG & uart.IE & EUSCI_A_IFG_TXIFG) ? 4 : 0;
+}
+
+static uint64_t uartLines(void) {
+    return (uart.IFG & uart.IE & (EUSCI_A_IFG_RXIFG | EUSCI_A_IFG_TXIFG))
+            ? 1ULL << EUSCIA0_IRQn : 0;
+}
+
+void simUartSetSink(SimUartSink sink) {
+    uartSink = sink;
+}
+
+uint16_t simUartSend(const uint8_t *data, uint16_t length) {
+    uint16_t i;
+
+    for (i = 0; i < length; i++) {
+        if (((rxHead + 1) & (RX_QUEUE_SIZE - 1)) == rxTail) {
+            break;
+        }
+        rxQueue[rxHead] = data[i];
+        rxHead = (rxHead + 1) & (RX_QUEUE_SIZE - 1);
+    }
+    if (!rxDoneAt && rxHead != rxTail) {
+        rxDoneAt = now + 10 * RX_BIT_PS;
+        syncPorts();
+        uartRxPin();
+        touch((SimDevice)(SIM_DEV_PJ + 1));
+    }
+    invalidate();
+    return i;
+}
+
+uint32_t simUartLost(void) {
+    return rxLost;
+}
+
+/******************************************************************************
+* CS, PCM, SYSCTL_A: clock tree and core voltage                              *
+******************************************************************************/
+static uint64_t hfxtStableAt = SIM_NEVER;
+static uint64_t lfxtStableAt = SIM_NEVER;
+
+static uint32_t csFaults(void) {
+    uint32_t faults = 0;
+
+    if (now < lfxtStableAt) {
+        faults |= CS_IFG_LFXTIFG;
+    }
+    if (now < hfxtStableAt) {
+        faults |= CS_IFG_HFXTIFG;
+    }
+    return faults;
+}
+
+static uint64_t csSourceHz(uint32_t select) {
+    switch (select) {
+    case 0:             // LFXT, REFO stands in while it is faulty
+        return XT32_HZ;
+    case 1:
+        return VLO_HZ;
+    case 2:
+        return (cs.CLKEN & CS_CLKEN_REFOFSEL) ? 128000 : XT32_HZ;
+    case 3:
+        return (uint64_t)DCO_BASE_HZ
+                << ((cs.CTL0 & CS_CTL0_DCORSEL_MASK) >> CS_CTL0_DCORSEL_OFS);
+    case 4:
+        return MODOSC_HZ;
+    case 5:
+        return (csFaults() & CS_IFG_HFXTIFG) ? SYSOSC_HZ : HFXT_HZ;
+    default:
+        return MODOSC_HZ;
+    }
+}
+
+static void vcoreCheck(void) {
+    uint8_t vcore1 = (pcm.CTL0 & PCM_CTL0_AMR_MASK) & 1;
+    uint64_t cpuMax = vcore1 ? 48000000 : 24000000;
+    uint64_t peripheralMax = vcore1 ? 24000000 : 12000000;
+
+    if (mclkRunHz > cpuMax) {
+        simViolation("MCLK %lu Hz above the VCORE%u limit",
+                     (unsigned long)mclkRunHz, vcore1);
+    }
+    if (clocks[CLK_SMCLK].hz > peripheralMax) {
+        simViolation("SMCLK %lu Hz above the VCORE%u limit",
+                     (unsigned long)clocks[CLK_SMCLK].hz, vcore1);
+    }
+}
+
+static void csApply(void) {
+    uint32_t ctl1 = cs.CTL1;
+    uint64_t mclk = csSourceHz(ctl1 & CS_CTL1_SELM_MASK)
+            >> ((ctl1 & CS_CTL1_DIVM_MASK) >> CS_CTL1_DIVM_OFS);
+    uint64_t smclk = csSourceHz((ctl1 & CS_CTL1_SELS_MASK) >> CS_CTL1_SELS_OFS)
+            >> ((ctl1 & CS_CTL1_DIVS_MASK) >> CS_CTL1_DIVS_OFS);
+    uint64_t aclk = csSourceHz((ctl1 & CS_CTL1_SELA_MASK) >> CS_CTL1_SELA_OFS)
+            >> ((ctl1 & CS_CTL1_DIVA_MASK) >> CS_CTL1_DIVA_OFS);
+    uint64_t oldMclk = mclkRunHz;
+    uint64_t oldSmclk = clocks[CLK_SMCLK].hz;
+
+    mclkRunHz = mclk;
+    accessPs = cyclesToPs(SIM_ACCESS_CYCLES);
+    clockSet(CLK_MCLK, sleeping ? 0 : mclk);
+    clockSet(CLK_SMCLK, sleeping ? 0 : smclk);
+    clockSet(CLK_ACLK, aclk);
+    if (!sleeping && (mclk != oldMclk || smclk != oldSmclk)) {
+        vcoreCheck();
+    }
+    invalidate();
+}
+
+static void csWritten(SimDevice device, const void *before) {
+    const CS_Type *old = before;
+    uint32_t cleared;
+
+    (void)device;
+    if ((old->KEY & 0xFFFF) != CS_KEY_VAL && (cs.CTL0 != old->CTL0
+            || cs.CTL1 != old->CTL1 || cs.CTL2 != old->CTL2 || cs.CLKEN != old->CLKEN)) {
+        simViolation("CS written while locked");
+        cs.CTL0 = old->CTL0;
+        cs.CTL1 = old->CTL1;
+        cs.CTL2 = old->CTL2;
+        cs.CLKEN = old->CLKEN;
+    }
+    if ((cs.CTL2 & CS_CTL2_HFXT_EN) && !(old->CTL2 & CS_CTL2_HFXT_EN)) {
+        hfxtStableAt = now + HFXT_START_US * SIM_PS_PER_US;
+    } else if (!(cs.CTL2 & CS_CTL2_HFXT_EN)) {
+        hfxtStableAt = SIM_NEVER;
+    }
+    if ((cs.CTL2 & CS_CTL2_LFXT_EN) && !(old->CTL2 & CS_CTL2_LFXT_EN)) {
+        lfxtStableAt = now + LFXT_START_US * SIM_PS_PER_US;
+    } else if (!(cs.CTL2 & CS_CTL2_LFXT_EN)) {
+        lfxtStableAt = SIM_NEVER;
+    }
+    cleared = cs.CLRIFG;
+    *(uint32_t *)&cs.IFG = (cs.IFG & ~cleared) | csFaults();
+    cs.CLRIFG = 0;
+    csApply();
+}
+
+static void csPublish(SimDevice device) {
+    (void)device;
+    *(uint32_t *)&cs.IFG |= csFaults();
+}
+
+static void pcmWritten(SimDevice device, const void *before) {
+    const PCM_Type *old = before;
+    uint32_t amr;
+
+    (void)device;
+    if (pcm.CTL0 != old->CTL0) {
+        if ((pcm.CTL0 & PCM_CTL0_KEY_MASK) != PCM_CTL0_KEY_VAL) {
+            simViolation("PCM CTL0 written without the key");
+            pcm.CTL0 = old->CTL0;
+        } else {
+            amr = pcm.CTL0 & PCM_CTL0_AMR_MASK;
+            pcm.CTL0 = 0xA5960000 | (amr << PCM_CTL0_CPM_OFS)
+                    | (pcm.CTL0 & PCM_CTL0_LPMR_MASK) | amr;
+            if (amr != (old->CTL0 & PCM_CTL0_AMR_MASK)) {
+                vcoreCheck();
+            }
+        }
+    }
+    pcm.CTL1 &= ~PCM_CTL1_PMR_BUSY;     // transitions complete at once
+}
+
+static void sysctlPublish(SimDevice device) {
+    (void)device;
+    sysctl.NMI_CTLSTAT = (sysctl.NMI_CTLSTAT & ~SYSCTL_A_NMI_CTLSTAT_CS_FLG)
+            | ((cs.IFG | csFaults()) & (CS_IFG_LFXTIFG | CS_IFG_HFXTIFG)
+               ? SYSCTL_A_NMI_CTLSTAT_CS_FLG : 0);
+}
+
+static void wdtWritten(SimDevice device, const void *before) {
+    const WDT_A_Type *old = before;
+
+    (void)device;
+    if ((wdt.CTL & 0xFF00) != WDT_A_CTL_PW) {
+        simViolation("WDT_A written without the password, the part would reset");
+        wdt.CTL = old->CTL;
+    }
+    wdt.CTL = 0x6900 | (wdt.CTL & 0xFF);
+}
+
+uint32_t simClockHz(uint8_t smclk) {
+    return (uint32_t)clocks[smclk ? CLK_SMCLK : CLK_MCLK].hz;
+}
+
+/******************************************************************************
+* RTC_C, calendar mode in binary, 1Hz ready interrupt                         *
+******************************************************************************/
+static uint64_t rtcOrigin = 0;          // RTC tick of the last second boundary
+static uint8_t rtcRunning = 0;
+static uint8_t rtcLocked = 1;
+
+static void rtcAddSecond(void) {
+    uint16_t sec = rtc.TIM0 & 0xFF;
+    uint16_t min = rtc.TIM0 >> 8;
+    uint16_t hour = rtc.TIM1 & 0xFF;
+
+    if (++sec == 60) {
+        sec = 0;
+        if (++min == 60) {
+            min = 0;
+            hour = (hour + 1) % 24;
+        }
+    }
+    rtc.TIM0 = (min << 8) | sec;
+    rtc.TIM1 = (rtc.TIM1 & 0xFF00) | hour;
+}
+
+static void rtcUpdate(void) {
+    uint64_t ticks;
+
+    if (!rtcRunning) {
+        return;
+    }
+    ticks = clockTicks(CLK_RTC);
+    while (ticks - rtcOrigin >= XT32_HZ) {
+        rtcOrigin += XT32_HZ;
+        rtcAddSecond();
+        rtc.CTL0 |= RTC_C_CTL0_RDYIFG;
+        linesDirty = 1;
+    }
+}
+
+static uint64_t rtcNext(void) {
+    if (!rtcRunning || (rtc.CTL0 & RTC_C_CTL0_RDYIFG)) {
+        return SIM_NEVER;
+    }
+    return clockTime(CLK_RTC, rtcOrigin + XT32_HZ);
+}
+
+static void rtcWritten(SimDevice device, const void *before) {
+    const RTC_C_Type *old = before;
+    uint16_t ps;
+
+    (void)device;
+    rtcUpdate();
+    ps = rtcRunning ? (uint16_t)(clockTicks(CLK_RTC) - rtcOrigin) : old->PS;
+    if (rtc.CTL0 != old->CTL0) {
+        uint8_t key = rtc.CTL0 >> RTC_C_CTL0_KEY_OFS;
+
+        if (key != (RTC_C_KEY >> RTC_C_CTL0_KEY_OFS) && rtcLocked) {
+            rtc.CTL0 = (rtc.CTL0 & 0xFF) | (old->CTL0 & ~0xFF);
+        }
+        rtcLocked = key != (RTC_C_KEY >> RTC_C_CTL0_KEY_OFS);
+        rtc.CTL0 = 0x9600 | (rtc.CTL0 & 0xFF);
+    }
+    if (rtcLocked && !(rtc.CTL0 != old->CTL0) && (rtc.CTL13 != old->CTL13
+            || rtc.TIM0 != old->TIM0 || rtc.TIM1 != old->TIM1 || rtc.PS != old->PS)) {
+        simViolation("RTC_C written while locked");
+        rtc.CTL13 = old->CTL13;
+        rtc.TIM0 = old->TIM0;
+        rtc.TIM1 = old->TIM1;
+        rtc.PS = old->PS;
+    }
+    if (rtc.PS != old->PS) {
+        ps = rtc.PS & (XT32_HZ - 1);
+    }
+    rtc.CTL13 |= RTC_C_CTL13_RDY;
+    rtcRunning = !(rtc.CTL13 & RTC_C_CTL13_HOLD);
+    rtcOrigin = clockTicks(CLK_RTC) - ps;
+    rtc.PS = ps;
+}
+
+static void rtcPublish(SimDevice device) {
+    uint16_t flags;
+
+    (void)device;
+    rtcUpdate();
+    if (rtcRunning) {
+        rtc.PS = (uint16_t)(clockTicks(CLK_RTC) - rtcOrigin);
+    }
+    flags = rtc.CTL0 & (rtc.CTL0 >> 4) & 0x0F;
+    *(uint16_t *)&rtc.IV = (flags & RTC_C_CTL0_OFIFG) ? RTC_C_IV_RTCOFIFG
+            : (flags & RTC_C_CTL0_RDYIFG) ? RTC_C_IV_RTCRDYIFG
+            : (flags & RTC_C_CTL0_TEVIFG) ? RTC_C_IV_RTCTEVIFG
+            : (flags & RTC_C_CTL0_AIFG) ? RTC_C_IV_RTCAIFG : RTC_C_IV_NONE;
+}
+
+static uint64_t rtcLines(void) {
+    return (rtc.CTL0 & (rtc.CTL0 >> 4) & 0x0F) ? 1ULL << RTC_C_IRQn : 0;
+}
+
+/******************************************************************************
+* FLCTL_A and the information flash                                           *
+******************************************************************************/
+static uint8_t *const flash = (uint8_t *)SIM_INFO_FLASH_START;
+static uint8_t flashAccepted[SIM_INFO_FLASH_SIZE];
+static uint8_t flashProgrammed[SIM_INFO_FLASH_SIZE / 4];   // word since erase
+static volatile sig_atomic_t flashDirty = 0;                // page bit mask
+static long pageSize = 4096;
+static uint64_t programDoneAt = 0;
+static uint64_t eraseDoneAt = 0;
+static uint32_t eraseOffset = 0;
+static uint32_t flashErases = 0;
+static uint32_t flashPrograms = 0;
+
+static void flashFault(int signal, siginfo_t *info, void *context) {
+    uintptr_t address = (uintptr_t)info->si_addr;
+    uintptr_t page = (address - SIM_INFO_FLASH_START) / pageSize;
+
+    (void)context;
+    if (address < SIM_INFO_FLASH_START
+            || address >= SIM_INFO_FLASH_START + SIM_INFO_FLASH_SIZE
+            || mprotect(flash + page * pageSize, pageSize, PROT_READ | PROT_WRITE)) {
+        // not a flash store, let the access fault again fatally
+        sigaction(signal, &(struct sigaction){ .sa_handler = SIG_DFL }, 0);
+        return;
+    }
+    flashDirty |= 1 << page;
+}
+
+static void flashProtect(uint8_t writable) {
+    mprotect(flash, SIM_INFO_FLASH_SIZE, writable ? PROT_READ | PROT_WRITE : PROT_READ);
+}
+
+static uint8_t flashSectorProtected(uint32_t offset) {
+    uint32_t bank1 = SIM_INFO_FLASH_SIZE / 2;
+
+    if (offset >= bank1) {
+        return (flctl.BANK1_INFO_WEPROT >> ((offset - bank1) / SIM_FLASH_SECTOR_SIZE)) & 1;
+    }
+    return (flctl.BANK0_INFO_WEPROT >> (offset / SIM_FLASH_SECTOR_SIZE)) & 1;
+}
+
+// Checks the words the firmware stored since the last access
+static void flashSync(void) {
+    uint32_t offset, end, old, word;
+    uint32_t lines = 0;
+    uint32_t lastLine = UINT32_MAX;
+    long page;
+
+    if (!flashDirty) {
+        return;
+    }
+    for (page = 0; page < SIM_INFO_FLASH_SIZE / pageSize; page++) {
+        if (!(flashDirty & (1 << page))) {
+            continue;
+        }
+        end = (page + 1) * pageSize;
+        for (offset = page * pageSize; offset < end; offset += 4) {
+            memcpy(&old, flashAccepted + offset, 4);
+            memcpy(&word, flash + offset, 4);
+            if (word == old) {
+                continue;
+            }
+            if (!(flctl.PRG_CTLSTAT & FLCTL_A_PRG_CTLSTAT_ENABLE)) {
+                simViolation("flash 0x%06X written outside program mode",
+                             SIM_INFO_FLASH_START + offset);
+                word = old;
+            } else if (flashSectorProtected(offset)) {
+                simViolation("flash 0x%06X written in a protected sector",
+                             SIM_INFO_FLASH_START + offset);
+                word = old;
+            } else if (eraseDoneAt && offset / SIM_FLASH_SECTOR_SIZE
+                       == eraseOffset / SIM_FLASH_SECTOR_SIZE) {
+                simViolation("flash 0x%06X written during its erase",
+                             SIM_INFO_FLASH_START + offset);
+                word = old;
+            } else {
+                if (word & ~old) {
+                    simViolation("flash 0x%06X programmed 0x%08X over 0x%08X, "
+                                 "bits cannot go back to 1", SIM_INFO_FLASH_START + offset,
+                                 word, old);
+                    word &= old;
+                }
+                if (flashProgrammed[offset / 4]) {
+                    simViolation("flash 0x%06X programmed twice since its erase",
+                                 SIM_INFO_FLASH_START + offset);
+                }
+                flashProgrammed[offset / 4] = 1;
+                flashPrograms++;
+                if (offset / 16 != lastLine) {
+                    lastLine = offset / 16;     // one 128-bit flash word
+                    lines++;
+                }
+            }
+            memcpy(flash + offset, &word, 4);
+            memcpy(flashAccepted + offset, &word, 4);
+        }
+        mprotect(flash + page * pageSize, pageSize, PROT_READ);
+    }
+    flashDirty = 0;
+    if (lines) {
+        // back to back with any words still being programmed
+        programDoneAt = (programDoneAt > now ? programDoneAt : now)
+                + lines * FLASH_PROGRAM_US * SIM_PS_PER_US;
+        flctl.PRG_CTLSTAT = (flctl.PRG_CTLSTAT & ~FLCTL_A_PRG_CTLSTAT_STATUS_MASK)
+                | FLCTL_A_PRG_CTLSTAT_STATUS_1;
+        touch(SIM_DEV_FLCTL_A);
+        invalidate();
+    }
+}
+
+static void flashUpdate(void) {
+    if (programDoneAt && programDoneAt <= now) {
+        programDoneAt = 0;
+        flctl.PRG_CTLSTAT &= ~FLCTL_A_PRG_CTLSTAT_STATUS_MASK;
+    }
+    if (eraseDoneAt && eraseDoneAt <= now) {
+        eraseDoneAt = 0;
+        flashProtect(1);
+        memset(flash + eraseOffset, 0xFF, SIM_FLASH_SECTOR_SIZE);
+        flashProtect(0);
+        memset(flashAccepted + eraseOffset, 0xFF, SIM_FLASH_SECTOR_SIZE);
+        memset(flashProgrammed + eraseOffset / 4, 0, SIM_FLASH_SECTOR_SIZE / 4);
+        flashErases++;
+        flctl.ERASE_CTLSTAT = (flctl.ERASE_CTLSTAT & ~FLCTL_A_ERASE_CTLSTAT_STATUS_MASK)
+                | FLCTL_A_ERASE_CTLSTAT_STATUS_3;
+    }
+}
+
+static uint64_t flashNext(void) {
+    return earliest(programDoneAt ? programDoneAt : SIM_NEVER,
+                    eraseDoneAt ? eraseDoneAt : SIM_NEVER);
+}
+
+static void flctlWritten(SimDevice device, const void *before) {
+    const FLCTL_A_Type *old = before;
+    uint32_t status;
+
+    (void)device;
+    flashUpdate();
+    // status fields are read-only, keep the model's
+    flctl.PRG_CTLSTAT = (flctl.PRG_CTLSTAT & ~FLCTL_A_PRG_CTLSTAT_STATUS_MASK)
+            | (old->PRG_CTLSTAT & FLCTL_A_PRG_CTLSTAT_STATUS_MASK);
+    status = old->ERASE_CTLSTAT & (FLCTL_A_ERASE_CTLSTAT_STATUS_MASK
+                                   | FLCTL_A_ERASE_CTLSTAT_ADDR_ERR);
+    if (flctl.ERASE_CTLSTAT & FLCTL_A_ERASE_CTLSTAT_CLR_STAT) {
+        status = 0;
+    }
+    if (flctl.ERASE_CTLSTAT & FLCTL_A_ERASE_CTLSTAT_START) {
+        uint32_t offset = flctl.ERASE_SECTADDR & (SIM_INFO_FLASH_SIZE - 1)
+                & ~(SIM_FLASH_SECTOR_SIZE - 1);
+
+        if ((flctl.ERASE_CTLSTAT & FLCTL_A_ERASE_CTLSTAT_TYPE_MASK)
+                != FLCTL_A_ERASE_CTLSTAT_TYPE_1
+                || (flctl.ERASE_CTLSTAT & FLCTL_A_ERASE_CTLSTAT_MODE)) {
+            simViolation("only INFO sector erase is modeled");
+            status = FLCTL_A_ERASE_CTLSTAT_STATUS_3 | FLCTL_A_ERASE_CTLSTAT_ADDR_ERR;
+        } else if (eraseDoneAt) {
+            simViolation("flash erase started while one is running");
+        } else if (flashSectorProtected(offset)) {
+            simViolation("flash erase of protected sector 0x%06X",
+                         SIM_INFO_FLASH_START + offset);
+            status = FLCTL_A_ERASE_CTLSTAT_STATUS_3;
+        } else {
+            eraseOffset = offset;
+            eraseDoneAt = now + FLASH_ERASE_US * SIM_PS_PER_US;
+            status = FLCTL_A_ERASE_CTLSTAT_STATUS_2;
+        }
+    }
+    flctl.ERASE_CTLSTAT = (flctl.ERASE_CTLSTAT & ~(FLCTL_A_ERASE_CTLSTAT_START
+            | FLCTL_A_ERASE_CTLSTAT_CLR_STAT | FLCTL_A_ERASE_CTLSTAT_STATUS_MASK
+            | FLCTL_A_ERASE_CTLSTAT_ADDR_ERR)) | status;
+}
+
+uint8_t *simFlashImage(void) {
+    return flash;
+}
+
+void simFlashCounts(uint32_t *erases, uint32_t *programs) {
+    if (erases) {
+        *erases = flashErases;
+    }
+    if (programs) {
+        *programs = flashPrograms;
+    }
+}
+
+uint8_t simFlashLoad(const char *path) {
+    FILE *file = fopen(path, "rb");
+    size_t length;
+
+    if (!file) {
+        return 0;
+    }
+    flashProtect(1);
+    length = fread(flash, 1, SIM_INFO_FLASH_SIZE, file);
+    flashProtect(0);
+    fclose(file);
+    memcpy(flashAccepted, flash, SIM_INFO_FLASH_SIZE);
+    return length == SIM_INFO_FLASH_SIZE;
+}
+
+uint8_t simFlashSave(const char *path) {
+    FILE *file = fopen(path, "wb");
+    size_t length;
+
+    if (!file) {
+        return 0;
+    }
+    length = fwrite(flash, 1, SIM_INFO_FLASH_SIZE, file);
+    fclose(file);
+    return length == SIM_INFO_FLASH_SIZE;
+}
+
+/******************************************************************************
+* DMA, one item per request, basic and ping-pong modes                        *
+******************************************************************************/
+static uint32_t dmaEnabled = 0;
+static uint32_t dmaAlternate = 0;
+static uint32_t dmaUseBurst = 0;
+static uint32_t dmaRequestMask = 0;
+static uint32_t dmaPriority = 0;
+
+static uint32_t dmaRead(const volatile void *address, uint32_t size) {
+    uint32_t value = 0;
+
+    memcpy(&value, (const void *)address, size);
+    if ((const uint8_t *)address >= (const uint8_t *)adc.MEM
+            && (const uint8_t *)address < (const uint8_t *)(adc.MEM + 32)) {
+        // reading a conversion result clears its flag
+        *(uint32_t *)&adc.IFGR0 &= ~(1u << ((const uint32_t *)address - adc.MEM));
+    }
+    return value;
+}
+
+static void dmaDone(uint8_t channel) {
+    if ((dmaChannel.INT1_SRCCFG & DMA_INT1_SRCCFG_EN)
+            && (dmaChannel.INT1_SRCCFG & DMA_INT1_SRCCFG_INT_SRC_MASK) == channel) {
+        pend(DMA_INT1_IRQn);
+    } else if ((dmaChannel.INT2_SRCCFG & DMA_INT2_SRCCFG_EN)
+            && (dmaChannel.INT2_SRCCFG & DMA_INT2_SRCCFG_INT_SRC_MASK) == channel) {
+        pend(DMA_INT2_IRQn);
+    } else if ((dmaChannel.INT3_SRCCFG & DMA_INT3_SRCCFG_EN)
+            && (dmaChannel.INT3_SRCCFG & DMA_INT3_SRCCFG_INT_SRC_MASK) == channel) {
+        pend(DMA_INT3_IRQn);
+    } else {
+        *(uint32_t *)&dmaChannel.INT0_SRCFLG |= 1u << channel;
+        linesDirty = 1;
+    }
+}
+
+static void dmaTrigger(uint8_t channel, uint8_t source) {
+    uint32_t bit = 1u << channel;
+    DmaControl *table = (DmaControl *)(uintptr_t)dmaControl.CTLBASE;
+    DmaControl *entry;
+    uint32_t control, n, srcSize, dstSize, srcInc, dstInc, value;
+
+    if (!(dmaControl.CFG & DMA_CFG_MASTEN) || !(dmaEnabled & bit)
+            || (dmaRequestMask & bit) || dmaChannel.CH_SRCCFG[channel] != source) {
+        return;
+    }
+    if (!table) {
+        simViolation("DMA request with no control table");
+        return;
+    }
+    entry = &table[channel + ((dmaAlternate & bit) ? DMA_CHANNEL_COUNT : 0)];
+    control = entry->control;
+    if ((control & DMA_CTL_MODE_MASK) == DMA_CTL_MODE_STOP) {
+        dmaEnabled &= ~bit;         // the other half was not re-armed in time
+        return;
+    }
+    n = (control & DMA_CTL_N_MASK) >> DMA_CTL_N_OFS;
+    srcSize = 1u << ((control >> 24) & 3);
+    dstSize = 1u << ((control >> 28) & 3);
+    srcInc = ((control >> 26) & 3) == 3 ? 0 : 1u << ((control >> 26) & 3);
+    dstInc = ((control >> 30) & 3) == 3 ? 0 : 1u << ((control >> 30) & 3);
+    value = dmaRead((const volatile uint8_t *)entry->srcEnd - n * srcInc, srcSize);
+    memcpy((void *)((volatile uint8_t *)entry->dstEnd - n * dstInc), &value, dstSize);
+
+    if (n) {
+        entry->control = (control & ~DMA_CTL_N_MASK) | ((n - 1) << DMA_CTL_N_OFS);
+        return;
+    }
+    entry->control = control & ~DMA_CTL_MODE_MASK;
+    if ((control & DMA_CTL_MODE_MASK) == DMA_CTL_MODE_PINGPONG) {
+        dmaAlternate ^= bit;
+    } else {
+        dmaEnabled &= ~bit;
+    }
+    dmaDone(channel);
+}
+
+static void dmaControlWritten(SimDevice device, const void *before) {
+    (void)device;
+    (void)before;
+    dmaEnabled = (dmaEnabled | dmaControl.ENASET) & ~dmaControl.ENACLR;
+    dmaAlternate = (dmaAlternate | dmaControl.ALTSET) & ~dmaControl.ALTCLR;
+    dmaUseBurst = (dmaUseBurst | dmaControl.USEBURSTSET) & ~dmaControl.USEBURSTCLR;
+    dmaRequestMask = (dmaRequestMask | dmaControl.REQMASKSET) & ~dmaControl.REQMASKCLR;
+    dmaPriority = (dmaPriority | dmaControl.PRIOSET) & ~dmaControl.PRIOCLR;
+    dmaControl.ENACLR = dmaControl.ALTCLR = dmaControl.USEBURSTCLR = 0;
+    dmaControl.REQMASKCLR = dmaControl.PRIOCLR = dmaControl.ERRCLR = 0;
+    dmaControl.ENASET = dmaEnabled;
+    dmaControl.ALTSET = dmaAlternate;
+    dmaControl.USEBURSTSET = dmaUseBurst;
+    dmaControl.REQMASKSET = dmaRequestMask;
+    dmaControl.PRIOSET = dmaPriority;
+    *(uint32_t *)&dmaControl.STAT = dmaControl.CFG & DMA_CFG_MASTEN;
+}
+
+static void dmaControlPublish(SimDevice device) {
+    (void)device;
+    dmaControl.ENASET = dmaEnabled;
+    dmaControl.ALTSET = dmaAlternate;
+}
+
+static void dmaChannelWritten(SimDevice device, const void *before) {
+    (void)device;
+    (void)before;
+    *(uint32_t *)&dmaChannel.INT0_SRCFLG &= ~dmaChannel.INT0_CLRFLG;
+    dmaChannel.INT0_CLRFLG = 0;
+}
+
+static uint64_t dmaLines(void) {
+    return dmaChannel.INT0_SRCFLG ? 1ULL << DMA_INT0_IRQn : 0;
+}
+
+/******************************************************************************
+* ADC14, conversions on the Timer_A0 trigger, microphone on A0                *
+******************************************************************************/
+static uint32_t micHz = 0;
+static uint16_t micAmplitude = 0;
+
+static uint16_t micSample(void) {
+    double seconds = (double)now / PS_PER_S;
+    double value = 8192.0 + micAmplitude * sin(2.0 * M_PI * micHz * seconds);
+
+    if (value < 0) {
+        return 0;
+    }
+    return value > 16383 ? 16383 : (uint16_t)value;
+}
+
+static void adcTrigger(void) {
+    uint32_t start;
+
+    if ((adc.CTL0 & (ADC14_CTL0_ON | ADC14_CTL0_ENC)) != (ADC14_CTL0_ON | ADC14_CTL0_ENC)
+            || (adc.CTL0 & ADC14_CTL0_SHS_MASK) != ADC14_CTL0_SHS_1) {
+        return;
+    }
+    start = (adc.CTL1 >> 16) & 0x1F;
+    *(uint32_t *)&adc.MEM[start] = micSample();
+    *(uint32_t *)&adc.IFGR0 |= 1u << start;
+    linesDirty = 1;
+    dmaTrigger(DMA_CH_ADC, DMA_SRC_ADC);
+}
+
+static void adcWritten(SimDevice device, const void *before) {
+    (void)device;
+    (void)before;
+    *(uint32_t *)&adc.IFGR0 &= ~adc.CLRIFGR0;
+    adc.CLRIFGR0 = 0;
+}
+
+static uint64_t adcLines(void) {
+    return (adc.IFGR0 & adc.IER0) ? 1ULL << ADC14_IRQn : 0;
+}
+
+void simMicTone(uint32_t hz, uint16_t amplitude) {
+    micHz = hz;
+    micAmplitude = amplitude;
+}
+
+/******************************************************************************
+* NVIC, SCB, DWT                                                              *
+******************************************************************************/
+static uint64_t cycleBase = 0;
+static uint32_t cycleFrozen = 0;
+
+static uint8_t cyclesCounting(const DWT_Type *d, const CoreDebug_Type *c) {
+    return (c->DEMCR & CoreDebug_DEMCR_TRCENA_Msk) && (d->CTRL & DWT_CTRL_CYCCNTENA_Msk);
+}
+
+static uint32_t cycleCount(const DWT_Type *d, const CoreDebug_Type *c) {
+    return cyclesCounting(d, c) ? (uint32_t)(clockTicks(CLK_MCLK) - cycleBase)
+            : cycleFrozen;
+}
+
+static void debugWritten(SimDevice device, const void *before) {
+    const DWT_Type *oldDwt = device == SIM_DEV_DWT ? before : (const void *)&dwt;
+    const CoreDebug_Type *oldDebug = device == SIM_DEV_COREDEBUG
+            ? before : (const void *)&coreDebug;
+
+    cycleFrozen = cycleCount(oldDwt, oldDebug);
+    if (device == SIM_DEV_DWT && dwt.CYCCNT != oldDwt->CYCCNT) {
+        cycleFrozen = dwt.CYCCNT;
+    }
+    cycleBase = clockTicks(CLK_MCLK) - cycleFrozen;
+}
+
+static void dwtPublish(SimDevice device) {
+    (void)device;
+    dwt.CYCCNT = cycleCount(&dwt, &coreDebug);
+}
+
+static void nvicWritten(SimDevice device, const void *before) {
+    uint8_t i;
+
+    (void)device;
+    (void)before;
+    for (i = 0; i < 2; i++) {
+        irqEnabled |= (uint64_t)nvic.ISER[i] << (32 * i);
+        irqEnabled &= ~((uint64_t)nvic.ICER[i] << (32 * i));
+        irqPending |= (uint64_t)nvic.ISPR[i] << (32 * i);
+        irqPending &= ~((uint64_t)nvic.ICPR[i] << (32 * i));
+        nvic.ICER[i] = nvic.ISPR[i] = nvic.ICPR[i] = 0;
+    }
+    irqEnabled |= 1ULL << IRQ_SYSTICK;
+    nvic.ISER[0] = (uint32_t)irqEnabled;
+    nvic.ISER[1] = (uint32_t)(irqEnabled >> 32) & ~(1u << (IRQ_SYSTICK - 32));
+}
+
+/******************************************************************************
+* Device table                                                                *
+******************************************************************************/
+#define DEVICE(id, block, shadowBlock, writtenFn, publishFn) \
+    devices[id] = (DeviceInfo){ &(block), &(shadowBlock), sizeof(block), \
+                                (writtenFn), (publishFn) }
+
+static void deviceTable(void) {
+    int p;
+
+    for (p = 0; p < SIM_PORT_COUNT; p++) {
+        DEVICE(SIM_DEV_PJ + p, port[p], portShadow[p], portWritten, 0);
+    }
+    for (p = 0; p < 4; p++) {
+        DEVICE(SIM_DEV_TIMER_A0 + p, timerA[p], timerAShadow[p], taWritten, taPublish);
+    }
+    DEVICE(SIM_DEV_TIMER32_1, timer32[0], timer32Shadow[0], t32Written, t32Publish);
+    DEVICE(SIM_DEV_TIMER32_2, timer32[1], timer32Shadow[1], t32Written, t32Publish);
+    DEVICE(SIM_DEV_EUSCI_A0, uart, uartShadow, uartWritten, uartPublish);
+    DEVICE(SIM_DEV_CS, cs, csShadow, csWritten, csPublish);
+    DEVICE(SIM_DEV_PCM, pcm, pcmShadow, pcmWritten, 0);
+    DEVICE(SIM_DEV_FLCTL_A, flctl, flctlShadow, flctlWritten, 0);
+    DEVICE(SIM_DEV_RTC_C, rtc, rtcShadow, rtcWritten, rtcPublish);
+    DEVICE(SIM_DEV_DMA_CHANNEL, dmaChannel, dmaChannelShadow, dmaChannelWritten, 0);
+    DEVICE(SIM_DEV_DMA_CONTROL, dmaControl, dmaControlShadow, dmaControlWritten,
+           dmaControlPublish);
+    DEVICE(SIM_DEV_ADC14, adc, adcShadow, adcWritten, 0);
+    DEVICE(SIM_DEV_WDT_A, wdt, wdtShadow, wdtWritten, 0);
+    DEVICE(SIM_DEV_SYSCTL_A, sysctl, sysctlShadow, 0, sysctlPublish);
+    DEVICE(SIM_DEV_SYSTICK, sysTick, sysTickShadow, sysTickWritten, sysTickPublish);
+    DEVICE(SIM_DEV_SCB, scb, scbShadow, 0, 0);
+    DEVICE(SIM_DEV_NVIC, nvic, nvicShadow, nvicWritten, 0);
+    DEVICE(SIM_DEV_DWT, dwt, dwtShadow, debugWritten, dwtPublish);
+    DEVICE(SIM_DEV_COREDEBUG, coreDebug, coreDebugShadow, debugWritten, 0);
+}
+
+static void syncDevice(SimDevice device) {
+    DeviceInfo *info = &devices[device];
+    AnyBlock before;
+
+    if (!memcmp(info->regs, info->shadow, info->size)) {
+        return;
+    }
+    memcpy(&before, info->shadow, info->size);
+    if (info->written) {
+        info->written(device, &before);
+    }
+    touch(device);
+    invalidate();
+}
+
+static void syncWrites(void) {
+    if (lastDevice != SIM_DEV_NONE) {
+        syncDevice(lastDevice);
+    }
+    syncPorts();
+    flashSync();
+}
+
+/******************************************************************************
+* Events                                                                      *
+******************************************************************************/
+static uint64_t scheduleNext(void) {
+    return scheduleCount ? schedule[0].ps : SIM_NEVER;
+}
+
+static void runSchedule(void) {
+    ScheduledCall call;
+
+    while (scheduleCount && schedule[0].ps <= now) {
+        call = schedule[0];
+        scheduleCount--;
+        memmove(&schedule[0], &schedule[1], scheduleCount * sizeof(ScheduledCall));
+        call.callback(call.arg);
+        invalidate();
+    }
+}
+
+uint8_t simSchedule(uint64_t ps, SimCallback callback, void *arg) {
+    uint16_t i;
+
+    if (scheduleCount == SCHEDULE_SIZE) {
+        return 0;
+    }
+    for (i = scheduleCount; i > 0 && schedule[i - 1].ps > ps; i--) {
+        schedule[i] = schedule[i - 1];
+    }
+    schedule[i] = (ScheduledCall){ ps, callback, arg };
+    scheduleCount++;
+    eventsDirty = 1;
+    return 1;
+}
+
+static uint64_t nextEvent(void) {
+    if (eventsDirty) {
+        nextEventPs = earliest(t32Next(), taNext());
+        nextEventPs = earliest(nextEventPs, sysTickNext());
+        nextEventPs = earliest(nextEventPs, uartNext());
+        nextEventPs = earliest(nextEventPs, rtcNext());
+        nextEventPs = earliest(nextEventPs, flashNext());
+        nextEventPs = earliest(nextEventPs, scheduleNext());
+        eventsDirty = 0;
+    }
+    return nextEventPs;
+}
+
+static void advanceTo(uint64_t target) {
+    uint64_t next;
+
+    while ((next = nextEvent()) <= target) {
+        if (next > now) {
+            now = next;
+        }
+        t32Update();
+        taUpdate();
+        sysTickUpdate();
+        uartUpdate();
+        rtcUpdate();
+        flashUpdate();
+        syncPorts();        // DMA writes to port outputs, before the models'
+        uartRxPin();        //  own register updates are taken as the baseline
+        touchAll();
+        runSchedule();
+        invalidate();
+    }
+    if (target > now) {
+        now = target;
+    }
+}
+
+/******************************************************************************
+* Interrupt delivery                                                          *
+******************************************************************************/
+static uint32_t irqPriority(int irq) {
+    if (irq == IRQ_SYSTICK) {
+        return scb.SHP[11] >> (8 - __NVIC_PRIO_BITS);
+    }
+    return nvic.IP[irq] >> (8 - __NVIC_PRIO_BITS);
+}
+
+static void irqEntered(int irq) {
+    if (irq == EUSCIA0_IRQn) {
+        rxSequenceAtEntry = rxSequence;
+    }
+}
+
+// Flags a handler clears by reading a register the model cannot watch
+static void irqReturned(int irq) {
+    if (irq == EUSCIA0_IRQn && rxSequence == rxSequenceAtEntry) {
+        uart.IFG &= ~EUSCI_A_IFG_RXIFG;     // the handler read RXBUF
+        touch(SIM_DEV_EUSCI_A0);
+    }
+    if (irq == RTC_C_IRQn) {
+        uint16_t flags = rtc.CTL0 & (rtc.CTL0 >> 4) & 0x0F;
+        uint16_t highest = (flags & RTC_C_CTL0_OFIFG) ? RTC_C_CTL0_OFIFG
+                : (flags & RTC_C_CTL0_RDYIFG) ? RTC_C_CTL0_RDYIFG
+                : flags & -flags;
+
+        rtc.CTL0 &= ~highest;               // the handler read RTCIV
+        touch(SIM_DEV_RTC_C);
+    }
+}
+
+static uint64_t irqLines(void) {
+    return portLines() | t32Lines() | taLines() | uartLines() | rtcLines()
+            | dmaLines() | adcLines();
+}
+
+static int irqNext(void) {
+    uint64_t ready;
+    uint32_t best = executionPriority;
+    int chosen = -1;
+    int irq;
+
+    if (linesDirty) {
+        irqPending |= irqLines();
+        linesDirty = 0;
+    }
+    if (primask) {
+        return -1;
+    }
+    ready = irqPending & irqEnabled;
+    while (ready) {
+        irq = __builtin_ctzll(ready);
+        ready &= ready - 1;
+        if (irqPriority(irq) < best) {
+            best = irqPriority(irq);
+            chosen = irq;
+        }
+    }
+    return chosen;
+}
+
+static void dispatch(void) {
+    uint32_t saved;
+    int irq;
+
+    while ((irq = irqNext()) >= 0) {
+        if (!vectors[irq]) {
+            fprintf(stderr, "%12.3f ms  interrupt %d has no handler\n", simNowMs(), irq);
+            exit(2);
+        }
+        irqPending &= ~(1ULL << irq);
+        saved = executionPriority;
+        executionPriority = irqPriority(irq);
+        irqCounts[irq]++;
+        advanceTo(now + cyclesToPs(SIM_IRQ_CYCLES));
+        irqEntered(irq);
+        vectors[irq]();
+        syncWrites();
+        advanceTo(now + cyclesToPs(SIM_IRQ_CYCLES));
+        irqReturned(irq);
+        executionPriority = saved;
+        invalidate();
+    }
+}
+
+/******************************************************************************
+* Firmware interface                                                          *
+******************************************************************************/
+void *simAccess(SimDevice device) {
+    accessCount++;
+    syncWrites();
+    advanceTo(now + accessPs);
+    dispatch();
+    if (device == SIM_DEV_NONE) {
+        return 0;
+    }
+    if (devices[device].publish) {
+        devices[device].publish(device);
+        touch(device);
+    }
+    lastDevice = device;
+    return devices[device].regs;
+}
+
+void __enable_irq(void) {
+    primask = 0;
+    simAccess(SIM_DEV_NONE);
+}
+
+void __disable_irq(void) {
+    primask = 1;
+}
+
+uint32_t __get_PRIMASK(void) {
+    return primask;
+}
+
+void __set_PRIMASK(uint32_t priMask) {
+    primask = priMask & 1;
+    if (!primask) {
+        simAccess(SIM_DEV_NONE);
+    }
+}
+
+uint32_t __get_MSP(void) {
+    return (uint32_t)(uintptr_t)&__STACK_END;
+}
+
+void __no_operation(void) {
+    simAccess(SIM_DEV_NONE);
+}
+
+static uint8_t wakeReady(void) {
+    if (linesDirty) {
+        irqPending |= irqLines();
+        linesDirty = 0;
+    }
+    return (irqPending & irqEnabled) != 0;
+}
+
+void __wfi(void) {
+    uint64_t start = now;
+    uint64_t next;
+
+    syncWrites();
+    sleeping = (scb.SCR & SCB_SCR_SLEEPDEEP_Msk) != 0;
+    if (sleeping && (pcm.CTL0 & PCM_CTL0_LPMR_MASK) != PCM_CTL0_LPMR__LPM3) {
+        simViolation("only LPM3 is modeled, LPMR 0x%X sleeps as LPM3",
+                     (unsigned)(pcm.CTL0 & PCM_CTL0_LPMR_MASK));
+    }
+    if (sleeping) {
+        csApply();
+    }
+    while (!wakeReady()) {
+        next = nextEvent();
+        if (next == SIM_NEVER) {
+            fprintf(stderr, "%12.3f ms  WFI with nothing left to wake it\n", simNowMs());
+            exit(3);
+        }
+        advanceTo(next);
+    }
+    if (sleeping) {
+        sleeping = 0;
+        sleepPs += now - start;
+        wokeAt = now;
+        csApply();
+    }
+    dispatch();
+}
+
+/******************************************************************************
+* Test and runner interface                                                   *
+******************************************************************************/
+uint64_t simNow(void) {
+    return now;
+}
+
+double simNowMs(void) {
+    return (double)now / SIM_PS_PER_MS;
+}
+
+void simRunUntil(uint64_t ps) {
+    syncWrites();
+    dispatch();
+    while (now < ps) {
+        advanceTo(earliest(nextEvent(), ps));
+        dispatch();
+    }
+}
+
+void simRunFor(uint32_t micros) {
+    simRunUntil(now + micros * SIM_PS_PER_US);
+}
+
+uint32_t simIrqCount(IRQn_Type irq) {
+    return irqCounts[irq < 0 ? IRQ_SYSTICK : irq];
+}
+
+uint64_t simAccessCount(void) {
+    return accessCount;
+}
+
+uint64_t simSleepTime(void) {
+    return sleepPs;
+}
+
+/******************************************************************************
+* Power-on                                                                    *
+******************************************************************************/
+static void mapFixed(uintptr_t address, size_t length) {
+    void *mapped = mmap((void *)address, length, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+
+    if (mapped != (void *)address) {
+        fprintf(stderr, "sim: cannot map 0x%08lX, build with -no-pie\n",
+                (unsigned long)address);
+        exit(2);
+    }
+}
+
+__attribute__((constructor))
+static void simPowerOn(void) {
+    struct sigaction action;
+    uintptr_t stackStart;
+
+    pageSize = sysconf(_SC_PAGESIZE);
+    mapFixed(SIM_INFO_FLASH_START, SIM_INFO_FLASH_SIZE);
+    memset(flash, 0xFF, SIM_INFO_FLASH_SIZE);
+    memset(flashAccepted, 0xFF, SIM_INFO_FLASH_SIZE);
+    flashProtect(0);
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = flashFault;
+    action.sa_flags = SA_SIGINFO | SA_NODEFER;
+    sigaction(SIGSEGV, &action, 0);
+
+    if (&__stack && &__STACK_END) {
+        stackStart = (uintptr_t)&__stack & ~(uintptr_t)(pageSize - 1);
+        mapFixed(stackStart, (uintptr_t)&__STACK_END - stackStart);
+    }
+
+    deviceTable();
+    cs.KEY = 0xA596;
+    cs.CTL0 = CS_CTL0_DCORSEL_1;
+    cs.CTL1 = CS_CTL1_SELS__DCOCLK | CS_CTL1_SELM__DCOCLK;
+    cs.CTL2 = CS_CTL2_HFXTDRIVE | 0x3;
+    cs.CLKEN = 0x0000000F;
+    *(uint32_t *)&cs.IFG = CS_IFG_LFXTIFG | CS_IFG_HFXTIFG;
+    pcm.CTL0 = 0xA5960000;
+    flctl.BANK0_INFO_WEPROT = 0x3;
+    flctl.BANK1_INFO_WEPROT = 0xF;
+    timer32[0].CONTROL = timer32[1].CONTROL = TIMER32_CONTROL_IE;
+    *(uint32_t *)&timer32[0].VALUE = *(uint32_t *)&timer32[1].VALUE = 0xFFFFFFFF;
+    t32State[0].value = t32State[1].value = 0xFFFFFFFF;
+    *(uint32_t *)&timer32[0].INTCLR = *(uint32_t *)&timer32[1].INTCLR = INTCLR_IDLE;
+    uart.CTLW0 = EUSCI_A_CTLW0_SWRST;
+    uart.IFG = EUSCI_A_IFG_TXIFG;
+    uart.TXBUF = TXBUF_IDLE;
+    portDriven[1] = portLevel[1] = BIT2;    // UART RX from the ESP32, idle high
+    rtc.CTL0 = 0x9600;
+    rtc.CTL13 = RTC_C_CTL13_HOLD | RTC_C_CTL13_MODE | RTC_C_CTL13_RDY;
+    wdt.CTL = 0x6904;
+
+    clocks[CLK_RTC].hz = XT32_HZ;
+    csApply();
+    touchAll();
+}
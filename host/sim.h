@@ -0,0 +1,300 @@
+/*! \file */
+/*!
+ * sim.h
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Virtual MSP432P4111 for running the firmware on a Linux host.
+ *              Time is kept in picoseconds and each clock domain (MCLK,
+ *              SMCLK, ACLK, the RTC crystal) converts it to its own ticks,
+ *              so a clock profile change or LPM3 only moves the domains it
+ *              touches. Peripheral models live in sim.c and see the
+ *              firmware only through register accesses, see msp.h.
+ *
+ *              Code between two register accesses takes no virtual time;
+ *              SIM_ACCESS_CYCLES per access stands in for it. Cycle counts
+ *              from DWT therefore measure register traffic and waits, not
+ *              computation.
+ *
+ *              The board around the MCU (buttons, LCD, the ESP32 on the
+ *              UART, the microphone) is driven through the functions below.
+ */
+
+#ifndef SIM_H_
+#define SIM_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include "msp.h"
+
+#define SIM_PS_PER_US           1000000ULL
+#define SIM_PS_PER_MS           1000000000ULL
+#define SIM_NEVER               UINT64_MAX
+
+#define SIM_ACCESS_CYCLES       8       // MCLK cycles charged per access
+#define SIM_IRQ_CYCLES          12      // exception entry, and again for exit
+#define SIM_UART_BAUD           115200  // rate the ESP32 side runs at
+#define SIM_PORT_COUNT          11      // PJ, then P1 to P10
+#define SIM_PORT_J              0
+
+/* Information flash, the only flash the firmware writes */
+#define SIM_INFO_FLASH_START    0x00200000
+#define SIM_INFO_FLASH_SIZE     0x8000
+#define SIM_FLASH_SECTOR_SIZE   4096
+
+typedef void (*SimCallback)(void *arg);
+
+/* Called when a port's OUT or DIR changed, with the values before */
+typedef void (*SimPortHook)(uint8_t port, uint8_t out, uint8_t previousOut);
+
+/* Called with each byte the firmware finished sending on eUSCI_A0 */
+typedef void (*SimUartSink)(uint8_t data);
+
+/*!
+ * \brief This function returns the virtual time
+ *
+ * \return picoseconds since power-on
+ */
+extern uint64_t simNow(void);
+
+/*!
+ * \brief This function returns the virtual time in milliseconds
+ *
+ * \return milliseconds since power-on, for printing
+ */
+extern double simNowMs(void);
+
+/*!
+ * \brief This function runs interrupts only, without the firmware main loop
+ *
+ * Jumps from one peripheral event to the next until \b ps, delivering the
+ *  interrupts they raise. Used by tests that call driver functions directly
+ *  and let the ISRs do the rest.
+ *
+ * \param ps is the absolute virtual time to stop at
+ *
+ * \return None
+ */
+extern void simRunUntil(uint64_t ps);
+
+/*!
+ * \brief This function runs interrupts only for a while, see simRunUntil
+ *
+ * \param micros is the time to run for
+ *
+ * \return None
+ */
+extern void simRunFor(uint32_t micros);
+
+/*!
+ * \brief This function calls a function at a virtual time
+ *
+ * The callback runs between two register accesses of whatever code is
+ *  executing then, so it must only drive the board, not call the firmware.
+ *  A callback that never returns (exit) ends the simulation there.
+ *
+ * \param ps is the absolute virtual time, not before simNow()
+ * \param callback is the function to call
+ * \param arg is passed to \b callback
+ *
+ * \return 1 if scheduled, 0 if the queue is full
+ */
+extern uint8_t simSchedule(uint64_t ps, SimCallback callback, void *arg);
+
+/*!
+ * \brief This function drives port pins from outside the MCU
+ *
+ * \param port is 1 to 10, or SIM_PORT_J
+ * \param mask selects the pins
+ * \param level is 0 or 1
+ *
+ * \return None
+ */
+extern void simGpioDrive(uint8_t port, uint8_t mask, uint8_t level);
+
+/*!
+ * \brief This function stops driving port pins, pull resistors take over
+ *
+ * \param port is 1 to 10, or SIM_PORT_J
+ * \param mask selects the pins
+ *
+ * \return None
+ */
+extern void simGpioRelease(uint8_t port, uint8_t mask);
+
+/*!
+ * \brief This function returns the output register of a port
+ *
+ * \param port is 1 to 10, or SIM_PORT_J
+ *
+ * \return PxOUT as the firmware or the DMA last wrote it
+ */
+extern uint8_t simGpioOut(uint8_t port);
+
+/*!
+ * \brief This function watches a port's outputs
+ *
+ * \param port is 1 to 10, or SIM_PORT_J
+ * \param hook is called at the virtual time of each change
+ *
+ * \return 1 if added, 0 if the port already has all its watchers
+ */
+extern uint8_t simGpioWatch(uint8_t port, SimPortHook hook);
+
+/*!
+ * \brief This function sets where transmitted UART bytes go
+ *
+ * \param sink receives each byte, 0 to drop them
+ *
+ * \return None
+ */
+extern void simUartSetSink(SimUartSink sink);
+
+/*!
+ * \brief This function sends bytes to the firmware's UART
+ *
+ * The bytes arrive back to back at SIM_UART_BAUD, after any still queued.
+ *  Each start bit pulls the RX pin P1.2 low. Bytes on the line while the
+ *  CPU is in LPM3 are lost, as eUSCI_A0 has no clock then.
+ *
+ * \param data is the bytes to send
+ * \param length is the number of bytes
+ *
+ * \return number of bytes queued
+ */
+extern uint16_t simUartSend(const uint8_t *data, uint16_t length);
+
+/*!
+ * \brief This function counts the bytes received while in LPM3
+ *
+ * \return bytes lost since power-on because SMCLK was stopped
+ */
+extern uint32_t simUartLost(void);
+
+/*!
+ * \brief This function sets the microphone signal
+ *
+ * The ADC reads mid-scale plus a sine of \b hz and \b amplitude counts.
+ *
+ * \param hz is the tone frequency, 0 for silence
+ * \param amplitude is the peak deviation in ADC counts
+ *
+ * \return None
+ */
+extern void simMicTone(uint32_t hz, uint16_t amplitude);
+
+/*!
+ * \brief This function returns the current frequency of a clock
+ *
+ * \param smclk selects SMCLK instead of MCLK
+ *
+ * \return Hz, 0 while the clock is stopped in LPM3
+ */
+extern uint32_t simClockHz(uint8_t smclk);
+
+/*!
+ * \brief This function counts the handler invocations of an interrupt
+ *
+ * \param irq is the interrupt number, SysTick_IRQn included
+ *
+ * \return invocations since power-on
+ */
+extern uint32_t simIrqCount(IRQn_Type irq);
+
+/*!
+ * \brief This function counts register accesses
+ *
+ * \return accesses since power-on
+ */
+extern uint64_t simAccessCount(void);
+
+/*!
+ * \brief This function returns the virtual time spent in LPM3
+ *
+ * \return picoseconds asleep since power-on
+ */
+extern uint64_t simSleepTime(void);
+
+/*!
+ * \brief This function records a broken hardware rule
+ *
+ * Prints the message with the virtual time and counts it. Models call this
+ *  for things the real part would silently get wrong, e.g. programming a
+ *  flash bit back to 1 or writing the LCD while it is busy.
+ *
+ * \param format is a printf format
+ *
+ * \return None
+ */
+extern void simViolation(const char *format, ...);
+
+/*!
+ * \brief This function counts the broken hardware rules
+ *
+ * \return simViolation calls since power-on
+ */
+extern uint32_t simViolationCount(void);
+
+/*!
+ * \brief This function silences simViolation's messages, counting goes on
+ *
+ * \param quiet is 1 to stop printing
+ *
+ * \return None
+ */
+extern void simViolationQuiet(uint8_t quiet);
+
+/*!
+ * \brief This function returns the information flash contents
+ *
+ * \return SIM_INFO_FLASH_SIZE bytes at SIM_INFO_FLASH_START
+ */
+extern uint8_t *simFlashImage(void);
+
+/*!
+ * \brief This function counts flash operations
+ *
+ * \param erases receives completed sector erases, may be 0
+ * \param programs receives programmed 32-bit words, may be 0
+ *
+ * \return None
+ */
+extern void simFlashCounts(uint32_t *erases, uint32_t *programs);
+
+/*!
+ * \brief This function loads the information flash from a file
+ *
+ * \param path is an image saved by simFlashSave
+ *
+ * \return 1 if loaded, 0 if the file could not be read
+ */
+extern uint8_t simFlashLoad(const char *path);
+
+/*!
+ * \brief This function saves the information flash to a file
+ *
+ * \param path is the file to write
+ *
+ * \return 1 if saved
+ */
+extern uint8_t simFlashSave(const char *path);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_H_ */
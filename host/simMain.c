@@ -0,0 +1,357 @@
+/*! \file */
+/*!
+ * simMain.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Runs the firmware on the virtual MSP432 from a script of
+ *              board events, one per line:
+ *
+ *                  wait <ms>               let virtual time pass
+ *                  press <switch> [ms]     hold next, select, toggle or
+ *                                          reset for ms (default 80)
+ *                  send <text>             ESP32 sends a line on the UART
+ *                  tone <hz> [amplitude]   microphone hears a tone
+ *                  screen                  print the LCD
+ *
+ *              '#' starts a comment. The run ends after the last line
+ *              with a summary; the exit status is the number of hardware
+ *              rule violations, capped at 100.
+ *
+ *              Usage: karaokeSim [-q] [-f flashImage] [-s hours]
+ *                                [-j report] script
+ *                  -q  do not echo what the firmware sends on the UART
+ *                  -f  load the information flash from the file and save it
+ *                      back at the end, so resume state survives runs
+ *                  -s  soak: run the script again and again until hours of
+ *                      virtual time have passed, e.g. -s 0.5
+ *                  -j  write the firmware's J: CPU budget reports to the
+ *                      file, "-" for stdout, one JSON line each: "PR" every
+ *                      SOAK_REPORT_MS of a soak and "P" at the end. The
+ *                      figures are zero unless built with DIAGNOSTICS=1
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sim.h"
+#include "hd44780.h"
+
+#define LINE_MAX                4096    // the J: and K: replies are one line
+#define SCRIPT_MAX              400     // actions, within the sim's schedule
+#define SOAK_REPORT_MS          3600000ULL
+#define REPORT_TIMEOUT_MS       1000
+#define PRESS_DEFAULT_MS        80
+#define SWITCH_PORT             3
+
+typedef enum _ActionType {
+    ACTION_PRESS, ACTION_RELEASE, ACTION_SEND, ACTION_TONE, ACTION_SCREEN, ACTION_END
+} ActionType;
+
+typedef struct _Action {
+    uint64_t ms;            // from the start of a pass
+    ActionType type;
+    uint32_t value;         // switch mask, Hz
+    uint16_t amplitude;
+    char *text;
+} Action;
+
+static const struct {
+    const char *name;
+    uint8_t mask;
+} switches[] = {
+    { "next", 0x04 }, { "select", 0x08 }, { "toggle", 0x20 }, { "reset", 0x40 },
+};
+
+static uint8_t echo = 1;
+static const char *flashPath = 0;
+static char uartLine[LINE_MAX];
+static uint16_t uartLength = 0;
+static Action *script[SCRIPT_MAX];
+static uint16_t scriptLength = 0;
+static uint64_t soakEndPs = 0;
+static uint32_t passes = 0;
+static FILE *reportFile = 0;
+static uint8_t finishing = 0;
+static double hostStartS;
+static char reportCommand[] = "P\n";
+static char reportResetCommand[] = "PR\n";
+
+extern int firmwareMain(void);
+
+static void finish(void);
+
+static double hostSeconds(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void uartReceived(uint8_t data) {
+    if (data == '\r') {
+        return;
+    }
+    if (data != '\n' && uartLength < LINE_MAX - 1) {
+        uartLine[uartLength++] = (char)data;
+        return;
+    }
+    uartLine[uartLength] = '\0';
+    if (echo) {
+        printf("%12.3f ms  <-  %s\n", simNowMs(), uartLine);
+    }
+    uartLength = 0;
+    if (reportFile && !strncmp(uartLine, "J:", 2)) {
+        fprintf(reportFile, "%s\n", uartLine + 2);
+        fflush(reportFile);
+        if (finishing) {
+            finish();
+        }
+    }
+}
+
+static void summary(void) {
+    uint32_t erases, programs;
+
+    simFlashCounts(&erases, &programs);
+    printf("%12.3f ms  end: %llu register accesses, %.1f%% in LPM3, %lu LCD writes\n",
+           simNowMs(), (unsigned long long)simAccessCount(),
+           simNow() ? 100.0 * simSleepTime() / simNow() : 0.0,
+           (unsigned long)hd44780Writes());
+    printf("%12s     %lu flash erases, %lu words programmed, %lu violations\n", "",
+           (unsigned long)erases, (unsigned long)programs,
+           (unsigned long)simViolationCount());
+    if (soakEndPs) {
+        printf("%12s     %lu passes, %.2f h in %.1f s of host time, %.0fx real time\n",
+               "", (unsigned long)passes, simNowMs() / SOAK_REPORT_MS,
+               hostSeconds() - hostStartS,
+               simNowMs() / 1000 / (hostSeconds() - hostStartS));
+    }
+}
+
+static void finish(void) {
+    hd44780Print();
+    summary();
+    if (flashPath && !simFlashSave(flashPath)) {
+        fprintf(stderr, "cannot save %s\n", flashPath);
+    }
+    if (reportFile && reportFile != stdout) {
+        fclose(reportFile);
+    }
+    fflush(stdout);
+    exit(simViolationCount() > 100 ? 100 : (int)simViolationCount());
+}
+
+// Sends a profiler command as the ESP32 would, the J: reply is kept
+static void requestReport(void *arg) {
+    const char *command = arg;
+
+    if (echo) {
+        printf("%12.3f ms  ->  %.*s\n", simNowMs(), (int)strlen(command) - 1, command);
+    }
+    simUartSend((const uint8_t *)command, (uint16_t)strlen(command));
+}
+
+// "PR" once per SOAK_REPORT_MS keeps the 32-bit counts from wrapping
+static void hourlyReport(void *arg) {
+    uint64_t next = simNow() + SOAK_REPORT_MS * SIM_PS_PER_MS;
+
+    requestReport(arg);
+    if (next < soakEndPs) {
+        simSchedule(next, hourlyReport, arg);
+    }
+}
+
+static void reportTimeout(void *arg) {
+    (void)arg;
+    fprintf(stderr, "no J: report within %u ms\n", REPORT_TIMEOUT_MS);
+    finish();
+}
+
+// Puts every action of the script on the schedule, from ps on
+static void schedulePass(uint64_t ps);
+
+static void perform(void *arg) {
+    Action *action = arg;
+    char line[LINE_MAX + 1];
+    uint16_t length;
+
+    switch (action->type) {
+    case ACTION_PRESS:
+        simGpioDrive(SWITCH_PORT, action->value, 0);
+        break;
+    case ACTION_RELEASE:
+        simGpioRelease(SWITCH_PORT, action->value);
+        break;
+    case ACTION_SEND:
+        length = (uint16_t)snprintf(line, sizeof(line), "%s\n", action->text);
+        if (echo) {
+            printf("%12.3f ms  ->  %s\n", simNowMs(), action->text);
+        }
+        simUartSend((const uint8_t *)line, length);
+        break;
+    case ACTION_TONE:
+        simMicTone(action->value, action->amplitude);
+        break;
+    case ACTION_SCREEN:
+        hd44780Print();
+        break;
+    case ACTION_END:
+        if (simNow() < soakEndPs) {
+            passes++;
+            schedulePass(simNow());
+        } else if (reportFile) {
+            finishing = 1;
+            requestReport(reportCommand);
+            simSchedule(simNow() + REPORT_TIMEOUT_MS * SIM_PS_PER_MS, reportTimeout, 0);
+        } else {
+            finish();
+        }
+        break;
+    }
+}
+
+static void add(uint64_t ms, ActionType type, uint32_t value, uint16_t amplitude,
+                const char *text) {
+    Action *action;
+
+    if (scriptLength == SCRIPT_MAX) {
+        fprintf(stderr, "script too long\n");
+        exit(2);
+    }
+    action = calloc(1, sizeof(Action));
+    action->ms = ms;
+    action->type = type;
+    action->value = value;
+    action->amplitude = amplitude;
+    action->text = text ? strdup(text) : 0;
+    script[scriptLength++] = action;
+}
+
+static void schedulePass(uint64_t ps) {
+    uint16_t i;
+
+    for (i = 0; i < scriptLength; i++) {
+        if (!simSchedule(ps + script[i]->ms * SIM_PS_PER_MS, perform, script[i])) {
+            fprintf(stderr, "script too long\n");
+            exit(2);
+        }
+    }
+}
+
+static uint8_t switchMask(const char *name) {
+    uint8_t i;
+
+    for (i = 0; i < sizeof(switches) / sizeof(switches[0]); i++) {
+        if (!strcmp(name, switches[i].name)) {
+            return switches[i].mask;
+        }
+    }
+    return 0;
+}
+
+// Turns the script into actions, returns 0 on a bad line
+static uint8_t loadScript(FILE *file) {
+    char line[LINE_MAX];
+    char word[16];
+    char *rest;
+    uint64_t at = 0;
+    unsigned long a, b;
+    int consumed, fields;
+    uint16_t number = 0;
+    uint8_t mask;
+
+    while (fgets(line, sizeof(line), file)) {
+        number++;
+        line[strcspn(line, "#\r\n")] = '\0';
+        if (sscanf(line, " %15s%n", word, &consumed) != 1) {
+            continue;
+        }
+        rest = line + consumed;
+        rest += strspn(rest, " \t");
+        if (!strcmp(word, "wait") && sscanf(rest, "%lu", &a) == 1) {
+            at += a;
+        } else if (!strcmp(word, "press")) {
+            fields = sscanf(rest, "%15s %lu", word, &a);
+            mask = fields >= 1 ? switchMask(word) : 0;
+            if (!mask) {
+                fprintf(stderr, "line %u: unknown switch\n", number);
+                return 0;
+            }
+            add(at, ACTION_PRESS, mask, 0, 0);
+            at += fields == 2 ? a : PRESS_DEFAULT_MS;
+            add(at, ACTION_RELEASE, mask, 0, 0);
+        } else if (!strcmp(word, "send")) {
+            add(at, ACTION_SEND, 0, 0, rest);
+        } else if (!strcmp(word, "tone") && (fields = sscanf(rest, "%lu %lu", &a, &b)) >= 1) {
+            add(at, ACTION_TONE, (uint32_t)a, fields == 2 ? (uint16_t)b : 2000, 0);
+        } else if (!strcmp(word, "screen")) {
+            add(at, ACTION_SCREEN, 0, 0, 0);
+        } else {
+            fprintf(stderr, "line %u: cannot parse \"%s\"\n", number, line);
+            return 0;
+        }
+    }
+    add(at, ACTION_END, 0, 0, 0);
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    FILE *file;
+    const char *reportPath = 0;
+    double hours = 0;
+    int i;
+
+    for (i = 1; i < argc - 1; i++) {
+        if (!strcmp(argv[i], "-q")) {
+            echo = 0;
+        } else if (!strcmp(argv[i], "-f") && i + 1 < argc - 1) {
+            flashPath = argv[++i];
+        } else if (!strcmp(argv[i], "-s") && i + 1 < argc - 1
+                   && (hours = atof(argv[i + 1])) > 0) {
+            i++;
+        } else if (!strcmp(argv[i], "-j") && i + 1 < argc - 1) {
+            reportPath = argv[++i];
+        } else {
+            break;
+        }
+    }
+    if (i != argc - 1) {
+        fprintf(stderr, "usage: %s [-q] [-f flashImage] [-s hours] [-j report] script\n",
+                argv[0]);
+        return 2;
+    }
+    file = fopen(argv[i], "r");
+    if (!file || !loadScript(file)) {
+        fprintf(stderr, "cannot run %s\n", argv[i]);
+        return 2;
+    }
+    fclose(file);
+    if (hours > 0 && !script[scriptLength - 1]->ms) {
+        fprintf(stderr, "%s takes no time, it cannot soak\n", argv[i]);
+        return 2;
+    }
+    if (reportPath) {
+        reportFile = strcmp(reportPath, "-") ? fopen(reportPath, "w") : stdout;
+        if (!reportFile) {
+            fprintf(stderr, "cannot write %s\n", reportPath);
+            return 2;
+        }
+    }
+    if (flashPath) {
+        simFlashLoad(flashPath);    // a missing image is a blank part
+    }
+    schedulePass(0);
+    if (hours > 0) {
+        soakEndPs = (uint64_t)(hours * SOAK_REPORT_MS) * SIM_PS_PER_MS;
+        passes = 1;
+        if (reportFile && SOAK_REPORT_MS * SIM_PS_PER_MS < soakEndPs) {
+            simSchedule(SOAK_REPORT_MS * SIM_PS_PER_MS, hourlyReport, reportResetCommand);
+        }
+    }
+    hostStartS = hostSeconds();
+    hd44780Attach();
+    simUartSetSink(uartReceived);
+    firmwareMain();
+    return 0;
+}
@@ -11,7 +11,9 @@
  *                            R/W --->GND
  *                P4  <-----> DB
  *
- *          This module uses SysTick timer for delays.
+ *          Instruction execution times are tracked with a deadline from
+ *          sysTickDelays; a write only waits if the previous one is still
+ *          executing, so the caller is free in between.
  *
  *      Author: ece230
  */
@@ -22,12 +24,52 @@
 #include "sysTickDelays.h"
 #include "stdio.h"
 #include "timer32.h"
+#include "uart.h"
+#include "clockManager.h"
+#include "profiler.h"
+#include "trace.h"
 
-#define NONHOME_MASK        0xF
-#define LCD_WIDTH 16
+#define NONHOME_MASK        0xFC    // any bit above clear display and return home
 #define LONG_INSTR_DELAY    2000
 #define SHORT_INSTR_DELAY   50
+#define ENABLE_PULSE_NS     450
+
+/* Execution deadline of the last instruction sent to the LCD */
+static uint8_t lcdBusy = DEADLINE_NONE;
+
+#if LCD_MONITOR
+/* Minimum execution times from Table 6 of HD44780 data sheet (270kHz) */
+#define EXEC_TIME_SHORT     37
+#define EXEC_TIME_LONG      1520
+#define DDRAM_LINE_LENGTH   40
+
+/* Shadow of what the controller holds, decoded from every bus write */
+static char ddram[2][DDRAM_LINE_LENGTH];
+static uint8_t cgram[64];
+static uint8_t addressCounter = 0;      // DDRAM address or CGRAM address
+static uint8_t cgramSelected = 0;
+
+/* Bus statistics */
+static uint32_t busWrites = 0;
+static uint32_t timingViolations = 0;
+static uint32_t stallTicks = 0;         // time writers spent waiting
+static uint32_t lastWriteTicks = 0;
+static uint32_t lastExecMicros = 0;
+static uint32_t refreshTicks = 0;       // cost of last lcdDisplayTitleArtist
+static uint32_t refreshWrites = 0;
+
+/* Timestamped history of the visible 16x2 window */
+typedef struct {
+    uint32_t time;
+    char text[2][LCD_WIDTH];
+} LcdFrame;
+
+static LcdFrame frames[LCD_FRAME_HISTORY];
+static uint8_t frameHead = 0;
+static uint8_t frameCount = 0;
 
+static void monitorWrite(uint8_t mode, uint8_t instruction, uint32_t now);
+#endif
 
 
 typedef struct {
@@ -41,11 +83,61 @@ static struct {
     uint32_t lastUpdateTime;
 } displayState = {{0, 0}, {0, 0}, 0};
 
+static char statusTag[LCD_TAG_MAX + 1] = "";
 
-void lcdDisplayTitleArtist(const char *songInfo) {
-    static char lastTitle[32] = "";
-    static char lastArtist[32] = "";
+void lcdSetStatusTag(const char *tag) {
+    strncpy(statusTag, tag, LCD_TAG_MAX);
+    statusTag[LCD_TAG_MAX] = '\0';
+}
+
+/* Level bar cells as shown, valid while barShown is set. barOnGlass stays
+ *  set after the bar is hidden until the title underneath is rewritten */
+#define BAR_GLYPH_CODE      8       // CGRAM 0 alias, glyph k at code 8 + k - 1
+static char barText[LCD_BAR_CELLS];
+static uint8_t barShown = 0;
+static uint8_t barOnGlass = 0;
+static uint8_t barGlyphsLoaded = 0;
+
+/* Song text and both rows as last drawn by lcdDisplayTitleArtist, the title
+ *  row without the bar, for the partial redraw of lcdUpdateStatusTag */
+static char lastTitle[32] = "";
+static char lastArtist[32] = "";
+static char titleRow[LCD_WIDTH + 1];
+static char artistRow[LCD_WIDTH + 1];
+static uint8_t rowsShown = 0;
+
+// The artist gets the bottom row up to a space before the status tag
+static int artistColumns(void)
+{
+    int tagLen = strlen(statusTag);
+
+    return tagLen ? LCD_WIDTH - tagLen - 1 : LCD_WIDTH;
+}
+
+// Artist row from lastArtist, its scroll offset and the status tag
+static void buildArtistRow(char *row)
+{
+    int artistLen = strlen(lastArtist);
+    int tagLen = strlen(statusTag);
+    int artistWidth = artistColumns();
 
+    displayState.artist.isScrolling = (artistLen > artistWidth) ? 1 : 0;
+    if (displayState.artist.isScrolling) {
+        scrollText(row, lastArtist, artistLen, displayState.artist.offset,
+                   artistWidth);
+    } else {
+        centerText(row, lastArtist, artistLen, artistWidth);
+    }
+    memset(row + artistWidth, ' ', LCD_WIDTH - artistWidth - tagLen);
+    memcpy(row + LCD_WIDTH - tagLen, statusTag, tagLen);
+    row[LCD_WIDTH] = '\0';
+}
+
+void lcdDisplayTitleArtist(const char *songInfo) {
+#if LCD_MONITOR
+    uint32_t startTicks = delayGetTicks();
+    uint32_t startWrites = busWrites;
+#endif
     char formattedTitle[32];  // Store "1. Song Title"
     char title[32] = {0};
     char artist[32] = {0};
@@ -71,8 +163,10 @@ void lcdDisplayTitleArtist(const char *songInfo) {
         strncpy(title, songInfo, sizeof(title) - 1);
         artist[0] = '\0';
     } else {
-        strncpy(title, songInfo, splitIndex);
-        title[splitIndex] = '\0';
+        // a title longer than the buffer is cut, like the artist
+        i = splitIndex < (int)sizeof(title) - 1 ? splitIndex : (int)sizeof(title) - 1;
+        strncpy(title, songInfo, i);
+        title[i] = '\0';
 
         artistStart = songInfo + splitIndex + 1;
         while (*artistStart == ' ') artistStart++; // Skip leading spaces
@@ -82,11 +176,18 @@ void lcdDisplayTitleArtist(const char *songInfo) {
     // Format title with song number
     snprintf(formattedTitle, sizeof(formattedTitle), "%d. %s", currentSong + 1, title);
 
+    // Get current system time
+    currentTime = getSystemTime();
+
     // Only update display if content changed
     if (strcmp(formattedTitle, lastTitle) != 0 || strcmp(artist, lastArtist) != 0) {
         lcdClearDisplay();  // Only clear if necessary
         strncpy(lastTitle, formattedTitle, sizeof(lastTitle));
         strncpy(lastArtist, artist, sizeof(lastArtist));
+        // new text starts from its beginning and scrolls a full period later
+        displayState.title.offset = 0;
+        displayState.artist.offset = 0;
+        displayState.lastUpdateTime = currentTime;
     }
 
     // Get lengths and determine if scrolling is needed
@@ -94,10 +195,7 @@ void lcdDisplayTitleArtist(const char *songInfo) {
     artistLen = strlen(artist);
 
     displayState.title.isScrolling = (titleLen > LCD_WIDTH) ? 1 : 0;
-    displayState.artist.isScrolling = (artistLen > LCD_WIDTH) ? 1 : 0;
-
-    // Get current system time
-    currentTime = getSystemTime();
+    displayState.artist.isScrolling = (artistLen > artistColumns()) ? 1 : 0;
 
     // Update scroll positions if enough time has passed
     if ((currentTime - displayState.lastUpdateTime) >= SCROLL_DELAY_MS) {
@@ -115,47 +213,89 @@ void lcdDisplayTitleArtist(const char *songInfo) {
     // Display formatted title (top row)
     lcdSetCursor(0, 0);
     if (displayState.title.isScrolling) {
-        scrollText(displayBuffer, formattedTitle, titleLen, displayState.title.offset);
+        scrollText(displayBuffer, formattedTitle, titleLen, displayState.title.offset,
+                   LCD_WIDTH);
     } else {
-        centerText(displayBuffer, formattedTitle, titleLen);
+        centerText(displayBuffer, formattedTitle, titleLen, LCD_WIDTH);
+    }
+    memcpy(titleRow, displayBuffer, sizeof(titleRow));
+    if (barShown) {
+        memcpy(displayBuffer + LCD_WIDTH - LCD_BAR_CELLS, barText, LCD_BAR_CELLS);
     }
+    barOnGlass = barShown;
     lcdPrintString(displayBuffer);
 
     // Display artist (bottom row)
     lcdSetCursor(1, 0);
-    if (displayState.artist.isScrolling) {
-        scrollText(displayBuffer, artist, artistLen, displayState.artist.offset);
-    } else {
-        centerText(displayBuffer, artist, artistLen);
-    }
-    lcdPrintString(displayBuffer);
+    buildArtistRow(artistRow);
+    lcdPrintString(artistRow);
+    rowsShown = 1;
+
+#if LCD_MONITOR
+    refreshTicks = delayGetTicks() - startTicks;
+    refreshWrites = busWrites - startWrites;
+    lcdCaptureFrame();
+#endif
 }
 
 
 
-static void scrollText(char *dest, const char *src, int srcLen, int offset) {
+void lcdUpdateStatusTag(const char *tag) {
+    char row[LCD_WIDTH + 1];
+    int first;
+    int last;
+
+    lcdSetStatusTag(tag);
+    if (!rowsShown) {
+        return;     // the next lcdDisplayTitleArtist shows it
+    }
+    if (!barShown && barOnGlass) {
+        // title cells the hidden bar still covers
+        lcdSetCursor(0, LCD_WIDTH - LCD_BAR_CELLS);
+        lcdPrintString(titleRow + LCD_WIDTH - LCD_BAR_CELLS);
+        barOnGlass = 0;
+    }
+
+    // rewrite the artist row from its first to its last changed cell
+    buildArtistRow(row);
+    for (first = 0; first < LCD_WIDTH && row[first] == artistRow[first]; first++) {
+    }
+    if (first < LCD_WIDTH) {
+        for (last = LCD_WIDTH - 1; row[last] == artistRow[last]; last--) {
+        }
+        memcpy(artistRow, row, sizeof(artistRow));
+        row[last + 1] = '\0';
+        lcdSetCursor(1, first);
+        lcdPrintString(row + first);
+    }
+#if LCD_MONITOR
+    lcdCaptureFrame();
+#endif
+}
+
+void scrollText(char *dest, const char *src, int srcLen, int offset, int width) {
     int i;
     int totalLen = srcLen + SCROLL_PADDING;  // Add padding between wrap
 
-    for (i = 0; i < LCD_WIDTH; i++) {
+    for (i = 0; i < width; i++) {
         int pos = (offset + i) % totalLen;
         dest[i] = pos < srcLen ? src[pos] : ' ';
     }
-    dest[LCD_WIDTH] = '\0';
+    dest[width] = '\0';
 }
 
-static void centerText(char *dest, const char *src, int srcLen) {
-    int padding = (LCD_WIDTH - srcLen) / 2;
+void centerText(char *dest, const char *src, int srcLen, int width) {
+    int padding = (width > srcLen) ? (width - srcLen) / 2 : 0;
     int i;
 
     // Fill with spaces first
-    for (i = 0; i < LCD_WIDTH; i++) {
+    for (i = 0; i < width; i++) {
         dest[i] = ' ';
     }
-    dest[LCD_WIDTH] = '\0';
+    dest[width] = '\0';
 
     // Copy text in center position
-    for (i = 0; i < srcLen && i < LCD_WIDTH; i++) {
+    for (i = 0; i < srcLen && i < width; i++) {
         dest[padding + i] = src[i];
     }
 }
@@ -179,7 +319,7 @@ void configLCD(uint32_t clkFreq) {
 }
 
 /*!
- * Delay method based on instruction execution time.
+ * Starts the execution deadline for an instruction.
  *   Execution times from Table 6 of HD44780 data sheet, with buffer.
  *
  * \param mode RS mode selection
@@ -188,13 +328,19 @@ void configLCD(uint32_t clkFreq) {
  * \return None
  */
 void instructionDelay(uint8_t mode, uint8_t instruction) {
+    uint32_t delay;
+
     // if instruction is Return Home or Clear Display, use long delay for
     //  instruction execution; otherwise, use short delay
     if ((mode == DATA_MODE) || (instruction & NONHOME_MASK)) {
-        delayMicroSec(SHORT_INSTR_DELAY);
+        delay = SHORT_INSTR_DELAY;
     }
     else {
-        delayMicroSec(LONG_INSTR_DELAY);
+        delay = LONG_INSTR_DELAY;
+    }
+    lcdBusy = deadlineStart(delay);
+    if (lcdBusy == DEADLINE_NONE) {
+        delayMicroSec(delay);       // no free slot, fall back to blocking
     }
 }
 
@@ -207,6 +353,20 @@ void instructionDelay(uint8_t mode, uint8_t instruction) {
  * \return None
  */
 void writeInstruction(uint8_t mode, uint8_t instruction) {
+    PROFILE_BEGIN(PROF_LCD);
+#if LCD_MONITOR
+    uint32_t waitStart = delayGetTicks();
+#endif
+    // previous instruction must have finished executing
+    deadlineWait(lcdBusy);
+    lcdBusy = DEADLINE_NONE;
+#if LCD_MONITOR
+    monitorWrite(mode, instruction, delayGetTicks());
+    stallTicks += delayGetTicks() - waitStart;
+#endif
+
+    TRACE(TRACE_LCD_WRITE, ((uint16_t)mode << 8) | instruction);
+
     // DONE set 8-bit data on LCD DB port
     LCD_DB_PORT->OUT = instruction;
 
@@ -222,14 +382,133 @@ void writeInstruction(uint8_t mode, uint8_t instruction) {
     //      use bit-masking to avoid affecting other pins of port
 
     LCD_EN_PORT->OUT |= LCD_EN_MASK;  // Set Enable signal high
-    delayMicroSec(1);
+    spinNanoSec(ENABLE_PULSE_NS);
     // DONE set Enable signal low
     //      use bit-masking to avoid affecting other pins of port
     LCD_EN_PORT->OUT &= ~LCD_EN_MASK; // Set Enable signal low
-    // delay to allow instruction execution to complete
+    // track instruction execution, the next write waits for it
     instructionDelay(mode, instruction);
+    PROFILE_END(PROF_LCD);
 }
 
+#if LCD_MONITOR
+/*!
+ * Checks the write against the data sheet execution time of the previous
+ *  one and updates the DDRAM/CGRAM shadow the way the controller would.
+ *  Assumes increment entry mode without display shift (set in initLCD).
+ *
+ * \param mode          Write mode: 0 - control, 1 - data
+ * \param instruction   Instruction/data being written
+ * \param now           Tick count at the write
+ *
+ * \return None
+ */
+static void monitorWrite(uint8_t mode, uint8_t instruction, uint32_t now) {
+    uint8_t line, column;
+
+    if (busWrites > 0
+            && now - lastWriteTicks < delayMicrosToTicks(lastExecMicros)) {
+        timingViolations++;
+    }
+    busWrites++;
+    lastWriteTicks = now;
+    lastExecMicros = ((mode == DATA_MODE) || (instruction & NONHOME_MASK))
+            ? EXEC_TIME_SHORT : EXEC_TIME_LONG;
+
+    if (mode == DATA_MODE) {
+        if (cgramSelected) {
+            cgram[addressCounter] = instruction;
+            addressCounter = (addressCounter + 1) & 0x3F;
+        } else {
+            line = (addressCounter & LINE2_OFFSET) ? 1 : 0;
+            column = addressCounter & ~LINE2_OFFSET;
+            if (column < DDRAM_LINE_LENGTH) {
+                ddram[line][column] = instruction;
+            }
+            // increment, wrapping 0x27 -> 0x40 -> 0x67 -> 0x00
+            if (++column >= DDRAM_LINE_LENGTH) {
+                column = 0;
+                line ^= 1;
+            }
+            addressCounter = (line ? LINE2_OFFSET : LINE1_OFFSET) | column;
+        }
+    } else if (instruction & SET_CURSOR_MASK) {
+        addressCounter = instruction & ~SET_CURSOR_MASK;
+        cgramSelected = 0;
+    } else if (instruction & SET_CGRAM_MASK) {
+        addressCounter = instruction & 0x3F;
+        cgramSelected = 1;
+    } else if (instruction == CLEAR_DISPLAY_MASK) {
+        memset(ddram, ' ', sizeof(ddram));
+        addressCounter = 0;
+        cgramSelected = 0;
+    } else if ((instruction & ~0x01) == RETURN_HOME_MASK) {
+        addressCounter = 0;
+        cgramSelected = 0;
+    }
+}
+
+uint32_t lcdGetBusWrites(void) {
+    return busWrites;
+}
+
+void lcdCaptureFrame(void) {
+    LcdFrame *frame = &frames[frameHead];
+    uint8_t i;
+
+    frame->time = getSystemTime();
+    memcpy(frame->text[0], ddram[0], LCD_WIDTH);
+    memcpy(frame->text[1], ddram[1], LCD_WIDTH);
+    // custom glyphs (codes 8-15) would be control characters on the UART
+    for (i = 0; i < LCD_WIDTH; i++) {
+        if ((uint8_t)frame->text[0][i] < ' ') {
+            frame->text[0][i] = '=';
+        }
+        if ((uint8_t)frame->text[1][i] < ' ') {
+            frame->text[1][i] = '=';
+        }
+    }
+    frameHead = (frameHead + 1) % LCD_FRAME_HISTORY;
+    if (frameCount < LCD_FRAME_HISTORY) {
+        frameCount++;
+    }
+}
+
+void lcdReportFrames(void) {
+    char buffer[24 + 2 * LCD_WIDTH];
+    LcdFrame *frame;
+    uint8_t i;
+
+    // oldest first
+    for (i = 0; i < frameCount; i++) {
+        frame = &frames[(frameHead + LCD_FRAME_HISTORY - frameCount + i)
+                        % LCD_FRAME_HISTORY];
+        sprintf(buffer, "F:%lu|%.16s|%.16s\n", (unsigned long)frame->time,
+                frame->text[0], frame->text[1]);
+        sendString(buffer);
+    }
+}
+
+void lcdReportStats(void) {
+    char buffer[96];
+    uint32_t seconds = getSystemTime() / 1000;
+
+    sprintf(buffer, "L:W%lu V%lu S%lu R%lu/%lu H%lu\n",
+            (unsigned long)busWrites,
+            (unsigned long)timingViolations,
+            (unsigned long)stallTicks,
+            (unsigned long)refreshWrites,
+            (unsigned long)refreshTicks,
+            (unsigned long)(seconds ? busWrites / seconds : busWrites));
+    sendString(buffer);
+    if (refreshTicks) {
+        sprintf(buffer, "L:MAXHZ%lu\n",
+                (unsigned long)(getMCLKFrequency() / refreshTicks));
+        sendString(buffer);
+    }
+}
+#endif
+
 /*!
  * Function to write command instruction to LCD.
  *
@@ -253,28 +532,78 @@ void dataInstruction(uint8_t data) {
     writeInstruction(DATA_MODE, data);
 }
 
-void initLCD(void) {
-    // follows initialization sequence described for 8-bit data mode in
-    //  Figure 23 of HD447780 data sheet
-    delayMilliSec(40);
-    commandInstruction(FUNCTION_SET_MASK | DL_FLAG_MASK);
-    delayMilliSec(5);
-    commandInstruction(FUNCTION_SET_MASK | DL_FLAG_MASK);
-    delayMicroSec(150);
-    commandInstruction(FUNCTION_SET_MASK | DL_FLAG_MASK);
-    delayMicroSec(SHORT_INSTR_DELAY);
-    commandInstruction(FUNCTION_SET_MASK | DL_FLAG_MASK | N_FLAG_MASK);
-    delayMicroSec(SHORT_INSTR_DELAY);
-    commandInstruction(DISPLAY_CTRL_MASK);
-    delayMicroSec(SHORT_INSTR_DELAY);
-    commandInstruction(CLEAR_DISPLAY_MASK);
-    delayMicroSec(SHORT_INSTR_DELAY);
-    commandInstruction(ENTRY_MODE_MASK | ID_FLAG_MASK);
-    delayMicroSec(LONG_INSTR_DELAY);
-
+/* Power-on initialization for 8-bit data mode, Figure 23 of the HD44780
+ *  data sheet. Each instruction is held off for the hold time after the one
+ *  before it, on top of the execution time tracked by lcdBusy. */
+typedef struct _LcdInitStep {
+    uint8_t instruction;
+    uint16_t holdMicros;        // wait after this step before the next
+} LcdInitStep;
+
+static const LcdInitStep initSequence[] = {
+    { FUNCTION_SET_MASK | DL_FLAG_MASK,                 5000 },
+    { FUNCTION_SET_MASK | DL_FLAG_MASK,                 150 },
+    { FUNCTION_SET_MASK | DL_FLAG_MASK,                 0 },
+    { FUNCTION_SET_MASK | DL_FLAG_MASK | N_FLAG_MASK,   0 },
+    { DISPLAY_CTRL_MASK,                                0 },
+    { CLEAR_DISPLAY_MASK,                               0 },
+    { ENTRY_MODE_MASK | ID_FLAG_MASK,                   0 },
     // after initialization and configuration, turn display ON
-    commandInstruction(DISPLAY_CTRL_MASK | D_FLAG_MASK);
-    lcdClearDisplay();
+    { DISPLAY_CTRL_MASK | D_FLAG_MASK,                  0 },
+};
+
+#define INIT_STEPS  (sizeof(initSequence) / sizeof(initSequence[0]))
+
+static uint8_t initStep = INIT_STEPS;
+static uint8_t initHold = DEADLINE_NONE;
+
+uint8_t lcdIsBusy(void) {
+    if (!deadlineExpired(lcdBusy)) {
+        return 1;
+    }
+    lcdBusy = DEADLINE_NONE;    // handle released, never wait on it again
+    return 0;
+}
+
+void lcdInitStart(void) {
+#if LCD_MONITOR
+    memset(ddram, ' ', sizeof(ddram));
+#endif
+    initStep = 0;
+    initHold = deadlineStart(LCD_POWER_UP_US);
+    if (initHold == DEADLINE_NONE) {
+        delayMicroSec(LCD_POWER_UP_US);     // no free slot, fall back to blocking
+    }
+}
+
+uint8_t lcdInitPoll(void) {
+    const LcdInitStep *step;
+
+    if (!deadlineExpired(initHold)) {
+        return 0;
+    }
+    initHold = DEADLINE_NONE;   // released by deadlineExpired
+    if (lcdIsBusy()) {
+        return 0;
+    }
+    if (initStep == INIT_STEPS) {
+        return 1;
+    }
+
+    step = &initSequence[initStep++];
+    commandInstruction(step->instruction);
+    if (step->holdMicros) {
+        initHold = deadlineStart(step->holdMicros);
+        if (initHold == DEADLINE_NONE) {
+            delayMicroSec(step->holdMicros);
+        }
+    }
+    return 0;
+}
+
+void initLCD(void) {
+    lcdInitStart();
+    while (!lcdInitPoll()) {}
     lcdSetCursor(0, 0);
 }
 
@@ -315,6 +644,64 @@ void lcdSetCursor(uint8_t row, uint8_t col) { // Sets cursor at select row and c
 
 void lcdClearDisplay() {
     // clear the LCD display and return cursor to home position
+    //  (long execution time is covered by the instruction deadline)
     commandInstruction(CLEAR_DISPLAY_MASK);
-    delayMicroSec(LONG_INSTR_DELAY);
+    rowsShown = 0;
+    barOnGlass = 0;
+}
+
+void lcdDefineChar(uint8_t code, const uint8_t *rows) {
+    int i;
+
+    commandInstruction(SET_CGRAM_MASK | ((code & 0x07) << 3));
+    for (i = 0; i < 8; i++) {
+        dataInstruction(rows[i] & 0x1F);
+    }
+}
+
+void lcdSetLevelBar(uint8_t level) {
+    uint8_t rows[8];
+    char cells[LCD_BAR_CELLS];
+    uint8_t columns;
+    int i;
+
+    if (level == LCD_BAR_OFF) {
+        barShown = 0;
+        return;
+    }
+    if (level > LCD_BAR_LEVELS) {
+        level = LCD_BAR_LEVELS;
+    }
+
+    if (!barGlyphsLoaded) {
+        // glyph k fills the k leftmost columns, bottom six rows
+        for (columns = 1; columns <= 5; columns++) {
+            rows[0] = rows[1] = 0;
+            for (i = 2; i < 8; i++) {
+                rows[i] = (0x1F << (5 - columns)) & 0x1F;
+            }
+            lcdDefineChar(columns - 1, rows);
+        }
+        barGlyphsLoaded = 1;
+    }
+
+    for (i = 0; i < LCD_BAR_CELLS; i++) {
+        columns = (level > 5) ? 5 : level;
+        level -= columns;
+        cells[i] = columns ? (char)(BAR_GLYPH_CODE + columns - 1) : ' ';
+    }
+
+    if (barShown && memcmp(cells, barText, LCD_BAR_CELLS) == 0) {
+        return;
+    }
+    // write from the first changed cell on
+    for (i = 0; barShown && cells[i] == barText[i]; i++) {
+    }
+    lcdSetCursor(0, LCD_WIDTH - LCD_BAR_CELLS + i);
+    for (; i < LCD_BAR_CELLS; i++) {
+        dataInstruction(cells[i]);
+    }
+    memcpy(barText, cells, LCD_BAR_CELLS);
+    barShown = 1;
+    barOnGlass = 1;
 }
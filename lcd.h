@@ -11,7 +11,7 @@
  *                            R/W --->GND
  *                P4  <-----> DB
  *
- *          This module uses SysTick timer for delays.
+ *          This module uses sysTickDelays deadlines for instruction timing.
  *
  *      Author: ece230
  */
@@ -35,6 +35,23 @@ extern "C"
 
 #define SCROLL_PADDING 4
 #define SCROLL_DELAY_MS 2000
+#define LCD_WIDTH 16
+#define LCD_TAG_MAX 5       // characters of the status tag
+#define LCD_POWER_UP_US 40000   // Vcc rise to first instruction
+#define LCD_BAR_CELLS 3     // character cells of the level bar
+#define LCD_BAR_LEVELS (LCD_BAR_CELLS * 5)  // one level per pixel column
+#define LCD_BAR_OFF 0xFF    // lcdSetLevelBar value that hides the bar
+
+/* 1 to shadow controller RAM, check bus timing and keep a frame history;
+ *  0 removes the monitor entirely. On with KARAOKE_DIAGNOSTICS */
+#ifndef LCD_MONITOR
+#ifdef KARAOKE_DIAGNOSTICS
+#define LCD_MONITOR         1
+#else
+#define LCD_MONITOR         0
+#endif
+#endif
+#define LCD_FRAME_HISTORY   8
 
 #define LCD_DB_PORT         P4
 #define LCD_RS_PORT         P6
@@ -106,12 +123,41 @@ extern void configLCD(uint32_t clkFreq);
  *  \brief This function initializes LCD
  *
  *  This function generates initialization sequence for LCD for 8-bit mode.
- *      Delays set by worst-case 2.7 V
+ *      Delays set by worst-case 2.7 V. Blocks until the controller is ready,
+ *      use lcdInitStart and lcdInitPoll to overlap it with other work.
  *
  *  \return None
  */
 extern void initLCD(void);
 
+/*!
+ *  \brief This function starts the LCD power-on initialization
+ *
+ *  Starts the LCD_POWER_UP_US wait after power-on and returns. The
+ *      instructions of the initialization sequence are then issued by
+ *      lcdInitPoll, one per call, as their hold times run out.
+ *
+ *  \return None
+ */
+extern void lcdInitStart(void);
+
+/*!
+ *  \brief This function advances the LCD initialization sequence
+ *
+ *  Never waits. Sends the next instruction if its hold time and the
+ *      previous instruction's execution time are over.
+ *
+ *  \return 1 once the display is initialized and idle, 0 otherwise
+ */
+extern uint8_t lcdInitPoll(void);
+
+/*!
+ *  \brief This function tells whether the last instruction is executing
+ *
+ *  \return 1 if a write now would have to wait, 0 otherwise
+ */
+extern uint8_t lcdIsBusy(void);
+
 /*!
  *  \brief This function prints character to current cursor position
  *
@@ -131,9 +177,129 @@ extern void lcdClearDisplay(void);
 
 void lcdDisplayTitleArtist(const char *songInfo);
 
-static void centerText(char *dest, const char *src, int srcLen);
+/*!
+ *  \brief This function sets the status tag shown on the artist row
+ *
+ *  The tag is right aligned at the end of the bottom row by every
+ *      following lcdDisplayTitleArtist, e.g. the playlist position "2/5".
+ *      The artist is centered, or scrolls, in the columns left of it with
+ *      one space between.
+ *
+ *  \param tag is up to LCD_TAG_MAX characters, "" to remove it
+ *
+ *  \return None
+ */
+extern void lcdSetStatusTag(const char *tag);
+
+/*!
+ *  \brief This function changes the status tag on the rows already shown
+ *
+ *  Sets the tag like lcdSetStatusTag, then rewrites only the artist row
+ *      cells it changes, and the title cells under a level bar hidden since
+ *      the last lcdDisplayTitleArtist, for tag and pause changes on the same
+ *      song. Writes nothing while no title is on screen.
+ *
+ *  \param tag is up to LCD_TAG_MAX characters, "" to remove it
+ *
+ *  \return None
+ */
+extern void lcdUpdateStatusTag(const char *tag);
+
+/*!
+ *  \brief This function defines a custom character in CGRAM
+ *
+ *  The glyph is shown by printing character code \b code + 8; codes 8-15
+ *      alias CGRAM 0-7 so custom glyphs never terminate a string.
+ *
+ *  \param code is the CGRAM slot (0-7)
+ *  \param rows is 8 rows of 5 pixels, bit 4 is the leftmost column
+ *
+ *  \return None
+ */
+extern void lcdDefineChar(uint8_t code, const uint8_t *rows);
 
-static void scrollText(char *dest, const char *src, int srcLen, int offset);
+/*!
+ *  \brief This function draws the horizontal level bar
+ *
+ *  The bar covers the right LCD_BAR_CELLS cells of the title row and is
+ *      drawn with CGRAM glyphs of 1-5 filled pixel columns. Only cells whose
+ *      glyph changed are written, and lcdDisplayTitleArtist keeps the bar in
+ *      place while it is shown. Hiding the bar writes nothing; the next
+ *      lcdDisplayTitleArtist or lcdUpdateStatusTag restores the title
+ *      underneath.
+ *
+ *  \param level is 0 to LCD_BAR_LEVELS, or LCD_BAR_OFF to hide the bar
+ *
+ *  \return None
+ */
+extern void lcdSetLevelBar(uint8_t level);
+
+#if LCD_MONITOR
+/*!
+ *  \brief This function records the visible display contents
+ *
+ *  Adds the 16x2 window of the DDRAM shadow with a millisecond timestamp
+ *      to the frame history. Called after every lcdDisplayTitleArtist.
+ *
+ *  \return None
+ */
+extern void lcdCaptureFrame(void);
+
+/*!
+ *  \brief This function sends the frame history over UART
+ *
+ *  One line per frame, oldest first: "F:<ms>|<line 1>|<line 2>\n"
+ *
+ *  \return None
+ */
+extern void lcdReportFrames(void);
+
+/*!
+ *  \brief This function sends LCD bus statistics over UART
+ *
+ *  Format: "L:W<writes> V<violations> S<stall> R<writes>/<ticks> H<rate>\n"
+ *      W counts bus writes, V writes issued before the previous
+ *      instruction's data sheet execution time, S MCLK ticks writers spent
+ *      waiting, R the bus writes and MCLK ticks of the last
+ *      lcdDisplayTitleArtist, H the average bus writes per second. A second
+ *      line "L:MAXHZ<n>" gives the refresh rate the last refresh cost allows.
+ *
+ *  \return None
+ */
+extern void lcdReportStats(void);
+
+/*!
+ *  \brief This function returns the number of LCD bus writes so far
+ *
+ *  \return bus writes since reset
+ */
+extern uint32_t lcdGetBusWrites(void);
+#endif
+
+/*!
+ *  \brief This function centers text in a line buffer
+ *
+ *  \param dest receives \b width characters and a terminator
+ *  \param src is the text, truncated to \b width
+ *  \param srcLen is the length of \b src
+ *  \param width is the number of columns, at most LCD_WIDTH
+ *
+ *  \return None
+ */
+extern void centerText(char *dest, const char *src, int srcLen, int width);
+
+/*!
+ *  \brief This function fills a window of scrolling text
+ *
+ *  \param dest receives \b width characters and a terminator
+ *  \param src is the text, repeated with SCROLL_PADDING spaces between
+ *  \param srcLen is the length of \b src
+ *  \param offset is the scroll position
+ *  \param width is the number of columns, at most LCD_WIDTH
+ *
+ *  \return None
+ */
+extern void scrollText(char *dest, const char *src, int srcLen, int offset, int width);
 
 
 //*****************************************************************************
@@ -0,0 +1,197 @@
+/*! \file */
+/*!
+ * microphone.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Microphone level meter, see microphone.h.
+ */
+
+#include <stdio.h>
+#include "microphone.h"
+#include "dma.h"
+#include "dsp.h"
+#include "profiler.h"
+#include "uart.h"
+
+/* Ping-pong halves, word storage keeps them aligned for the SIMD kernel */
+static uint32_t micWords[2][MIC_BLOCK_SIZE / 2];
+
+static volatile uint8_t readyMask = 0;     // bit per half, filled not processed
+static volatile uint8_t latestHalf = 0;
+static volatile uint32_t blockCount = 0;
+static volatile uint32_t overrunCount = 0;
+static uint8_t running = 0;
+
+static uint8_t lastHalf = 0;
+static uint32_t lastIndex = 0;
+static uint16_t lastRms = 0;
+static uint16_t lastPeak = 0;
+static uint32_t lastCycles = 0;
+
+static void armHalf(uint8_t half);
+
+void initMicrophone(void) {
+    // P5.5 tertiary function is analog input A0
+    MIC_PORT->SEL0 |= MIC_PIN;
+    MIC_PORT->SEL1 |= MIC_PIN;
+
+    // MODCLK, 16 cycle sample window, repeat single channel on TA0.1 edges
+    ADC14->CTL0 &= ~ADC14_CTL0_ENC;
+    ADC14->CTL0 = ADC14_CTL0_SHT0_2 | ADC14_CTL0_SHP | ADC14_CTL0_SSEL__MODCLK
+            | ADC14_CTL0_CONSEQ_2 | ADC14_CTL0_SHS_1 | ADC14_CTL0_ON;
+    ADC14->CTL1 = ADC14_CTL1_RES__14BIT;    // conversion into MEM[0]
+    ADC14->MCTL[0] = ADC14_MCTLN_INCH_0 | ADC14_MCTLN_VRSEL_0;  // A0, AVCC
+    ADC14->IER0 = 0;        // the DMA request is the only consumer
+
+    // ACLK is 32768Hz from REFO or LFXT in every clock profile
+    TIMER_A0->CTL = TIMER_A_CTL_SSEL__ACLK | TIMER_A_CTL_MC__STOP
+            | TIMER_A_CTL_CLR;
+    TIMER_A0->CCR[0] = MIC_ACLK_DIVIDER - 1;
+    TIMER_A0->CCR[1] = MIC_ACLK_DIVIDER / 2;
+    TIMER_A0->CCTL[1] = TIMER_A_CCTLN_OUTMOD_7;    // rising edge each period
+
+    initDMA();
+    DMA_Channel->CH_SRCCFG[DMA_CH_ADC] = DMA_SRC_ADC;
+    DMA_Control->USEBURSTCLR = 1 << DMA_CH_ADC;
+    DMA_Control->REQMASKCLR = 1 << DMA_CH_ADC;
+    DMA_Channel->INT2_SRCCFG = DMA_INT2_SRCCFG_EN | DMA_CH_ADC;
+}
+
+void micStart(void) {
+    if (running) {
+        return;
+    }
+    readyMask = 0;
+    armHalf(0);
+    armHalf(1);
+    DMA_Control->ALTCLR = 1 << DMA_CH_ADC;     // start on primary
+    NVIC_EnableIRQ(DMA_INT2_IRQn);
+    DMA_Control->ENASET = 1 << DMA_CH_ADC;
+
+    ADC14->CTL0 |= ADC14_CTL0_ENC;
+    TIMER_A0->CTL |= TIMER_A_CTL_CLR;
+    TIMER_A0->CTL |= TIMER_A_CTL_MC__UP;
+    running = 1;
+}
+
+void micStop(void) {
+    if (!running) {
+        return;
+    }
+    TIMER_A0->CTL = (TIMER_A0->CTL & ~TIMER_A_CTL_MC_MASK) | TIMER_A_CTL_MC__STOP;
+    ADC14->CTL0 &= ~ADC14_CTL0_ENC;
+    DMA_Control->ENACLR = 1 << DMA_CH_ADC;
+    NVIC_DisableIRQ(DMA_INT2_IRQn);
+    readyMask = 0;
+    lastRms = 0;
+    lastPeak = 0;
+    running = 0;
+}
+
+uint8_t micUpdate(void) {
+    DspBlockStats stats;
+    uint32_t start;
+    uint8_t half;
+
+    if (!readyMask) {
+        return 0;
+    }
+    half = latestHalf;
+    lastIndex = blockCount;
+    lastHalf = half;
+
+    PROFILE_BEGIN(PROF_MIC);
+    start = DWT->CYCCNT;
+    dspBlockStats((const uint16_t *)micWords[half], MIC_BLOCK_SIZE, &stats);
+    lastRms = dspRms(&stats);
+    lastPeak = dspPeak(&stats);
+    lastCycles = DWT->CYCCNT - start;
+    PROFILE_END(PROF_MIC);
+
+    __disable_irq();
+    if (latestHalf == half) {
+        if (readyMask & (1 << (half ^ 1))) {
+            overrunCount++;     // the older half was never looked at
+        }
+        readyMask = 0;
+    } else {
+        readyMask &= ~(1 << half);  // a newer block arrived meanwhile
+    }
+    __enable_irq();
+    return 1;
+}
+
+const uint16_t *micLastBlock(uint32_t *index) {
+    *index = lastIndex;
+    return (const uint16_t *)micWords[lastHalf];
+}
+
+uint32_t micBlockCount(void) {
+    return blockCount;
+}
+
+uint16_t micGetRms(void) {
+    return lastRms;
+}
+
+uint16_t micGetPeak(void) {
+    return lastPeak;
+}
+
+uint8_t micGetLevel(uint8_t levels) {
+    uint8_t msb = 0;
+    int16_t level;
+
+    if (lastRms == 0) {
+        return 0;
+    }
+    while (lastRms >> (msb + 1)) {
+        msb++;
+    }
+    // two steps per bit, the second once the next lower bit is set
+    level = 2 * msb - MIC_LEVEL_FLOOR;
+    if (msb && (lastRms & (1 << (msb - 1)))) {
+        level++;
+    }
+    if (level < 0) {
+        return 0;
+    }
+    return level > levels ? levels : (uint8_t)level;
+}
+
+void micReport(void) {
+    char buffer[64];
+
+    sprintf(buffer, "N:%u %u B%lu O%lu C%lu\n", lastRms, lastPeak,
+            (unsigned long)blockCount, (unsigned long)overrunCount,
+            (unsigned long)lastCycles);
+    sendString(buffer);
+}
+
+// Points one half of the ping-pong pair at its buffer for another block
+static void armHalf(uint8_t half) {
+    DmaControl *entry = half ? DMA_ALTERNATE(DMA_CH_ADC) : DMA_PRIMARY(DMA_CH_ADC);
+    uint16_t *buffer = (uint16_t *)micWords[half];
+
+    entry->srcEnd = &ADC14->MEM[0];
+    entry->dstEnd = &buffer[MIC_BLOCK_SIZE - 1];
+    entry->control = DMA_CTL_DST_INC_16 | DMA_CTL_DST_SIZE_16
+            | DMA_CTL_SRC_INC_NONE | DMA_CTL_SRC_SIZE_16 | DMA_CTL_ARB_1
+            | DMA_CTL_N(MIC_BLOCK_SIZE) | DMA_CTL_MODE_PINGPONG;
+}
+
+// DMA channel completion interrupt: one half of the sample buffer is full
+void DMA_INT2_IRQHandler(void)
+{
+    uint8_t half;
+
+    // the controller has moved on to the other half
+    half = (DMA_Control->ALTSET & (1 << DMA_CH_ADC)) ? 0 : 1;
+    if (readyMask & (1 << half)) {
+        overrunCount++;     // refilled before the main loop processed it
+    }
+    armHalf(half);
+    readyMask |= 1 << half;
+    latestHalf = half;
+    blockCount++;
+}
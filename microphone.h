@@ -0,0 +1,147 @@
+/*! \file */
+/*!
+ * microphone.h
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Microphone level meter for MSP432P4111.
+ *              ADC14 samples the microphone on P5.5 (A0) at MIC_SAMPLE_RATE,
+ *              triggered by Timer_A0 CCR1 from ACLK so clock profile changes
+ *              do not move the sample rate. DMA channel 7 copies results
+ *              into two MIC_BLOCK_SIZE buffers in ping-pong mode; the main
+ *              loop reduces each finished block to RMS and peak levels.
+ *              Uses ADC14, Timer_A0, DMA channel 7 (DMA_INT2) and P5.5
+ */
+
+#ifndef MICROPHONE_H_
+#define MICROPHONE_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "msp.h"
+
+#define MIC_PORT                P5
+#define MIC_PIN                 BIT5    // A0
+#define MIC_SAMPLE_RATE         8192    // ACLK / MIC_ACLK_DIVIDER
+#define MIC_ACLK_DIVIDER        4       // Timer_A0 period in ACLK ticks
+#define MIC_BLOCK_SIZE          256     // samples per ping-pong half, 31.25ms
+#define MIC_LEVEL_FLOOR         8       // RMS of 16 counts shows as level 0
+
+/* Duration of a number of blocks in milliseconds */
+#define MIC_BLOCKS_TO_MS(blocks) \
+    ((uint32_t)((uint64_t)(blocks) * MIC_BLOCK_SIZE * 1000 / MIC_SAMPLE_RATE))
+
+/*!
+ * \brief This function configures the microphone input
+ *
+ * This function sets up P5.5 as analog input A0, ADC14 for 14-bit repeated
+ *  single channel conversions triggered by Timer_A0 CCR1, and DMA channel 7.
+ *  Sampling does not start until micStart().
+ *
+ * Modified \b ADC14, \b TIMER_A0, \b P5 registers.
+ *
+ * \return None
+ */
+extern void initMicrophone(void);
+
+/*!
+ * \brief This function starts continuous sampling
+ *
+ * Safe to call while sampling is already running.
+ *
+ * \return None
+ */
+extern void micStart(void);
+
+/*!
+ * \brief This function stops sampling and clears the levels
+ *
+ * \return None
+ */
+extern void micStop(void);
+
+/*!
+ * \brief This function processes a finished block, called from the main loop
+ *
+ * This function runs the block statistics kernel over the newest finished
+ *  half of the ping-pong buffer. Halves that are refilled before the main
+ *  loop gets to them are counted as overruns.
+ *
+ * \return 1 if the levels were updated, 0 if no block was ready
+ */
+extern uint8_t micUpdate(void);
+
+/*!
+ * \brief This function returns the block micUpdate last processed
+ *
+ * The samples stay valid until the DMA refills that half, one block period
+ *  after micUpdate returned 1.
+ *
+ * \param index receives the block's sequence number, see micBlockCount
+ *
+ * \return MIC_BLOCK_SIZE samples, word aligned
+ */
+extern const uint16_t *micLastBlock(uint32_t *index);
+
+/*!
+ * \brief This function returns the number of blocks sampled
+ *
+ * The count only advances while sampling, so differences between two counts
+ *  measure time spent playing.
+ *
+ * \return blocks completed since power-up
+ */
+extern uint32_t micBlockCount(void);
+
+/*!
+ * \brief This function returns the AC RMS of the last block
+ *
+ * \return RMS in ADC counts (0 to 8191)
+ */
+extern uint16_t micGetRms(void);
+
+/*!
+ * \brief This function returns the peak deviation of the last block
+ *
+ * \return peak in ADC counts (0 to 8191)
+ */
+extern uint16_t micGetPeak(void);
+
+/*!
+ * \brief This function maps the last block's RMS to a meter level
+ *
+ * Levels are 3 dB apart (half a bit of RMS), starting at MIC_LEVEL_FLOOR.
+ *
+ * \param levels is the number of levels of the meter
+ *
+ * \return 0 to \b levels
+ */
+extern uint8_t micGetLevel(uint8_t levels);
+
+/*!
+ * \brief This function sends microphone statistics to the UART
+ *
+ * Sends "N:<rms> <peak> B<blocks> O<overruns> C<cycles per block>".
+ *
+ * \return None
+ */
+extern void micReport(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MICROPHONE_H_ */
@@ -0,0 +1,122 @@
+/*! \file */
+/*!
+ * pitch.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Fixed-point YIN pitch detector, see pitch.h.
+ */
+
+#include "pitch.h"
+#include "dsp.h"
+
+#define Q12_ONE             4096
+#define CENTS_A4            6900
+#define HZ_A4               440
+
+/* Mean removed block and the same block one sample later; word storage
+ *  keeps both aligned, so even lags read the first and odd lags the second
+ *  as sample pairs */
+static uint32_t centeredWords[PITCH_BLOCK_MAX / 2];
+static uint32_t shiftedWords[PITCH_BLOCK_MAX / 2];
+
+/* Cumulative mean normalized difference in Q12, indexed by lag */
+static uint16_t normalized[PITCH_MAX_LAG + 2];
+
+uint8_t pitchDetect(const uint16_t *samples, uint16_t count,
+                    PitchEstimate *estimate) {
+    int16_t *centered = (int16_t *)centeredWords;
+    int16_t *shifted = (int16_t *)shiftedWords;
+    DspBlockStats stats;
+    uint64_t difference;
+    uint64_t running = 0;
+    uint64_t scaled;
+    uint16_t window, mean, i;
+    uint8_t lag, candidate;
+    uint8_t minimum = 0;
+    int32_t a, b, c, curvature;
+    int32_t offsetQ8 = 0;
+
+    estimate->cents = PITCH_UNVOICED;
+    estimate->lagQ8 = 0;
+    estimate->aperiodicity = Q12_ONE;
+    estimate->lagsSearched = 0;
+    if (count < PITCH_MAX_LAG + 32 || count > PITCH_BLOCK_MAX) {
+        return 0;
+    }
+
+    dspBlockStats(samples, count, &stats);
+    if (dspRms(&stats) < PITCH_MIN_RMS) {
+        return 0;
+    }
+    mean = (uint16_t)(stats.sum / count);
+    for (i = 0; i < count; i++) {
+        centered[i] = (int16_t)(samples[i] - mean);
+    }
+    for (i = 0; i + 1 < count; i++) {
+        shifted[i] = centered[i + 1];
+    }
+
+    // every lag up to PITCH_MAX_LAG + 1 compares the same leading window
+    window = count - PITCH_MAX_LAG - 1;
+    normalized[0] = Q12_ONE;
+    for (lag = 1; lag <= PITCH_MAX_LAG + 1; lag++) {
+        difference = dspSquaredDifference(centered,
+                (lag & 1) ? shifted + lag - 1 : centered + lag, window);
+        running += difference;
+        scaled = running ? difference * lag * Q12_ONE / running : Q12_ONE;
+        normalized[lag] = scaled > 0xFFFF ? 0xFFFF : (uint16_t)scaled;
+        estimate->lagsSearched = lag;
+
+        // a lag is judged once its right neighbour is known
+        candidate = lag - 1;
+        if (candidate < PITCH_MIN_LAG) {
+            continue;
+        }
+        if (!minimum || normalized[candidate] < normalized[minimum]) {
+            minimum = candidate;
+        }
+        if (normalized[candidate] < PITCH_THRESHOLD_Q12
+                && normalized[lag] >= normalized[candidate]) {
+            minimum = candidate;    // bottom of the first dip, the period
+            break;
+        }
+    }
+
+    estimate->aperiodicity = normalized[minimum];
+    if (normalized[minimum] >= PITCH_ACCEPT_Q12) {
+        return 0;
+    }
+
+    // vertex of the parabola through the dip and its neighbours
+    a = normalized[minimum - 1];
+    b = normalized[minimum];
+    c = normalized[minimum + 1];
+    curvature = a - 2 * b + c;
+    if (curvature > 0) {
+        offsetQ8 = (a - c) * 128 / curvature;
+        if (offsetQ8 > 128) {
+            offsetQ8 = 128;
+        } else if (offsetQ8 < -128) {
+            offsetQ8 = -128;
+        }
+    }
+    estimate->lagQ8 = (uint16_t)(minimum * 256 + offsetQ8);
+    estimate->cents = pitchLagToCents(estimate->lagQ8);
+    return 1;
+}
+
+uint16_t pitchLagToCents(uint32_t lagQ8) {
+    uint64_t centsQ16;
+
+    if (lagQ8 < 256) {
+        lagQ8 = 256;
+    } else if (lagQ8 > 0xFFFF) {
+        lagQ8 = 0xFFFF;
+    }
+    // 6900 + 1200 * log2(f / 440) with f = rate / lag, kept non-negative
+    centsQ16 = ((uint64_t)CENTS_A4 << 16)
+            + 1200ull * dspLog2Q16((uint32_t)PITCH_SAMPLE_RATE * 256)
+            - 1200ull * dspLog2Q16(HZ_A4)
+            - 1200ull * dspLog2Q16(lagQ8);
+    return (uint16_t)((centsQ16 + 0x8000) >> 16);
+}
@@ -0,0 +1,89 @@
+/*! \file */
+/*!
+ * pitch.h
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Fixed-point YIN pitch detector for one block of microphone
+ *              samples. The difference function for every lag comes from
+ *              dspSquaredDifference, so the inner loop is one SSUB16 and one
+ *              SMLALD per sample pair. The search stops at the first dip of
+ *              the normalized difference below PITCH_THRESHOLD_Q12, so a
+ *              clean note costs a fraction of the worst case.
+ *
+ *              No hardware access.
+ */
+
+#ifndef PITCH_H_
+#define PITCH_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+#define PITCH_SAMPLE_RATE       8192    // Hz, same as MIC_SAMPLE_RATE
+#define PITCH_BLOCK_MAX         256     // samples, same as MIC_BLOCK_SIZE
+#define PITCH_MIN_HZ            80
+#define PITCH_MAX_HZ            1000
+#define PITCH_MIN_LAG           (PITCH_SAMPLE_RATE / PITCH_MAX_HZ)
+#define PITCH_MAX_LAG           (PITCH_SAMPLE_RATE / PITCH_MIN_HZ)
+#define PITCH_THRESHOLD_Q12     614     // 0.15, first dip taken as the period
+#define PITCH_ACCEPT_Q12        1434    // 0.35, best dip must be below this
+#define PITCH_MIN_RMS           24      // ADC counts, quieter blocks unvoiced
+#define PITCH_UNVOICED          0       // cents value when there is no pitch
+
+/* Noise evaluates every lag, roughly 60000 cycles at PITCH_BLOCK_MAX; the
+ *  rest is headroom for interrupts */
+#define PITCH_BUDGET_CYCLES     96000   // 2ms of a 31.25ms block at 48MHz
+
+typedef struct _PitchEstimate {
+    uint16_t cents;             // MIDI note x100 (A4 = 6900), or PITCH_UNVOICED
+    uint16_t lagQ8;             // period in samples, 8 fractional bits
+    uint16_t aperiodicity;      // normalized difference at the period, Q12
+    uint8_t lagsSearched;       // difference function evaluations
+} PitchEstimate;
+
+/*!
+ * \brief This function estimates the pitch of one block
+ *
+ * This function removes the block mean, evaluates the YIN cumulative mean
+ *  normalized difference for lags 1 up to PITCH_MAX_LAG and refines the
+ *  chosen lag with a parabola through its neighbours. Blocks quieter than
+ *  PITCH_MIN_RMS, or with no dip below PITCH_ACCEPT_Q12, are unvoiced.
+ *
+ * \param samples is the block of unsigned 14-bit ADC results
+ * \param count is the number of samples, PITCH_MAX_LAG + 32 to PITCH_BLOCK_MAX
+ * \param estimate receives the result
+ *
+ * \return 1 if the block is voiced, 0 if not
+ */
+extern uint8_t pitchDetect(const uint16_t *samples, uint16_t count,
+                           PitchEstimate *estimate);
+
+/*!
+ * \brief This function converts a period to a pitch
+ *
+ * \param lagQ8 is the period in samples with 8 fractional bits
+ *
+ * \return pitch in cents, MIDI note x100 (A4 = 6900)
+ */
+extern uint16_t pitchLagToCents(uint32_t lagQ8);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PITCH_H_ */
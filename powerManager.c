@@ -0,0 +1,203 @@
+/*! \file */
+/*!
+ * powerManager.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Dynamic frequency and voltage scaling policy. HIGH and LOW
+ *              map to clockManager profiles; this module decides when to
+ *              switch and keeps transition statistics.
+ */
+
+#include <stdio.h>
+#include "msp.h"
+#include "powerManager.h"
+#include "clockManager.h"
+#include "timer32.h"
+#include "rtc.h"
+#include "uart.h"
+#include "trace.h"
+
+typedef struct _TransitionStats {
+    uint32_t count;
+    uint32_t lastCycles;
+    uint32_t maxCycles;
+} TransitionStats;
+
+static PowerState powerState = POWER_STATE_HIGH;
+static uint32_t lastActivity = 0;
+static uint32_t stateEntered = 0;
+
+/* Indexed by the state being entered */
+static TransitionStats transitions[2];
+static uint32_t timeInState[2];
+
+/* LPM3 statistics, latency in RTC ticks */
+static volatile uint8_t wakeStamped = 0;    // wakeTicks is from this wake
+static volatile uint8_t wakePending = 0;
+static uint16_t wakeTicks = 0;
+static uint32_t rxWakeTime = 0;
+static uint8_t rxWakeHold = 0;
+static uint32_t sleepCount = 0;
+static uint32_t lastWakeLatency = 0;
+static uint32_t maxWakeLatency = 0;
+static uint32_t lastSyncTime = 0;
+static uint32_t rtcOffset = 0;      // system time when the RTC started
+static int32_t resyncError = 0;
+static int32_t resyncPpm = 0;
+
+/* The RTC counts from initRTC(), well after Timer32 started; system time
+ *  follows the RTC shifted by the time it had already reached then */
+static uint32_t rtcSystemTime(void) {
+    return rtcGetMillis() + rtcOffset;
+}
+
+static void enterState(PowerState state) {
+    TransitionStats *stats = &transitions[state];
+    uint32_t start, cycles, now;
+
+    now = getSystemTime();
+    timeInState[powerState] += now - stateEntered;
+    stateEntered = now;
+
+    start = DWT->CYCCNT;
+    clockSetProfile(state == POWER_STATE_HIGH
+                    ? CLOCK_PROFILE_HFXT_48MHZ : CLOCK_PROFILE_DCO_12MHZ);
+    cycles = DWT->CYCCNT - start;
+
+    powerState = state;
+    stats->count++;
+    stats->lastCycles = cycles;
+    if (cycles > stats->maxCycles) {
+        stats->maxCycles = cycles;
+    }
+}
+
+void initPowerManager(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    clockSetProfile(CLOCK_PROFILE_HFXT_48MHZ);
+    initRTC();
+    rtcOffset = getSystemTime() - rtcGetMillis();
+    powerState = POWER_STATE_HIGH;
+    lastActivity = getSystemTime();
+    stateEntered = lastActivity;
+    lastSyncTime = lastActivity;
+}
+
+void powerActivity(void) {
+    uint32_t latency;
+
+    lastActivity = getSystemTime();
+    if (powerState != POWER_STATE_HIGH) {
+        enterState(POWER_STATE_HIGH);
+    }
+    if (wakePending) {
+        wakePending = 0;
+        latency = (rtcGetTicks() - wakeTicks) & (RTC_TICKS_PER_SECOND - 1);
+        lastWakeLatency = latency;
+        if (latency > maxWakeLatency) {
+            maxWakeLatency = latency;
+        }
+    }
+}
+
+void powerMarkWake(void) {
+    // the time was taken as LPM3 ended, before this handler could run
+    if (wakeStamped) {
+        wakePending = 1;
+    }
+}
+
+uint8_t powerSleep(void) {
+    uint32_t rtcTime, span;
+    int32_t error;
+
+    if (powerState != POWER_STATE_LOW) {
+        return 0;
+    }
+    // a byte on RX woke us, give the command that follows time to arrive
+    if (rxWakeHold) {
+        if (getSystemTime() - rxWakeTime < POWER_RX_AWAKE_MS) {
+            return 0;
+        }
+        rxWakeHold = 0;
+    }
+
+    // Timer32 ran since the last resync, compare it with the RTC
+    rtcTime = rtcSystemTime();
+    span = rtcTime - lastSyncTime;
+    if (span >= 1000) {
+        error = (int32_t)(getSystemTime() - rtcTime);
+        resyncError = error;
+        resyncPpm = (int32_t)((int64_t)error * 1000000 / (int32_t)span);
+    }
+
+    // PRIMASK holds off the handlers until the clocks are back, a pending
+    //  interrupt still ends WFI
+    TRACE(TRACE_SLEEP, 0);
+    __disable_irq();
+    uartSleep();
+    SCB->SCR |= SCB_SCR_SLEEPDEEP_Msk;
+    PCM->CTL0 = PCM_CTL0_KEY_VAL | (PCM->CTL0 & ~(PCM_CTL0_KEY_MASK | PCM_CTL0_LPMR_MASK))
+                | PCM_CTL0_LPMR__LPM3;
+    __wfi();
+    // wake latency starts here, not when the wake source's handler gets in
+    wakeTicks = rtcGetTicks();
+    wakeStamped = 1;
+    SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+    rxWakeHold = uartWake();
+    TRACE(TRACE_WAKE, 0);
+    __enable_irq();     // the pending handler runs here
+    wakeStamped = 0;
+
+    // time asleep counts toward the LOW state through the resync
+    sleepCount++;
+    setSystemTime(rtcSystemTime());
+    lastSyncTime = getSystemTime();
+    rxWakeTime = lastSyncTime;
+    return 1;
+}
+
+void powerUpdate(void) {
+    if (powerState == POWER_STATE_HIGH
+            && getSystemTime() - lastActivity >= POWER_IDLE_TIMEOUT_MS) {
+        enterState(POWER_STATE_LOW);
+    }
+}
+
+PowerState powerGetState(void) {
+    return powerState;
+}
+
+void powerReportStats(void) {
+    char buffer[96];
+    uint32_t inState[2];
+    uint32_t now = getSystemTime();
+
+    inState[POWER_STATE_LOW] = timeInState[POWER_STATE_LOW];
+    inState[POWER_STATE_HIGH] = timeInState[POWER_STATE_HIGH];
+    inState[powerState] += now - stateEntered;
+
+    sprintf(buffer, "V:H%lu L%lu U%lu/%lu/%lu D%lu/%lu/%lu\n",
+            (unsigned long)inState[POWER_STATE_HIGH],
+            (unsigned long)inState[POWER_STATE_LOW],
+            (unsigned long)transitions[POWER_STATE_HIGH].count,
+            (unsigned long)transitions[POWER_STATE_HIGH].lastCycles,
+            (unsigned long)transitions[POWER_STATE_HIGH].maxCycles,
+            (unsigned long)transitions[POWER_STATE_LOW].count,
+            (unsigned long)transitions[POWER_STATE_LOW].lastCycles,
+            (unsigned long)transitions[POWER_STATE_LOW].maxCycles);
+    sendString(buffer);
+}
+
+void powerReportSleepStats(void) {
+    char buffer[80];
+
+    sprintf(buffer, "W:S%lu L%lu/%lu E%ld P%ld\n",
+            (unsigned long)sleepCount,
+            (unsigned long)(lastWakeLatency * 1000000 / RTC_TICKS_PER_SECOND),
+            (unsigned long)(maxWakeLatency * 1000000 / RTC_TICKS_PER_SECOND),
+            (long)resyncError, (long)resyncPpm);
+    sendString(buffer);
+}
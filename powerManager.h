@@ -0,0 +1,138 @@
+/*! \file */
+/*!
+ * powerManager.h
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Dynamic frequency and voltage scaling policy. The machine
+ *              runs in the HIGH state (VCORE1, 48MHz HFXT) while the user
+ *              is interacting and drops to the LOW state (VCORE0, 12MHz
+ *              DCO) after POWER_IDLE_TIMEOUT_MS without activity. Clock
+ *              changes go through clockManager so drivers are rescaled.
+ *
+ *              When LOW and nothing is pending, powerSleep() enters LPM3.
+ *              RTC_C (LFXT) keeps time and wakes the CPU every second; a
+ *              switch press wakes it through the PORT3 interrupt. Timer32
+ *              stops in LPM3 and is resynced from the RTC on every wake.
+ *              eUSCI_A0 stops too: a start bit on RX wakes the CPU but
+ *              that byte is lost, so the ESP32 sends UART_WAKE_BYTE first.
+ */
+
+#ifndef POWERMANAGER_H_
+#define POWERMANAGER_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+#define POWER_IDLE_TIMEOUT_MS   5000
+#define POWER_RX_AWAKE_MS       50      // awake after a UART wake byte
+
+typedef enum _PowerState {
+    POWER_STATE_LOW, POWER_STATE_HIGH
+} PowerState;
+
+/*!
+ * \brief This function starts the power manager in the HIGH state
+ *
+ * Enables the DWT cycle counter used for transition latency figures.
+ * Timer32_Init() must have been called, time in state uses its ms tick.
+ * Starts the RTC, which then keeps system time through LPM3 without
+ * setting it back.
+ *
+ * \return None
+ */
+extern void initPowerManager(void);
+
+/*!
+ * \brief This function records user activity
+ *
+ * Switches to the HIGH state if needed and restarts the idle timeout.
+ * Call on button presses and received commands, before handling them.
+ *
+ * \return None
+ */
+extern void powerActivity(void);
+
+/*!
+ * \brief This function applies the idle policy
+ *
+ * Drops to the LOW state once POWER_IDLE_TIMEOUT_MS has passed since the
+ * last activity. Call from the main loop.
+ *
+ * \return None
+ */
+extern void powerUpdate(void);
+
+/*!
+ * \brief This function returns the current power state
+ *
+ * \return POWER_STATE_LOW or POWER_STATE_HIGH
+ */
+extern PowerState powerGetState(void);
+
+/*!
+ * \brief This function enters LPM3 until the next interrupt
+ *
+ * Only sleeps in the LOW state. The caller must make sure no peripheral
+ *  clocked from SMCLK or MCLK is busy (stepper, UART). On wake, Timer32
+ *  time is compared with the RTC to track drift and then resynced. After a
+ *  wake by a byte on UART RX it stays awake for POWER_RX_AWAKE_MS.
+ *
+ * \return 1 if the CPU slept, 0 if the call returned immediately
+ */
+extern uint8_t powerSleep(void);
+
+/*!
+ * \brief This function marks a wakeup as caused by user input
+ *
+ * Call from the interrupt handler of a user input (switch) so the next
+ *  powerActivity() records the latency from the end of LPM3, timestamped
+ *  by powerSleep() before any handler ran. No effect outside a wakeup.
+ *
+ * \return None
+ */
+extern void powerMarkWake(void);
+
+/*!
+ * \brief This function sends DVFS statistics over UART
+ *
+ * Format: "V:H<ms> L<ms> U<count>/<last>/<max> D<count>/<last>/<max>\n"
+ * where H and L are total milliseconds spent in each state, and U and D
+ * are up and down transitions with the last and worst latency in CPU
+ * cycles (counted across the clock switch, so the unit is approximate).
+ *
+ * \return None
+ */
+extern void powerReportStats(void);
+
+/*!
+ * \brief This function sends LPM3 sleep statistics over UART
+ *
+ * Format: "W:S<sleeps> L<last>/<max> E<error> P<ppm>\n" where L is wake to
+ * responsive latency in microseconds (RTC resolution, 31us), E is the
+ * Timer32 error in ms against the RTC over the last awake period before
+ * resync and P the same error in parts per million.
+ *
+ * \return None
+ */
+extern void powerReportSleepStats(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* POWERMANAGER_H_ */
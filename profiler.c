@@ -0,0 +1,230 @@
+/*! \file */
+/*!
+ * profiler.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: CPU budget accounting per subsystem using the DWT cycle
+ *              counter.
+ */
+
+#include <stdio.h>
+#include "msp.h"
+#include "profiler.h"
+#include "clockManager.h"
+#include "timer32.h"
+#include "uart.h"
+
+typedef struct _ProfileEntry {
+    uint32_t count;
+    uint64_t total;
+    uint32_t min;
+    uint32_t peak;
+    uint32_t overruns;
+    uint32_t lastOverrun;
+} ProfileEntry;
+
+static const char * const profileNames[PROF_COUNT] = {
+    "lcd", "uart", "stepper", "t32", "ui", "disp", "cmd", "mic", "pitch"
+};
+
+static ProfileEntry entries[PROF_COUNT];
+static uint32_t resetTime = 0;
+
+/* Budgets in microseconds and in cycles at the current MCLK */
+static uint32_t budgetMicros[PROF_COUNT] = {
+    BUDGET_LCD_US, BUDGET_UART_US, BUDGET_STEPPER_ISR_US,
+    BUDGET_TIMER32_ISR_US, BUDGET_STATE_MACHINE_US, BUDGET_DISPLAY_US,
+    BUDGET_UART_CMD_US, BUDGET_MIC_US, BUDGET_PITCH_US
+};
+static uint32_t budgetCycles[PROF_COUNT];
+static volatile uint16_t alarmMask = 0;    // bit per section, new overruns
+
+static const char * const bootNames[BOOT_COUNT] = {
+    "clock", "init", "status", "lcd", "frame", "rtc"
+};
+
+/* Boot clock: microseconds up to bootCycles, then cycles at bootMhz */
+static uint32_t bootMicros[BOOT_COUNT];
+static uint32_t bootBaseMicros = 0;
+static uint32_t bootCycles = 0;
+static uint32_t bootMhz = 3;            // MCLK out of reset
+
+static void updateBudgetCycles(ProfileId id) {
+    budgetCycles[id] = budgetMicros[id] * (getMCLKFrequency() / 1000000);
+}
+
+/* Budgets are times, rescale their cycle counts with MCLK */
+static void profilerClockChanged(ClockEvent event) {
+    uint8_t i;
+
+    if (event == CLOCK_POST_CHANGE) {
+        for (i = 0; i < PROF_COUNT; i++) {
+            updateBudgetCycles((ProfileId)i);
+        }
+    }
+}
+
+static uint32_t bootNow(void) {
+    return bootBaseMicros + (DWT->CYCCNT - bootCycles) / bootMhz;
+}
+
+/* Fold the time at the old MCLK in once the new one is running */
+static void bootClockChanged(ClockEvent event) {
+    if (event == CLOCK_POST_CHANGE) {
+        bootBaseMicros = bootNow();
+        bootCycles = DWT->CYCCNT;
+        bootMhz = getMCLKFrequency() / 1000000;
+    }
+}
+
+void profileBootStart(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    bootBaseMicros = 0;
+    bootCycles = 0;
+    bootMhz = getMCLKFrequency() / 1000000;
+    clockRegisterListener(bootClockChanged);
+}
+
+void profileBootMark(BootMilestone milestone) {
+    if (!bootMicros[milestone]) {
+        bootMicros[milestone] = bootNow();
+    }
+}
+
+void profileReportBoot(void) {
+    char buffer[112];
+    uint8_t length = 0;
+    uint8_t i;
+
+    buffer[length++] = 'O';
+    buffer[length++] = ':';
+    for (i = 0; i < BOOT_COUNT; i++) {
+        length += sprintf(buffer + length, "%s%s%lu", i ? " " : "",
+                          bootNames[i], (unsigned long)bootMicros[i]);
+    }
+    buffer[length++] = '\n';
+    buffer[length] = '\0';
+    sendString(buffer);
+}
+
+void initProfiler(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    profilerClockChanged(CLOCK_POST_CHANGE);
+    clockRegisterListener(profilerClockChanged);
+    profileReset();
+}
+
+void profileSetBudget(ProfileId id, uint32_t micros) {
+    budgetMicros[id] = micros;
+    updateBudgetCycles(id);
+}
+
+void profileRecord(ProfileId id, uint32_t cycles) {
+    ProfileEntry *entry = &entries[id];
+    uint32_t primask = __get_PRIMASK();
+
+    // main loop and ISRs may share an entry
+    __disable_irq();
+    entry->count++;
+    entry->total += cycles;
+    if (cycles < entry->min) {
+        entry->min = cycles;
+    }
+    if (cycles > entry->peak) {
+        entry->peak = cycles;
+    }
+    if (budgetCycles[id] && cycles > budgetCycles[id]) {
+        entry->overruns++;
+        entry->lastOverrun = cycles;
+        alarmMask |= 1 << id;
+    }
+    __set_PRIMASK(primask);
+}
+
+void profileReset(void) {
+    uint32_t primask = __get_PRIMASK();
+    uint8_t i;
+
+    __disable_irq();
+    for (i = 0; i < PROF_COUNT; i++) {
+        entries[i].count = 0;
+        entries[i].total = 0;
+        entries[i].min = 0xFFFFFFFF;
+        entries[i].peak = 0;
+        entries[i].overruns = 0;
+        entries[i].lastOverrun = 0;
+    }
+    alarmMask = 0;
+    resetTime = getSystemTime();
+    __set_PRIMASK(primask);
+}
+
+void profileReport(void) {
+    char buffer[96];
+    ProfileEntry entry;
+    uint32_t primask = __get_PRIMASK();
+    uint8_t i;
+
+    sprintf(buffer, "J:{\"ms\":%lu,\"mclk\":%lu,\"p\":[",
+            (unsigned long)(getSystemTime() - resetTime),
+            (unsigned long)getMCLKFrequency());
+    sendString(buffer);
+    for (i = 0; i < PROF_COUNT; i++) {
+        __disable_irq();
+        entry = entries[i];         // consistent copy
+        __set_PRIMASK(primask);
+        sprintf(buffer, "%s{\"n\":\"%s\",\"c\":%lu,\"kcyc\":%lu,\"avg\":%lu,\"peak\":%lu}",
+                i ? "," : "", profileNames[i],
+                (unsigned long)entry.count,
+                (unsigned long)(entry.total / 1000),
+                (unsigned long)(entry.count ? entry.total / entry.count : 0),
+                (unsigned long)entry.peak);
+        sendString(buffer);
+    }
+    sendString("]}\n");
+}
+
+void profileReportBudgets(void) {
+    char buffer[80];
+    ProfileEntry entry;
+    uint32_t primask = __get_PRIMASK();
+    uint8_t i;
+
+    for (i = 0; i < PROF_COUNT; i++) {
+        __disable_irq();
+        entry = entries[i];
+        __set_PRIMASK(primask);
+        sprintf(buffer, "T:%s %lu %lu/%lu/%lu B%lu O%lu\n", profileNames[i],
+                (unsigned long)entry.count,
+                (unsigned long)(entry.count ? entry.min : 0),
+                (unsigned long)(entry.count ? entry.total / entry.count : 0),
+                (unsigned long)entry.peak,
+                (unsigned long)budgetMicros[i],
+                (unsigned long)entry.overruns);
+        sendString(buffer);
+    }
+}
+
+void profileCheckAlarms(void) {
+    char buffer[48];
+    uint16_t pending;
+    uint32_t primask = __get_PRIMASK();
+    uint8_t i;
+
+    __disable_irq();
+    pending = alarmMask;
+    alarmMask = 0;
+    __set_PRIMASK(primask);
+
+    for (i = 0; pending; i++, pending >>= 1) {
+        if (pending & 1) {
+            sprintf(buffer, "A:%s %lu B%lu\n", profileNames[i],
+                    (unsigned long)entries[i].lastOverrun,
+                    (unsigned long)budgetMicros[i]);
+            sendString(buffer);
+        }
+    }
+}
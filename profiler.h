@@ -0,0 +1,195 @@
+/*! \file */
+/*!
+ * profiler.h
+ * ECE230 Winter 2024-2025
+ *
+ * Description: CPU budget accounting per subsystem using the DWT cycle
+ *              counter. Sections are bracketed with PROFILE_BEGIN and
+ *              PROFILE_END; each records count, total, min and peak cycles
+ *              and counts overruns of a per-section time budget.
+ *              Sections are inclusive: an ISR that preempts a main loop
+ *              section is counted in both.
+ */
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include "msp.h"
+
+/* 1 to collect figures, 0 compiles all instrumentation out. On with
+ *  KARAOKE_DIAGNOSTICS */
+#ifndef PROFILER_ENABLED
+#ifdef KARAOKE_DIAGNOSTICS
+#define PROFILER_ENABLED    1
+#else
+#define PROFILER_ENABLED    0
+#endif
+#endif
+
+typedef enum _ProfileId {
+    PROF_LCD,                   // LCD bus writes, including execution waits
+    PROF_UART,                  // eUSCI_A0 RX ISR
+    PROF_STEPPER_ISR,           // Timer_A3 scheduler and DMA refill ISRs
+    PROF_TIMER32_ISR,           // 1ms system tick
+    PROF_STATE_MACHINE,         // button event dispatch and screen render
+    PROF_DISPLAY,               // main loop scroll refresh
+    PROF_UART_CMD,              // main loop command handling
+    PROF_MIC,                   // microphone block statistics
+    PROF_PITCH,                 // pitch detection and scoring of one block
+    PROF_COUNT
+} ProfileId;
+
+/* Default budgets in microseconds, 0 for no budget */
+#define BUDGET_LCD_US           2100    // longest instruction plus margin
+#define BUDGET_UART_US          20      // one received byte
+#define BUDGET_STEPPER_ISR_US   20
+#define BUDGET_TIMER32_ISR_US   5
+#define BUDGET_STATE_MACHINE_US 5000
+#define BUDGET_DISPLAY_US       6000
+#define BUDGET_UART_CMD_US      2000
+#define BUDGET_MIC_US           200     // one 256 sample block
+#define BUDGET_PITCH_US         2000    // PITCH_BUDGET_CYCLES at 48MHz
+
+/* Boot milestones, microseconds since main() */
+typedef enum _BootMilestone {
+    BOOT_CLOCK,                 // HFXT running
+    BOOT_INIT,                  // peripherals configured, LCD still starting
+    BOOT_FIRST_STATUS,          // first status line sent to the ESP32
+    BOOT_LCD_READY,             // LCD initialization sequence done
+    BOOT_FIRST_FRAME,           // first screen drawn
+    BOOT_RTC,                   // LFXT and RTC running, boot complete
+    BOOT_COUNT
+} BootMilestone;
+
+#if PROFILER_ENABLED
+#define PROFILE_BEGIN(id)   uint32_t profileStart_##id = DWT->CYCCNT
+#define PROFILE_END(id)     profileRecord((id), DWT->CYCCNT - profileStart_##id)
+#else
+#define PROFILE_BEGIN(id)
+#define PROFILE_END(id)
+#endif
+
+/*!
+ * \brief This function starts the DWT cycle counter and clears all figures
+ *
+ * \return None
+ */
+extern void initProfiler(void);
+
+/*!
+ * \brief This function sets the time budget of a section
+ *
+ * Runs longer than the budget count as overruns and raise an alarm. The
+ *  budget is kept in time, so it follows MCLK changes.
+ *
+ * \param id is the section
+ * \param micros is the budget in microseconds, 0 disables the check
+ *
+ * \return None
+ */
+extern void profileSetBudget(ProfileId id, uint32_t micros);
+
+/*!
+ * \brief This function adds one run of a section
+ *
+ * Safe to call from ISRs. Use through PROFILE_END.
+ *
+ * \param id is the section being recorded
+ * \param cycles is the duration of the run in CPU cycles
+ *
+ * \return None
+ */
+extern void profileRecord(ProfileId id, uint32_t cycles);
+
+/*!
+ * \brief This function clears all figures
+ *
+ * \return None
+ */
+extern void profileReset(void);
+
+/*!
+ * \brief This function sends all figures over UART as one JSON line
+ *
+ * Format: J:{"ms":<since reset>,"mclk":<Hz>,"p":[{"n":"<name>","c":<count>,
+ *  "kcyc":<total kilocycles>,"avg":<cycles>,"peak":<cycles>},...]}
+ *
+ * \return None
+ */
+extern void profileReport(void);
+
+/*!
+ * \brief This function sends per-section budget figures over UART
+ *
+ * One compact line per section:
+ *  "T:<name> <count> <min>/<avg>/<max> B<budget> O<overruns>\n"
+ *  with times in CPU cycles and the budget in microseconds.
+ *
+ * \return None
+ */
+extern void profileReportBudgets(void);
+
+/*!
+ * \brief This function reports new overruns over UART
+ *
+ * Sends "A:<name> <cycles> B<budget>\n" once for each section that
+ *  overran since the last call, with the duration of its latest overrun.
+ *  Call from the main loop.
+ *
+ * \return None
+ */
+extern void profileCheckAlarms(void);
+
+/*!
+ * \brief This function starts boot time measurement
+ *
+ * Call first thing in main. Boot time is kept in microseconds across
+ *  clock changes, time spent switching is counted at the old MCLK.
+ *
+ * \return None
+ */
+extern void profileBootStart(void);
+
+/*!
+ * \brief This function records a boot milestone
+ *
+ * Only the first call for each milestone counts.
+ *
+ * \param milestone is the milestone reached
+ *
+ * \return None
+ */
+extern void profileBootMark(BootMilestone milestone);
+
+/*!
+ * \brief This function sends the boot milestones over UART
+ *
+ * Format: "O:clock<us> init<us> status<us> lcd<us> frame<us> rtc<us>\n"
+ *  with 0 for milestones not reached.
+ *
+ * \return None
+ */
+extern void profileReportBoot(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PROFILER_H_ */
@@ -0,0 +1,62 @@
+/*! \file */
+/*!
+ * rtc.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: RTC_C wall clock fed by the 32kHz LFXT.
+ */
+
+#include "msp.h"
+#include "rtc.h"
+#include "clockManager.h"
+
+/* Seconds since initRTC(), counted by the RTC ready interrupt */
+static volatile uint32_t rtcSeconds = 0;
+
+void initRTC(void) {
+    clockStartLFXT();
+
+    RTC_C->CTL0 = (RTC_C->CTL0 & ~RTC_C_CTL0_KEY_MASK) | RTC_C_KEY;  // Unlock
+    // Calendar mode, binary format, held while the time is set
+    RTC_C->CTL13 = RTC_C_CTL13_HOLD | RTC_C_CTL13_MODE;
+    RTC_C->TIM0 = 0;                    // minutes, seconds
+    RTC_C->TIM1 = 0;                    // day of week, hours
+    RTC_C->DATE = (1 << RTC_C_DATE_MON_OFS) | 1;
+    RTC_C->YEAR = 2025;
+    rtcSeconds = 0;
+
+    RTC_C->CTL0 = (RTC_C->CTL0 & ~(RTC_C_CTL0_KEY_MASK | RTC_C_CTL0_RDYIFG))
+                  | RTC_C_KEY | RTC_C_CTL0_RDYIE;
+    RTC_C->CTL13 &= ~RTC_C_CTL13_HOLD;  // Start counting
+    RTC_C->CTL0 = RTC_C->CTL0 & ~RTC_C_CTL0_KEY_MASK;                // Lock
+
+    NVIC_EnableIRQ(RTC_C_IRQn);
+}
+
+uint32_t rtcGetSeconds(void) {
+    return rtcSeconds;
+}
+
+uint16_t rtcGetTicks(void) {
+    return RTC_C->PS & (RTC_TICKS_PER_SECOND - 1);
+}
+
+uint32_t rtcGetMillis(void) {
+    uint32_t seconds;
+    uint16_t ticks;
+
+    // retry if the second rolled over between the two reads
+    do {
+        seconds = rtcSeconds;
+        ticks = rtcGetTicks();
+    } while (seconds != rtcSeconds);
+
+    return seconds * 1000 + (((uint32_t)ticks * 1000) >> 15);
+}
+
+// RTC_C interrupt: once per second when the time registers update
+void RTC_C_IRQHandler(void) {
+    if (RTC_C->IV == RTC_C_IV_RTCRDYIFG) {
+        rtcSeconds++;
+    }
+}
@@ -0,0 +1,78 @@
+/*! \file */
+/*!
+ * rtc.h
+ * ECE230 Winter 2024-2025
+ *
+ * Description: RTC_C wall clock fed by the 32kHz LFXT. Keeps running in
+ *              LPM3 while Timer32 (MCLK) is stopped, raises a once per
+ *              second interrupt that doubles as the sleep wakeup tick, and
+ *              provides millisecond time for resyncing Timer32 after wake.
+ */
+
+#ifndef RTC_H_
+#define RTC_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+#define RTC_TICKS_PER_SECOND    32768   // RTCPS resolution
+
+/*!
+ * \brief This function starts LFXT and RTC_C in calendar mode
+ *
+ * Time starts at 0 and counts up. Enables the RTC ready interrupt
+ *  (1Hz) in the NVIC.
+ *
+ * Modified RTC_C registers, ACLK is switched to LFXT through clockManager.
+ *
+ * \return None
+ */
+extern void initRTC(void);
+
+/*!
+ * \brief This function returns seconds since initRTC()
+ *
+ * \return whole seconds
+ */
+extern uint32_t rtcGetSeconds(void);
+
+/*!
+ * \brief This function returns milliseconds since initRTC()
+ *
+ * Combines the seconds count with the RTCPS prescaler for sub-second
+ *  resolution. Call with interrupts enabled.
+ *
+ * \return milliseconds
+ */
+extern uint32_t rtcGetMillis(void);
+
+/*!
+ * \brief This function returns the free-running sub-second counter
+ *
+ * Counts RTC_TICKS_PER_SECOND per second and wraps every second. Useful
+ *  for short, clock-independent interval measurements.
+ *
+ * \return RTCPS value, 0 to RTC_TICKS_PER_SECOND - 1
+ */
+extern uint16_t rtcGetTicks(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RTC_H_ */
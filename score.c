@@ -0,0 +1,124 @@
+/*! \file */
+/*!
+ * score.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Karaoke scoring against a reference pitch track, see score.h.
+ */
+
+#include <stdio.h>
+#include "score.h"
+#include "uart.h"
+
+typedef struct _ReferenceEvent {
+    uint32_t ms;
+    uint8_t note;
+} ReferenceEvent;
+
+/* Events not yet due, oldest at head */
+static ReferenceEvent track[SCORE_TRACK_SIZE];
+static uint8_t head = 0;
+static uint8_t count = 0;
+static uint32_t lastEventMs = 0;
+static uint8_t hasTrack = 0;
+static uint8_t currentNote = SCORE_REST;
+
+/* Totals for the current song */
+static uint32_t marks = 0;
+static uint16_t scored = 0;
+static uint16_t onPitch = 0;
+static uint16_t unvoiced = 0;
+static uint16_t dropped = 0;
+
+static uint8_t marksFor(uint16_t cents, uint8_t note);
+
+void scoreReset(void) {
+    head = 0;
+    count = 0;
+    lastEventMs = 0;
+    hasTrack = 0;
+    currentNote = SCORE_REST;
+    marks = 0;
+    scored = 0;
+    onPitch = 0;
+    unvoiced = 0;
+    dropped = 0;
+}
+
+uint8_t scoreAddReference(uint32_t ms, uint8_t note) {
+    if (count == SCORE_TRACK_SIZE || (hasTrack && ms < lastEventMs)) {
+        dropped++;
+        return 0;
+    }
+    track[(head + count) & (SCORE_TRACK_SIZE - 1)].ms = ms;
+    track[(head + count) & (SCORE_TRACK_SIZE - 1)].note = note;
+    count++;
+    lastEventMs = ms;
+    hasTrack = 1;
+    return 1;
+}
+
+uint8_t scoreHasTrack(void) {
+    return hasTrack;
+}
+
+uint8_t scoreBlock(uint32_t positionMs, uint16_t cents) {
+    uint8_t blockMarks;
+
+    while (count && track[head].ms <= positionMs) {
+        currentNote = track[head].note;
+        head = (head + 1) & (SCORE_TRACK_SIZE - 1);
+        count--;
+    }
+    if (currentNote == SCORE_REST || scored == 0xFFFF) {
+        return 0;
+    }
+
+    scored++;
+    if (cents == 0) {
+        unvoiced++;
+        return 1;
+    }
+    blockMarks = marksFor(cents, currentNote);
+    if (blockMarks == 100) {
+        onPitch++;
+    }
+    marks += blockMarks;
+    return 1;
+}
+
+uint8_t scoreIsActive(void) {
+    return scored != 0;
+}
+
+uint8_t scoreGet(void) {
+    return scored ? (uint8_t)(marks / scored) : 0;
+}
+
+void scoreReport(uint8_t song) {
+    char buffer[64];
+
+    sprintf(buffer, "G:%u %u H%u/%u U%u D%u\n", song, scoreGet(), onPitch,
+            scored, unvoiced, dropped);
+    sendString(buffer);
+}
+
+// Marks out of 100 for singing at cents when note is due, any octave
+static uint8_t marksFor(uint16_t cents, uint8_t note) {
+    int32_t error = ((int32_t)cents - note * 100) % 1200;
+
+    if (error < 0) {
+        error += 1200;
+    }
+    if (error > 600) {
+        error = 1200 - error;   // distance to the nearest octave
+    }
+    if (error <= SCORE_FULL_CENTS) {
+        return 100;
+    }
+    if (error >= SCORE_ZERO_CENTS) {
+        return 0;
+    }
+    return (uint8_t)(100 * (SCORE_ZERO_CENTS - error)
+                     / (SCORE_ZERO_CENTS - SCORE_FULL_CENTS));
+}
@@ -0,0 +1,110 @@
+/*! \file */
+/*!
+ * score.h
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Karaoke scoring against a reference pitch track. The ESP32
+ *              streams the current song's melody ahead of time as
+ *              (song position, MIDI note) events; every microphone block is
+ *              scored by how close the sung pitch is to the note that is due
+ *              at the block's song position. Octave errors are forgiven, so
+ *              any voice range can score full marks.
+ */
+
+#ifndef SCORE_H_
+#define SCORE_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+#define SCORE_TRACK_SIZE        32      // events buffered, must be a power of 2
+#define SCORE_REST              0       // note value of a rest, not scored
+#define SCORE_FULL_CENTS        50      // full marks within a quarter tone
+#define SCORE_ZERO_CENTS        300     // no marks beyond three semitones
+
+/*!
+ * \brief This function starts scoring a new song
+ *
+ * Drops the reference track and clears the totals.
+ *
+ * \return None
+ */
+extern void scoreReset(void);
+
+/*!
+ * \brief This function appends an event to the reference track
+ *
+ * \param ms is the song position the note starts at, not before the
+ *        previous event
+ * \param note is the MIDI note number, SCORE_REST for silence
+ *
+ * \return 1 if buffered, 0 if the track buffer is full or out of order
+ */
+extern uint8_t scoreAddReference(uint32_t ms, uint8_t note);
+
+/*!
+ * \brief This function tells whether the song has a reference track
+ *
+ * \return 1 once any event was received since scoreReset
+ */
+extern uint8_t scoreHasTrack(void);
+
+/*!
+ * \brief This function scores one block of singing
+ *
+ * Events due at or before \b positionMs are consumed. Blocks during a rest
+ *  are ignored; unvoiced blocks during a note score zero.
+ *
+ * \param positionMs is the song position of the block
+ * \param cents is the detected pitch (MIDI note x100), 0 if unvoiced
+ *
+ * \return 1 if the block counted towards the score
+ */
+extern uint8_t scoreBlock(uint32_t positionMs, uint16_t cents);
+
+/*!
+ * \brief This function tells whether any block has been scored
+ *
+ * \return 1 if scoreGet has a meaningful value
+ */
+extern uint8_t scoreIsActive(void);
+
+/*!
+ * \brief This function returns the running score
+ *
+ * \return average marks of the scored blocks, 0 to 100
+ */
+extern uint8_t scoreGet(void);
+
+/*!
+ * \brief This function sends the score to the UART
+ *
+ * Sends "G:<song> <score> H<blocks on pitch>/<blocks scored> U<unvoiced>
+ *  D<events dropped>".
+ *
+ * \param song is the index of the song being scored
+ *
+ * \return None
+ */
+extern void scoreReport(uint8_t song);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SCORE_H_ */
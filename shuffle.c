@@ -0,0 +1,71 @@
+/*! \file */
+/*!
+ * shuffle.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Keyed Feistel permutation with cycle walking.
+ */
+
+#include "shuffle.h"
+
+#define GOLDEN_RATIO        0x9E3779B9  // round key spacing
+
+// Integer hash of one half, any mixing function keeps the network a bijection
+static uint32_t roundFunction(uint32_t half, uint32_t key, uint8_t round) {
+    uint32_t x = half ^ (key + round * GOLDEN_RATIO);
+
+    x ^= x >> 16;
+    x *= 0x7FEB352D;
+    x ^= x >> 15;
+    x *= 0x846CA68B;
+    x ^= x >> 16;
+    return x;
+}
+
+static uint32_t feistel(const ShuffleIterator *shuffle, uint32_t value) {
+    uint32_t mask = ((uint32_t)1 << shuffle->halfBits) - 1;
+    uint32_t left = value >> shuffle->halfBits;
+    uint32_t right = value & mask;
+    uint32_t next;
+    uint8_t round;
+
+    for (round = 0; round < SHUFFLE_ROUNDS; round++) {
+        next = left ^ (roundFunction(right, shuffle->key, round) & mask);
+        left = right;
+        right = next;
+    }
+    return (left << shuffle->halfBits) | right;
+}
+
+void shuffleInit(ShuffleIterator *shuffle, uint32_t count, uint32_t key) {
+    uint8_t bits = 1;
+
+    if (!count) {
+        count = 1;
+    }
+    while (bits < 32 && ((count - 1) >> bits)) {
+        bits++;     // bits needed for the largest index
+    }
+    shuffle->count = count;
+    shuffle->position = 0;
+    shuffle->key = key;
+    shuffle->halfBits = (bits + 1) / 2;
+}
+
+uint32_t shufflePermute(const ShuffleIterator *shuffle, uint32_t position) {
+    uint32_t value = feistel(shuffle, position);
+
+    // the walk stays on the cycle of position, which holds an index in range
+    while (value >= shuffle->count) {
+        value = feistel(shuffle, value);
+    }
+    return value;
+}
+
+uint32_t shuffleNext(ShuffleIterator *shuffle) {
+    if (shuffle->position == shuffle->count) {
+        shuffle->position = 0;
+        shuffle->key = roundFunction(shuffle->key, GOLDEN_RATIO, SHUFFLE_ROUNDS);
+    }
+    return shufflePermute(shuffle, shuffle->position++);
+}
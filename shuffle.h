@@ -0,0 +1,85 @@
+/*! \file */
+/*!
+ * shuffle.h
+ * ECE230 Winter 2024-2025
+ *
+ * Description: No-repeat random order over a catalog of any size without a
+ *              permutation table. A keyed 4-round Feistel network permutes
+ *              the smallest power-of-4 range covering the catalog, and
+ *              values past the end are fed back in (cycle walking) until
+ *              one lands inside. The range is less than 4 times the
+ *              catalog, so a step takes under 4 walks on average.
+ *
+ *              No hardware access.
+ */
+
+#ifndef SHUFFLE_H_
+#define SHUFFLE_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+#define SHUFFLE_ROUNDS      4
+
+typedef struct _ShuffleIterator {
+    uint32_t count;             // catalog size
+    uint32_t position;          // steps taken in this cycle
+    uint32_t key;
+    uint8_t halfBits;           // Feistel half width, range is 4^halfBits
+} ShuffleIterator;
+
+/*!
+ * \brief This function starts a shuffled order
+ *
+ * \param shuffle is the iterator
+ * \param count is the number of songs, at least 1
+ * \param key selects the order, e.g. a free running timer value
+ *
+ * \return None
+ */
+extern void shuffleInit(ShuffleIterator *shuffle, uint32_t count, uint32_t key);
+
+/*!
+ * \brief This function maps a position to a song
+ *
+ * A bijection on 0 to count - 1 for every key.
+ *
+ * \param shuffle is the iterator
+ * \param position is the position in the shuffled order
+ *
+ * \return song index at \b position
+ */
+extern uint32_t shufflePermute(const ShuffleIterator *shuffle, uint32_t position);
+
+/*!
+ * \brief This function returns the next song in the shuffled order
+ *
+ * Every song comes once per cycle of \b count calls. The next cycle uses a
+ *  new key, so it gets a different order.
+ *
+ * \param shuffle is the iterator
+ *
+ * \return song index
+ */
+extern uint32_t shuffleNext(ShuffleIterator *shuffle);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SHUFFLE_H_ */
@@ -0,0 +1,144 @@
+/*! \file */
+/*!
+ * songLists.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Recently played and favorite songs.
+ */
+
+#include <string.h>
+#include "songLists.h"
+
+void recentClear(RecentList *list) {
+    memset(list->node, RECENT_NONE, sizeof(list->node));
+    list->newest = RECENT_NONE;
+    list->oldest = RECENT_NONE;
+    list->count = 0;
+}
+
+static void unlinkNode(RecentList *list, uint8_t node) {
+    if (list->newer[node] != RECENT_NONE) {
+        list->older[list->newer[node]] = list->older[node];
+    } else {
+        list->newest = list->older[node];
+    }
+    if (list->older[node] != RECENT_NONE) {
+        list->newer[list->older[node]] = list->newer[node];
+    } else {
+        list->oldest = list->newer[node];
+    }
+}
+
+void recentTouch(RecentList *list, uint8_t song) {
+    uint8_t node = list->node[song];
+
+    if (node != RECENT_NONE) {
+        if (node == list->newest) {
+            return;
+        }
+        unlinkNode(list, node);
+    } else if (list->count < RECENT_SIZE) {
+        node = list->count++;
+    } else {
+        // evict the least recently played song, reuse its node
+        node = list->oldest;
+        list->node[list->songs[node]] = RECENT_NONE;
+        unlinkNode(list, node);
+    }
+
+    list->songs[node] = song;
+    list->node[song] = node;
+    list->newer[node] = RECENT_NONE;
+    list->older[node] = list->newest;
+    if (list->newest != RECENT_NONE) {
+        list->newer[list->newest] = node;
+    } else {
+        list->oldest = node;
+    }
+    list->newest = node;
+}
+
+uint8_t recentContains(const RecentList *list, uint8_t song) {
+    return list->node[song] != RECENT_NONE;
+}
+
+int16_t recentNewest(const RecentList *list) {
+    return list->newest == RECENT_NONE ? -1 : list->songs[list->newest];
+}
+
+int16_t recentOlder(const RecentList *list, uint8_t song) {
+    uint8_t node = list->node[song];
+
+    if (list->newest == RECENT_NONE) {
+        return -1;
+    }
+    if (node == RECENT_NONE || list->older[node] == RECENT_NONE) {
+        return list->songs[list->newest];
+    }
+    return list->songs[list->older[node]];
+}
+
+uint8_t recentExport(const RecentList *list, uint8_t *songs) {
+    uint8_t node = list->newest;
+    uint8_t count = 0;
+
+    while (node != RECENT_NONE) {
+        songs[count++] = list->songs[node];
+        node = list->older[node];
+    }
+    return count;
+}
+
+void favoriteClear(FavoriteSet *set) {
+    memset(set->bits, 0, sizeof(set->bits));
+    set->count = 0;
+}
+
+uint8_t favoriteToggle(FavoriteSet *set, uint8_t song) {
+    uint32_t mask = (uint32_t)1 << (song & 31);
+
+    set->bits[song >> 5] ^= mask;
+    if (set->bits[song >> 5] & mask) {
+        set->count++;
+        return 1;
+    }
+    set->count--;
+    return 0;
+}
+
+uint8_t favoriteContains(const FavoriteSet *set, uint8_t song) {
+    return (set->bits[song >> 5] >> (song & 31)) & 1;
+}
+
+int16_t favoriteNext(const FavoriteSet *set, uint8_t song) {
+    uint16_t start = (song + 1) % SONG_LIST_MAX;
+    uint8_t word = start >> 5;
+    uint32_t bits = set->bits[word] & (0xFFFFFFFF << (start & 31));
+    uint8_t i, bit;
+
+    if (!set->count) {
+        return -1;
+    }
+    // the first word is visited twice, above and then below the start bit
+    for (i = 0; !bits && i < FAVORITE_WORDS; i++) {
+        word = (word + 1) % FAVORITE_WORDS;
+        bits = set->bits[word];
+    }
+    for (bit = 0; !(bits & 1); bit++) {
+        bits >>= 1;
+    }
+    return (word << 5) + bit;
+}
+
+void favoriteRestore(FavoriteSet *set, const uint32_t *bits) {
+    uint32_t word;
+    uint8_t i;
+
+    set->count = 0;
+    for (i = 0; i < FAVORITE_WORDS; i++) {
+        set->bits[i] = bits[i];
+        for (word = bits[i]; word; word &= word - 1) {
+            set->count++;   // clears the lowest set bit
+        }
+    }
+}
@@ -0,0 +1,175 @@
+/*! \file */
+/*!
+ * songLists.h
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Recently played and favorite songs. The recent list is a
+ *              least recently used list of RECENT_SIZE songs, linked
+ *              through small node arrays with a song to node map, so
+ *              touching, evicting and looking up a song are all O(1).
+ *              Favorites are a bitset over the song index range.
+ *
+ *              Song indices are uint8_t, so any catalog fits in
+ *              SONG_LIST_MAX. No hardware access.
+ */
+
+#ifndef SONGLISTS_H_
+#define SONGLISTS_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+#define SONG_LIST_MAX       256     // songs addressable by a uint8_t index
+#define RECENT_SIZE         8       // songs kept in the recent list
+#define RECENT_NONE         0xFF    // empty link or map entry
+#define FAVORITE_WORDS      (SONG_LIST_MAX / 32)
+
+typedef struct _RecentList {
+    uint8_t songs[RECENT_SIZE];     // node -> song
+    uint8_t newer[RECENT_SIZE];     // node -> node played after it
+    uint8_t older[RECENT_SIZE];     // node -> node played before it
+    uint8_t node[SONG_LIST_MAX];    // song -> node, RECENT_NONE if absent
+    uint8_t newest;
+    uint8_t oldest;
+    uint8_t count;
+} RecentList;
+
+typedef struct _FavoriteSet {
+    uint32_t bits[FAVORITE_WORDS];  // bit per song index
+    uint16_t count;
+} FavoriteSet;
+
+/*!
+ * \brief This function empties a recent list
+ *
+ * \param list is the list to clear
+ *
+ * \return None
+ */
+extern void recentClear(RecentList *list);
+
+/*!
+ * \brief This function marks a song as just played
+ *
+ * Moves the song to the front, adding it and evicting the least recently
+ *  played song if needed.
+ *
+ * \param list is the recent list
+ * \param song is the song index
+ *
+ * \return None
+ */
+extern void recentTouch(RecentList *list, uint8_t song);
+
+/*!
+ * \brief This function tells whether a song is in the recent list
+ *
+ * \param list is the recent list
+ * \param song is the song index
+ *
+ * \return 1 if \b song was played recently, 0 otherwise
+ */
+extern uint8_t recentContains(const RecentList *list, uint8_t song);
+
+/*!
+ * \brief This function returns the most recently played song
+ *
+ * \param list is the recent list
+ *
+ * \return song index, -1 if the list is empty
+ */
+extern int16_t recentNewest(const RecentList *list);
+
+/*!
+ * \brief This function steps through the recent list
+ *
+ * \param list is the recent list
+ * \param song is the current song
+ *
+ * \return the song played before \b song, the most recent one after the
+ *      oldest or if \b song is not in the list, -1 if the list is empty
+ */
+extern int16_t recentOlder(const RecentList *list, uint8_t song);
+
+/*!
+ * \brief This function copies the recent list, most recent first
+ *
+ * \param list is the recent list
+ * \param songs receives up to RECENT_SIZE song indices
+ *
+ * \return number of songs copied
+ */
+extern uint8_t recentExport(const RecentList *list, uint8_t *songs);
+
+/*!
+ * \brief This function empties a favorite set
+ *
+ * \param set is the set to clear
+ *
+ * \return None
+ */
+extern void favoriteClear(FavoriteSet *set);
+
+/*!
+ * \brief This function adds or removes a favorite
+ *
+ * \param set is the favorite set
+ * \param song is the song index
+ *
+ * \return 1 if \b song is now a favorite, 0 if it was removed
+ */
+extern uint8_t favoriteToggle(FavoriteSet *set, uint8_t song);
+
+/*!
+ * \brief This function tells whether a song is a favorite
+ *
+ * \param set is the favorite set
+ * \param song is the song index
+ *
+ * \return 1 if \b song is a favorite, 0 otherwise
+ */
+extern uint8_t favoriteContains(const FavoriteSet *set, uint8_t song);
+
+/*!
+ * \brief This function steps through the favorites in catalog order
+ *
+ * Scans at most FAVORITE_WORDS + 1 words, whatever the number of songs.
+ *
+ * \param set is the favorite set
+ * \param song is the current song
+ *
+ * \return the next favorite after \b song, wrapping around, -1 if the set
+ *      is empty
+ */
+extern int16_t favoriteNext(const FavoriteSet *set, uint8_t song);
+
+/*!
+ * \brief This function loads a favorite set from saved bits
+ *
+ * \param set is the favorite set
+ * \param bits is FAVORITE_WORDS words as found in FavoriteSet.bits
+ *
+ * \return None
+ */
+extern void favoriteRestore(FavoriteSet *set, const uint32_t *bits);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SONGLISTS_H_ */
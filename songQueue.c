@@ -0,0 +1,59 @@
+/*! \file */
+/*!
+ * songQueue.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Fixed-capacity playlist of song indices.
+ */
+
+#include "songQueue.h"
+
+static uint8_t songs[SONG_QUEUE_SIZE];
+static uint8_t head = 0;        // oldest entry
+static uint8_t count = 0;       // entries in the ring
+static uint8_t played = 0;      // entries started, current is played - 1
+
+void queueClear(void) {
+    head = 0;
+    count = 0;
+    played = 0;
+}
+
+uint8_t queueAdd(uint8_t song) {
+    if (count == SONG_QUEUE_SIZE) {
+        if (played < 2) {
+            return 0;   // only the current song is older, keep it
+        }
+        head = (head + 1) & (SONG_QUEUE_SIZE - 1);
+        count--;
+        played--;
+    }
+    songs[(head + count) & (SONG_QUEUE_SIZE - 1)] = song;
+    count++;
+    return 1;
+}
+
+uint8_t queueAdvance(uint8_t *song) {
+    if (played == count) {
+        return 0;
+    }
+    *song = songs[(head + played) & (SONG_QUEUE_SIZE - 1)];
+    played++;
+    return 1;
+}
+
+uint8_t queuePosition(void) {
+    return played;
+}
+
+uint8_t queueLength(void) {
+    return count;
+}
+
+uint8_t queuePending(void) {
+    return count - played;
+}
+
+uint8_t queueAt(uint8_t position) {
+    return songs[(head + position) & (SONG_QUEUE_SIZE - 1)];
+}
@@ -0,0 +1,100 @@
+/*! \file */
+/*!
+ * songQueue.h
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Fixed-capacity playlist of song indices. Entries stay in the
+ *              ring after they have been played so the display can show the
+ *              position in the playlist; the oldest finished entry is
+ *              dropped when a new song is added to a full ring.
+ *
+ *              No hardware access.
+ */
+
+#ifndef SONGQUEUE_H_
+#define SONGQUEUE_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+#define SONG_QUEUE_SIZE     8       // entries, must be a power of 2
+
+/*!
+ * \brief This function empties the playlist
+ *
+ * \return None
+ */
+extern void queueClear(void);
+
+/*!
+ * \brief This function appends a song to the playlist
+ *
+ * If the ring is full the oldest finished entry is dropped to make room.
+ *  Fails when nothing before the current song is left to drop.
+ *
+ * \param song is the index into the song list
+ *
+ * \return 1 if the song was added, 0 if the playlist is full
+ */
+extern uint8_t queueAdd(uint8_t song);
+
+/*!
+ * \brief This function moves to the next song in the playlist
+ *
+ * \param song receives the index of the song to play next
+ *
+ * \return 1 if there was a next song, 0 if the playlist is exhausted
+ */
+extern uint8_t queueAdvance(uint8_t *song);
+
+/*!
+ * \brief This function returns the position of the current song
+ *
+ * \return 1-based position of the song last returned by queueAdvance,
+ *      0 if none has been started since the last queueClear
+ */
+extern uint8_t queuePosition(void);
+
+/*!
+ * \brief This function returns the number of entries in the playlist
+ *
+ * \return played and waiting entries
+ */
+extern uint8_t queueLength(void);
+
+/*!
+ * \brief This function returns the number of songs still to be played
+ *
+ * \return entries after the current position
+ */
+extern uint8_t queuePending(void);
+
+/*!
+ * \brief This function returns a playlist entry
+ *
+ * \param position is the 0-based position, oldest first
+ *
+ * \return song index at \b position, undefined if past queueLength
+ */
+extern uint8_t queueAt(uint8_t position);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SONGQUEUE_H_ */
@@ -0,0 +1,53 @@
+/*! \file */
+/*!
+ * stackMonitor.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Runtime stack usage monitor.
+ */
+
+#include <stdio.h>
+#include "msp.h"
+#include "stackMonitor.h"
+#include "uart.h"
+
+/* Defined by the TI linker; only the addresses are meaningful */
+extern uint32_t __stack;            // lowest address of .stack
+extern uint32_t __STACK_END;        // one past the highest address
+extern uint32_t __STACK_SIZE;
+extern uint32_t __SYSMEM_SIZE;      // heap
+
+void stackPaint(void) {
+    uint32_t *word = &__stack;
+    uint32_t *limit = (uint32_t *)(__get_MSP() - STACK_PAINT_MARGIN);
+
+    while (word < limit) {
+        *word++ = STACK_PAINT;
+    }
+}
+
+uint32_t stackHighWater(void) {
+    uint32_t *word = &__stack;
+    uint32_t *end = &__STACK_END;
+
+    // painting grows up from the bottom, first overwritten word is the peak
+    while (word < end && *word == STACK_PAINT) {
+        word++;
+    }
+    return (uint32_t)end - (uint32_t)word;
+}
+
+uint32_t stackSize(void) {
+    return (uint32_t)&__STACK_SIZE;
+}
+
+void stackReport(void) {
+    char buffer[64];
+    uint32_t used = stackHighWater();
+
+    sprintf(buffer, "M:S%lu/%lu F%lu H%lu\n",
+            (unsigned long)used, (unsigned long)stackSize(),
+            (unsigned long)(stackSize() - used),
+            (unsigned long)(uint32_t)&__SYSMEM_SIZE);
+    sendString(buffer);
+}
@@ -0,0 +1,73 @@
+/*! \file */
+/*!
+ * stackMonitor.h
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Runtime stack usage monitor. The unused part of the stack
+ *              is painted with a known pattern at startup; the deepest
+ *              overwritten word gives the high-water mark. Static RAM per
+ *              module is reported from the linker map by tools/ramusage.py.
+ */
+
+#ifndef STACKMONITOR_H_
+#define STACKMONITOR_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+#define STACK_PAINT         0xA5A5A5A5
+#define STACK_PAINT_MARGIN  32          // bytes below SP left unpainted
+
+/*!
+ * \brief This function paints the unused stack
+ *
+ * Fills from the bottom of .stack to just below the current stack pointer.
+ *  Call first thing in main, before anything deep has run.
+ *
+ * \return None
+ */
+extern void stackPaint(void);
+
+/*!
+ * \brief This function returns the deepest stack use since stackPaint()
+ *
+ * \return bytes of stack used at the high-water mark
+ */
+extern uint32_t stackHighWater(void);
+
+/*!
+ * \brief This function returns the linker allocated stack size
+ *
+ * \return stack size in bytes
+ */
+extern uint32_t stackSize(void);
+
+/*!
+ * \brief This function sends stack figures over UART
+ *
+ * Format: "M:S<high water>/<size> F<free> H<heap size>\n" in bytes.
+ *
+ * \return None
+ */
+extern void stackReport(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STACKMONITOR_H_ */
@@ -4,90 +4,808 @@
  * ECE230 Winter 2024-2025
  *
  * Description: Stepper motor ULN2003 driver for MSP432P4111 Launchpad.
- *              Assumes SMCLK configured with 48MHz HFXT as source.
- *              Uses Timer_A3 and P2.7, P2.6, P2.5, P2.4
+ *              Timer_A3 dividers are derived from SMCLK so the engine ticks
+ *              at STEPPER_TICK_HZ for any clockManager profile.
+ *              Uses Timer_A3 and P2.7, P2.6, P2.5, P2.4 for the main motor.
+ *
+ *              Up to STEPPER_MAX_MOTORS motors share Timer_A3 running in
+ *              continuous mode. Each motor keeps the absolute time of its
+ *              next step; the CCR0 interrupt steps every motor that is due
+ *              and programs CCR0 with the earliest remaining deadline.
  *
  *  Created on:
  *      Author:
  */
 
 #include "stepperMotor.h"
+#include "stepperProfile.h"
+#include "dma.h"
+#include "clockManager.h"
+#include "profiler.h"
+#include "trace.h"
 #include "msp.h"
 
+/* Coil patterns for IN1..IN4 in bits 3..0, shifted onto the motor's pins
+ *  when a drive mode is selected */
+const uint8_t waveSequence[STEP_SEQ_CNT] =  { 0x8, 0x4, 0x2, 0x1 };
+const uint8_t fullStepSequence[STEP_SEQ_CNT] =  { 0xC, 0x6, 0x3, 0x9 };
+const uint8_t halfStepSequence[HALF_STEP_SEQ_CNT] =
+        { 0x8, 0xC, 0x4, 0x6, 0x2, 0x3, 0x1, 0x9 };
+
+/* Motion profile phase - ramp table is walked forward (accelerate) or
+ *  backward (decelerate), tempo mode computes intervals in fixed point.
+ *  A move that arrived holds its last step for one interval before the
+ *  coils are released. */
+typedef enum _RampPhase {
+    RAMP_IDLE, RAMP_ACCEL, RAMP_CRUISE, RAMP_DECEL, RAMP_TEMPO, RAMP_DMA, RAMP_HOLD
+} RampPhase;
+
+typedef enum _MoveMode {
+    MOVE_FREE, MOVE_TARGET
+} MoveMode;
+
+typedef struct _StepperMotor {
+    /* Output pins */
+    volatile uint8_t *out;
+    uint8_t mask;
+    uint8_t shift;
+    uint8_t pattern[HALF_STEP_SEQ_CNT];     // coil patterns already on pins
+    uint8_t seqMask;                        // sequence length - 1
+    uint8_t phase;                          // index into pattern
+    StepperDriveMode driveMode;
+
+    /* Motion profile, intervals in Timer_A3 ticks */
+    uint16_t rampTable[RAMP_TABLE_MAX];
+    uint16_t rampLength;
+    uint16_t rampIndex;
+    uint16_t cruisePeriod;
+    uint16_t interval;                      // time from this step to the next
+    RampPhase rampPhase;
+
+    /* Position, positive is clockwise */
+    int32_t position;
+    int32_t target;
+    int8_t direction;
+    MoveMode moveMode;
+
+    /* Tempo lock, Q16.16 ticks */
+    int32_t tempoTarget;
+    int32_t tempoInterval;
+    uint32_t tempoPhase;
+
+    /* Absolute engine time of the next step */
+    uint32_t nextDue;
+} StepperMotor;
+
 /* Global Variables  */
-const uint8_t stepperSequence[STEP_SEQ_CNT] =  { 0b1000, 0b0100, 0b0010, 0b0001 };
-uint16_t stepPeriod = 2500;
-uint8_t currentStep = 0;
+StepperMotor motors[STEPPER_MAX_MOTORS];
+uint8_t motorCount = 0;
 
+/* Engine time of the last serviced and the pending CCR0 compare, extended
+ *  to 32 bits */
+volatile uint32_t lastDue = 0;
+volatile uint32_t scheduledDue = 0;
+volatile uint8_t engineRunning = 0;
 
-void initStepperMotor(void) {
-    // set stepper port pins as GPIO outputs
-    STEPPER_PORT->SEL0 = (STEPPER_PORT->SEL0) & ~STEPPER_MASK;
-    STEPPER_PORT->SEL1 = (STEPPER_PORT->SEL1) & ~STEPPER_MASK;
-    STEPPER_PORT->DIR = (STEPPER_PORT->DIR) | STEPPER_MASK;
+/* DMA output mode: Timer_A3 runs in up mode and each CCR0 event makes the
+ *  DMA copy one byte from a ping-pong pattern buffer to the motor's port */
+uint8_t dmaMotor = STEPPER_INVALID;
+uint8_t dmaBuffer[2][STEPPER_DMA_BUFFER_LEN];
 
-    // initialize stepper outputs to LOW
-    STEPPER_PORT->OUT = (STEPPER_PORT->OUT) & ~STEPPER_MASK;
+#if STEPPER_MEASURE_CYCLES
+/* CPU cost accounting for ISR driven and DMA driven stepping */
+uint32_t isrCycles = 0;
+uint32_t isrSteps = 0;
+uint32_t dmaCycles = 0;
+uint32_t dmaSteps = 0;
+#endif
 
-    /* Configure Timer_A3 and CCR0 */
-    // Set period of Timer_A3 in CCR0 register for Up Mode
-    TIMER_A3->CCR[0] = stepPeriod;
+static void stepMotor(StepperMotor *m);
+static uint8_t startMotor(StepperMotor *m);
+static void scheduleMotor(StepperMotor *m);
+static uint32_t engineTime(void);
+static void fillDmaBuffer(StepperMotor *m, uint8_t half);
+static void stepperClockChanged(ClockEvent event);
+static void moveMotorTo(StepperMotor *m, int32_t target);
+static uint8_t motorStopped(const StepperMotor *m);
+
+void initStepperMotor(void) {
+    const StepperPins mainPins = STEPPER_PINS(STEPPER_PORT, 4);  // copied by stepperAttach
 
+    /* Configure Timer_A3 and CCR0 */
     TIMER_A3->CCTL[0] = TIMER_A_CCTLN_CCIE;
-    // Configure Timer_A3 in Stop Mode, with source SMCLK, prescale 12:1, and
-    //  interrupt disabled  -  tick rate will be 4MHz (for SMCLK = 48MHz)
+    // Configure Timer_A3 in Stop Mode with source SMCLK, prescalers picked
+    //  for a STEPPER_TICK_HZ tick rate and updated on clock changes
 
-    TIMER_A3->CTL = 0x2C0;
-        //0x2C0 0x02D4 0x280
-        TIMER_A3->EX0 = 0b101;
+    TIMER_A3->CTL = TIMER_A_CTL_SSEL__SMCLK | TIMER_A_CTL_MC__STOP;
+    stepperClockChanged(CLOCK_POST_CHANGE);
+    clockRegisterListener(stepperClockChanged);
 
     /* Configure global interrupts and NVIC */
     // Enable TA3CCR0 compare interrupt by setting IRQ bit in NVIC ISER0 register
 
     NVIC->ISER[0] = 1 << (TA3_0_IRQn);  // Enable Timer_A3 CCR0 interrupt
-    //TIMER_A3->CCTL[0] &= ~TIMER_A_CCTLN_CCIFG;  // Clear interrupt flag
 
+#if STEPPER_MEASURE_CYCLES
+    // free-running core cycle counter for the cost figures
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
+    motorCount = 0;
+    stepperAttach(&mainPins);
 
     __enable_irq();                             // Enable global interrupt
 }
 
-void enableStepperMotor(void) {
+uint8_t stepperAttach(const StepperPins *pins) {
+    StepperMotor *m;
+    uint8_t id;
+    uint8_t mask;
+
+    if (motorCount >= STEPPER_MAX_MOTORS) {
+        return STEPPER_INVALID;
+    }
+    id = motorCount;
+    m = &motors[id];
+    mask = 0x0F << pins->shift;
+
+    // set stepper port pins as GPIO outputs, initially LOW
+    *pins->sel0 &= ~mask;
+    *pins->sel1 &= ~mask;
+    *pins->out &= ~mask;
+    *pins->dir |= mask;
+
+    m->out = pins->out;
+    m->mask = mask;
+    m->shift = pins->shift;
+    m->phase = 0;
+    m->driveMode = DRIVE_WAVE;
+    m->rampPhase = RAMP_IDLE;
+    m->position = 0;
+    m->target = 0;
+    m->direction = 1;
+    m->moveMode = MOVE_FREE;
+    m->rampLength = 0;
+
+    // default motion profile: trapezoidal ramp up to INIT_PERIOD
+    motorCount++;
+    stepperSetDriveMode(id, DRIVE_WAVE);
+    stepperSetProfile(id, PROFILE_TRAPEZOIDAL, RAMP_START_PERIOD, INIT_PERIOD,
+                      DEFAULT_RAMP_STEPS);
+    return id;
+}
+
+uint16_t stepperSetProfile(uint8_t motor, StepperProfileType type,
+                           uint16_t startPeriod, uint16_t cruisePeriod,
+                           uint16_t rampSteps) {
+    StepperMotor *m = &motors[motor];
+    uint16_t length;
+
+    if (motor >= motorCount || !motorStopped(m)) {
+        return 0;
+    }
+    length = buildRampTable(m->rampTable, rampSteps, type, startPeriod, cruisePeriod);
+    if (length) {
+        m->rampLength = length;
+        m->cruisePeriod = cruisePeriod;
+    }
+    return length;
+}
+
+/* Current engine time. The pending compare is never more than one timer
+ *  wrap after the last one, so TAR is always within a wrap of lastDue. */
+static uint32_t engineTime(void) {
+    return lastDue + (uint16_t)(TIMER_A3->R - (uint16_t)lastDue);
+}
+
+/* Retune the Timer_A3 prescalers (ID x IDEX) to the closest match of
+ *  SMCLK / STEPPER_TICK_HZ. Setting TACLR restarts the divider and clears
+ *  TAR, so pending deadlines are rebased to keep their distance from now. */
+static void stepperClockChanged(ClockEvent event) {
+    uint32_t divider, error, bestError;
+    uint32_t now;
+    uint8_t id, idex, bestId, bestIdex;
+    uint8_t i;
+
+    if (event != CLOCK_POST_CHANGE) {
+        return;
+    }
+
+    divider = getSMCLKFrequency() / STEPPER_TICK_HZ;
+    bestId = 0;
+    bestIdex = 1;
+    bestError = 0xFFFFFFFF;
+    for (id = 0; id < 4; id++) {                // ID is 1 << id
+        for (idex = 1; idex <= 8; idex++) {
+            error = (divider > ((uint32_t)idex << id))
+                    ? divider - ((uint32_t)idex << id)
+                    : ((uint32_t)idex << id) - divider;
+            if (error < bestError) {
+                bestError = error;
+                bestId = id;
+                bestIdex = idex;
+            }
+        }
+    }
+
+    __disable_irq();
+    now = engineTime();
+    TIMER_A3->CTL = (TIMER_A3->CTL & ~TIMER_A_CTL_ID_MASK)
+                    | ((uint16_t)bestId << TIMER_A_CTL_ID_OFS);
+    TIMER_A3->EX0 = bestIdex - 1;
+    TIMER_A3->CTL |= TIMER_A_CTL_CLR;
+    if (engineRunning) {
+        for (i = 0; i < motorCount; i++) {
+            motors[i].nextDue -= now;
+        }
+        scheduledDue -= now;
+        if ((int32_t)scheduledDue < STEPPER_ISR_MARGIN) {
+            scheduledDue = STEPPER_ISR_MARGIN;
+        }
+        lastDue = 0;
+        TIMER_A3->CCR[0] = (uint16_t)scheduledDue;
+    }
+    __enable_irq();
+}
+
+static uint8_t startMotor(StepperMotor *m) {
+    // Timer_A3 belongs to the DMA stream while one is running
+    if (dmaMotor != STEPPER_INVALID) {
+        return 0;
+    }
+
+    // start from the slow end of the ramp, stepMotor() loads the rest
+    m->rampIndex = 1;
+    m->rampPhase = (m->rampLength > 1) ? RAMP_ACCEL : RAMP_CRUISE;
+    m->interval = m->rampTable[0];
+    scheduleMotor(m);
+    return 1;
+}
+
+static void scheduleMotor(StepperMotor *m) {
+    uint32_t now;
+
+    TIMER_A3->CCTL[0] &= ~TIMER_A_CCTLN_CCIE;   // keep ISR out while scheduling
+    if (!engineRunning) {
+        TIMER_A3->R = 0;
+        lastDue = 0;
+        scheduledDue = m->interval;
+        m->nextDue = m->interval;
+        TIMER_A3->CCR[0] = m->interval;
+        TIMER_A3->CCTL[0] &= ~TIMER_A_CCTLN_CCIFG;
+        engineRunning = 1;
+        TIMER_A3->CTL |= TIMER_A_CTL_MC__CONTINUOUS;
+    } else {
+        now = engineTime();
+        m->nextDue = now + m->interval;
+        if ((int32_t)(m->nextDue - scheduledDue) < 0) {
+            scheduledDue = m->nextDue;
+            TIMER_A3->CCR[0] = (uint16_t)m->nextDue;
+        }
+    }
+    TIMER_A3->CCTL[0] |= TIMER_A_CCTLN_CCIE;
+}
+
+void enableStepperMotor(uint8_t motor) {
+    StepperMotor *m = &motors[motor];
+    uint32_t primask = __get_PRIMASK();
+
+    if (motor >= motorCount) {
+        return;
+    }
+    // free-run clockwise until stopped
+    __disable_irq();
+    m->moveMode = MOVE_FREE;
+    m->direction = 1;
+    if (motorStopped(m)) {
+        startMotor(m);
+    }
+    __set_PRIMASK(primask);
+}
+
+void disableStepperMotor(uint8_t motor) {
+    StepperMotor *m = &motors[motor];
+    uint32_t primask = __get_PRIMASK();
+
+    if (motor >= motorCount) {
+        return;
+    }
+    // stop stepping this motor and release its coils in one piece, so the
+    //  ISR cannot step it again after the outputs were cleared; the timer is
+    //  stopped once no motor is active
+    __disable_irq();
+    stepperStopDma(motor);
+    m->moveMode = MOVE_FREE;
+    m->rampPhase = RAMP_IDLE;
+    *m->out &= ~m->mask;
+    __set_PRIMASK(primask);
+}
+
+void stepperRequestStop(uint8_t motor) {
+    StepperMotor *m = &motors[motor];
+    uint32_t primask = __get_PRIMASK();
+    uint16_t index;
+
+    if (motor >= motorCount) {
+        return;
+    }
+    // the Timer_A3 ISR advances the ramp, change it in one piece
+    __disable_irq();
+    // walk back down the ramp from wherever acceleration got to
+    m->moveMode = MOVE_FREE;
+    if (m->rampPhase == RAMP_TEMPO) {
+        // join the ramp at the entry closest to the current tempo
+        index = m->rampLength;
+        while (index > 0 && m->rampTable[index - 1] < (m->tempoInterval >> 16)) {
+            index--;
+        }
+        m->rampIndex = index;
+        m->rampPhase = RAMP_DECEL;
+    } else if (m->rampPhase == RAMP_ACCEL || m->rampPhase == RAMP_CRUISE) {
+        m->rampPhase = RAMP_DECEL;
+    } else if (m->rampPhase == RAMP_DMA) {
+        // back to the ISR at cruise speed, then down the ramp
+        stepperStopDma(motor);
+        m->rampPhase = RAMP_DECEL;
+    }
+    __set_PRIMASK(primask);
+}
+
+uint8_t isStepperRunning(uint8_t motor) {
+    return motors[motor].rampPhase != RAMP_IDLE;
+}
+
+/* Free to start a new motion: idle, or only holding the last step of one */
+static uint8_t motorStopped(const StepperMotor *m) {
+    return m->rampPhase == RAMP_IDLE || m->rampPhase == RAMP_HOLD;
+}
+
+void stepperFollowTempo(uint8_t motor, uint16_t bpmX100) {
+    StepperMotor *m = &motors[motor];
+    int32_t target = (int32_t)tempoIntervalQ16(bpmX100, STEPS_PER_BEAT,
+                                               STEPPER_TICK_HZ);
+    uint32_t primask = __get_PRIMASK();
+
+    // the ISR slews tempoInterval towards tempoTarget on every step
+    __disable_irq();
+    m->tempoTarget = target;
+    m->moveMode = MOVE_FREE;
+    m->direction = 1;
+    if (motorStopped(m)) {
+        m->tempoInterval = (int32_t)m->rampTable[0] << 16;
+        m->tempoPhase = 0;
+        if (startMotor(m)) {
+            m->rampPhase = RAMP_TEMPO;
+        }
+    } else if (m->rampPhase != RAMP_TEMPO && m->rampPhase != RAMP_DMA) {
+        // take over from the ramp at its current speed
+        m->tempoInterval = (int32_t)m->interval << 16;
+        m->rampPhase = RAMP_TEMPO;
+    }
+    __set_PRIMASK(primask);
+}
+
+/* Body of stepperMoveTo, called with interrupts masked since the ISR
+ *  reads target and moveMode on every step */
+static void moveMotorTo(StepperMotor *m, int32_t target) {
+    if (m->rampPhase == RAMP_DMA) {
+        return;                         // stop the DMA stream first
+    }
+    m->target = target;
+    if (!motorStopped(m)) {
+        // already moving, ISR re-plans (and turns around if needed)
+        m->moveMode = MOVE_TARGET;
+        return;
+    }
+    if (target == m->position) {
+        return;
+    }
+    m->direction = (target > m->position) ? 1 : -1;
+    m->moveMode = MOVE_TARGET;
+    startMotor(m);
+}
+
+void stepperMoveTo(uint8_t motor, int32_t target) {
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    moveMotorTo(&motors[motor], target);
+    __set_PRIMASK(primask);
+}
+
+void stepperMoveBy(uint8_t motor, int32_t delta) {
+    StepperMotor *m = &motors[motor];
+    uint32_t primask = __get_PRIMASK();
+
+    // relative to the current target while a move is in progress
+    __disable_irq();
+    if (m->moveMode == MOVE_TARGET && m->rampPhase != RAMP_IDLE) {
+        moveMotorTo(m, m->target + delta);
+    } else {
+        moveMotorTo(m, m->position + delta);
+    }
+    __set_PRIMASK(primask);
+}
+
+int32_t stepperGetPosition(uint8_t motor) {
+    return motors[motor].position;
+}
+
+void stepperSetPosition(uint8_t motor, int32_t position) {
+    StepperMotor *m = &motors[motor];
+    uint32_t primask = __get_PRIMASK();
+
+    if (motor >= motorCount) {
+        return;
+    }
+    // redefine the origin, only meaningful while stopped; the ISR moves
+    //  position and reads target on every step
+    __disable_irq();
+    if (motorStopped(m)) {
+        m->position = position;
+        m->target = position;
+    }
+    __set_PRIMASK(primask);
+}
+
+uint8_t stepperStartDma(uint8_t motor) {
+    StepperMotor *m = &motors[motor];
+    uint8_t i;
 
-    TIMER_A3->CTL |= TIMER_A_CTL_MC__UP;  // Set Timer_A3 to Up Mode
+    // hand over only at steady cruise speed with no other motor on the timer
+    if (dmaMotor != STEPPER_INVALID || m->rampPhase != RAMP_CRUISE
+            || m->moveMode != MOVE_FREE) {
+        return 0;
+    }
+    for (i = 0; i < motorCount; i++) {
+        if (i != motor && motors[i].rampPhase != RAMP_IDLE) {
+            return 0;
+        }
+    }
+
+    // stop the scheduler, the next steps come from the pattern buffers
+    TIMER_A3->CCTL[0] &= ~TIMER_A_CCTLN_CCIE;
+    TIMER_A3->CTL = (TIMER_A3->CTL & ~TIMER_A_CTL_MC_MASK) | TIMER_A_CTL_MC__STOP;
+    engineRunning = 0;
+    m->rampPhase = RAMP_DMA;
+    dmaMotor = motor;
 
+    fillDmaBuffer(m, 0);
+    fillDmaBuffer(m, 1);
+
+    initDMA();
+    DMA_Channel->CH_SRCCFG[DMA_CH_STEPPER] = DMA_SRC_STEPPER;
+    DMA_Control->ALTCLR = 1 << DMA_CH_STEPPER;         // start on primary
+    DMA_Control->USEBURSTCLR = 1 << DMA_CH_STEPPER;
+    DMA_Control->REQMASKCLR = 1 << DMA_CH_STEPPER;
+    DMA_Channel->INT1_SRCCFG = DMA_INT1_SRCCFG_EN | DMA_CH_STEPPER;
+    NVIC_EnableIRQ(DMA_INT1_IRQn);
+    DMA_Control->ENASET = 1 << DMA_CH_STEPPER;
+
+    // Up Mode at cruise rate, CCR0 event is the DMA trigger (no interrupt)
+    TIMER_A3->CCTL[0] &= ~TIMER_A_CCTLN_CCIFG;
+    TIMER_A3->CCR[0] = m->interval - 1;
+    TIMER_A3->R = 0;
+    TIMER_A3->CTL |= TIMER_A_CTL_MC__UP;
+    return 1;
 }
 
-void disableStepperMotor(void) {
-    //  Configure Timer_A3 in Stop Mode (leaving remaining configuration unchanged)
+void stepperStopDma(uint8_t motor) {
+    StepperMotor *m = &motors[motor];
+    DmaControl *active;
+    uint16_t unsent;
+
+    if (dmaMotor != motor) {
+        return;
+    }
     TIMER_A3->CTL = (TIMER_A3->CTL & ~TIMER_A_CTL_MC_MASK) | TIMER_A_CTL_MC__STOP;
+    DMA_Control->ENACLR = 1 << DMA_CH_STEPPER;
+    NVIC_DisableIRQ(DMA_INT1_IRQn);
 
+    // position and phase were advanced as buffers were filled; take back
+    //  what was queued but never reached the port
+    active = (DMA_Control->ALTSET & (1 << DMA_CH_STEPPER))
+            ? DMA_ALTERNATE(DMA_CH_STEPPER) : DMA_PRIMARY(DMA_CH_STEPPER);
+    unsent = STEPPER_DMA_BUFFER_LEN;
+    if ((active->control & DMA_CTL_MODE_MASK) != DMA_CTL_MODE_STOP) {
+        unsent += ((active->control & DMA_CTL_N_MASK) >> DMA_CTL_N_OFS) + 1;
+    }
+    m->position -= m->direction * unsent;
+    m->phase = (m->phase - m->direction * unsent) & m->seqMask;
+    dmaMotor = STEPPER_INVALID;
+
+    // resume on the ISR path at cruise speed
+    m->rampIndex = m->rampLength;
+    m->rampPhase = RAMP_CRUISE;
+    scheduleMotor(m);
 }
 
-void stepClockwise(void) {
-   // currentStep = (currentStep + 1) % STEP_SEQ_CNT;  // increment to next step position
-    currentStep = ((uint8_t)(currentStep + 1)) % STEP_SEQ_CNT;  // decrement to previous step position (counter-clockwise)
-    //  do this as a single assignment to avoid transient changes on driver signals
+uint32_t stepperCyclesPerStep(uint8_t dmaPath) {
+#if STEPPER_MEASURE_CYCLES
+    if (dmaPath) {
+        return dmaSteps ? dmaCycles / dmaSteps : 0;
+    }
+    return isrSteps ? isrCycles / isrSteps : 0;
+#else
+    return 0;
+#endif
+}
 
-    STEPPER_PORT->OUT = (STEPPER_PORT->OUT & 0x0F) + (stepperSequence[currentStep] << 4);
+/* Generates the next STEPPER_DMA_BUFFER_LEN port values for one half of
+ *  the ping-pong buffer and re-arms its control structure. Port bits that
+ *  do not belong to the motor are sampled now, so other outputs on the same
+ *  port written in the meantime may be delayed by up to two buffers. */
+static void fillDmaBuffer(StepperMotor *m, uint8_t half) {
+    DmaControl *entry;
+    uint8_t *buffer = dmaBuffer[half];
+    uint8_t keep = *m->out & ~m->mask;
+    uint8_t i;
 
+    for (i = 0; i < STEPPER_DMA_BUFFER_LEN; i++) {
+        m->phase = (m->phase + m->direction) & m->seqMask;
+        buffer[i] = keep | m->pattern[m->phase];
+    }
+    m->position += m->direction * STEPPER_DMA_BUFFER_LEN;
+
+    entry = half ? DMA_ALTERNATE(DMA_CH_STEPPER) : DMA_PRIMARY(DMA_CH_STEPPER);
+    entry->srcEnd = &buffer[STEPPER_DMA_BUFFER_LEN - 1];
+    entry->dstEnd = m->out;
+    entry->control = DMA_CTL_DST_INC_NONE | DMA_CTL_DST_SIZE_8
+            | DMA_CTL_SRC_INC_8 | DMA_CTL_SRC_SIZE_8 | DMA_CTL_ARB_1
+            | DMA_CTL_N(STEPPER_DMA_BUFFER_LEN) | DMA_CTL_MODE_PINGPONG;
 }
 
-void stepCounterClockwise(void) {
-    currentStep = ((uint8_t)(currentStep - 1)) % STEP_SEQ_CNT;  // decrement to previous step position (counter-clockwise)
-    //  update output port for current step pattern
+// DMA channel completion interrupt: one half of the pattern buffer is done
+void DMA_INT1_IRQHandler(void)
+{
+#if STEPPER_MEASURE_CYCLES
+    uint32_t start = DWT->CYCCNT;
+#endif
+    PROFILE_BEGIN(PROF_STEPPER_ISR);
+    TRACE(TRACE_DMA_BEGIN, 0);
+
+    // controller has moved on to the other structure, refill the finished one
+    if (DMA_Control->ALTSET & (1 << DMA_CH_STEPPER)) {
+        fillDmaBuffer(&motors[dmaMotor], 0);
+    } else {
+        fillDmaBuffer(&motors[dmaMotor], 1);
+    }
+
+#if STEPPER_MEASURE_CYCLES
+    dmaCycles += DWT->CYCCNT - start + IRQ_ENTRY_EXIT_CYCLES;
+    dmaSteps += STEPPER_DMA_BUFFER_LEN;
+#endif
+    TRACE(TRACE_DMA_END, 0);
+    PROFILE_END(PROF_STEPPER_ISR);
+}
+
+void stepperSetDriveMode(uint8_t motor, StepperDriveMode mode) {
+    StepperMotor *m = &motors[motor];
+    const uint8_t *sequence;
+    uint32_t primask = __get_PRIMASK();
+    uint8_t halfPhase;
+    uint8_t i;
+
+    if (motor >= motorCount) {
+        return;
+    }
+    // the step ISR indexes pattern with phase and seqMask, swap all three in
+    //  one piece. The queued DMA buffers were built from the old table, so
+    //  the mode only changes on the interrupt path
+    __disable_irq();
+    if (m->rampPhase == RAMP_DMA) {
+        __set_PRIMASK(primask);
+        return;
+    }
+
+    // express current rotor position in half-steps: wave patterns sit on
+    //  even half-steps, two-phase patterns on odd ones
+    if (m->driveMode == DRIVE_HALF_STEP) {
+        halfPhase = m->phase;
+    } else if (m->driveMode == DRIVE_FULL_STEP) {
+        halfPhase = (m->phase << 1) + 1;
+    } else {
+        halfPhase = m->phase << 1;
+    }
+
+    switch (mode) {
+    case DRIVE_HALF_STEP:
+        sequence = halfStepSequence;
+        m->seqMask = HALF_STEP_SEQ_CNT - 1;
+        m->phase = halfPhase;
+        break;
+    case DRIVE_FULL_STEP:
+        sequence = fullStepSequence;
+        m->seqMask = STEP_SEQ_CNT - 1;
+        m->phase = (halfPhase >> 1) & (STEP_SEQ_CNT - 1);
+        break;
+    default:
+        mode = DRIVE_WAVE;
+        sequence = waveSequence;
+        m->seqMask = STEP_SEQ_CNT - 1;
+        m->phase = ((halfPhase + 1) >> 1) & (STEP_SEQ_CNT - 1);
+        break;
+    }
+
+    // pre-shift patterns onto this motor's pins so a step is a single
+    //  masked index and one port store, with no modulo
+    for (i = 0; i <= m->seqMask; i++) {
+        m->pattern[i] = sequence[i] << m->shift;
+    }
+    m->driveMode = mode;
+    __set_PRIMASK(primask);
+}
+
+void stepClockwise(uint8_t motor) {
+    StepperMotor *m = &motors[motor];
+
+    m->phase = (m->phase + 1) & m->seqMask;
     //  do this as a single assignment to avoid transient changes on driver signals
-    //STEPPER_PORT->OUT |= (stepperSequence[currentStep] << 4);
-    STEPPER_PORT->OUT = (STEPPER_PORT->OUT & 0x0F) + (stepperSequence[currentStep] << 4);
+    *m->out = (*m->out & ~m->mask) | m->pattern[m->phase];
+}
+
+void stepCounterClockwise(uint8_t motor) {
+    StepperMotor *m = &motors[motor];
+
+    m->phase = (m->phase - 1) & m->seqMask;
+    //  do this as a single assignment to avoid transient changes on driver signals
+    *m->out = (*m->out & ~m->mask) | m->pattern[m->phase];
+}
+
+/* Advances one motor by one step and works out the interval to its next
+ *  step. Called from the Timer_A3 ISR when the motor's deadline is reached. */
+static void stepMotor(StepperMotor *m) {
+    int32_t remaining;
+    int32_t slew;
+
+    if (m->rampPhase == RAMP_HOLD) {
+        // the last step has had its interval, de-energize the coils
+        *m->out &= ~m->mask;
+        m->rampPhase = RAMP_IDLE;
+        return;
+    }
+
+    m->phase = (m->phase + m->direction) & m->seqMask;
+    *m->out = (*m->out & ~m->mask) | m->pattern[m->phase];
+    m->position += m->direction;
+
+    if (m->moveMode == MOVE_TARGET) {
+        remaining = (m->target - m->position) * m->direction;
+        if (remaining == 0) {
+            // arrived: hold for the current interval so the rotor settles on
+            //  this step, then release; the timer stops with the last motor
+            m->moveMode = MOVE_FREE;
+            m->rampPhase = RAMP_HOLD;
+            return;
+        }
+        if (remaining < 0) {
+            // target is behind us: brake, then turn around at the slow end
+            if (m->rampIndex == 0) {
+                m->direction = -m->direction;
+                m->rampPhase = RAMP_ACCEL;
+            } else {
+                m->rampPhase = RAMP_DECEL;
+            }
+        } else if (remaining <= m->rampIndex) {
+            // just enough steps left to ramp down
+            m->rampPhase = RAMP_DECEL;
+        } else if (m->rampPhase == RAMP_DECEL) {
+            // target moved further away while braking
+            m->rampPhase = RAMP_ACCEL;
+        }
+    }
+
+    // interval to the next step, at most one table read per step
+    switch (m->rampPhase) {
+    case RAMP_ACCEL:
+        m->interval = m->rampTable[m->rampIndex];
+        if (++m->rampIndex == m->rampLength) {
+            m->rampPhase = RAMP_CRUISE;
+        }
+        break;
+    case RAMP_CRUISE:
+        // the last ramp interval is still a little slower than cruise
+        m->interval = m->cruisePeriod;
+        break;
+    case RAMP_TEMPO:
+        // first-order slew to the target tempo, fraction carried in phase.
+        //  The shift rounds down, so slowing down would stall just short of
+        //  the target and drift off the beat; finish the last bit directly
+        slew = (m->tempoTarget - m->tempoInterval) >> TEMPO_SLEW_SHIFT;
+        if (slew == 0) {
+            m->tempoInterval = m->tempoTarget;
+        } else {
+            m->tempoInterval += slew;
+        }
+        m->tempoPhase += (uint32_t)m->tempoInterval;
+        m->interval = (uint16_t)(m->tempoPhase >> 16);
+        m->tempoPhase &= 0xFFFF;
+        break;
+    case RAMP_DECEL:
+        if (m->rampIndex > 0) {
+            m->interval = m->rampTable[--m->rampIndex];
+        } else if (m->moveMode == MOVE_FREE) {
+            // slowest step taken, hold it for one interval and release
+            m->rampPhase = RAMP_HOLD;
+        }
+        break;
+    default:
+        break;
+    }
 }
 
 // Timer A3 CCR0 interrupt service routine
 void TA3_0_IRQHandler(void)
 {
+    StepperMotor *m;
+    uint32_t now;
+    uint32_t next;
+    int16_t elapsed;
+    uint8_t active;
+    uint8_t i;
+#if STEPPER_MEASURE_CYCLES
+    uint32_t start = DWT->CYCCNT;
+#endif
+    PROFILE_BEGIN(PROF_STEPPER_ISR);
+    TRACE(TRACE_STEPPER_BEGIN, 0);
+
+    TIMER_A3->CCTL[0] &= ~TIMER_A_CCTLN_CCIFG;      // Clear CCR0 interrupt flag
+
     /* Not necessary to check which flag is set because only one IRQ
      *  mapped to this interrupt vector     */
-    stepClockwise();
+    now = scheduledDue;
+    while (1) {
+        // step every motor that is due, find the earliest next deadline
+        active = 0;
+        next = now + 0xFFFF;
+        for (i = 0; i < motorCount; i++) {
+            m = &motors[i];
+            if (m->rampPhase == RAMP_IDLE) {
+                continue;
+            }
+            if ((int32_t)(m->nextDue - now) <= 0) {
+                stepMotor(m);
+#if STEPPER_MEASURE_CYCLES
+                isrSteps++;
+#endif
+                if (m->rampPhase == RAMP_IDLE) {
+                    continue;
+                }
+                m->nextDue += m->interval;
+            }
+            if ((int32_t)(m->nextDue - next) < 0) {
+                next = m->nextDue;
+            }
+            active = 1;
+        }
 
-    TIMER_A3->CCTL[0] &= ~TIMER_A_CCTLN_CCIFG;      // Clear CCR0 interrupt flag
+        if (!active) {
+            //  Configure Timer_A3 in Stop Mode until a motor is started again
+            TIMER_A3->CTL = (TIMER_A3->CTL & ~TIMER_A_CTL_MC_MASK) | TIMER_A_CTL_MC__STOP;
+            engineRunning = 0;
+            break;
+        }
+
+        // if the next deadline is already (nearly) here, handle it now
+        //  rather than programming a compare the timer has passed. After
+        //  taking a deadline early, now is ahead of TAR and elapsed negative
+        elapsed = (int16_t)(TIMER_A3->R - (uint16_t)now);
+        if ((int32_t)(next - now) > elapsed + STEPPER_ISR_MARGIN) {
+            break;
+        }
+        now = next;
+    }
 
+    if (active) {
+        lastDue = now;
+        scheduledDue = next;
+        TIMER_A3->CCR[0] = (uint16_t)next;
+    }
 
+#if STEPPER_MEASURE_CYCLES
+    isrCycles += DWT->CYCCNT - start + IRQ_ENTRY_EXIT_CYCLES;
+#endif
+    TRACE(TRACE_STEPPER_END, active);
+    PROFILE_END(PROF_STEPPER_ISR);
 }
@@ -4,7 +4,7 @@
  * ECE230 Winter 2024-2025
  *
  * Description: Stepper motor ULN2003 driver for MSP432P4111 Launchpad.
- *              Assumes SMCLK configured with 48MHz HFXT as source.
+ *              Timer_A3 runs from SMCLK, prescaled to STEPPER_TICK_HZ.
  *              Uses Timer_A3 and P2.7, P2.6, P2.5, P2.4
  *
  *  Created on:
@@ -26,6 +26,7 @@ extern "C"
 #endif
 
 #include "msp.h"
+#include "stepperProfile.h"
 
 #define STEPPER_PORT                    P2
 #define STEPPER_MASK                    (0x00F0)
@@ -36,13 +37,55 @@ extern "C"
 
 #define INIT_PERIOD                     2500
 #define STEP_SEQ_CNT                    4
+#define HALF_STEP_SEQ_CNT               8
+#define RAMP_START_PERIOD               10000   // first step of a ramp
+#define DEFAULT_RAMP_STEPS              48
+#define STEPPER_TICK_HZ                 1000000 // Timer_A3 rate, any SMCLK
+#define STEPS_PER_BEAT                  64
+#define TEMPO_SLEW_SHIFT                4       // tempo change time constant
+
+#define STEPPER_MAX_MOTORS              3
+#define STEPPER_MAIN                    0       // motor on P2.4-P2.7
+#define STEPPER_INVALID                 0xFF
+#define STEPPER_ISR_MARGIN              20      // ticks, min compare lead time
+#define STEPPER_DMA_BUFFER_LEN          32      // steps per ping-pong half
+
+/* 1 to count CPU cycles spent per step on the ISR and DMA paths. Off unless
+ *  the build defines KARAOKE_DIAGNOSTICS, as the Debug configuration does */
+#ifndef STEPPER_MEASURE_CYCLES
+#ifdef KARAOKE_DIAGNOSTICS
+#define STEPPER_MEASURE_CYCLES          1
+#else
+#define STEPPER_MEASURE_CYCLES          0
+#endif
+#endif
+#define IRQ_ENTRY_EXIT_CYCLES           24      // Cortex-M4 stacking + return
+
+typedef enum _StepperDriveMode {
+    DRIVE_WAVE,             // one coil at a time, 4 steps
+    DRIVE_FULL_STEP,        // two adjacent coils, 4 steps, full torque
+    DRIVE_HALF_STEP         // alternates one and two coils, 8 steps
+} StepperDriveMode;
+
+/* Output pins of one motor: four adjacent bits of a port, IN1 on the highest */
+typedef struct _StepperPins {
+    volatile uint8_t *out;
+    volatile uint8_t *dir;
+    volatile uint8_t *sel0;
+    volatile uint8_t *sel1;
+    uint8_t shift;          // 4 for pins 7..4, 0 for pins 3..0
+} StepperPins;
+
+#define STEPPER_PINS(port, nibbleShift) \
+    { &(port)->OUT, &(port)->DIR, &(port)->SEL0, &(port)->SEL1, (nibbleShift) }
 
 /*!
  * \brief This function configures pins and timer for stepper motor driver
  *
  * This function configures P2.4, P2.5, P2.6, and P2.6 as output pins
- *  for the ULN2003 stepper driver IN port, and initializes Timer_A3 to
- *  increment step position with compare interrupt
+ *  for the ULN2003 stepper driver IN port (motor STEPPER_MAIN), and
+ *  initializes Timer_A3 to schedule steps of all motors with the CCR0
+ *  compare interrupt
  *
  * Modified bits 4 to 7 of \b P2DIR register and \b P2SEL registers.
  * Modified \b TA3CTL register and \b TA3CCTL0 registers.
@@ -53,29 +96,233 @@ extern void initStepperMotor(void);
 
 
 /*!
- * \brief This starts stepper motor rotation by turning on Timer_A3
+ * \brief This function adds another motor to the step engine
+ *
+ * This function configures four pins as outputs for a ULN2003 driver and
+ *  registers the motor with the Timer_A3 scheduler. Each motor has its own
+ *  drive mode, profile and position. All motors share one interrupt.
+ *
+ * \param pins describes the port and nibble, see STEPPER_PINS()
+ *
+ * \return motor id for the other stepper functions, or STEPPER_INVALID if
+ *  STEPPER_MAX_MOTORS are already attached
+ */
+extern uint8_t stepperAttach(const StepperPins *pins);
+
+
+/*!
+ * \brief This function selects the acceleration profile
  *
- * This function starts stepper motor rotation by turning on Timer_A3.
+ * This function precomputes the per-step CCR0 intervals used to ramp from
+ *  \b startPeriod up to \b cruisePeriod. Must be called while the motor is
+ *  stopped. The same table is replayed in reverse when decelerating.
+ *
+ * \param motor is the motor id
+ * \param type is PROFILE_CONSTANT, PROFILE_TRAPEZOIDAL or PROFILE_SCURVE
+ * \param startPeriod is the first step interval in Timer_A3 ticks
+ * \param cruisePeriod is the full speed step interval in Timer_A3 ticks
+ * \param rampSteps is the ramp length in steps (up to RAMP_TABLE_MAX)
+ *
+ * \return ramp length, or 0 if the profile was rejected and left unchanged
+ */
+extern uint16_t stepperSetProfile(uint8_t motor, StepperProfileType type,
+                                  uint16_t startPeriod, uint16_t cruisePeriod,
+                                  uint16_t rampSteps);
+
+
+/*!
+ * \brief This starts stepper motor rotation
+ *
+ * This function starts free-running clockwise rotation, turning on Timer_A3
+ * if no other motor is running. Rotation begins at the slow end of the
+ * configured ramp and accelerates to cruise speed.
  * Assumes stepper motor has already been configured by initStepperMotor().
  *
  * Modified \b TA3CTL register.
  *
+ * \param motor is the motor id
+ *
  * \return None
  */
-void enableStepperMotor(void);
+void enableStepperMotor(uint8_t motor);
 
 
 /*!
- * \brief This stops stepper motor rotation by turning off timer
+ * \brief This stops stepper motor rotation immediately
  *
- * This function stops stepper motor rotation by turning off Timer_A3.
+ * This function stops stepping the motor without a ramp and de-energizes
+ * its coils. Timer_A3 is turned off once no motor is running.
  * Stepper motor is still configured after calling this function.
  *
  * Modified \b TA3CTL register.
  *
+ * \param motor is the motor id
+ *
+ * \return None
+ */
+void disableStepperMotor(uint8_t motor);
+
+
+/*!
+ * \brief This decelerates the stepper motor to a stop
+ *
+ * This function makes the step interrupt replay the ramp in reverse and
+ *  stop the motor after the slowest step, then releases the coils one
+ *  interval later. Returns immediately.
+ *
+ * \param motor is the motor id
+ *
  * \return None
  */
-void disableStepperMotor(void);
+extern void stepperRequestStop(uint8_t motor);
+
+
+/*!
+ * \brief This reports whether a motor is stepping
+ *
+ * \param motor is the motor id
+ *
+ * \return 1 while the motor is being stepped or holds its last step, 0 when
+ *  stopped
+ */
+extern uint8_t isStepperRunning(uint8_t motor);
+
+
+/*!
+ * \brief This locks the step rate to a song tempo
+ *
+ * This function runs the motor clockwise at STEPS_PER_BEAT steps per beat.
+ *  Step intervals are fixed-point with the fraction carried from step to
+ *  step, so the motor stays aligned with the beat over a whole song. Calling
+ *  again with a new tempo slews the rate smoothly instead of jumping. If the
+ *  motor is stopped it spins up from the slow end of the ramp.
+ *
+ * \param motor is the motor id
+ * \param bpmX100 is the tempo in beats per minute times 100
+ *
+ * \return None
+ */
+extern void stepperFollowTempo(uint8_t motor, uint16_t bpmX100);
+
+
+/*!
+ * \brief This hands a cruising motor over to DMA driven stepping
+ *
+ * This function switches Timer_A3 to Up Mode at the motor's current step
+ *  interval and lets every CCR0 event trigger a DMA copy of the next coil
+ *  pattern from a ping-pong buffer straight to the port OUT register. The
+ *  CPU only runs at buffer boundaries (every STEPPER_DMA_BUFFER_LEN steps).
+ *  The motor must be cruising in free-run mode and no other motor may be
+ *  running; other motors cannot start until stepperStopDma().
+ *
+ * This is an opt-in API, the firmware itself does not call it. A motor
+ *  locked to a tempo by stepperFollowTempo() is not eligible: Up Mode
+ *  repeats a whole-tick interval and would drop the fraction that keeps it
+ *  on the beat, e.g. 0.5us per step at 120 bpm, 19ms over a five minute
+ *  song.
+ *
+ * \param motor is the motor id
+ *
+ * \return 1 if DMA stepping started, 0 if the motor was not eligible
+ */
+extern uint8_t stepperStartDma(uint8_t motor);
+
+
+/*!
+ * \brief This returns a DMA driven motor to interrupt driven stepping
+ *
+ * This function stops the DMA stream, corrects position for patterns that
+ *  were queued but not output, and resumes the motor at cruise speed on the
+ *  Timer_A3 interrupt. stepperRequestStop() also does this implicitly.
+ *
+ * \param motor is the motor id
+ *
+ * \return None
+ */
+extern void stepperStopDma(uint8_t motor);
+
+
+/*!
+ * \brief This reports average CPU cost per step
+ *
+ * This function returns the measured cycles per step, including a nominal
+ *  IRQ_ENTRY_EXIT_CYCLES per interrupt, for either stepping path. Requires
+ *  STEPPER_MEASURE_CYCLES.
+ *
+ * \param dmaPath is 1 for the DMA path, 0 for the Timer_A3 ISR path
+ *
+ * \return average cycles per step, 0 if nothing measured
+ */
+extern uint32_t stepperCyclesPerStep(uint8_t dmaPath);
+
+
+/*!
+ * \brief This moves the stepper motor to an absolute position
+ *
+ * This function starts a ramped move to \b target, choosing the direction
+ *  from the current position. If a move is already in progress the target is
+ *  updated on the fly. The last step is held for one step interval, then
+ *  the coils are de-energized, and Timer_A3 is stopped if no other motor is
+ *  running, so no step interrupts occur while idle.
+ *
+ * \param motor is the motor id
+ * \param target is the absolute position in steps (positive is clockwise)
+ *
+ * \return None
+ */
+extern void stepperMoveTo(uint8_t motor, int32_t target);
+
+
+/*!
+ * \brief This moves the stepper motor by a relative number of steps
+ *
+ * \param motor is the motor id
+ * \param delta is the number of steps to move (positive is clockwise)
+ *
+ * \return None
+ */
+extern void stepperMoveBy(uint8_t motor, int32_t delta);
+
+
+/*!
+ * \brief This returns the absolute step position
+ *
+ * \param motor is the motor id
+ *
+ * \return steps moved since initStepperMotor(), positive is clockwise
+ */
+extern int32_t stepperGetPosition(uint8_t motor);
+
+
+/*!
+ * \brief This redefines the current absolute position
+ *
+ * This function sets the step counter (e.g. to 0 to mark a home position).
+ *  It is ignored while the motor is moving or for an unknown motor id.
+ *
+ * \param motor is the motor id
+ * \param position is the new value of the step counter
+ *
+ * \return None
+ */
+extern void stepperSetPosition(uint8_t motor, int32_t position);
+
+
+/*!
+ * \brief This function selects the coil drive sequence
+ *
+ * This function switches between wave, two-phase full-step and half-step
+ *  drive. The current rotor position is carried over, so switching modes
+ *  does not cause a jump. Note half-step mode takes twice as many steps per
+ *  revolution. Safe to call while the motor steps under interrupts; ignored
+ *  while a DMA stream runs or for an unknown motor id.
+ *
+ * \param motor is the motor id
+ * \param mode is DRIVE_WAVE, DRIVE_FULL_STEP or DRIVE_HALF_STEP
+ *
+ * \return None
+ */
+extern void stepperSetDriveMode(uint8_t motor, StepperDriveMode mode);
 
 
 /*!
@@ -83,11 +330,13 @@ void disableStepperMotor(void);
  *
  * This function increments to next clockwise step position
  *
- * Modified bit 4, 5, 6, and 7 of \b P2OUT register.
+ * Modified the motor's four bits of its port \b OUT register.
+ *
+ * \param motor is the motor id
  *
  * \return None
  */
-extern void stepClockwise(void);
+extern void stepClockwise(uint8_t motor);
 
 
 /*!
@@ -95,11 +344,13 @@ extern void stepClockwise(void);
  *
  * This function increments to next counter-clockwise step position
  *
- * Modified bit 4, 5, 6, and 7 of \b P2OUT register.
+ * Modified the motor's four bits of its port \b OUT register.
+ *
+ * \param motor is the motor id
  *
  * \return None
  */
-extern void stepCounterClockwise(void);
+extern void stepCounterClockwise(uint8_t motor);
 
 
 //*****************************************************************************
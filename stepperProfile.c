@@ -0,0 +1,112 @@
+/*! \file */
+/*!
+ * stepperProfile.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Motion profile generator for the stepper motor driver.
+ *              Runs once when a profile is configured; the step ISR only
+ *              indexes the resulting table.
+ */
+
+#include "stepperProfile.h"
+
+#define SOLVER_ITERATIONS   24
+
+float rampPosition(StepperProfileType type, float t, float rampTime,
+                   float v0, float v1) {
+    float x;
+
+    if (t <= 0.0f) {
+        return 0.0f;
+    }
+    if (t >= rampTime) {
+        // past the ramp, continue at cruise velocity
+        return rampTime * (v0 + v1) * 0.5f + (t - rampTime) * v1;
+    }
+
+    x = t / rampTime;
+    switch (type) {
+    case PROFILE_TRAPEZOIDAL:
+        // v(x) = v0 + (v1 - v0) * x
+        return v0 * t + (v1 - v0) * rampTime * x * x * 0.5f;
+    case PROFILE_SCURVE:
+        // v(x) = v0 + (v1 - v0) * (3x^2 - 2x^3), integral is x^3 - x^4/2
+        return v0 * t + (v1 - v0) * rampTime * (x * x * x - x * x * x * x * 0.5f);
+    default:
+        return v1 * t;
+    }
+}
+
+uint16_t buildRampTable(uint16_t *table, uint16_t rampSteps,
+                        StepperProfileType type, uint16_t startPeriod,
+                        uint16_t cruisePeriod) {
+    float v0, v1, rampTime;
+    float lo, hi, mid, tPrev;
+    uint32_t tick, tickPrev;
+    uint16_t n;
+    int i;
+
+    if (rampSteps == 0 || rampSteps > RAMP_TABLE_MAX
+            || cruisePeriod < MIN_STEP_PERIOD || startPeriod < cruisePeriod) {
+        return 0;
+    }
+
+    if (type == PROFILE_CONSTANT || startPeriod == cruisePeriod) {
+        for (n = 0; n < rampSteps; n++) {
+            table[n] = cruisePeriod;
+        }
+        return rampSteps;
+    }
+
+    v0 = 1.0f / startPeriod;
+    v1 = 1.0f / cruisePeriod;
+    // both profiles average (v0 + v1) / 2 over the ramp
+    rampTime = 2.0f * rampSteps / (v0 + v1);
+
+    tPrev = 0.0f;
+    tickPrev = 0;
+    for (n = 0; n < rampSteps; n++) {
+        // bisect for the time at which step n+1 is reached
+        lo = tPrev;
+        hi = rampTime;
+        for (i = 0; i < SOLVER_ITERATIONS; i++) {
+            mid = 0.5f * (lo + hi);
+            if (rampPosition(type, mid, rampTime, v0, v1) < (float)(n + 1)) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+        tPrev = hi;
+
+        // difference of rounded absolute times keeps rounding from drifting
+        tick = (uint32_t)(hi + 0.5f);
+        if (tick - tickPrev > startPeriod) {
+            table[n] = startPeriod;
+        } else if (tick - tickPrev < cruisePeriod) {
+            table[n] = cruisePeriod;
+        } else {
+            table[n] = (uint16_t)(tick - tickPrev);
+        }
+        tickPrev = tick;
+    }
+    return rampSteps;
+}
+
+uint32_t tempoIntervalQ16(uint16_t bpmX100, uint16_t stepsPerBeat,
+                          uint32_t tickHz) {
+    uint64_t interval;
+
+    if (bpmX100 == 0 || stepsPerBeat == 0) {
+        return (uint32_t)0xFFFF << 16;
+    }
+    // ticks per step = tickHz * 60 s / (bpm * stepsPerBeat), bpm scaled by 100
+    interval = ((uint64_t)tickHz * 6000u << 16)
+                / ((uint32_t)bpmX100 * stepsPerBeat);
+    if (interval > ((uint32_t)0xFFFF << 16)) {
+        interval = (uint32_t)0xFFFF << 16;
+    } else if (interval < ((uint32_t)MIN_STEP_PERIOD << 16)) {
+        interval = (uint32_t)MIN_STEP_PERIOD << 16;
+    }
+    return (uint32_t)interval;
+}
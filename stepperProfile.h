@@ -0,0 +1,102 @@
+/*! \file */
+/*!
+ * stepperProfile.h
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Motion profile generator for the stepper motor driver.
+ *              Precomputes per-step Timer_A CCR0 intervals for trapezoidal
+ *              (constant acceleration) and S-curve (smoothstep velocity)
+ *              ramps so the step ISR only has to load the next table entry.
+ *
+ *              No hardware access; intervals are in timer ticks.
+ */
+
+#ifndef STEPPERPROFILE_H_
+#define STEPPERPROFILE_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+#define RAMP_TABLE_MAX                  64      // max steps in accel ramp
+#define MIN_STEP_PERIOD                 2       // smallest usable CCR0 value
+
+typedef enum _StepperProfileType {
+    PROFILE_CONSTANT, PROFILE_TRAPEZOIDAL, PROFILE_SCURVE
+} StepperProfileType;
+
+/*!
+ * \brief This function fills an acceleration ramp table
+ *
+ * This function computes the CCR0 interval for each step of a ramp from
+ *  \b startPeriod to \b cruisePeriod. The velocity profile is solved in the
+ *  time domain and each entry is the time between consecutive whole steps,
+ *  so the table matches the analytic profile without accumulating rounding.
+ *  Deceleration reuses the same table in reverse order.
+ *
+ * \param table is the destination, at least \b rampSteps entries long
+ * \param rampSteps is the number of steps in the ramp (1 to RAMP_TABLE_MAX)
+ * \param type selects the velocity profile
+ * \param startPeriod is the interval of the first step in timer ticks
+ * \param cruisePeriod is the interval at full speed in timer ticks
+ *
+ * \return number of entries written (0 if arguments are invalid)
+ */
+extern uint16_t buildRampTable(uint16_t *table, uint16_t rampSteps,
+                               StepperProfileType type, uint16_t startPeriod,
+                               uint16_t cruisePeriod);
+
+/*!
+ * \brief This function evaluates the analytic ramp profile
+ *
+ * This function returns the number of steps travelled after \b t ticks of a
+ *  ramp with the given parameters. Used by buildRampTable and handy for
+ *  checking table contents against the ideal curve.
+ *
+ * \param type selects the velocity profile
+ * \param t is the time since the start of the ramp in timer ticks
+ * \param rampTime is the total ramp duration in timer ticks
+ * \param v0 is the start velocity in steps per tick
+ * \param v1 is the cruise velocity in steps per tick
+ *
+ * \return position in steps (fractional)
+ */
+extern float rampPosition(StepperProfileType type, float t, float rampTime,
+                          float v0, float v1);
+
+/*!
+ * \brief This function converts a tempo to a fixed-point step interval
+ *
+ * This function computes the Timer_A interval between steps, in ticks with
+ *  16 fractional bits, for the motor to cover \b stepsPerBeat steps per beat.
+ *  Accumulating the fraction in the step ISR keeps long-run beat alignment
+ *  exact to within one tick.
+ *
+ * \param bpmX100 is the tempo in beats per minute times 100 (12050 = 120.5)
+ * \param stepsPerBeat is the number of motor steps per beat
+ * \param tickHz is the timer tick frequency in Hz
+ *
+ * \return step interval in ticks, Q16.16, clamped to the 16-bit timer range
+ */
+extern uint32_t tempoIntervalQ16(uint16_t bpmX100, uint16_t stepsPerBeat,
+                                 uint32_t tickHz);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STEPPERPROFILE_H_ */
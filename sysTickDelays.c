@@ -1,49 +1,164 @@
 /*!
  * sysTickDelays.c
- *      Description: Helper file for delay functions using SysTick timer. Must be
+ *      Description: Helper file for delay and deadline functions. Must be
  *                   initialized with system clock frequency using initDelayTimer.
+ *                   Follows later MCLK changes made through clockManager.
+ *
+ *                   Timer32_2 runs free at MCLK as the time base. Microseconds
+ *                   are converted to ticks with a Q8 ticks-per-microsecond
+ *                   factor computed once per clock change, so no call needs a
+ *                   64-bit multiply or a divide.
  *
  *      Author: ece230
  */
 
 #include <msp.h>
 #include "sysTickDelays.h"
+#include "clockManager.h"
 
 #define USEC_DIVISOR    1000000
-#define MSEC_DIVISOR    1000
-#define SYSTICK_LIMIT   0x00FFFFFF
+#define DEADLINE_LIMIT  0x7FFFFFFF      // deadlines compare as signed
+
+/* MCLK ticks per microsecond, Q8, must be set in initDelayTimer */
+static uint32_t ticksPerMicroQ8 = 0;
+/* Longest delay that fits DEADLINE_LIMIT at the current clock */
+static uint32_t maxMicros = 0;
+
+/* Deadline slots, absolute Timer32_2 tick times */
+static uint32_t deadlineDue[DEADLINE_SLOTS];
+static uint8_t deadlineUsed = 0;        // bit per slot
+
+/* Remaining ticks of each slot while the clock changes */
+static uint32_t deadlineRemaining[DEADLINE_SLOTS];
+
+static inline uint32_t delayNow(void) {
+    // Timer32 counts down, flip it to count up
+    return ~TIMER32_2->VALUE;
+}
+
+static inline uint32_t microsToTicks(uint32_t micros) {
+    // split so the product stays within 32 bits for any valid delay
+    return (micros >> 8) * ticksPerMicroQ8
+            + (((micros & 0xFF) * ticksPerMicroQ8) >> 8);
+}
+
+static void setClockFrequency(uint32_t clkFreq) {
+    ticksPerMicroQ8 = (uint32_t)(((uint64_t)clkFreq << 8) / USEC_DIVISOR);
+    if (ticksPerMicroQ8 == 0) {
+        ticksPerMicroQ8 = 1;
+    }
+    maxMicros = (DEADLINE_LIMIT / ticksPerMicroQ8) << 8;
+}
 
-/* Holds frequency of system clock, must be set in initDelayTimer */
-uint64_t sysClkFreq = 0;
+/* Keeps tick calculations in step with MCLK changes. Pending deadlines keep
+ *  their remaining time by rescaling it to the new tick rate. */
+static void delayClockChanged(ClockEvent event) {
+    uint32_t now;
+    uint32_t oldRate;
+    uint8_t i;
+
+    if (event == CLOCK_PRE_CHANGE) {
+        now = delayNow();
+        for (i = 0; i < DEADLINE_SLOTS; i++) {
+            if ((deadlineUsed & (1 << i)) && (int32_t)(deadlineDue[i] - now) > 0) {
+                deadlineRemaining[i] = deadlineDue[i] - now;
+            } else {
+                deadlineRemaining[i] = 0;
+            }
+        }
+    } else {
+        oldRate = ticksPerMicroQ8;
+        setClockFrequency(getMCLKFrequency());
+        now = delayNow();
+        for (i = 0; i < DEADLINE_SLOTS; i++) {
+            if (deadlineUsed & (1 << i)) {
+                deadlineDue[i] = now + (uint32_t)((uint64_t)deadlineRemaining[i]
+                                    * ticksPerMicroQ8 / oldRate);
+            }
+        }
+    }
+}
 
 void initDelayTimer(uint32_t clkFreq) {
     // store value of system clock (MCLK) frequency
     //   used for tick count calculations
-    sysClkFreq = clkFreq;
+    setClockFrequency(clkFreq);
+    clockRegisterListener(delayClockChanged);
+
+    // Timer32_2 free-running, 32-bit, no prescale, no interrupt
+    TIMER32_2->CONTROL = TIMER32_CONTROL_SIZE;
+    TIMER32_2->LOAD = 0xFFFFFFFF;
+    TIMER32_2->CONTROL |= TIMER32_CONTROL_ENABLE;
+}
+
+uint32_t delayGetTicks(void) {
+    return delayNow();
+}
+
+uint32_t delayMicrosToTicks(uint32_t micros) {
+    return microsToTicks(micros > maxMicros ? maxMicros : micros);
+}
+
+uint8_t deadlineStart(uint32_t micros) {
+    uint8_t i;
+
+    if (micros > maxMicros) {
+        micros = maxMicros;
+    }
+    for (i = 0; i < DEADLINE_SLOTS; i++) {
+        if (!(deadlineUsed & (1 << i))) {
+            deadlineDue[i] = delayNow() + microsToTicks(micros);
+            deadlineUsed |= 1 << i;
+            return i;
+        }
+    }
+    return DEADLINE_NONE;
+}
+
+uint8_t deadlineExpired(uint8_t deadline) {
+    if (deadline >= DEADLINE_SLOTS || !(deadlineUsed & (1 << deadline))) {
+        return 1;
+    }
+    if ((int32_t)(deadlineDue[deadline] - delayNow()) > 0) {
+        return 0;
+    }
+    deadlineUsed &= ~(1 << deadline);
+    return 1;
+}
+
+void deadlineWait(uint8_t deadline) {
+    while (!deadlineExpired(deadline));
+}
+
+void deadlineCancel(uint8_t deadline) {
+    if (deadline < DEADLINE_SLOTS) {
+        deadlineUsed &= ~(1 << deadline);
+    }
+}
+
+void spinNanoSec(uint16_t nanos) {
+    uint32_t start = delayNow();
+    // round up, at least one tick
+    uint32_t ticks = ((uint32_t)nanos * ticksPerMicroQ8 + 255999) / 256000;
+
+    while (delayNow() - start < ticks);
 }
 
 int delayMicroSec(uint32_t micros) {
-    // calculate timer ticks needed for \b micros microseconds
-    uint64_t ticks = sysClkFreq * micros / USEC_DIVISOR;
-    // if requested delay is too short or exceeds max period of SysTick timer,
+    uint32_t start = delayNow();
+    uint32_t ticks;
+
+    // if requested delay is too short or exceeds the deadline range,
     //  return error state
+    if (micros > maxMicros) {
+        return OVERFLOW;
+    }
+    ticks = microsToTicks(micros);
     if (ticks < 2) {
         return UNDERFLOW;
     }
-    if (ticks > SYSTICK_LIMIT) {
-        return OVERFLOW;
-    }
 
-    // Set the period of the SysTick counter
-    SysTick->LOAD = ticks - 1;
-    // Write any value to reset timer counter
-    SysTick->VAL = 1;
-    // Enable SysTick timer
-    SysTick->CTRL |= SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
-    // Wait for SysTick COUNT flag
-    while(!(SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk));
-    // Disable SysTick timer
-    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    while (delayNow() - start < ticks);
     return SUCCESS;
 }
 
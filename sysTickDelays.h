@@ -1,7 +1,12 @@
 /*!
  * sysTickDelays.h
- *      Description: Helper file for delay functions using SysTick timer. Must be
- *                   initialized with system clock frequency using initDelayTimer.
+ *      Description: Helper file for delay and deadline functions using a
+ *                   free-running Timer32_2 at MCLK. Must be initialized with
+ *                   system clock frequency using initDelayTimer.
+ *
+ *                   Blocking delays spin on the counter. Deadlines are
+ *                   non-blocking timeouts held in DEADLINE_SLOTS slots, so
+ *                   several can be pending while the caller does other work.
  *
  *      Author: ece230
  */
@@ -20,16 +25,22 @@ extern "C"
 {
 #endif
 
+#include <stdint.h>
+
 #define UNDERFLOW       2
 #define OVERFLOW        1
 #define SUCCESS         0
 
+#define DEADLINE_SLOTS  8
+#define DEADLINE_NONE   0xFF
+
 
 /*!
  *
- * \brief This function initializes sysTick based delay module
+ * \brief This function initializes the delay module
  *
- * This function initializes sysTick based delay module to set clock frequency.
+ * This function sets the clock frequency used for tick calculations and
+ *  starts Timer32_2 as a free-running counter.
  *
  * \param clkFreq is the frequency of the system clock in Hz
  *
@@ -40,7 +51,8 @@ extern void initDelayTimer(uint32_t clkFreq);
 /*!
  * \brief This function delays for specified time
  *
- * This function delays for specified microseconds using sysTick.
+ * This function delays for specified microseconds by spinning on the
+ *  free-running counter.
  *
  * \param micros is the number of microseconds to delay
  *
@@ -52,7 +64,8 @@ extern int delayMicroSec(uint32_t micros);
 /*!
  * \brief This function delays for specified time
  *
- * This function delays for specified milliseconds using sysTick.
+ * This function delays for specified milliseconds by spinning on the
+ *  free-running counter.
  *
  * \param millis is the number of milliseconds to delay
  *
@@ -61,6 +74,80 @@ extern int delayMicroSec(uint32_t micros);
  */
 extern int delayMilliSec(uint32_t millis);
 
+/*!
+ * \brief This function returns the free-running MCLK tick counter
+ *
+ * Counts up and wraps at 32 bits. Differences of two readings are MCLK
+ *  cycles as long as the clock did not change in between.
+ *
+ * \return current tick count
+ */
+extern uint32_t delayGetTicks(void);
+
+/*!
+ * \brief This function converts microseconds to ticks at the current MCLK
+ *
+ * \param micros is the interval in microseconds
+ *
+ * \return interval in ticks
+ */
+extern uint32_t delayMicrosToTicks(uint32_t micros);
+
+/*!
+ * \brief This function busy-waits for a sub-microsecond interval
+ *
+ * For bus timing such as strobe pulse widths. Rounds up to whole MCLK
+ *  ticks, so it waits at least \b nanos nanoseconds.
+ *
+ * \param nanos is the number of nanoseconds to wait
+ *
+ * \return None
+ */
+extern void spinNanoSec(uint16_t nanos);
+
+/*!
+ * \brief This function starts a non-blocking timeout
+ *
+ * Pending deadlines keep their remaining time across MCLK changes; the
+ *  time the switch itself takes is not counted, so they end that much late,
+ *  never early. Delays beyond the counter range are clamped.
+ *
+ * \param micros is the timeout in microseconds
+ *
+ * \return deadline handle, or DEADLINE_NONE if all slots are in use
+ */
+extern uint8_t deadlineStart(uint32_t micros);
+
+/*!
+ * \brief This function checks a deadline without blocking
+ *
+ * The slot is released once this returns 1. DEADLINE_NONE and released
+ *  handles always report expired.
+ *
+ * \param deadline is a handle from deadlineStart
+ *
+ * \return 1 if the deadline has passed, 0 otherwise
+ */
+extern uint8_t deadlineExpired(uint8_t deadline);
+
+/*!
+ * \brief This function waits for a deadline and releases it
+ *
+ * \param deadline is a handle from deadlineStart
+ *
+ * \return None
+ */
+extern void deadlineWait(uint8_t deadline);
+
+/*!
+ * \brief This function releases a deadline without waiting
+ *
+ * \param deadline is a handle from deadlineStart
+ *
+ * \return None
+ */
+extern void deadlineCancel(uint8_t deadline);
+
 //*****************************************************************************
 //
 // Mark the end of the C bindings section for C++ compilers.
@@ -0,0 +1,210 @@
+/*! \file */
+/*!
+ * dspTest.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Builds dsp.c with DSP_USE_SIMD on the host, where the
+ *              SMLAD, SMLALD and SSUB16 intrinsics come from host/msp.h.
+ *              Checks the shims against known instruction results, then the
+ *              dual-sample kernels against the one-sample references bit
+ *              for bit on random, saturating and odd-length blocks, and
+ *              times both per microphone block. Host times only compare the
+ *              C code; the cycles on the target come from the 'K' command.
+ */
+
+#include <string.h>
+#include <time.h>
+#include <msp.h>
+#include "dsp.h"
+#include "microphone.h"
+#include "test.h"
+
+#define MAX_COUNT       65535
+#define RANDOM_BLOCKS   2000
+#define DIFF_MIN        (-16384)
+#define DIFF_MAX        16383
+#define BENCH_BLOCKS    20000
+#define BENCH_RUNS      5       // best of, against scheduling noise
+
+/* Word arrays keep the sample pairs aligned like the microphone buffers */
+static uint32_t blockWords[(MAX_COUNT + 1) / 2];
+static uint32_t otherWords[(MAX_COUNT + 1) / 2];
+static uint16_t *const block = (uint16_t *)blockWords;
+static int16_t *const signedA = (int16_t *)blockWords;
+static int16_t *const signedB = (int16_t *)otherWords;
+static uint32_t seed = 12345;
+static volatile uint64_t sink;
+
+static uint32_t nextRandom(void) {
+    seed = seed * 1664525 + 1013904223;
+    return seed >> 8;
+}
+
+static uint64_t nowNs(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Results from the ARMv7-M reference manual's pseudocode, worked by hand
+static void testIntrinsics(void) {
+    CHECK_EQ(__SMLAD(0x00030002, 0x00050004, 7), 7 + 2 * 4 + 3 * 5);
+    CHECK_EQ(__SMLAD(0xFFFF0002, 0x00030003, 0), 3);             // -3 + 6
+    CHECK_EQ(__SMLAD(0x7FFF7FFF, 0x7FFF7FFF, 0), 0x7FFE0002);
+    CHECK_EQ(__SMLAD(0x80008000, 0x80008000, 0), 0x80000000);    // wraps
+    CHECK_EQ(__SMLAD(0x80008000, 0x80008000, 0x80000000), 0);
+    CHECK_EQ(__SMLALD(0x80008000, 0x80008000, 0), 0x80000000ULL);
+    CHECK_EQ(__SMLALD(0x80008000, 0x7FFF7FFF, 0), -0x7FFF0000LL);
+    CHECK_EQ(__SMLALD(0xFFFFFFFF, 0x00010001, 0xFFFFFFFFULL), 0xFFFFFFFDULL);
+    CHECK_EQ(__SSUB16(0x00050003, 0x00020004), 0x0003FFFF);
+    CHECK_EQ(__SSUB16(0x80000001, 0x00010002), 0x7FFFFFFF);      // wraps
+    CHECK_EQ(__SSUB16(0x7FFF0000, 0xFFFF8000), 0x80008000);
+}
+
+static void checkStats(uint16_t count, const char *kind) {
+    DspBlockStats stats, reference;
+
+    dspBlockStats(block, count, &stats);
+    dspBlockStatsReference(block, count, &reference);
+    CHECK(stats.sum == reference.sum && stats.sumSquares == reference.sumSquares
+          && stats.min == reference.min && stats.max == reference.max
+          && stats.count == reference.count,
+          "%s block of %u: sum %u/%u, squares %llu/%llu, min %u/%u, max %u/%u",
+          kind, count, stats.sum, reference.sum,
+          (unsigned long long)stats.sumSquares,
+          (unsigned long long)reference.sumSquares, stats.min, reference.min,
+          stats.max, reference.max);
+}
+
+static void testBlockStats(void) {
+    uint32_t i;
+    uint16_t count;
+    uint16_t n;
+
+    // random values and lengths, every other one odd
+    for (n = 0; n < RANDOM_BLOCKS; n++) {
+        count = 1 + nextRandom() % (2 * MIC_BLOCK_SIZE);
+        for (i = 0; i < count; i++) {
+            block[i] = nextRandom() % (DSP_SAMPLE_MAX + 1);
+        }
+        checkStats(count, "random");
+    }
+
+    // full scale up to the longest block, the sum wraps nowhere
+    for (i = 0; i < MAX_COUNT; i++) {
+        block[i] = DSP_SAMPLE_MAX;
+    }
+    checkStats(1, "saturated");
+    checkStats(MIC_BLOCK_SIZE - 1, "saturated");
+    checkStats(MAX_COUNT, "saturated");
+    for (i = 0; i < MAX_COUNT; i++) {
+        block[i] = (i & 1) ? DSP_SAMPLE_MAX : 0;
+    }
+    checkStats(MIC_BLOCK_SIZE + 1, "alternating");
+    checkStats(MAX_COUNT, "alternating");
+    memset(block, 0, MAX_COUNT * sizeof(uint16_t));
+    checkStats(MIC_BLOCK_SIZE, "silent");
+}
+
+static void checkDifference(uint16_t count, const char *kind) {
+    uint64_t total = dspSquaredDifference(signedA, signedB, count);
+    uint64_t reference = dspSquaredDifferenceReference(signedA, signedB, count);
+
+    CHECK(total == reference, "%s blocks of %u: %llu, expected %llu", kind, count,
+          (unsigned long long)total, (unsigned long long)reference);
+}
+
+static void testSquaredDifference(void) {
+    uint32_t i;
+    uint16_t count;
+    uint16_t n;
+
+    for (n = 0; n < RANDOM_BLOCKS; n++) {
+        count = 1 + nextRandom() % (2 * MIC_BLOCK_SIZE);
+        for (i = 0; i < count; i++) {
+            signedA[i] = DIFF_MIN + nextRandom() % (DIFF_MAX - DIFF_MIN + 1);
+            signedB[i] = DIFF_MIN + nextRandom() % (DIFF_MAX - DIFF_MIN + 1);
+        }
+        checkDifference(count, "random");
+    }
+
+    // largest differences of either sign, as far as SSUB16 stays in range
+    for (i = 0; i < MAX_COUNT; i++) {
+        signedA[i] = (i & 1) ? DIFF_MAX : DIFF_MIN;
+        signedB[i] = (i & 1) ? DIFF_MIN : DIFF_MAX;
+    }
+    checkDifference(1, "extreme");
+    checkDifference(MIC_BLOCK_SIZE - 1, "extreme");
+    checkDifference(MAX_COUNT, "extreme");
+}
+
+typedef void (*BenchKernel)(void);
+
+static void runStats(void) {
+    DspBlockStats stats;
+
+    dspBlockStats(block, MIC_BLOCK_SIZE, &stats);
+    sink += stats.sumSquares;
+}
+
+static void runStatsReference(void) {
+    DspBlockStats stats;
+
+    dspBlockStatsReference(block, MIC_BLOCK_SIZE, &stats);
+    sink += stats.sumSquares;
+}
+
+static void runDifference(void) {
+    sink += dspSquaredDifference(signedA, signedB, MIC_BLOCK_SIZE);
+}
+
+static void runDifferenceReference(void) {
+    sink += dspSquaredDifferenceReference(signedA, signedB, MIC_BLOCK_SIZE);
+}
+
+// Best host blocks per second over BENCH_RUNS runs of BENCH_BLOCKS blocks
+static double benchBlocks(BenchKernel kernel) {
+    double best = 0, rate;
+    uint64_t start;
+    uint32_t i;
+    uint8_t run;
+
+    for (run = 0; run < BENCH_RUNS; run++) {
+        start = nowNs();
+        for (i = 0; i < BENCH_BLOCKS; i++) {
+            kernel();
+        }
+        rate = BENCH_BLOCKS * 1e9 / (double)(nowNs() - start);
+        if (rate > best) {
+            best = rate;
+        }
+    }
+    return best;
+}
+
+static void bench(const char *name, BenchKernel kernel, BenchKernel reference) {
+    double rate = benchBlocks(kernel);
+    double referenceRate = benchBlocks(reference);
+
+    printf("  %-22s %10.0f %10.0f\n", name, rate, referenceRate);
+    CHECK(rate > 0 && referenceRate > 0, "%s: no blocks timed", name);
+}
+
+int main(void) {
+    uint32_t i;
+
+    testIntrinsics();
+    testBlockStats();
+    testSquaredDifference();
+
+    // in range for both kernels, block is signedA
+    for (i = 0; i < MIC_BLOCK_SIZE; i++) {
+        block[i] = nextRandom() % (DIFF_MAX + 1);
+        signedB[i] = DIFF_MIN + nextRandom() % (DIFF_MAX - DIFF_MIN + 1);
+    }
+    printf("  host blocks/s of %u     dual   one-by-one\n", MIC_BLOCK_SIZE);
+    bench("dspBlockStats", runStats, runStatsReference);
+    bench("dspSquaredDifference", runDifference, runDifferenceReference);
+    testDone("dspTest");
+}
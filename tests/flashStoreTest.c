@@ -0,0 +1,278 @@
+/*! \file */
+/*!
+ * flashStoreTest.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Runs the record store against the simulated flash, which
+ *              flags programming a bit back to 1, programming a line twice
+ *              and writing a protected sector. Each boot is a fresh process
+ *              so the store only knows what it finds in flash; the image
+ *              goes from one boot to the next through a file, where the
+ *              test can also tear a record the way a power cut would.
+ *
+ *              The record layout and CRC are recomputed here, so a change
+ *              that would strand the records of a previous build fails.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "timer32.h"
+#include "flashStore.h"
+#include "sim.h"
+#include "test.h"
+
+#define STORE_OFFSET        (STORE_BASE - SIM_INFO_FLASH_START)
+#define SLOTS_PER_SECTOR    (STORE_SECTOR_SIZE / STORE_RECORD_SIZE)
+#define SETTLE_LIMIT_MS     10000
+
+/* The record as the firmware of every release has to read it */
+#define RECORD_MAGIC        0x5AC3
+#define MAGIC_OFFSET        0
+#define SEQUENCE_OFFSET     2
+#define LENGTH_OFFSET       4
+#define CRC_OFFSET          6
+#define PAYLOAD_OFFSET      8
+
+/* Four laps round the sectors, the last record opens sector 0 again */
+#define LAP_RECORDS         (STORE_SECTORS * SLOTS_PER_SECTOR + 1)
+#define TORN_COUNTER        1000
+
+typedef struct _TestPayload {
+    uint32_t counter;
+    char name[12];
+} TestPayload;
+
+/* Words the flash model counts per record: it sees a store only when it
+ *  changes the word, and the padding stays erased */
+#define RECORD_WORDS        ((PAYLOAD_OFFSET + sizeof(TestPayload)) / 4)
+
+/* Read by timer32.c, which is shared with the application */
+ScreenState currentState = START_SCREEN;
+volatile uint8_t updateLCD = 0;
+
+static char imagePath[] = "/tmp/flashStoreTestXXXXXX";
+
+// CRC-16-CCITT, polynomial 0x1021, initial value 0xFFFF
+static uint16_t crc16(uint16_t crc, const uint8_t *data, uint16_t length) {
+    uint8_t bit;
+
+    while (length--) {
+        crc ^= (uint16_t)*data++ << 8;
+        for (bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static uint16_t field(const uint8_t *record, uint8_t offset) {
+    return record[offset] | (record[offset + 1] << 8);
+}
+
+static const uint8_t *slotAt(uint8_t sector, uint8_t slot) {
+    return simFlashImage() + STORE_OFFSET + sector * STORE_SECTOR_SIZE
+           + slot * STORE_RECORD_SIZE;
+}
+
+// Checks one record byte for byte, padding included
+static void checkRecord(uint8_t sector, uint8_t slot, uint16_t sequence,
+                        uint32_t counter) {
+    const uint8_t *record = slotAt(sector, slot);
+    TestPayload payload;
+    uint16_t crc;
+    uint8_t i;
+
+    memset(&payload, 0, sizeof(payload));
+    payload.counter = counter;
+    strcpy(payload.name, "Resume");
+    crc = crc16(0xFFFF, record + SEQUENCE_OFFSET, 4);
+    crc = crc16(crc, record + PAYLOAD_OFFSET, sizeof(payload));
+
+    CHECK_EQ(field(record, MAGIC_OFFSET), RECORD_MAGIC);
+    CHECK_EQ(field(record, SEQUENCE_OFFSET), sequence);
+    CHECK_EQ(field(record, LENGTH_OFFSET), sizeof(payload));
+    CHECK_EQ(field(record, CRC_OFFSET), crc);
+    CHECK(!memcmp(record + PAYLOAD_OFFSET, &payload, sizeof(payload)),
+          "sector %u slot %u: payload", sector, slot);
+    for (i = PAYLOAD_OFFSET + sizeof(payload); i < STORE_RECORD_SIZE; i++) {
+        CHECK(record[i] == 0xFF, "sector %u slot %u: byte %u programmed",
+              sector, slot, i);
+    }
+}
+
+static uint8_t slotErased(uint8_t sector, uint8_t slot) {
+    const uint8_t *record = slotAt(sector, slot);
+    uint8_t i;
+
+    for (i = 0; i < STORE_RECORD_SIZE; i++) {
+        if (record[i] != 0xFF) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void save(uint32_t counter) {
+    TestPayload payload;
+
+    memset(&payload, 0, sizeof(payload));
+    payload.counter = counter;
+    strcpy(payload.name, "Resume");
+    storeSave(&payload, sizeof(payload));
+}
+
+static uint32_t load(void) {
+    TestPayload payload;
+
+    if (!storeLoad(&payload, sizeof(payload))) {
+        return 0;
+    }
+    CHECK(!strcmp(payload.name, "Resume"), "loaded \"%.12s\"", payload.name);
+    return payload.counter;
+}
+
+// Runs the main loop's share of the store until it has nothing left to do
+static void settle(void) {
+    uint32_t ms;
+
+    for (ms = 0; !storeIsIdle() && ms < SETTLE_LIMIT_MS; ms++) {
+        storeUpdate();
+        simRunFor(1000);
+    }
+    CHECK(storeIsIdle(), "store busy after %ums", ms);
+}
+
+// Blank part: the first save erases sector 0, a burst is one write
+static void bootBlank(void) {
+    uint32_t erases, programs;
+    uint32_t ms;
+
+    CHECK_EQ(load(), 0);
+    CHECK(storeIsIdle(), "busy with nothing saved");
+    save(1);
+    settle();
+    simFlashCounts(&erases, &programs);
+    CHECK_EQ(erases, 1);
+    CHECK_EQ(programs, RECORD_WORDS);
+    checkRecord(0, 0, 1, 1);
+    CHECK(slotErased(0, 1), "slot after the record programmed");
+    CHECK_EQ(load(), 1);
+
+    // changes inside the batch time replace the staged record
+    save(100);
+    for (ms = 0; ms < STORE_BATCH_MS / 2; ms++) {
+        storeUpdate();
+        simRunFor(1000);
+    }
+    save(2);
+    settle();
+    simFlashCounts(&erases, &programs);
+    CHECK_EQ(programs, 2 * RECORD_WORDS);
+    checkRecord(0, 1, 2, 2);
+
+    // saving what is already in flash costs nothing
+    save(2);
+    CHECK(storeIsIdle(), "staged a record already in flash");
+}
+
+// Reload, then enough saves to wrap round all sectors
+static void bootLaps(void) {
+    uint32_t erases, programs;
+    uint32_t counter;
+    uint8_t sector;
+
+    CHECK_EQ(load(), 2);
+    for (counter = 3; counter <= LAP_RECORDS; counter++) {
+        save(counter);
+        settle();
+    }
+    simFlashCounts(&erases, &programs);
+    CHECK_EQ(erases, STORE_SECTORS);
+    CHECK_EQ(programs, (LAP_RECORDS - 2) * RECORD_WORDS);
+    CHECK_EQ(load(), LAP_RECORDS);
+
+    // sector 0 was compacted to the newest record, the others hold a lap
+    checkRecord(0, 0, LAP_RECORDS, LAP_RECORDS);
+    CHECK(slotErased(0, 1), "sector 0 not erased before reuse");
+    for (sector = 1; sector < STORE_SECTORS; sector++) {
+        checkRecord(sector, 0, sector * SLOTS_PER_SECTOR + 1,
+                    sector * SLOTS_PER_SECTOR + 1);
+        checkRecord(sector, SLOTS_PER_SECTOR - 1,
+                    (sector + 1) * SLOTS_PER_SECTOR,
+                    (sector + 1) * SLOTS_PER_SECTOR);
+    }
+}
+
+// The record that opened sector 0 was torn, the previous sector still has
+// the one before it, and the next save compacts over the torn sector
+static void bootTorn(void) {
+    uint32_t erases, programs;
+
+    CHECK_EQ(load(), LAP_RECORDS - 1);
+    save(TORN_COUNTER);
+    settle();
+    simFlashCounts(&erases, &programs);
+    CHECK_EQ(erases, 1);
+    CHECK_EQ(programs, RECORD_WORDS);
+    checkRecord(0, 0, LAP_RECORDS, TORN_COUNTER);
+}
+
+static void bootResume(void) {
+    CHECK_EQ(load(), TORN_COUNTER);
+    CHECK(storeIsIdle(), "busy after boot");
+}
+
+// Clears bits of the record in sector 0, slot 0, as a cut-off program would
+static void tearFirstRecord(void) {
+    FILE *image = fopen(imagePath, "r+b");
+    uint8_t byte;
+
+    CHECK(image != 0, "cannot open %s", imagePath);
+    if (!image) {
+        return;
+    }
+    fseek(image, STORE_OFFSET + PAYLOAD_OFFSET + 4, SEEK_SET);
+    byte = (uint8_t)fgetc(image) & 0x0F;
+    fseek(image, STORE_OFFSET + PAYLOAD_OFFSET + 4, SEEK_SET);
+    fputc(byte, image);
+    fclose(image);
+}
+
+// Powers up a fresh copy of the firmware on the saved flash image
+static void boot(const char *name, void (*run)(void)) {
+    pid_t child;
+    int status;
+
+    fflush(stdout);     // or the child prints it again
+    child = fork();
+    if (child == 0) {
+        simFlashLoad(imagePath);    // blank the first time
+        Timer32_Init();
+        initFlashStore();
+        run();
+        CHECK_EQ(simViolationCount(), 0);
+        CHECK(simFlashSave(imagePath), "cannot save %s", imagePath);
+        testDone(name);
+    }
+    waitpid(child, &status, 0);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0, "%s failed", name);
+}
+
+int main(void) {
+    int file = mkstemp(imagePath);
+
+    CHECK(file >= 0, "cannot create %s", imagePath);
+    close(file);
+    unlink(imagePath);
+
+    boot("  blank boot", bootBlank);
+    boot("  laps boot", bootLaps);
+    tearFirstRecord();
+    boot("  torn boot", bootTorn);
+    boot("  resume boot", bootResume);
+    unlink(imagePath);
+    testDone("flashStoreTest");
+}
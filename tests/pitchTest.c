@@ -0,0 +1,201 @@
+/*! \file */
+/*!
+ * pitchTest.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Feeds pitchDetect synthetic ADC blocks: sines across the
+ *              whole PITCH_MIN_HZ to PITCH_MAX_HZ range at several phases
+ *              and levels must come out within MAX_ERROR_CENTS, or
+ *              MAX_HIGH_CENTS above HIGH_HZ, white noise and silence must
+ *              be unvoiced. Then scores sung blocks
+ *              against a reference note, and times the detector in blocks
+ *              per second for a tone and for noise, which searches every
+ *              lag.
+ */
+
+#include <math.h>
+#include <string.h>
+#include <time.h>
+#include "pitch.h"
+#include "score.h"
+#include "test.h"
+
+#define BLOCK_SIZE      PITCH_BLOCK_MAX
+#define ADC_MID         8192        // 14-bit ADC, mid-scale bias
+#define TONE_STEPS      240         // log-spaced test frequencies
+#define PHASES          4
+/* Parabolic refinement of a lag of only 8 to 13 samples loses accuracy
+ *  at the top, both bounds are well inside SCORE_FULL_CENTS */
+#define MAX_ERROR_CENTS 6           // below HIGH_HZ, most singing
+#define HIGH_HZ         640
+#define MAX_HIGH_CENTS  16          // HIGH_HZ to PITCH_MAX_HZ
+#define NOISE_BLOCKS    2000
+#define BENCH_BLOCKS    2000
+#define BENCH_RUNS      5           // best of, against scheduling noise
+#define BLOCKS_PER_S    (PITCH_SAMPLE_RATE / BLOCK_SIZE)    // real time
+
+static uint32_t blockWords[BLOCK_SIZE / 2];     // pairs aligned for the DSP
+static uint16_t *const block = (uint16_t *)blockWords;
+static uint32_t seed = 12345;
+static char report[64];
+
+/* Stands in for uart.c, keeps the last scoreReport line */
+void sendString(const char *str) {
+    strncpy(report, str, sizeof(report) - 1);
+}
+
+static uint32_t nextRandom(void) {
+    seed = seed * 1664525 + 1013904223;
+    return seed >> 8;
+}
+
+static uint64_t nowNs(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static double hzToCents(double hz) {
+    return 6900 + 1200 * log2(hz / 440);
+}
+
+static void makeTone(double hz, double phase, uint16_t amplitude) {
+    uint16_t i;
+
+    for (i = 0; i < BLOCK_SIZE; i++) {
+        block[i] = (uint16_t)lround(ADC_MID + amplitude
+                * sin(2 * M_PI * hz * i / PITCH_SAMPLE_RATE + phase));
+    }
+}
+
+// Uniform noise of +/- amplitude around mid-scale
+static void makeNoise(uint16_t amplitude) {
+    uint16_t i;
+
+    for (i = 0; i < BLOCK_SIZE; i++) {
+        block[i] = ADC_MID - amplitude + nextRandom() % (2 * amplitude + 1);
+    }
+}
+
+static void testTones(void) {
+    static const uint16_t levels[] = { 200, 2000, 8000 };
+    PitchEstimate estimate;
+    double hz, error, bound, worst = 0, worstHz = 0;
+    uint16_t step;
+    uint8_t phase, level;
+
+    for (step = 0; step <= TONE_STEPS; step++) {
+        hz = PITCH_MIN_HZ * pow((double)PITCH_MAX_HZ / PITCH_MIN_HZ,
+                                (double)step / TONE_STEPS);
+        bound = hz < HIGH_HZ ? MAX_ERROR_CENTS : MAX_HIGH_CENTS;
+        for (level = 0; level < sizeof(levels) / sizeof(levels[0]); level++) {
+            for (phase = 0; phase < PHASES; phase++) {
+                makeTone(hz, phase * M_PI / 2.5, levels[level]);
+                CHECK(pitchDetect(block, BLOCK_SIZE, &estimate),
+                      "%.1f Hz at %u: unvoiced, aperiodicity %u", hz,
+                      levels[level], estimate.aperiodicity);
+                error = fabs(estimate.cents - hzToCents(hz));
+                CHECK(error <= bound, "%.1f Hz at %u: %u cents, %.1f off",
+                      hz, levels[level], estimate.cents, error);
+                if (error > worst) {
+                    worst = error;
+                    worstHz = hz;
+                }
+            }
+        }
+    }
+    printf("  %u to %u Hz: worst %.1f cents off at %.1f Hz\n", PITCH_MIN_HZ,
+           PITCH_MAX_HZ, worst, worstHz);
+}
+
+static void testUnvoiced(void) {
+    PitchEstimate estimate;
+    uint16_t n, voiced = 0;
+
+    for (n = 0; n < NOISE_BLOCKS; n++) {
+        makeNoise(2000);
+        voiced += pitchDetect(block, BLOCK_SIZE, &estimate);
+    }
+    CHECK(voiced == 0, "%u of %u noise blocks voiced", voiced, NOISE_BLOCKS);
+
+    // below PITCH_MIN_RMS, a tone included
+    makeNoise(PITCH_MIN_RMS / 2);
+    CHECK(!pitchDetect(block, BLOCK_SIZE, &estimate), "faint noise voiced");
+    makeTone(440, 0, PITCH_MIN_RMS);
+    CHECK(!pitchDetect(block, BLOCK_SIZE, &estimate), "faint tone voiced");
+    makeNoise(0);
+    CHECK(!pitchDetect(block, BLOCK_SIZE, &estimate), "silence voiced");
+    CHECK_EQ(estimate.cents, PITCH_UNVOICED);
+}
+
+// Score of a note sung as a tone of hz, one block per 31ms
+static uint8_t scoreSung(double hz, uint16_t blocks) {
+    PitchEstimate estimate;
+    uint16_t n;
+
+    scoreReset();
+    scoreAddReference(0, 69);               // A4 for the whole song
+    for (n = 0; n < blocks; n++) {
+        if (hz > 0) {
+            makeTone(hz, n, 2000);
+        } else {
+            makeNoise(0);
+        }
+        pitchDetect(block, BLOCK_SIZE, &estimate);
+        scoreBlock(n * 1000 / BLOCKS_PER_S, estimate.cents);
+    }
+    return scoreGet();
+}
+
+static void testScore(void) {
+    CHECK_EQ(scoreSung(440, 64), 100);
+    CHECK_EQ(scoreSung(220, 64), 100);      // an octave down counts
+    // two semitones off, 100 * (300 - 200) / (300 - 50)
+    CHECK_NEAR(scoreSung(440 * pow(2, 2.0 / 12), 64), 40, 2);
+    CHECK_EQ(scoreSung(440 * pow(2, 4.0 / 12), 64), 0);
+    CHECK_EQ(scoreSung(0, 64), 0);          // silence during a note
+    scoreReport(3);
+    CHECK(!strcmp(report, "G:3 0 H0/64 U64 D0\n"), "report \"%s\"", report);
+}
+
+// Best host blocks per second over BENCH_RUNS runs of BENCH_BLOCKS blocks
+static double benchBlocks(void) {
+    PitchEstimate estimate;
+    double best = 0, rate;
+    uint64_t start;
+    uint16_t i;
+    uint8_t run;
+
+    for (run = 0; run < BENCH_RUNS; run++) {
+        start = nowNs();
+        for (i = 0; i < BENCH_BLOCKS; i++) {
+            pitchDetect(block, BLOCK_SIZE, &estimate);
+        }
+        rate = BENCH_BLOCKS * 1e9 / (double)(nowNs() - start);
+        if (rate > best) {
+            best = rate;
+        }
+    }
+    return best;
+}
+
+static void bench(const char *name) {
+    double rate = benchBlocks();
+
+    printf("  %-16s %10.0f blocks/s, %.0fx real time\n", name, rate,
+           rate / BLOCKS_PER_S);
+    CHECK(rate > BLOCKS_PER_S, "%s: %.0f blocks/s", name, rate);
+}
+
+int main(void) {
+    testTones();
+    testUnvoiced();
+    testScore();
+
+    makeTone(440, 0, 2000);
+    bench("pitchDetect tone");
+    makeNoise(2000);
+    bench("pitchDetect noise");
+    testDone("pitchTest");
+}
@@ -0,0 +1,146 @@
+/*! \file */
+/*!
+ * powerSleepTest.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Runs the whole firmware on the simulated board until it
+ *              idles into LPM3, then talks to it over the UART. A command
+ *              sent to a sleeping CPU loses its first byte; one sent after
+ *              UART_WAKE_BYTE is answered. A switch press from LPM3 is
+ *              reported with the latency from the end of the sleep.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "powerManager.h"
+#include "uart.h"
+#include "sim.h"
+#include "test.h"
+
+#define SWITCH_PORT     3
+#define NEXT            0x04
+
+#define PRESS_MS        80
+#define REPLY_MAX       128
+#define WAKE_GAP_MS     5       // host pause after the wake byte
+#define MAX_LATENCY_US  500     // WFI exit to the main loop
+
+typedef enum _StepType {
+    STEP_CHECK_ASLEEP, STEP_SEND, STEP_WAKE_SEND, STEP_PRESS, STEP_EXPECT,
+    STEP_DONE
+} StepType;
+
+typedef struct _Step {
+    uint32_t ms;
+    StepType type;
+    const char *text;       // STEP_SEND, STEP_WAKE_SEND, STEP_EXPECT prefix
+    uint8_t lost;           // STEP_EXPECT, bytes lost to LPM3
+} Step;
+
+/* The machine drops to LOW POWER_IDLE_TIMEOUT_MS after boot and after each
+ *  command line or press, then sleeps between RTC seconds. The '\n' of the
+ *  lost command still ends an (empty) line, which counts as activity */
+static const Step steps[] = {
+    {  7000, STEP_CHECK_ASLEEP },
+    {  7500, STEP_SEND,       "W\n" },
+    {  7600, STEP_EXPECT,     0,      1 },      // 'W' was lost
+    { 13000, STEP_CHECK_ASLEEP },
+    { 13500, STEP_WAKE_SEND,  "W\n" },
+    { 13600, STEP_EXPECT,     "W:S",  1 },      // only the wake byte
+    { 19000, STEP_CHECK_ASLEEP },
+    { 19500, STEP_PRESS },
+    { 20000, STEP_WAKE_SEND,  "W\n" },
+    { 20100, STEP_EXPECT,     "W:S",  0 },      // awake since the press
+    { 20200, STEP_DONE },
+};
+
+#define STEP_COUNT  (sizeof(steps) / sizeof(steps[0]))
+
+extern int firmwareMain(void);
+
+static char reply[REPLY_MAX];
+static uint16_t replyLength = 0;
+static uint64_t sleepBefore;
+static uint32_t lostBefore;
+
+static void uartReceived(uint8_t data) {
+    if (replyLength < REPLY_MAX - 1) {
+        reply[replyLength++] = data;
+        reply[replyLength] = '\0';
+    }
+}
+
+static void release(void *arg) {
+    (void)arg;
+    simGpioRelease(SWITCH_PORT, NEXT);
+}
+
+static void sendLater(void *arg) {
+    simUartSend((const uint8_t *)arg, strlen(arg));
+}
+
+// "W:S<sleeps> L<last>/<max> ..." from the last reply
+static void checkSleepStats(const Step *step) {
+    unsigned long sleeps, last, max;
+
+    CHECK(sscanf(reply, "W:S%lu L%lu/%lu", &sleeps, &last, &max) == 3,
+          "%ums: reply \"%s\"", step->ms, reply);
+    CHECK(sleeps > 0, "%ums: %lu sleeps", step->ms, sleeps);
+    CHECK(max <= MAX_LATENCY_US, "%ums: wake latency up to %lu us", step->ms, max);
+    printf("  %5ums  %s", step->ms, reply);
+}
+
+static void perform(void *arg) {
+    const Step *step = arg;
+    static const uint8_t wake = UART_WAKE_BYTE;
+
+    switch (step->type) {
+    case STEP_CHECK_ASLEEP:
+        CHECK(powerGetState() == POWER_STATE_LOW, "%ums: not in LOW", step->ms);
+        CHECK(simSleepTime() > 0, "%ums: never slept", step->ms);
+        sleepBefore = simSleepTime();
+        break;
+    case STEP_SEND:
+        lostBefore = simUartLost();
+        replyLength = 0;
+        simUartSend((const uint8_t *)step->text, strlen(step->text));
+        break;
+    case STEP_WAKE_SEND:
+        lostBefore = simUartLost();
+        replyLength = 0;
+        simUartSend(&wake, 1);
+        simSchedule(simNow() + WAKE_GAP_MS * SIM_PS_PER_MS, sendLater,
+                    (void *)step->text);
+        break;
+    case STEP_PRESS:
+        simGpioDrive(SWITCH_PORT, NEXT, 0);
+        simSchedule(simNow() + PRESS_MS * SIM_PS_PER_MS, release, 0);
+        break;
+    case STEP_EXPECT:
+        CHECK(simSleepTime() > sleepBefore, "%ums: was not asleep", step->ms);
+        CHECK_EQ(simUartLost() - lostBefore, step->lost);
+        if (step->text) {
+            CHECK(!strncmp(reply, step->text, strlen(step->text)),
+                  "%ums: reply \"%s\", expected \"%s\"", step->ms, reply, step->text);
+            checkSleepStats(step);
+        } else {
+            CHECK(replyLength == 0, "%ums: unexpected reply \"%s\"", step->ms, reply);
+        }
+        break;
+    case STEP_DONE:
+        CHECK_EQ(simViolationCount(), 0);
+        testDone("powerSleepTest");
+        break;
+    }
+}
+
+int main(void) {
+    uint8_t i;
+
+    for (i = 0; i < STEP_COUNT; i++) {
+        simSchedule(steps[i].ms * SIM_PS_PER_MS, perform, (void *)&steps[i]);
+    }
+    simUartSetSink(uartReceived);
+    firmwareMain();
+    return 0;
+}
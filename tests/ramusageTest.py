@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+"""Checks tools/ramusage.py against data/ramusage.map.
+
+The sample is laid out like a TI ARM linker map: RAM output sections with
+object files, library members, common symbols and holes, a .text section
+that must not count, and a .bss line after MODULE SUMMARY that must not
+be read. Prints the same summary line as the C tests and exits 1 if a
+check failed.
+
+    python3 ramusageTest.py
+"""
+
+import json
+import os
+import subprocess
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+SCRIPT = os.path.join(HERE, "..", "tools", "ramusage.py")
+SAMPLE = os.path.join(HERE, "data", "ramusage.map")
+
+SECTIONS = {".vtable": 0xe8, ".bss": 0x600, ".data": 0x20, ".sysmem": 0x400,
+            ".stack": 0x800}
+TOTAL = 4872
+MODULES = {
+    "startup_msp432p4111_ccs.obj": {".vtable": 0xe8},
+    "pitch.obj": {".bss": 0x200 + 0x100},
+    "stepperMotor.obj": {".bss": 0x180},
+    "(common)": {".bss": 0xc0},
+    "uart.obj": {".bss": 0x40},
+    "(padding)": {".bss": 0x80, ".data": 0x4, ".sysmem": 0x3f0, ".stack": 0x7fc},
+    "finalProject.obj": {".data": 0x10},
+    "exit.c.obj": {".data": 0xc},
+    "memory.c.obj": {".sysmem": 0x10},
+    "boot_cortex_m.c.obj": {".stack": 0x4},
+}
+
+checks = 0
+failures = 0
+
+
+def check(condition, message):
+    global checks, failures
+    checks += 1
+    if not condition:
+        failures += 1
+        print("ramusageTest.py: %s" % message)
+
+
+def run(*args):
+    result = subprocess.run([sys.executable, SCRIPT] + list(args) + [SAMPLE],
+                            capture_output=True, text=True)
+    return result.returncode, result.stdout, result.stderr
+
+
+def test_json():
+    status, out, _ = run("--json")
+    report = json.loads(out)
+    check(status == 0, "--json exited %d" % status)
+    check(report["total"] == TOTAL, "total %d, expected %d" % (report["total"], TOTAL))
+    check(report["sections"] == SECTIONS, "sections %s" % report["sections"])
+    check(report["modules"] == MODULES, "modules %s" % report["modules"])
+    check(sum(SECTIONS.values()) == TOTAL, "sample sections do not add up")
+
+
+def test_table():
+    status, out, _ = run()
+    rows = {line.split()[0]: line.split()[1:] for line in out.splitlines()[1:]}
+    check(status == 0, "table exited %d" % status)
+    check(out.splitlines()[0].split() == ["module", ".vtable", ".data", ".bss",
+                                          ".sysmem", ".stack", "total"],
+          "header %r" % out.splitlines()[0])
+    check(rows.get("TOTAL") == ["232", "32", "1536", "1024", "2048", str(TOTAL)],
+          "TOTAL row %s" % rows.get("TOTAL"))
+    check(rows.get("pitch.obj") == ["0", "0", "768", "0", "0", "768"],
+          "pitch.obj row %s" % rows.get("pitch.obj"))
+    check(list(rows)[0] == "(padding)", "largest module first: %s" % list(rows)[:3])
+
+
+def test_limits():
+    status, _, _ = run("--max-ram", str(TOTAL))
+    check(status == 0, "--max-ram at the total failed")
+    status, _, err = run("--max-ram", str(TOTAL - 1))
+    check(status == 1 and "exceeds" in err, "--max-ram below the total passed")
+
+    # 128 bytes of the 2048 byte stack is the default margin
+    status, _, _ = run("--stack-used", "1920")
+    check(status == 0, "1920 of 2048 stack bytes failed")
+    status, _, err = run("--stack-used", "1921")
+    check(status == 1 and "127 bytes free" in err, "1921 stack bytes passed: %r" % err)
+    status, _, _ = run("--stack-used", "1921", "--stack-margin", "127")
+    check(status == 0, "--stack-margin 127 not taken")
+
+
+def main():
+    test_json()
+    test_table()
+    test_limits()
+    print("%-20s %u checks, %u failed" % ("ramusageTest", checks, failures))
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
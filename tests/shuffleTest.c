@@ -0,0 +1,114 @@
+/*! \file */
+/*!
+ * shuffleTest.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Checks that shufflePermute visits every index exactly once
+ *              for every catalog size from 1 to SMALL_MAX and for sampled
+ *              sizes up to LARGE_MAX, including the power-of-4 range
+ *              boundaries where cycle walking is longest. Then runs
+ *              shuffleNext through several cycles, each must be a
+ *              permutation, and the re-keyed ones a different order.
+ */
+
+#include <string.h>
+#include "shuffle.h"
+#include "test.h"
+
+#define SMALL_MAX       4000
+#define LARGE_MAX       100000
+#define LARGE_SAMPLES   40      // pseudo-random sizes on top of the edges
+#define CYCLES          4       // shuffleNext cycles, three re-keys
+
+static uint8_t seen[LARGE_MAX];
+static uint32_t order[2][LARGE_MAX];    // previous and current cycle
+static uint32_t seed = 12345;
+
+static uint32_t nextRandom(void) {
+    seed = seed * 1664525 + 1013904223;
+    return seed;
+}
+
+// Every index of 0 to count - 1 once, returns the number of misses
+static uint32_t checkPermutation(const uint32_t *values, uint32_t count) {
+    uint32_t misses = 0;
+    uint32_t i;
+
+    memset(seen, 0, count);
+    for (i = 0; i < count; i++) {
+        if (values[i] >= count || seen[values[i]]) {
+            misses++;
+        } else {
+            seen[values[i]] = 1;
+        }
+    }
+    return misses;
+}
+
+static void testSize(uint32_t count, uint32_t key) {
+    ShuffleIterator shuffle;
+    uint32_t i;
+
+    shuffleInit(&shuffle, count, key);
+    for (i = 0; i < count; i++) {
+        order[0][i] = shufflePermute(&shuffle, i);
+    }
+    CHECK(checkPermutation(order[0], count) == 0,
+          "size %u key %08x: not a permutation", count, key);
+}
+
+static void testAllSmallSizes(void) {
+    uint32_t count;
+
+    for (count = 1; count <= SMALL_MAX; count++) {
+        testSize(count, nextRandom());
+    }
+}
+
+// Around each power of 4 and 2 the range grows or the halves change width
+static void testLargeSizes(void) {
+    uint32_t edge;
+    uint8_t i;
+
+    for (edge = 4096; edge <= LARGE_MAX; edge *= 2) {
+        testSize(edge - 1, nextRandom());
+        testSize(edge, nextRandom());
+        testSize(edge + 1, nextRandom());
+    }
+    testSize(LARGE_MAX, nextRandom());
+    for (i = 0; i < LARGE_SAMPLES; i++) {
+        testSize(SMALL_MAX + nextRandom() % (LARGE_MAX - SMALL_MAX), nextRandom());
+    }
+}
+
+// shuffleNext re-keys after each cycle, still a permutation but a new order
+static void testCycles(uint32_t count) {
+    ShuffleIterator shuffle;
+    uint32_t i;
+    uint8_t cycle;
+    uint8_t current = 0;
+
+    shuffleInit(&shuffle, count, nextRandom());
+    for (cycle = 0; cycle < CYCLES; cycle++) {
+        for (i = 0; i < count; i++) {
+            order[current][i] = shuffleNext(&shuffle);
+        }
+        CHECK(checkPermutation(order[current], count) == 0,
+              "size %u cycle %u: not a permutation", count, cycle);
+        if (cycle > 0 && count > 8) {     // 1 in 8! to repeat by chance
+            CHECK(memcmp(order[0], order[1], count * sizeof(uint32_t)) != 0,
+                  "size %u cycle %u: same order as the cycle before", count, cycle);
+        }
+        current ^= 1;
+    }
+}
+
+int main(void) {
+    testAllSmallSizes();
+    testLargeSizes();
+    testCycles(1);
+    testCycles(12);         // the firmware's song list
+    testCycles(257);
+    testCycles(LARGE_MAX);
+    testDone("shuffleTest");
+}
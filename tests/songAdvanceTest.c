@@ -0,0 +1,161 @@
+/*! \file */
+/*!
+ * songAdvanceTest.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Runs the whole firmware on the simulated board, queues three
+ *              songs with the buttons, then plays the ESP32 reporting the
+ *              end of each song. Checks that the next song's start status
+ *              goes out right after the end-of-song line, that the LCD shows
+ *              the playlist position, and that the end of the last song
+ *              stops playback.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "timer32.h"
+#include "songQueue.h"
+#include "sim.h"
+#include "hd44780.h"
+#include "test.h"
+
+#define SWITCH_PORT     3
+#define NEXT            0x04
+#define SELECT          0x08
+
+#define PRESS_MS        80
+#define LINE_MAX        64
+#define BYTE_PS         (10 * SIM_PS_PER_US * 1000000 / SIM_UART_BAUD)
+#define MAX_LATENCY_US  3000    // main loop pass plus the status line
+
+typedef enum _StepType {
+    STEP_PRESS, STEP_END_OF_SONG, STEP_CHECK, STEP_DONE
+} StepType;
+
+typedef struct _Step {
+    uint32_t ms;
+    StepType type;
+    uint8_t button;         // STEP_PRESS
+    const char *status;     // status line expected next, or 0
+    ScreenState state;      // STEP_CHECK
+    const char *tag;        // STEP_CHECK, end of the bottom row
+} Step;
+
+/* Songs 0, 1 and 2 queued, 0 starts with the first Select. Next from the
+ *  playing screen returns to the select screen on the playing song */
+static const Step steps[] = {
+    {  500, STEP_PRESS,       NEXT,   0 },
+    { 1000, STEP_PRESS,       SELECT, "P:1 S:0 R:0" },
+    { 1500, STEP_PRESS,       NEXT,   0 },
+    { 2000, STEP_PRESS,       NEXT,   0 },
+    { 2500, STEP_PRESS,       SELECT, 0 },
+    { 3000, STEP_PRESS,       NEXT,   0 },
+    { 3500, STEP_PRESS,       NEXT,   0 },
+    { 4000, STEP_PRESS,       NEXT,   0 },
+    { 4500, STEP_PRESS,       SELECT, 0 },
+    { 5000, STEP_CHECK,       0,      0, PLAYING_SCREEN, "1/3" },
+    { 5500, STEP_END_OF_SONG, 0,      "P:1 S:1 R:0" },
+    { 6000, STEP_CHECK,       0,      0, PLAYING_SCREEN, "2/3" },
+    { 6500, STEP_END_OF_SONG, 0,      "P:1 S:2 R:0" },
+    { 7000, STEP_CHECK,       0,      0, PLAYING_SCREEN, "3/3" },
+    { 7500, STEP_END_OF_SONG, 0,      "P:0 S:2 R:0" },
+    { 8000, STEP_CHECK,       0,      0, PLAYING_SCREEN, "3/3" },
+    { 8500, STEP_DONE },
+};
+
+#define STEP_COUNT (sizeof(steps) / sizeof(steps[0]))
+
+static char line[LINE_MAX];
+static uint8_t lineLength = 0;
+
+/* Next status line expected, and when the line that caused it arrived */
+static const char *expectedStatus = 0;
+static uint64_t causeTime = 0;
+static uint8_t isEndOfSong = 0;
+static uint32_t statusLines = 0;
+
+extern int firmwareMain(void);
+
+static void uartReceived(uint8_t data) {
+    uint64_t latency;
+
+    if (data != '\n') {
+        if (lineLength < LINE_MAX - 1) {
+            line[lineLength++] = (char)data;
+        }
+        return;
+    }
+    line[lineLength] = '\0';
+    lineLength = 0;
+    if (strncmp(line, "P:", 2)) {
+        return;     // scores and reports
+    }
+    statusLines++;
+    if (!expectedStatus) {
+        CHECK(0, "unexpected status \"%s\" at %.3fms", line, simNowMs());
+        return;
+    }
+    CHECK(!strcmp(line, expectedStatus), "status \"%s\", expected \"%s\"",
+          line, expectedStatus);
+    if (isEndOfSong) {
+        latency = (simNow() - causeTime) / SIM_PS_PER_US;
+        printf("  E to \"%s\" sent: %lluus\n", line,
+               (unsigned long long)latency);
+        CHECK(latency <= MAX_LATENCY_US, "%s %lluus after the end of song",
+              line, (unsigned long long)latency);
+    }
+    expectedStatus = 0;
+}
+
+static void release(void *arg) {
+    simGpioRelease(SWITCH_PORT, ((const Step *)arg)->button);
+}
+
+static void perform(void *arg) {
+    const Step *step = arg;
+    char top[HD44780_COLUMNS + 1];
+    char bottom[HD44780_COLUMNS + 1];
+    uint8_t tagLength;
+
+    CHECK(!expectedStatus, "no \"%s\" before %ums", expectedStatus, step->ms);
+    expectedStatus = step->status;
+    isEndOfSong = step->type == STEP_END_OF_SONG;
+    switch (step->type) {
+    case STEP_PRESS:
+        simGpioDrive(SWITCH_PORT, step->button, 0);
+        simSchedule(simNow() + PRESS_MS * SIM_PS_PER_MS, release, arg);
+        break;
+    case STEP_END_OF_SONG:
+        simUartSend((const uint8_t *)"E\n", 2);
+        causeTime = simNow() + 2 * BYTE_PS;     // "\n" received
+        break;
+    case STEP_CHECK:
+        hd44780Row(0, top);
+        hd44780Row(1, bottom);
+        tagLength = strlen(step->tag);
+        CHECK(currentState == step->state, "%ums: state %u, expected %u",
+              step->ms, currentState, step->state);
+        CHECK(!strcmp(bottom + HD44780_COLUMNS - tagLength, step->tag),
+              "%ums: screen |%s|%s|, expected tag \"%s\"", step->ms, top,
+              bottom, step->tag);
+        break;
+    case STEP_DONE:
+        CHECK_EQ(statusLines, 5);    // boot, three starts and the stop
+        CHECK_EQ(simViolationCount(), 0);
+        testDone("songAdvanceTest");
+        break;
+    }
+}
+
+int main(void) {
+    uint8_t i;
+
+    for (i = 0; i < STEP_COUNT; i++) {
+        simSchedule(steps[i].ms * SIM_PS_PER_MS, perform, (void *)&steps[i]);
+    }
+    expectedStatus = "P:0 S:0 R:1";     // the boot status
+    hd44780Attach();
+    simUartSetSink(uartReceived);
+    firmwareMain();
+    return 0;
+}
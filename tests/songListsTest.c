@@ -0,0 +1,201 @@
+/*! \file */
+/*!
+ * songListsTest.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Checks the recent list against a plain array LRU and the
+ *              favorite set against a linear scan over all SONG_LIST_MAX
+ *              songs, then times recentTouch, recentContains,
+ *              favoriteToggle and favoriteNext on nearly empty and on full
+ *              lists. The host time per call should not depend on how full
+ *              the list is.
+ */
+
+#include <string.h>
+#include <time.h>
+#include "songLists.h"
+#include "test.h"
+
+#define BENCH_CALLS     200000
+#define BENCH_RUNS      5       // best of, against scheduling noise
+#define MAX_SLOWDOWN    8       // full vs empty, a scan would be ~100x
+
+static RecentList recent;
+static FavoriteSet favorites;
+static uint8_t songs[BENCH_CALLS];  // pseudo-random song per call
+static volatile int32_t sink;
+
+static uint64_t nowNs(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Same sequence of touches through a shifting array, most recent first
+static void testRecentAgainstArray(void) {
+    uint8_t expected[RECENT_SIZE];
+    uint8_t exported[RECENT_SIZE];
+    uint8_t count = 0;
+    uint8_t song, found, i, j;
+    uint32_t n;
+
+    recentClear(&recent);
+    CHECK_EQ(recentNewest(&recent), -1);
+    for (n = 0; n < 20000; n++) {
+        song = songs[n] % (n < 10000 ? 12 : SONG_LIST_MAX);   // many repeats first
+        for (i = 0; i < count && expected[i] != song; i++) {}
+        found = i < count;
+        if (!found && count < RECENT_SIZE) {
+            count++;
+        }
+        for (j = found ? i : count - 1; j > 0; j--) {
+            expected[j] = expected[j - 1];
+        }
+        expected[0] = song;
+
+        CHECK_EQ(recentContains(&recent, song), found);
+        recentTouch(&recent, song);
+        CHECK_EQ(recentExport(&recent, exported), count);
+        CHECK(memcmp(exported, expected, count) == 0, "touch %u: lists differ", n);
+        CHECK_EQ(recentNewest(&recent), song);
+    }
+}
+
+// favoriteNext agrees with walking every song after the start
+static void testFavoritesAgainstScan(void) {
+    uint16_t song, start, expected;
+    uint8_t was;
+    uint32_t n;
+
+    favoriteClear(&favorites);
+    CHECK_EQ(favoriteNext(&favorites, 0), -1);
+    for (n = 0; n < 4000; n++) {
+        song = songs[n];
+        was = favoriteContains(&favorites, song);
+        CHECK_EQ(favoriteToggle(&favorites, song), !was);
+        CHECK_EQ(favoriteContains(&favorites, song), !was);
+        start = songs[BENCH_CALLS - 1 - n];
+        for (expected = 1; expected <= SONG_LIST_MAX; expected++) {
+            if (favoriteContains(&favorites, (start + expected) % SONG_LIST_MAX)) {
+                break;
+            }
+        }
+        if (expected > SONG_LIST_MAX) {
+            CHECK_EQ(favoriteNext(&favorites, start), -1);
+        } else {
+            CHECK_EQ(favoriteNext(&favorites, start), (start + expected) % SONG_LIST_MAX);
+        }
+    }
+
+    // every song a favorite, and toggled back out again
+    favoriteClear(&favorites);
+    for (song = 0; song < SONG_LIST_MAX; song++) {
+        CHECK_EQ(favoriteToggle(&favorites, song), 1);
+    }
+    CHECK_EQ(favorites.count, SONG_LIST_MAX);
+    CHECK_EQ(favoriteNext(&favorites, SONG_LIST_MAX - 1), 0);
+    for (song = 0; song < SONG_LIST_MAX; song++) {
+        CHECK_EQ(favoriteToggle(&favorites, song), 0);
+    }
+    CHECK_EQ(favorites.count, 0);
+}
+
+typedef void (*BenchSetup)(void);
+typedef void (*BenchCall)(uint8_t song);
+
+static void recentFew(void) {
+    recentClear(&recent);
+    recentTouch(&recent, 1);
+}
+
+static void recentFull(void) {
+    uint16_t song;
+
+    recentClear(&recent);
+    for (song = 0; song < SONG_LIST_MAX; song++) {
+        recentTouch(&recent, song);
+    }
+}
+
+// A single favorite right behind the start is the longest favoriteNext walk
+static void favoriteOne(void) {
+    favoriteClear(&favorites);
+    favoriteToggle(&favorites, 0);
+}
+
+static void favoriteAll(void) {
+    uint16_t song;
+
+    favoriteClear(&favorites);
+    for (song = 0; song < SONG_LIST_MAX; song++) {
+        favoriteToggle(&favorites, song);
+    }
+}
+
+static void callTouch(uint8_t song) {
+    recentTouch(&recent, song);
+}
+
+static void callContains(uint8_t song) {
+    sink += recentContains(&recent, song);
+}
+
+// Toggled twice so the set stays as full as it was set up
+static void callToggle(uint8_t song) {
+    sink += favoriteToggle(&favorites, song);
+    sink += favoriteToggle(&favorites, song);
+}
+
+static void callNext(uint8_t song) {
+    sink += favoriteNext(&favorites, song);
+}
+
+// Best nanoseconds per call over BENCH_RUNS runs of BENCH_CALLS calls
+static double benchNs(BenchSetup setup, BenchCall call) {
+    double best = 1e30, ns;
+    uint64_t start;
+    uint32_t i;
+    uint8_t run;
+
+    for (run = 0; run < BENCH_RUNS; run++) {
+        setup();
+        start = nowNs();
+        for (i = 0; i < BENCH_CALLS; i++) {
+            call(songs[i]);
+        }
+        ns = (double)(nowNs() - start) / BENCH_CALLS;
+        if (ns < best) {
+            best = ns;
+        }
+    }
+    return best;
+}
+
+static void bench(const char *name, BenchSetup few, BenchSetup full, BenchCall call) {
+    double fewNs = benchNs(few, call);
+    double fullNs = benchNs(full, call);
+
+    printf("  %-16s %8.2f %8.2f\n", name, fewNs, fullNs);
+    CHECK(fullNs <= fewNs * MAX_SLOWDOWN && fewNs <= fullNs * MAX_SLOWDOWN,
+          "%s: %.2f ns with few entries, %.2f ns full", name, fewNs, fullNs);
+}
+
+int main(void) {
+    uint32_t seed = 12345;
+    uint32_t i;
+
+    for (i = 0; i < BENCH_CALLS; i++) {
+        seed = seed * 1664525 + 1013904223;
+        songs[i] = seed >> 24;
+    }
+    testRecentAgainstArray();
+    testFavoritesAgainstScan();
+
+    printf("  host ns/call     from few  from full (of %u songs)\n", SONG_LIST_MAX);
+    bench("recentTouch", recentFew, recentFull, callTouch);
+    bench("recentContains", recentFew, recentFull, callContains);
+    bench("favoriteToggle", favoriteOne, favoriteAll, callToggle);
+    bench("favoriteNext", favoriteOne, favoriteAll, callNext);
+    testDone("songListsTest");
+}
@@ -0,0 +1,124 @@
+/*! \file */
+/*!
+ * songQueueTest.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Exercises the playlist ring: order, position and pending
+ *              counts, the full ring dropping finished entries but never the
+ *              current one, and many laps around the ring.
+ */
+
+#include "songQueue.h"
+#include "test.h"
+
+static void testEmpty(void) {
+    uint8_t song = 0xAA;
+
+    queueClear();
+    CHECK_EQ(queueLength(), 0);
+    CHECK_EQ(queuePosition(), 0);
+    CHECK_EQ(queuePending(), 0);
+    CHECK_EQ(queueAdvance(&song), 0);
+    CHECK_EQ(song, 0xAA);
+}
+
+static void testOrder(void) {
+    uint8_t song;
+
+    queueClear();
+    CHECK_EQ(queueAdd(7), 1);
+    CHECK_EQ(queueAdd(3), 1);
+    CHECK_EQ(queueAdd(11), 1);
+    CHECK_EQ(queueLength(), 3);
+    CHECK_EQ(queuePending(), 3);
+
+    CHECK_EQ(queueAdvance(&song), 1);
+    CHECK_EQ(song, 7);
+    CHECK_EQ(queuePosition(), 1);
+    CHECK_EQ(queuePending(), 2);
+    CHECK_EQ(queueAdvance(&song), 1);
+    CHECK_EQ(song, 3);
+    CHECK_EQ(queueAdvance(&song), 1);
+    CHECK_EQ(song, 11);
+    CHECK_EQ(queuePosition(), 3);
+    CHECK_EQ(queuePending(), 0);
+    CHECK_EQ(queueAdvance(&song), 0);
+    CHECK_EQ(queuePosition(), 3);     // the last song stays current
+
+    // adding to an exhausted playlist resumes it
+    CHECK_EQ(queueAdd(5), 1);
+    CHECK_EQ(queueAdvance(&song), 1);
+    CHECK_EQ(song, 5);
+    CHECK_EQ(queuePosition(), 4);
+    CHECK_EQ(queueAt(0), 7);
+    CHECK_EQ(queueAt(3), 5);
+}
+
+static void testFull(void) {
+    uint8_t song;
+    uint8_t i;
+
+    queueClear();
+    for (i = 0; i < SONG_QUEUE_SIZE; i++) {
+        CHECK_EQ(queueAdd(i), 1);
+    }
+    // nothing played, nothing to drop
+    CHECK_EQ(queueAdd(100), 0);
+    CHECK_EQ(queueLength(), SONG_QUEUE_SIZE);
+
+    // the current song is kept too
+    CHECK_EQ(queueAdvance(&song), 1);
+    CHECK_EQ(queueAdd(100), 0);
+
+    // one finished song makes room, positions shift with it
+    CHECK_EQ(queueAdvance(&song), 1);
+    CHECK_EQ(song, 1);
+    CHECK_EQ(queueAdd(100), 1);
+    CHECK_EQ(queueLength(), SONG_QUEUE_SIZE);
+    CHECK_EQ(queuePosition(), 1);
+    CHECK_EQ(queuePending(), SONG_QUEUE_SIZE - 1);
+    CHECK_EQ(queueAt(0), 1);
+    CHECK_EQ(queueAt(SONG_QUEUE_SIZE - 1), 100);
+    CHECK_EQ(queueAdd(101), 0);
+
+    for (i = 2; i < SONG_QUEUE_SIZE; i++) {
+        CHECK_EQ(queueAdvance(&song), 1);
+        CHECK_EQ(song, i);
+    }
+    CHECK_EQ(queueAdvance(&song), 1);
+    CHECK_EQ(song, 100);
+    CHECK_EQ(queueAdvance(&song), 0);
+}
+
+// Songs come out in the order they went in, however often the ring wraps
+static void testLaps(void) {
+    uint8_t next = 0;
+    uint8_t expected = 0;
+    uint8_t song;
+    uint16_t i;
+
+    queueClear();
+    for (i = 0; i < 20 * SONG_QUEUE_SIZE; i++) {
+        while (queueAdd(next)) {
+            next++;
+        }
+        CHECK_EQ(queueLength(), SONG_QUEUE_SIZE);
+        CHECK_EQ(queueAdvance(&song), 1);
+        CHECK_EQ(song, expected);
+        expected++;
+    }
+    while (queueAdvance(&song)) {
+        CHECK_EQ(song, expected);
+        expected++;
+    }
+    CHECK_EQ(expected, next);
+}
+
+int main(void) {
+    testEmpty();
+    testOrder();
+    testFull();
+    testLaps();
+    testEmpty();
+    testDone("songQueueTest");
+}
@@ -0,0 +1,89 @@
+/*! \file */
+/*!
+ * stackMonitorTest.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Paints the simulated .stack region (host.mk places it at
+ *              the linker symbols the firmware uses), then stands in for
+ *              code that ran to a known depth by writing below the top of
+ *              the stack, and checks that stackHighWater reports that peak:
+ *              word aligned, unaligned, the unpainted margin alone and the
+ *              whole stack. Then checks the 'M' report line on the UART.
+ */
+
+#include <string.h>
+#include "stackMonitor.h"
+#include "uart.h"
+#include "sim.h"
+#include "test.h"
+
+#define REPLY_MAX       64
+
+/* host.mk defines them with --defsym, as the TI linker does on the target */
+extern uint8_t __stack[];
+extern uint8_t __STACK_END[];
+extern uint8_t __SYSMEM_SIZE[];
+
+static uint8_t *stackEnd;        // one past the top of .stack
+static char reply[REPLY_MAX];
+static uint16_t replyLength = 0;
+
+static void uartReceived(uint8_t data) {
+    if (replyLength < REPLY_MAX - 1) {
+        reply[replyLength++] = data;
+        reply[replyLength] = '\0';
+    }
+}
+
+// Code that used depth bytes below the top, down to its deepest frame
+static void useStack(uint32_t depth) {
+    memset(stackEnd - depth, 0, depth);
+}
+
+static void checkPeak(uint32_t depth, uint32_t expected) {
+    stackPaint();
+    useStack(depth);
+    CHECK(stackHighWater() == expected, "peak %u bytes: high water %u, expected %u",
+          depth, stackHighWater(), expected);
+}
+
+int main(void) {
+    uint32_t size = stackSize();
+    uint32_t depth;
+    char expected[REPLY_MAX];
+
+    CHECK_EQ(size, __STACK_END - __stack);
+    stackEnd = __stack + size;
+
+    // untouched, only the margin left below the stack pointer counts
+    checkPeak(0, STACK_PAINT_MARGIN);
+    checkPeak(STACK_PAINT_MARGIN, STACK_PAINT_MARGIN);
+    for (depth = STACK_PAINT_MARGIN + 4; depth <= size; depth += 52) {
+        checkPeak(depth, depth);
+    }
+    checkPeak(401, 404);                    // rounds up to the word
+    checkPeak(size, size);
+
+    // a word equal to the paint is taken as untouched
+    stackPaint();
+    useStack(200);
+    *(uint32_t *)(stackEnd - 200) = STACK_PAINT;
+    CHECK_EQ(stackHighWater(), 196);
+
+    // the 'M' command line for a 404 byte peak
+    checkPeak(401, 404);
+    initUART();
+    simUartSetSink(uartReceived);
+    stackReport();
+    simRunFor(10000);
+    snprintf(expected, sizeof(expected), "M:S404/%u F%u H%u\n", size, size - 404,
+             (uint32_t)(uintptr_t)__SYSMEM_SIZE);
+    CHECK(!strcmp(reply, expected), "report \"%s\", expected \"%s\"", reply,
+          expected);
+
+    // repainting forgets the old peak
+    stackPaint();
+    CHECK_EQ(stackHighWater(), STACK_PAINT_MARGIN);
+    CHECK_EQ(simViolationCount(), 0);
+    testDone("stackMonitorTest");
+}
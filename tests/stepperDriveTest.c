@@ -0,0 +1,148 @@
+/*! \file */
+/*!
+ * stepperDriveTest.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Checks the coil patterns the wave, full-step and half-step
+ *              drive modes put on P2.4-P2.7, watched on the simulated port:
+ *              one store per step, the sequence in order, the other P2
+ *              pins left alone. The simulator sees a store through a
+ *              pointer at the next register access, so the hand-driven
+ *              steps are spaced by one.
+ */
+
+#include "clockManager.h"
+#include "stepperMotor.h"
+#include "sim.h"
+#include "test.h"
+
+#define COIL_PORT       2
+#define OTHER_PINS      0x0A    // P2.1 and P2.3 stay set throughout
+#define MAX_WRITES      256
+
+static const uint8_t wave[] = { 0x8, 0x4, 0x2, 0x1 };
+static const uint8_t fullStep[] = { 0xC, 0x6, 0x3, 0x9 };
+static const uint8_t halfStep[] = { 0x8, 0xC, 0x4, 0x6, 0x2, 0x3, 0x1, 0x9 };
+
+static uint8_t writes[MAX_WRITES];
+static uint16_t writeCount = 0;
+static uint8_t otherChanged = 0;
+
+static void coilsWritten(uint8_t port, uint8_t out, uint8_t previousOut) {
+    (void)port;
+    if ((out ^ previousOut) & ~STEPPER_MASK) {
+        otherChanged = 1;
+    }
+    if (writeCount < MAX_WRITES) {
+        writes[writeCount++] = (out & STEPPER_MASK) >> 4;
+    }
+}
+
+static void stepBy(int8_t direction) {
+    if (direction > 0) {
+        stepClockwise(STEPPER_MAIN);
+    } else {
+        stepCounterClockwise(STEPPER_MAIN);
+    }
+    __no_operation();
+}
+
+static uint8_t indexOf(const uint8_t *sequence, uint8_t length, uint8_t pattern) {
+    uint8_t i;
+
+    for (i = 0; i < length; i++) {
+        if (sequence[i] == pattern) {
+            return i;
+        }
+    }
+    return 0xFF;
+}
+
+// Steps by hand and checks each store against the table, in both directions
+static void testSequence(StepperDriveMode mode, const uint8_t *sequence, uint8_t length) {
+    uint8_t start, i;
+
+    stepperSetDriveMode(STEPPER_MAIN, mode);
+    stepBy(1);
+    writeCount = 0;
+    for (i = 0; i < 2 * length; i++) {
+        stepBy(1);
+    }
+    CHECK_EQ(writeCount, 2 * length);
+    start = indexOf(sequence, length, writes[0]);
+    CHECK(start != 0xFF, "mode %d wrote 0x%X, not in its table", mode, writes[0]);
+    for (i = 0; i < writeCount && start != 0xFF; i++) {
+        CHECK_EQ(writes[i], sequence[(start + i) % length]);
+    }
+
+    writeCount = 0;
+    for (i = 0; i < length; i++) {
+        stepBy(-1);
+    }
+    CHECK_EQ(writeCount, length);
+    for (i = 0; i < writeCount && start != 0xFF; i++) {
+        CHECK_EQ(writes[i], sequence[(start + 2 * length - 2 - i) % length]);
+    }
+}
+
+// Switching modes keeps the rotor where it is: the next step is adjacent
+static void testModeChangeKeepsPosition(void) {
+    uint8_t before, index;
+
+    stepperSetDriveMode(STEPPER_MAIN, DRIVE_WAVE);
+    stepBy(1);
+    stepBy(1);
+    before = (simGpioOut(COIL_PORT) & STEPPER_MASK) >> 4;
+
+    stepperSetDriveMode(STEPPER_MAIN, DRIVE_HALF_STEP);
+    writeCount = 0;
+    stepBy(1);
+    index = indexOf(halfStep, 8, before);
+    CHECK(index != 0xFF, "wave pattern 0x%X not a half step", before);
+    CHECK_EQ(writes[0], halfStep[(index + 1) % 8]);
+
+    stepperSetDriveMode(STEPPER_MAIN, DRIVE_FULL_STEP);
+    writeCount = 0;
+    stepBy(1);
+    index = indexOf(halfStep, 8, writes[0]);
+    CHECK(index != 0xFF && (index & 1), "full step 0x%X is not two adjacent coils",
+          writes[0]);
+}
+
+// The Timer_A3 ISR walks the same table, one store per step
+static void testIsrSteps(void) {
+    uint8_t index, previous;
+    uint16_t i;
+
+    stepperSetDriveMode(STEPPER_MAIN, DRIVE_HALF_STEP);
+    writeCount = 0;
+    stepperMoveBy(STEPPER_MAIN, 40);
+    simRunFor(1000000);
+    CHECK(!isStepperRunning(STEPPER_MAIN), "still moving");
+    CHECK_EQ(writeCount, 41);                   // 40 steps, then coils off
+    CHECK_EQ(writes[writeCount - 1], 0);
+    previous = indexOf(halfStep, 8, writes[0]);
+    for (i = 1; i + 1 < writeCount; i++) {
+        index = indexOf(halfStep, 8, writes[i]);
+        CHECK_EQ(index, (previous + 1) % 8);
+        previous = index;
+    }
+}
+
+int main(void) {
+    clockSetProfile(CLOCK_PROFILE_DCO_12MHZ);
+    P2->OUT = OTHER_PINS;
+    P2->DIR = OTHER_PINS;
+    initStepperMotor();
+    simGpioWatch(COIL_PORT, coilsWritten);
+
+    testSequence(DRIVE_WAVE, wave, 4);
+    testSequence(DRIVE_FULL_STEP, fullStep, 4);
+    testSequence(DRIVE_HALF_STEP, halfStep, 8);
+    testModeChangeKeepsPosition();
+    testIsrSteps();
+    CHECK(!otherChanged, "a step changed pins outside P2.4-P2.7");
+    CHECK_EQ(simGpioOut(COIL_PORT) & ~STEPPER_MASK, OTHER_PINS);
+    CHECK_EQ(simViolationCount(), 0);
+    testDone("stepperDriveTest");
+}
@@ -0,0 +1,201 @@
+/*! \file */
+/*!
+ * stepperMotorsTest.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Runs up to STEPPER_MAX_MOTORS motors on the one Timer_A3
+ *              interrupt and checks that each keeps its own step rate, then
+ *              prints what the shared ISR and the DMA path cost per step.
+ *              Built with STEPPER_MEASURE_CYCLES, cycles come from the
+ *              simulated DWT counter (register traffic, see sim.h).
+ */
+
+#include <stdio.h>
+#include "clockManager.h"
+#include "stepperMotor.h"
+#include "sim.h"
+#include "test.h"
+
+#define RUN_US          2000000
+#define MAX_JITTER      (STEPPER_ISR_MARGIN + 2)    // steps taken early
+
+/* Step cost counters of stepperMotor.c, reset between runs */
+extern uint32_t isrCycles;
+extern uint32_t isrSteps;
+extern uint32_t dmaCycles;
+extern uint32_t dmaSteps;
+
+typedef struct _MotorUnderTest {
+    uint8_t port;
+    uint8_t shift;
+    uint16_t period;
+    uint8_t id;
+    uint32_t steps;
+    uint64_t firstTime;
+    uint64_t lastTime;
+    uint32_t minInterval;
+    uint32_t maxInterval;
+} MotorUnderTest;
+
+/* Periods with no common factor, so the deadlines drift against each other
+ *  and regularly fall within STEPPER_ISR_MARGIN */
+static MotorUnderTest motorsUnderTest[STEPPER_MAX_MOTORS] = {
+    { 2, 4, 2500 },
+    { 9, 0, 3001 },
+    { 10, 4, 3997 },
+};
+
+static void recordStep(uint8_t port, uint8_t out, uint8_t previousOut) {
+    uint64_t now = simNow();
+    uint32_t interval;
+    uint8_t i;
+
+    for (i = 0; i < STEPPER_MAX_MOTORS; i++) {
+        MotorUnderTest *t = &motorsUnderTest[i];
+        uint8_t mask = 0x0F << t->shift;
+
+        // coils released by disableStepperMotor are not a step
+        if (t->port != port || !((out ^ previousOut) & mask) || !(out & mask)) {
+            continue;
+        }
+        if (t->steps++ == 0) {
+            t->firstTime = now;
+        } else {
+            interval = (uint32_t)((now - t->lastTime + SIM_PS_PER_US / 2)
+                                  / SIM_PS_PER_US);
+            if (interval < t->minInterval) {
+                t->minInterval = interval;
+            }
+            if (interval > t->maxInterval) {
+                t->maxInterval = interval;
+            }
+        }
+        t->lastTime = now;
+    }
+}
+
+// Runs the first \b count motors at their own constant rate
+static void runMotors(uint8_t count) {
+    uint32_t interrupts = simIrqCount(TA3_0_IRQn);
+    uint32_t steps = 0;
+    uint32_t meanX100;
+    uint8_t i;
+
+    for (i = 0; i < count; i++) {
+        MotorUnderTest *t = &motorsUnderTest[i];
+
+        t->steps = 0;
+        t->minInterval = UINT32_MAX;
+        t->maxInterval = 0;
+        CHECK(stepperSetProfile(t->id, PROFILE_CONSTANT, t->period, t->period,
+                                1) == 1, "profile of motor %u", t->id);
+    }
+    isrCycles = 0;
+    isrSteps = 0;
+    for (i = 0; i < count; i++) {
+        enableStepperMotor(motorsUnderTest[i].id);
+    }
+    simRunFor(RUN_US);
+    for (i = 0; i < count; i++) {
+        disableStepperMotor(motorsUnderTest[i].id);
+    }
+    simRunFor(1000);
+    for (i = 0; i < count; i++) {
+        CHECK_EQ(simGpioOut(motorsUnderTest[i].port) & (0x0F << motorsUnderTest[i].shift), 0);
+    }
+
+    for (i = 0; i < count; i++) {
+        MotorUnderTest *t = &motorsUnderTest[i];
+
+        steps += t->steps;
+        CHECK(t->steps >= RUN_US / t->period - 1, "motor %u: %u steps", t->id,
+              t->steps);
+        meanX100 = (uint32_t)((t->lastTime - t->firstTime) * 100
+                              / SIM_PS_PER_US / (t->steps - 1));
+        CHECK(meanX100 + 100 >= t->period * 100U
+              && meanX100 <= t->period * 100U + 100,
+              "%u motors, motor %u: mean interval %u.%02u, expected %u", count,
+              t->id, meanX100 / 100, meanX100 % 100, t->period);
+        CHECK(t->minInterval + MAX_JITTER >= t->period
+              && t->maxInterval <= t->period + MAX_JITTER,
+              "%u motors, motor %u: intervals %u to %u, expected %u", count,
+              t->id, t->minInterval, t->maxInterval, t->period);
+    }
+    interrupts = simIrqCount(TA3_0_IRQn) - interrupts;
+
+    CHECK_EQ(isrSteps, steps);
+    if (count == 1) {
+        CHECK_EQ(interrupts, steps);
+    }
+    CHECK(interrupts <= steps, "%u interrupts for %u steps", interrupts, steps);
+    printf("  %u     %6u   %6u      %5.3f      %5u\n", count, steps,
+           interrupts, (double)interrupts / steps, stepperCyclesPerStep(0));
+}
+
+// The same cruise handed over to DMA: one interrupt per buffer, not per step
+static void runDma(void) {
+    MotorUnderTest *t = &motorsUnderTest[0];
+    uint32_t interrupts = simIrqCount(DMA_INT1_IRQn);
+    uint32_t isrCost = stepperCyclesPerStep(0);
+    int32_t position;
+
+    stepperSetProfile(t->id, PROFILE_TRAPEZOIDAL, RAMP_START_PERIOD, t->period,
+                      DEFAULT_RAMP_STEPS);
+    enableStepperMotor(t->id);
+    simRunFor(1000000);             // through the ramp to cruise
+    dmaCycles = 0;
+    dmaSteps = 0;
+    position = stepperGetPosition(t->id);
+    CHECK(stepperStartDma(t->id), "DMA refused at cruise");
+    // the first DMA step is a full interval after the hand-over, not after
+    //  the last ISR step, so measure from it on
+    t->steps = 0;
+    t->minInterval = UINT32_MAX;
+    t->maxInterval = 0;
+    simRunFor(RUN_US);
+    CHECK(t->steps >= RUN_US / t->period - 1, "DMA: %u steps", t->steps);
+    CHECK(t->minInterval + 1 >= t->period && t->maxInterval <= t->period + 1,
+          "DMA: intervals %u to %u, expected %u", t->minInterval,
+          t->maxInterval, t->period);
+    stepperStopDma(t->id);
+    interrupts = simIrqCount(DMA_INT1_IRQn) - interrupts;
+    // patterns queued but not yet output are taken back off the position
+    CHECK_EQ(stepperGetPosition(t->id), position + (int32_t)t->steps);
+    CHECK(interrupts <= dmaSteps / STEPPER_DMA_BUFFER_LEN + 1,
+          "DMA: %u interrupts for %u steps", interrupts, dmaSteps);
+    CHECK(stepperCyclesPerStep(1) * 4 < isrCost,
+          "DMA: %u cycles per step, ISR %u", stepperCyclesPerStep(1), isrCost);
+    printf("  DMA   %6u   %6u      %5.3f      %5u\n", dmaSteps, interrupts,
+           (double)interrupts / dmaSteps, stepperCyclesPerStep(1));
+
+    stepperRequestStop(t->id);
+    simRunFor(1000000);
+    CHECK(!isStepperRunning(t->id), "still running after stop");
+}
+
+int main(void) {
+    const StepperPins extraPins[] = {
+        STEPPER_PINS(P9, 0),
+        STEPPER_PINS(P10, 4),
+    };
+    uint8_t i;
+
+    clockSetProfile(CLOCK_PROFILE_DCO_12MHZ);
+    initStepperMotor();
+    for (i = 1; i < STEPPER_MAX_MOTORS; i++) {
+        motorsUnderTest[i].id = stepperAttach(&extraPins[i - 1]);
+        CHECK_EQ(motorsUnderTest[i].id, i);
+    }
+    CHECK_EQ(stepperAttach(&extraPins[0]), STEPPER_INVALID);
+    simGpioWatch(2, recordStep);
+    simGpioWatch(9, recordStep);
+    simGpioWatch(10, recordStep);
+
+    printf("  motors steps   ISR calls  calls/step  cycles/step\n");
+    for (i = 1; i <= STEPPER_MAX_MOTORS; i++) {
+        runMotors(i);
+    }
+    runDma();
+    CHECK_EQ(simViolationCount(), 0);
+    testDone("stepperMotorsTest");
+}
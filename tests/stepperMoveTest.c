@@ -0,0 +1,175 @@
+/*! \file */
+/*!
+ * stepperMoveTest.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Runs absolute and relative moves through the simulated
+ *              Timer_A3 ISR and checks the final position, the number of
+ *              interrupts taken, the step timing on P2 and that the timer
+ *              and coils are off once the motor arrived.
+ */
+
+#include "clockManager.h"
+#include "stepperMotor.h"
+#include "sim.h"
+#include "test.h"
+
+#define COIL_PORT       2
+#define MAX_STEPS       2048
+#define TOLERANCE_US    2       // Timer_A3 tick plus interrupt latency
+
+static uint64_t stepTimes[MAX_STEPS];
+static uint16_t storeCount = 0;
+
+static void coilsWritten(uint8_t port, uint8_t out, uint8_t previousOut) {
+    (void)port;
+    if (((out ^ previousOut) & STEPPER_MASK) && storeCount < MAX_STEPS) {
+        stepTimes[storeCount++] = simNow();
+    }
+}
+
+static uint32_t isrCount(void) {
+    return simIrqCount(TA3_0_IRQn);
+}
+
+static void runUntilStopped(void) {
+    uint16_t i;
+
+    for (i = 0; i < 2000 && isStepperRunning(STEPPER_MAIN); i++) {
+        simRunFor(10000);
+    }
+}
+
+// Everything is off after arrival and stays off
+static void checkStopped(int32_t position) {
+    uint32_t interrupts;
+
+    CHECK(!isStepperRunning(STEPPER_MAIN), "still running");
+    CHECK_EQ(stepperGetPosition(STEPPER_MAIN), position);
+    CHECK_EQ(simGpioOut(COIL_PORT) & STEPPER_MASK, 0);
+    CHECK_EQ(TIMER_A3->CTL & TIMER_A_CTL_MC_MASK, TIMER_A_CTL_MC__STOP);
+    interrupts = isrCount();
+    simRunFor(1000000);
+    CHECK_EQ(isrCount(), interrupts);
+}
+
+// One interrupt per step plus one to release the held last step
+static void testMove(int32_t target) {
+    int32_t from = stepperGetPosition(STEPPER_MAIN);
+    uint32_t steps = target > from ? target - from : from - target;
+    uint32_t interrupts = isrCount();
+    uint64_t interval;
+    uint16_t i;
+
+    storeCount = 0;
+    stepperMoveTo(STEPPER_MAIN, target);
+    runUntilStopped();
+    checkStopped(target);
+    CHECK_EQ(isrCount() - interrupts, steps + 1);
+    CHECK_EQ(storeCount, steps + 1);
+
+    // intervals stay between cruise and the slow end of the ramp, and the
+    //  release comes no earlier than a cruise interval after the last step
+    for (i = 1; i < storeCount; i++) {
+        interval = (stepTimes[i] - stepTimes[i - 1]) / SIM_PS_PER_US;
+        CHECK(interval + TOLERANCE_US >= INIT_PERIOD
+              && interval <= RAMP_START_PERIOD + TOLERANCE_US,
+              "move to %ld, step %u after %lluus", (long)target, i,
+              (unsigned long long)interval);
+    }
+}
+
+static void testMoveToCurrentPosition(void) {
+    uint32_t interrupts = isrCount();
+
+    stepperMoveTo(STEPPER_MAIN, stepperGetPosition(STEPPER_MAIN));
+    CHECK(!isStepperRunning(STEPPER_MAIN), "started for a zero move");
+    simRunFor(100000);
+    CHECK_EQ(isrCount(), interrupts);
+}
+
+// A relative move during a move extends the current target
+static void testMoveByWhileMoving(void) {
+    int32_t from = stepperGetPosition(STEPPER_MAIN);
+
+    stepperMoveTo(STEPPER_MAIN, from + 200);
+    simRunFor(100000);
+    stepperMoveBy(STEPPER_MAIN, 50);
+    runUntilStopped();
+    checkStopped(from + 250);
+}
+
+// Turning around mid-move brakes down the ramp first, no step is lost
+static void testReverseWhileMoving(void) {
+    int32_t from = stepperGetPosition(STEPPER_MAIN);
+    uint32_t interrupts = isrCount();
+    int32_t turnedAt;
+
+    stepperMoveTo(STEPPER_MAIN, from + 300);
+    simRunFor(400000);
+    turnedAt = stepperGetPosition(STEPPER_MAIN);
+    CHECK(turnedAt > from + 50, "only reached %ld", (long)turnedAt);
+    stepperMoveTo(STEPPER_MAIN, from);
+    runUntilStopped();
+    checkStopped(from);
+    // every step out was stepped back, so the count is even, plus the release
+    CHECK_EQ((isrCount() - interrupts) % 2, 1);
+}
+
+// Moves after a hold pick up from idle without missing the release
+static void testBackToBack(void) {
+    int32_t from = stepperGetPosition(STEPPER_MAIN);
+
+    stepperMoveBy(STEPPER_MAIN, 10);
+    runUntilStopped();
+    stepperMoveBy(STEPPER_MAIN, -25);
+    runUntilStopped();
+    checkStopped(from - 15);
+}
+
+// Redefining the origin only takes while stopped, a drive mode change
+//  mid-move swaps the table without losing the target
+static void testChangesWhileMoving(void) {
+    int32_t from = stepperGetPosition(STEPPER_MAIN);
+
+    stepperMoveTo(STEPPER_MAIN, from + 150);
+    simRunFor(100000);
+    stepperSetPosition(STEPPER_MAIN, 0);
+    CHECK(stepperGetPosition(STEPPER_MAIN) != 0, "origin moved while stepping");
+    stepperSetDriveMode(STEPPER_MAIN, DRIVE_FULL_STEP);
+    runUntilStopped();
+    checkStopped(from + 150);
+
+    stepperSetPosition(STEPPER_MAIN, from);
+    CHECK_EQ(stepperGetPosition(STEPPER_MAIN), from);
+    stepperMoveBy(STEPPER_MAIN, -20);
+    runUntilStopped();
+    checkStopped(from - 20);
+
+    // unknown motor ids are ignored
+    stepperSetPosition(STEPPER_MAX_MOTORS, 5);
+    stepperSetDriveMode(STEPPER_MAX_MOTORS, DRIVE_HALF_STEP);
+    CHECK_EQ(stepperGetPosition(STEPPER_MAIN), from - 20);
+    stepperSetDriveMode(STEPPER_MAIN, DRIVE_WAVE);
+}
+
+int main(void) {
+    clockSetProfile(CLOCK_PROFILE_DCO_12MHZ);
+    initStepperMotor();
+    simGpioWatch(COIL_PORT, coilsWritten);
+
+    CHECK_EQ(stepperGetPosition(STEPPER_MAIN), 0);
+    testMove(100);
+    testMove(-50);
+    testMove(-48);
+    testMove(1000);
+    testMoveToCurrentPosition();
+    testMoveByWhileMoving();
+    testReverseWhileMoving();
+    testBackToBack();
+    testChangesWhileMoving();
+    stepperSetDriveMode(STEPPER_MAIN, DRIVE_HALF_STEP);
+    testMove(0);
+    CHECK_EQ(simViolationCount(), 0);
+    testDone("stepperMoveTest");
+}
@@ -0,0 +1,109 @@
+/*! \file */
+/*!
+ * stepperProfileTest.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Checks the ramp tables against the analytic profiles and the
+ *              tempo interval against exact beat timing, see stepperProfile.h.
+ */
+
+#include <math.h>
+#include "stepperProfile.h"
+#include "test.h"
+
+#define TICK_HZ         1000000
+#define START_PERIOD    10000
+#define CRUISE_PERIOD   500
+
+static void testRejectsBadArguments(void) {
+    uint16_t table[RAMP_TABLE_MAX + 1];
+
+    CHECK_EQ(buildRampTable(table, 0, PROFILE_TRAPEZOIDAL, START_PERIOD, CRUISE_PERIOD), 0);
+    CHECK_EQ(buildRampTable(table, RAMP_TABLE_MAX + 1, PROFILE_TRAPEZOIDAL,
+                            START_PERIOD, CRUISE_PERIOD), 0);
+    CHECK_EQ(buildRampTable(table, 8, PROFILE_TRAPEZOIDAL, START_PERIOD,
+                            MIN_STEP_PERIOD - 1), 0);
+    CHECK_EQ(buildRampTable(table, 8, PROFILE_TRAPEZOIDAL, CRUISE_PERIOD, START_PERIOD), 0);
+}
+
+static void testConstantProfile(void) {
+    uint16_t table[RAMP_TABLE_MAX];
+    uint16_t n;
+
+    CHECK_EQ(buildRampTable(table, 16, PROFILE_CONSTANT, START_PERIOD, CRUISE_PERIOD), 16);
+    for (n = 0; n < 16; n++) {
+        CHECK_EQ(table[n], CRUISE_PERIOD);
+    }
+}
+
+// Entries fall from the start period to the cruise period and each step
+//  lands where the analytic profile puts it, to within rounding
+static void testRampFollowsProfile(StepperProfileType type, uint16_t steps) {
+    uint16_t table[RAMP_TABLE_MAX];
+    float v0 = 1.0f / START_PERIOD;
+    float v1 = 1.0f / CRUISE_PERIOD;
+    float rampTime = 2.0f * steps / (v0 + v1);
+    uint32_t elapsed = 0;
+    uint16_t n;
+
+    CHECK_EQ(buildRampTable(table, steps, type, START_PERIOD, CRUISE_PERIOD), steps);
+    for (n = 0; n < steps; n++) {
+        CHECK(table[n] <= START_PERIOD && table[n] >= CRUISE_PERIOD,
+              "type %d step %u interval %u", type, n, table[n]);
+        if (n) {
+            CHECK(table[n] <= table[n - 1], "type %d step %u slower than %u", type, n, n - 1);
+        }
+        elapsed += table[n];
+        // half a tick of rounding at the step's velocity
+        CHECK_NEAR(rampPosition(type, elapsed, rampTime, v0, v1), n + 1, 0.02);
+    }
+    // differences of rounded absolute times, so no drift over the ramp
+    CHECK_NEAR(elapsed, rampTime, 1.0);
+}
+
+static void testScurveEasesIn(void) {
+    uint16_t trapezoid[32];
+    uint16_t scurve[32];
+
+    buildRampTable(trapezoid, 32, PROFILE_TRAPEZOIDAL, START_PERIOD, CRUISE_PERIOD);
+    buildRampTable(scurve, 32, PROFILE_SCURVE, START_PERIOD, CRUISE_PERIOD);
+    // same duration, but the S-curve leaves and arrives more gently
+    CHECK(scurve[1] > trapezoid[1], "S-curve second step %u, trapezoid %u",
+          scurve[1], trapezoid[1]);
+    CHECK(scurve[31] - CRUISE_PERIOD < trapezoid[31] - CRUISE_PERIOD,
+          "S-curve last step %u, trapezoid %u", scurve[31], trapezoid[31]);
+}
+
+static void testTempoInterval(void) {
+    // 120 bpm at 8 steps per beat is exactly 62500us per step
+    CHECK_EQ(tempoIntervalQ16(12000, 8, TICK_HZ), 62500u << 16);
+    CHECK_EQ(tempoIntervalQ16(0, 8, TICK_HZ), 0xFFFFu << 16);
+    CHECK_EQ(tempoIntervalQ16(12000, 0, TICK_HZ), 0xFFFFu << 16);
+    CHECK_EQ(tempoIntervalQ16(100, 1, TICK_HZ), 0xFFFFu << 16);     // 1 bpm, too slow
+    CHECK_EQ(tempoIntervalQ16(65535, 1000, 1000), MIN_STEP_PERIOD << 16);   // too fast
+}
+
+// Summing the Q16.16 interval keeps whole beats on time over a long song
+static void testTempoBeatAlignment(uint16_t bpmX100, uint16_t stepsPerBeat) {
+    uint32_t interval = tempoIntervalQ16(bpmX100, stepsPerBeat, TICK_HZ);
+    uint64_t beats = (uint64_t)bpmX100 * 5 / 100;      // five minutes
+    uint64_t accumulated = (uint64_t)interval * stepsPerBeat * beats;
+    double exact = (double)beats * 60.0 * TICK_HZ * 100 / bpmX100;
+
+    CHECK_NEAR((double)(accumulated >> 16), exact, 1.0);
+}
+
+int main(void) {
+    testRejectsBadArguments();
+    testConstantProfile();
+    testRampFollowsProfile(PROFILE_TRAPEZOIDAL, 32);
+    testRampFollowsProfile(PROFILE_TRAPEZOIDAL, RAMP_TABLE_MAX);
+    testRampFollowsProfile(PROFILE_SCURVE, 32);
+    testRampFollowsProfile(PROFILE_SCURVE, 5);
+    testScurveEasesIn();
+    testTempoInterval();
+    testTempoBeatAlignment(12000, 8);
+    testTempoBeatAlignment(12050, 8);
+    testTempoBeatAlignment(9700, 48);
+    testDone("stepperProfileTest");
+}
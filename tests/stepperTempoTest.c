@@ -0,0 +1,133 @@
+/*! \file */
+/*!
+ * stepperTempoTest.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Locks the motor to a tempo through the simulated Timer_A3 ISR
+ *              and checks from the P2 step times that it stays on the beat
+ *              over five minutes, and that a tempo change slews smoothly
+ *              instead of jumping.
+ */
+
+#include <stdio.h>
+#include "clockManager.h"
+#include "stepperMotor.h"
+#include "sim.h"
+#include "test.h"
+
+#define COIL_PORT           2
+#define SETTLE_US           5000000     // well past the slew time constant
+#define SONG_US             300000000   // five minutes
+#define TOLERANCE_US        2.0         // one tick plus rounding at the start
+
+static uint32_t steps = 0;
+static uint64_t lastTime = 0;
+static uint32_t lastInterval = 0;
+static uint32_t maxIntervalChange = 0;
+
+/* Alignment, measured from the reference step on */
+static uint8_t measuring = 0;
+static uint32_t referenceStep;
+static uint64_t referenceTime;
+static double intervalUs;
+static double maxErrorUs;
+
+static void coilsWritten(uint8_t port, uint8_t out, uint8_t previousOut) {
+    uint64_t now = simNow();
+    uint32_t interval;
+    double errorUs;
+
+    (void)port;
+    if (!((out ^ previousOut) & STEPPER_MASK)) {
+        return;
+    }
+    steps++;
+    interval = (uint32_t)((now - lastTime + SIM_PS_PER_US / 2) / SIM_PS_PER_US);
+    if (lastInterval != 0) {
+        uint32_t change = interval > lastInterval ? interval - lastInterval
+                                                  : lastInterval - interval;
+        if (change > maxIntervalChange) {
+            maxIntervalChange = change;
+        }
+    }
+    lastInterval = interval;
+    lastTime = now;
+
+    if (measuring) {
+        errorUs = (double)(now - referenceTime) / SIM_PS_PER_US
+                  - (steps - referenceStep) * intervalUs;
+        if (errorUs < 0) {
+            errorUs = -errorUs;
+        }
+        if (errorUs > maxErrorUs) {
+            maxErrorUs = errorUs;
+        }
+    }
+}
+
+// Beat alignment over a whole song once the tempo has settled
+static void testSong(uint16_t bpmX100) {
+    uint32_t songSteps;
+    double expectedSteps;
+
+    stepperFollowTempo(STEPPER_MAIN, bpmX100);
+    simRunFor(SETTLE_US);
+
+    measuring = 1;
+    referenceStep = steps;
+    referenceTime = lastTime;
+    intervalUs = tempoIntervalQ16(bpmX100, STEPS_PER_BEAT, STEPPER_TICK_HZ)
+                 / 65536.0;
+    maxErrorUs = 0;
+    simRunUntil(referenceTime + (uint64_t)SONG_US * SIM_PS_PER_US);
+    measuring = 0;
+
+    songSteps = steps - referenceStep;
+    expectedSteps = SONG_US / intervalUs;
+    printf("%5u.%02u bpm: %u steps (%.1f beats), worst %.2fus off the beat\n",
+           bpmX100 / 100, bpmX100 % 100, songSteps,
+           (double)songSteps / STEPS_PER_BEAT, maxErrorUs);
+    CHECK(maxErrorUs <= TOLERANCE_US, "%u: %.2fus off the beat", bpmX100,
+          maxErrorUs);
+    CHECK(songSteps >= expectedSteps - 1 && songSteps <= expectedSteps + 1,
+          "%u: %u steps, expected %.1f", bpmX100, songSteps, expectedSteps);
+}
+
+// A new tempo is reached by a first-order slew, never a jump
+static void testTempoChange(uint16_t fromX100, uint16_t toX100) {
+    uint32_t from = tempoIntervalQ16(fromX100, STEPS_PER_BEAT,
+                                     STEPPER_TICK_HZ) >> 16;
+    uint32_t to = tempoIntervalQ16(toX100, STEPS_PER_BEAT,
+                                   STEPPER_TICK_HZ) >> 16;
+    uint32_t largestStep = (from > to ? from - to : to - from)
+                           >> TEMPO_SLEW_SHIFT;
+
+    maxIntervalChange = 0;
+    stepperFollowTempo(STEPPER_MAIN, toX100);
+    simRunFor(SETTLE_US);
+    CHECK(maxIntervalChange <= largestStep + 2,
+          "%u to %u: interval changed by %u ticks in one step", fromX100,
+          toX100, maxIntervalChange);
+    CHECK(lastInterval + 1 >= to && lastInterval <= to + 1,
+          "%u to %u: settled at %u ticks, expected %u", fromX100, toX100,
+          lastInterval, to);
+}
+
+int main(void) {
+    clockSetProfile(CLOCK_PROFILE_DCO_12MHZ);
+    initStepperMotor();
+    simGpioWatch(COIL_PORT, coilsWritten);
+
+    testSong(12050);                // spin-up, speeding up to the tempo
+    testTempoChange(12050, 9000);
+    testSong(9000);                 // reached by slowing down
+    testTempoChange(9000, 14400);
+    testSong(14400);
+    stepperRequestStop(STEPPER_MAIN);
+    simRunFor(1000000);
+    CHECK(!isStepperRunning(STEPPER_MAIN), "still running after stop");
+    CHECK_EQ(simGpioOut(COIL_PORT) & STEPPER_MASK, 0);
+    CHECK_EQ(TIMER_A3->CTL & TIMER_A_CTL_MC_MASK, TIMER_A_CTL_MC__STOP);
+    CHECK_EQ(simViolationCount(), 0);
+    testDone("stepperTempoTest");
+}
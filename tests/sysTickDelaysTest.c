@@ -0,0 +1,132 @@
+/*! \file */
+/*!
+ * sysTickDelaysTest.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Times the Timer32_2 delays and deadlines on the simulated
+ *              board at the 3MHz reset clock and the 12MHz and 48MHz
+ *              profiles. Blocking delays and polled deadlines must end no
+ *              earlier than asked and at most MAX_LATE_CYCLES later. A
+ *              deadline pending across an MCLK change must not end early
+ *              either, nor later than the switch took. Prints the
+ *              call overhead of a deadline start, check and cancel as
+ *              simulated MCLK cycles (register traffic, see sim.h) and as
+ *              host nanoseconds.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include "clockManager.h"
+#include "sysTickDelays.h"
+#include "sim.h"
+#include "test.h"
+
+#define OVERHEAD_CALLS      10000
+#define MAX_LATE_CYCLES     (3 * SIM_ACCESS_CYCLES)     // last poll, entry
+#define MAX_CALL_CYCLES     (3 * SIM_ACCESS_CYCLES)     // start, check, cancel
+#define SWITCH_AFTER_US     500
+#define SWITCH_DEADLINE_US  5000
+#define MAX_SWITCH_LATE_US  2.0     // past the switch, rescaling rounds
+
+static const uint32_t delays[] = { 2, 10, 100, 1000, 10000, 100000 };
+#define DELAY_COUNT (sizeof(delays) / sizeof(delays[0]))
+
+static uint64_t nowNs(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Simulated time since start in MCLK cycles at the current clock
+static double cyclesSince(uint64_t start) {
+    return (double)(simNow() - start) * simClockHz(0) / (SIM_PS_PER_US * 1e6);
+}
+
+static void checkLate(const char *what, uint32_t micros, uint64_t start) {
+    double late = cyclesSince(start) - (double)micros * simClockHz(0) / 1e6;
+
+    CHECK(late >= 0 && late <= MAX_LATE_CYCLES, "%s %uus at %uHz: %.1f cycles late",
+          what, micros, simClockHz(0), late);
+}
+
+static void testAccuracy(void) {
+    uint64_t start;
+    uint8_t deadline;
+    uint8_t i;
+
+    for (i = 0; i < DELAY_COUNT; i++) {
+        start = simNow();
+        CHECK_EQ(delayMicroSec(delays[i]), SUCCESS);
+        checkLate("delayMicroSec", delays[i], start);
+
+        start = simNow();
+        deadline = deadlineStart(delays[i]);
+        while (!deadlineExpired(deadline)) {}
+        checkLate("deadline", delays[i], start);
+    }
+    CHECK_EQ(delayMicroSec(0), UNDERFLOW);
+    CHECK_EQ(delayMicroSec(0xFFFFFFFF), OVERFLOW);
+}
+
+// Host and simulated cost of one deadline start, check and cancel
+static void benchOverhead(const char *name) {
+    uint64_t start = simNow();
+    uint64_t hostStart = nowNs();
+    uint32_t i;
+    uint8_t deadline;
+    double cycles, ns;
+
+    for (i = 0; i < OVERHEAD_CALLS; i++) {
+        deadline = deadlineStart(1000);
+        deadlineExpired(deadline);
+        deadlineCancel(deadline);
+    }
+    ns = (double)(nowNs() - hostStart) / OVERHEAD_CALLS;
+    cycles = cyclesSince(start) / OVERHEAD_CALLS;
+    printf("  %-11s %8.1f cycles %8.1f us %8.1f host ns\n", name, cycles,
+           cycles / (simClockHz(0) / 1e6), ns);
+    CHECK(cycles <= MAX_CALL_CYCLES, "%s: %.1f cycles per deadline",
+          name, cycles);
+}
+
+static void runProfile(const char *name) {
+    testAccuracy();
+    benchOverhead(name);
+}
+
+/* A deadline keeps its remaining time when MCLK changes, so it is never
+ *  early; the time clockSetProfile takes is added on top */
+static void testClockChange(ClockProfile from, ClockProfile to, const char *name) {
+    uint64_t start, switchStart;
+    double switchUs, late;
+    uint8_t deadline;
+
+    clockSetProfile(from);
+    start = simNow();
+    deadline = deadlineStart(SWITCH_DEADLINE_US);
+    simRunFor(SWITCH_AFTER_US);
+    switchStart = simNow();
+    clockSetProfile(to);
+    switchUs = (double)(simNow() - switchStart) / SIM_PS_PER_US;
+    deadlineWait(deadline);
+    late = (double)(simNow() - start) / SIM_PS_PER_US - SWITCH_DEADLINE_US;
+    printf("  %-11s %uus deadline %.2fus late, switch took %.2fus\n", name,
+           SWITCH_DEADLINE_US, late, switchUs);
+    CHECK(late >= 0 && late <= switchUs + MAX_SWITCH_LATE_US,
+          "%s: %.2fus late, switch took %.2fus", name, late, switchUs);
+}
+
+int main(void) {
+    initDelayTimer(getMCLKFrequency());
+    printf("  MCLK        deadline start, check and cancel\n");
+    runProfile("3MHz reset");
+    clockSetProfile(CLOCK_PROFILE_DCO_12MHZ);
+    runProfile("12MHz DCO");
+    clockSetProfile(CLOCK_PROFILE_HFXT_48MHZ);
+    runProfile("48MHz HFXT");
+    testClockChange(CLOCK_PROFILE_DCO_12MHZ, CLOCK_PROFILE_HFXT_48MHZ, "12 to 48MHz");
+    testClockChange(CLOCK_PROFILE_HFXT_48MHZ, CLOCK_PROFILE_DCO_12MHZ, "48 to 12MHz");
+    CHECK_EQ(simViolationCount(), 0);
+    testDone("sysTickDelaysTest");
+}
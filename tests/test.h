@@ -0,0 +1,57 @@
+/*! \file */
+/*!
+ * test.h
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Minimal checks for the host tests in this directory. Each
+ *              test is its own program; a failed check prints its location
+ *              and the run goes on, testDone() turns the count into the
+ *              exit status for make.
+ */
+
+#ifndef TEST_H_
+#define TEST_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static unsigned testChecks = 0;
+static unsigned testFailures = 0;
+
+/* Checks a condition, printf-style arguments describe a failure */
+#define CHECK(condition, ...) \
+    do { \
+        testChecks++; \
+        if (!(condition)) { \
+            testFailures++; \
+            printf("%s:%d: %s: ", __FILE__, __LINE__, #condition); \
+            printf(__VA_ARGS__); \
+            printf("\n"); \
+        } \
+    } while (0)
+
+/* Checks that two integers are equal */
+#define CHECK_EQ(actual, expected) \
+    CHECK((long long)(actual) == (long long)(expected), "got %lld, expected %lld", \
+          (long long)(actual), (long long)(expected))
+
+/* Checks that |actual - expected| <= tolerance */
+#define CHECK_NEAR(actual, expected, tolerance) \
+    CHECK((double)(actual) - (double)(expected) <= (tolerance) \
+          && (double)(expected) - (double)(actual) <= (tolerance), \
+          "got %g, expected %g +/- %g", (double)(actual), (double)(expected), \
+          (double)(tolerance))
+
+/*!
+ * \brief This function reports the checks and ends the test
+ *
+ * \param name is the test program's name
+ *
+ * \return does not return, exits 1 if a check failed
+ */
+static inline void testDone(const char *name) {
+    printf("%-20s %u checks, %u failed\n", name, testChecks, testFailures);
+    exit(testFailures ? 1 : 0);
+}
+
+#endif /* TEST_H_ */
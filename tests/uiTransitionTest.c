@@ -0,0 +1,164 @@
+/*! \file */
+/*!
+ * uiTransitionTest.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Runs the whole firmware on the simulated board, presses the
+ *              buttons through every row of the UI transition table and
+ *              counts the LCD bus writes each press causes. A logical
+ *              change must cost at most one redraw, a change of the status
+ *              tag or pause alone at most the bottom row or the bar cells,
+ *              and a clear display only when the song on screen changed.
+ *
+ *              Presses are two seconds apart, between the title scroll
+ *              updates, so the writes counted belong to the press alone.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "timer32.h"
+#include "lcd.h"
+#include "sim.h"
+#include "hd44780.h"
+#include "test.h"
+
+#define SWITCH_PORT     3
+#define NEXT            0x04
+#define SELECT          0x08
+#define TOGGLE          0x20
+#define RESET           0x40
+
+#define STEP_MS         2000    // SCROLL_DELAY_MS, one press per scroll period
+#define PRESS_AT_MS     300     // into the period
+#define PRESS_MS        80
+#define CHECK_AT_MS     1700
+#define SAMPLE_MS       5       // system time checks until the first press
+
+/* Budgets: clear display, two cursor moves and two rows of 16 characters
+ *  for a frame, a cursor move and one row for a status tag, a cursor move
+ *  and the cells for the level bar, and the five bar glyphs (CGRAM address
+ *  and eight rows each) the first time it shows */
+#define FRAME_WRITES    (1 + 2 + 2 * HD44780_COLUMNS)
+#define TAG_WRITES      (1 + HD44780_COLUMNS)
+#define BAR_WRITES      (1 + LCD_BAR_CELLS)
+#define GLYPH_WRITES    (5 * (1 + 8))
+
+typedef struct _UiStep {
+    const char *name;
+    uint8_t button;
+    ScreenState state;      // after the press
+    uint8_t clears;         // 1 if the song on screen changes
+    uint8_t maxWrites;      // 0 if nothing visible may change
+    const char *top;        // expected top row, or 0
+    const char *bottom;     // expected bottom row, or 0
+} UiStep;
+
+static const UiStep steps[] = {
+    { "start, toggle",   TOGGLE, START_SCREEN,   0, 0, " Karaoke Machine" },
+    { "start, next",     NEXT,   SELECT_SCREEN,  1, FRAME_WRITES, "    1. Again" },
+    { "select, next",    NEXT,   SELECT_SCREEN,  1, FRAME_WRITES, "2. Friends" },
+    { "select, next",    NEXT,   SELECT_SCREEN,  1, FRAME_WRITES, "    3. Happy" },
+    // the artist keeps the columns left of the status tag
+    { "select, select",  SELECT, PLAYING_SCREEN, 0,
+      FRAME_WRITES + BAR_WRITES + GLYPH_WRITES, 0, "  Pharrell   1/1" },
+    // pausing puts the title back under the bar
+    { "playing, toggle", TOGGLE, PLAYING_SCREEN, 0, BAR_WRITES, "    3. Happy    " },
+    { "playing, select", SELECT, PLAYING_SCREEN, 0, TAG_WRITES, 0, " Pharrell   *1/1" },
+    { "playing, next",   NEXT,   SELECT_SCREEN,  0, FRAME_WRITES, 0 },
+    // the recent list starts with the song just played, still on screen
+    { "select, toggle",  TOGGLE, SELECT_SCREEN,  0, TAG_WRITES, 0, " Pharrell  R*1/1" },
+    { "select, reset",   RESET,  START_SCREEN,   1, FRAME_WRITES, " Karaoke Machine" },
+    { "start, select",   SELECT, SELECT_SCREEN,  1, FRAME_WRITES, "    1. Again" },
+    { "select, select",  SELECT, PLAYING_SCREEN, 0, FRAME_WRITES + BAR_WRITES, 0,
+      " Fetty Wap   1/1" },
+    { "playing, reset",  RESET,  START_SCREEN,   1, FRAME_WRITES, " Karaoke Machine" },
+};
+
+#define STEP_COUNT (sizeof(steps) / sizeof(steps[0]))
+
+static uint32_t writesBefore;
+static uint32_t clearsBefore;
+
+extern int firmwareMain(void);
+
+static uint64_t stepTime(uint8_t step, uint32_t ms) {
+    return ((uint64_t)(step + 1) * STEP_MS + ms) * SIM_PS_PER_MS;
+}
+
+static void press(void *arg) {
+    const UiStep *step = arg;
+
+    writesBefore = hd44780Writes();
+    clearsBefore = hd44780Clears();
+    simGpioDrive(SWITCH_PORT, step->button, 0);
+}
+
+static void release(void *arg) {
+    const UiStep *step = arg;
+
+    simGpioRelease(SWITCH_PORT, step->button);
+}
+
+static void verify(void *arg) {
+    const UiStep *step = arg;
+    uint32_t writes = hd44780Writes() - writesBefore;
+    uint32_t clears = hd44780Clears() - clearsBefore;
+    char top[HD44780_COLUMNS + 1];
+    char bottom[HD44780_COLUMNS + 1];
+
+    hd44780Row(0, top);
+    hd44780Row(1, bottom);
+    printf("  %-17s %4u %7u   |%s|%s|\n", step->name, writes, clears, top,
+           bottom);
+    CHECK(currentState == step->state, "%s: state %u, expected %u",
+          step->name, currentState, step->state);
+    CHECK(clears == step->clears, "%s: %u clears, expected %u", step->name,
+          clears, step->clears);
+    CHECK(writes <= step->maxWrites && (writes > 0) == (step->maxWrites > 0),
+          "%s: %u LCD writes, at most %u", step->name, writes, step->maxWrites);
+    if (step->top) {
+        CHECK(!strncmp(top, step->top, strlen(step->top)), "%s: screen |%s|%s|",
+              step->name, top, bottom);
+    }
+    if (step->bottom) {
+        CHECK(!strcmp(bottom, step->bottom), "%s: screen |%s|%s|", step->name,
+              top, bottom);
+    }
+}
+
+// The millisecond clock only moves forward, also when the RTC takes over
+static void sampleTime(void *arg) {
+    static uint32_t last = 0;
+    uint32_t now = getSystemTime();
+
+    (void)arg;
+    CHECK(now >= last, "system time went from %u to %u ms", last, now);
+    last = now;
+    if (simNow() < stepTime(0, PRESS_AT_MS)) {
+        simSchedule(simNow() + SAMPLE_MS * SIM_PS_PER_MS, sampleTime, 0);
+    }
+}
+
+static void finish(void *arg) {
+    (void)arg;
+    CHECK_EQ(simViolationCount(), 0);
+    testDone("uiTransitionTest");
+}
+
+int main(void) {
+    uint8_t i;
+
+    for (i = 0; i < STEP_COUNT; i++) {
+        simSchedule(stepTime(i, PRESS_AT_MS), press, (void *)&steps[i]);
+        simSchedule(stepTime(i, PRESS_AT_MS + PRESS_MS), release,
+                    (void *)&steps[i]);
+        simSchedule(stepTime(i, CHECK_AT_MS), verify, (void *)&steps[i]);
+    }
+    simSchedule(stepTime(STEP_COUNT, 0), finish, 0);
+    simSchedule(0, sampleTime, 0);
+    hd44780Attach();
+    simUartSetSink(0);
+    printf("  transition        writes clears  screen\n");
+    firmwareMain();
+    return 0;
+}
@@ -1,13 +1,23 @@
 #include "lcd.h"
 #include "timer32.h"
+#include "clockManager.h"
+#include "profiler.h"
 
 
 // Definitions
 volatile uint32_t millis = 0;
 extern volatile uint8_t updateLCD;
 
+/* Reload for a 1ms period at the new MCLK */
+static void timer32ClockChanged(ClockEvent event) {
+    if (event == CLOCK_POST_CHANGE) {
+        TIMER32_1->LOAD = (getMCLKFrequency() / 1000) - 1;
+    }
+}
+
 void Timer32_Init(void) {
-    TIMER32_1->LOAD = (SystemCoreClock / 1000) - 1;
+    TIMER32_1->LOAD = (getMCLKFrequency() / 1000) - 1;
+    clockRegisterListener(timer32ClockChanged);
     TIMER32_1->CONTROL = TIMER32_CONTROL_SIZE | TIMER32_CONTROL_MODE | TIMER32_CONTROL_IE | TIMER32_CONTROL_ENABLE;
 
     NVIC_SetPriority(T32_INT1_IRQn, 2);  // Lower priority so button presses get priority
@@ -17,6 +27,7 @@ void Timer32_Init(void) {
 
 // Timer32 Interrupt Handler (called every 1ms)
 void T32_INT1_IRQHandler(void) {
+    PROFILE_BEGIN(PROF_TIMER32_ISR);
     millis++;
 
     if ((currentState == SELECT_SCREEN || currentState == PLAYING_SCREEN) &&
@@ -25,8 +36,23 @@ void T32_INT1_IRQHandler(void) {
     }
 
     TIMER32_1->INTCLR = 0;  // Clear interrupt flag
+    PROFILE_END(PROF_TIMER32_ISR);
 }
 
 uint32_t getSystemTime(void) {
     return millis;
 }
+
+void setSystemTime(uint32_t time) {
+    uint32_t previous;
+
+    NVIC_DisableIRQ(T32_INT1_IRQn);
+    previous = millis;
+    millis = time;
+    // a scroll deadline passed while the tick was stopped
+    if ((currentState == SELECT_SCREEN || currentState == PLAYING_SCREEN) &&
+        (time / SCROLL_DELAY_MS != previous / SCROLL_DELAY_MS)) {
+        updateLCD = 1;
+    }
+    NVIC_EnableIRQ(T32_INT1_IRQn);
+}
@@ -17,5 +17,6 @@ extern ScreenState currentState; // current state
 
 void Timer32_Init(void);
 uint32_t getSystemTime(void);
+void setSystemTime(uint32_t time);  // resync after Timer32 was stopped in LPM3
 
 #endif // TIMER32_H
@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+"""Static RAM usage per module from a TI ARM linker map file.
+
+CCS writes the map to <config>/<project>.map. Run after a build:
+
+    python3 tools/ramusage.py Debug/ece230_finalproject.map
+    python3 tools/ramusage.py --json Debug/ece230_finalproject.map
+    python3 tools/ramusage.py --max-ram 65536 --stack-used 400 map
+
+The sizes come from the SECTION ALLOCATION MAP. Input sections placed in
+the RAM output sections (.vtable, .data, .bss, .sysmem, .stack) are
+summed per object file.
+
+--max-ram fails if the total exceeds the limit. --stack-used takes the
+high-water mark reported by the "M" UART command; the check fails if
+that leaves less than --stack-margin bytes free. Either failure exits
+with status 1, so the script can gate a build.
+"""
+
+import argparse
+import json
+import re
+import sys
+from collections import defaultdict
+
+RAM_SECTIONS = (".vtable", ".data", ".bss", ".sysmem", ".stack")
+
+OUTPUT_RE = re.compile(r"^(\.\S+)\s+\d+\s+([0-9a-fA-F]{8})\s+([0-9a-fA-F]{8})")
+INPUT_RE = re.compile(r"^\s+([0-9a-fA-F]{8})\s+([0-9a-fA-F]{8})\s+(.*)$")
+
+
+def module_name(description):
+    if description.startswith("--HOLE--"):
+        return "(padding)"
+    if description.startswith("("):
+        return "(common)"
+    # "lib.lib : member.obj (.bss)" or "file.obj (.bss:name)"
+    name = description.split(" (")[0]
+    return name.split(" : ")[-1].strip()
+
+
+def parse(lines):
+    usage = defaultdict(lambda: defaultdict(int))
+    sizes = {}
+    section = None
+    in_map = False
+
+    for line in lines:
+        if line.startswith("SECTION ALLOCATION MAP"):
+            in_map = True
+            continue
+        if in_map and line.startswith(("GLOBAL SYMBOLS", "LINKER GENERATED",
+                                       "MODULE SUMMARY", "SEGMENT ALLOCATION")):
+            break
+        if not in_map:
+            continue
+        output = OUTPUT_RE.match(line)
+        if output:
+            section = output.group(1) if output.group(1) in RAM_SECTIONS else None
+            if section:
+                sizes[section] = int(output.group(3), 16)
+            continue
+        if section:
+            entry = INPUT_RE.match(line)
+            if entry:
+                usage[module_name(entry.group(3))][section] += int(entry.group(2), 16)
+    return usage, sizes
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("map")
+    parser.add_argument("--json", action="store_true", help="machine-readable output")
+    parser.add_argument("--max-ram", type=int, help="fail if total RAM exceeds this")
+    parser.add_argument("--stack-used", type=int, help="measured stack high-water mark")
+    parser.add_argument("--stack-margin", type=int, default=128,
+                        help="minimum free stack in bytes (default 128)")
+    args = parser.parse_args()
+
+    with open(args.map) as mapfile:
+        usage, sizes = parse(mapfile)
+    total = sum(sizes.values())
+
+    if args.json:
+        json.dump({"total": total, "sections": sizes,
+                   "modules": {m: dict(s) for m, s in usage.items()}},
+                  sys.stdout, indent=1, sort_keys=True)
+        sys.stdout.write("\n")
+    else:
+        columns = [s for s in RAM_SECTIONS if s in sizes]
+        print("%-32s" % "module" + "".join("%9s" % c for c in columns) + "%9s" % "total")
+        for module in sorted(usage, key=lambda m: -sum(usage[m].values())):
+            row = usage[module]
+            print("%-32s" % module[:32] + "".join("%9d" % row[c] for c in columns)
+                  + "%9d" % sum(row.values()))
+        print("%-32s" % "TOTAL" + "".join("%9d" % sizes[c] for c in columns)
+              + "%9d" % total)
+
+    status = 0
+    if args.max_ram is not None and total > args.max_ram:
+        sys.stderr.write("RAM %d exceeds limit %d\n" % (total, args.max_ram))
+        status = 1
+    if args.stack_used is not None:
+        free = sizes.get(".stack", 0) - args.stack_used
+        if free < args.stack_margin:
+            sys.stderr.write("stack: %d bytes free, need %d\n" % (free, args.stack_margin))
+            status = 1
+    return status
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""Convert a trace dump from the karaoke firmware into Chrome trace JSON.
+
+Capture the UART output of the "X" command (any other lines in the log
+are ignored) and run:
+
+    python3 tools/trace2chrome.py capture.log > trace.json
+
+then open trace.json in chrome://tracing or https://ui.perfetto.dev.
+
+Timestamps are DWT cycle counts. The X:BEGIN header gives the MCLK in MHz
+at the first record and TRACE_CLOCK records give it from that point on, so
+time stays correct across DVFS changes. The
+32-bit counter is unwrapped assuming consecutive records are less than
+one wrap apart (89 s at 48 MHz).
+"""
+
+import json
+import sys
+
+# Event ID -> (name, phase, thread); keep in sync with TraceEvent in trace.h
+EVENTS = {
+    1: ("clock", "i", "system"),
+    2: ("button", "i", "ui"),
+    3: ("state", "i", "ui"),
+    4: ("uart rx", "i", "uart"),
+    5: ("uart tx", "i", "uart"),
+    6: ("lcd write", "i", "lcd"),
+    7: ("stepper isr", "B", "stepper"),
+    8: ("stepper isr", "E", "stepper"),
+    9: ("dma isr", "B", "stepper"),
+    10: ("dma isr", "E", "stepper"),
+    11: ("sleep", "B", "system"),
+    12: ("sleep", "E", "system"),
+    13: ("queue advance", "i", "ui"),
+}
+TRACE_CLOCK = 1
+DEFAULT_MHZ = 48    # captures from firmware that did not send it in X:BEGIN
+
+
+def parse(lines):
+    records = []
+    mhz = DEFAULT_MHZ
+    for line in lines:
+        line = line.strip()
+        if line.startswith("X:BEGIN"):
+            fields = line[7:].split()
+            if len(fields) > 1 and int(fields[1]):
+                mhz = int(fields[1])
+            continue
+        if not line.startswith("X:") or line.startswith("X:END"):
+            continue
+        fields = line[2:].split()
+        if len(fields) != 3:
+            continue
+        records.append(tuple(int(f, 16) for f in fields))
+    return records, mhz
+
+
+def convert(records, mhz):
+    events = []
+    threads = {}
+    micros = 0.0
+    previous = None
+
+    for cycles, event, arg in records:
+        if previous is not None:
+            micros += ((cycles - previous) & 0xFFFFFFFF) / mhz
+        previous = cycles
+        if event == TRACE_CLOCK and arg & 0xFF:
+            mhz = arg & 0xFF    # old MCLK << 8 | new MCLK
+
+        name, phase, thread = EVENTS.get(event, ("event %d" % event, "i", "other"))
+        tid = threads.setdefault(thread, len(threads) + 1)
+        entry = {"name": name, "ph": phase, "ts": round(micros, 3),
+                 "pid": 1, "tid": tid, "args": {"arg": arg}}
+        if phase == "i":
+            entry["s"] = "t"
+        events.append(entry)
+
+    for thread, tid in threads.items():
+        events.append({"name": "thread_name", "ph": "M", "pid": 1, "tid": tid,
+                       "args": {"name": thread}})
+    return {"traceEvents": events}
+
+
+def main():
+    source = open(sys.argv[1]) if len(sys.argv) > 1 else sys.stdin
+    with source:
+        records, mhz = parse(source)
+    json.dump(convert(records, mhz), sys.stdout, indent=1)
+    sys.stdout.write("\n")
+
+
+if __name__ == "__main__":
+    main()
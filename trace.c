@@ -0,0 +1,73 @@
+/*! \file */
+/*!
+ * trace.c
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Binary event trace in an SRAM ring.
+ */
+
+#include <stdio.h>
+#include "msp.h"
+#include "trace.h"
+#include "clockManager.h"
+#include "uart.h"
+
+TraceRecord traceBuffer[TRACE_BUFFER_SIZE];
+volatile uint32_t traceHead = 0;        // total records ever claimed
+volatile uint8_t traceEnabled = 0;
+static uint8_t clockMhz = 0;            // MCLK of the last TRACE_CLOCK record
+
+/* Tell the decoder how fast the cycle counter runs from here on */
+static void traceClockChanged(ClockEvent event) {
+    uint8_t mhz;
+
+    if (event == CLOCK_POST_CHANGE) {
+        mhz = getMCLKFrequency() / 1000000;
+        TRACE(TRACE_CLOCK, (uint16_t)clockMhz << 8 | mhz);
+        clockMhz = mhz;
+    }
+}
+
+void initTrace(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    traceHead = 0;
+    traceEnabled = 1;
+    clockRegisterListener(traceClockChanged);
+    clockMhz = getMCLKFrequency() / 1000000;
+    TRACE(TRACE_CLOCK, (uint16_t)clockMhz << 8 | clockMhz);
+}
+
+void traceDump(void) {
+    char buffer[32];
+    TraceRecord *record;
+    uint32_t head, count, i;
+    uint8_t wasEnabled = traceEnabled;
+    uint8_t mhz = getMCLKFrequency() / 1000000;
+
+    traceEnabled = 0;
+    head = traceHead;
+    count = (head < TRACE_BUFFER_SIZE) ? head : TRACE_BUFFER_SIZE;
+
+    // MCLK at the oldest record: before the first clock change left in the
+    // ring, or the current one if the ring has none
+    for (i = head - count; i != head; i++) {
+        record = &traceBuffer[i & (TRACE_BUFFER_SIZE - 1)];
+        if (record->event == TRACE_CLOCK) {
+            mhz = record->arg >> 8;
+            break;
+        }
+    }
+
+    sprintf(buffer, "X:BEGIN %lu %u\n", (unsigned long)count, mhz);
+    sendString(buffer);
+    for (i = head - count; i != head; i++) {
+        record = &traceBuffer[i & (TRACE_BUFFER_SIZE - 1)];
+        sprintf(buffer, "X:%08lx %x %x\n", (unsigned long)record->time,
+                record->event, record->arg);
+        sendString(buffer);
+    }
+    sendString("X:END\n");
+
+    traceEnabled = wasEnabled;
+}
@@ -0,0 +1,137 @@
+/*! \file */
+/*!
+ * trace.h
+ * ECE230 Winter 2024-2025
+ *
+ * Description: Binary event trace in an SRAM ring. Each record is 8 bytes:
+ *              DWT cycle timestamp, event ID and a 16-bit argument. A slot
+ *              is claimed by bumping the head index with interrupts masked
+ *              for three instructions, so ISRs and the main loop record
+ *              without locks or waiting. The ring is dumped over eUSCI_A0
+ *              and tools/trace2chrome.py turns the dump into Chrome /
+ *              Perfetto trace JSON.
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include "msp.h"
+
+/* 1 to record events, 0 compiles all TRACE() calls out. On with
+ *  KARAOKE_DIAGNOSTICS */
+#ifndef TRACE_ENABLED
+#ifdef KARAOKE_DIAGNOSTICS
+#define TRACE_ENABLED       1
+#else
+#define TRACE_ENABLED       0
+#endif
+#endif
+#define TRACE_BUFFER_SIZE   512         // records, must be a power of 2
+
+/* Event IDs, keep in sync with EVENTS in tools/trace2chrome.py */
+typedef enum _TraceEvent {
+    TRACE_CLOCK = 1,            // arg: old MCLK << 8 | new MCLK, in MHz
+    TRACE_BUTTON,               // arg: PORT3 interrupt flags
+    TRACE_STATE,                // arg: new ScreenState
+    TRACE_UART_LINE,            // arg: first character of the command
+    TRACE_UART_TX,              // arg: first character of the string
+    TRACE_LCD_WRITE,            // arg: RS mode << 8 | byte
+    TRACE_STEPPER_BEGIN,        // Timer_A3 scheduler ISR entry
+    TRACE_STEPPER_END,          // arg: motors still active
+    TRACE_DMA_BEGIN,            // stepper DMA refill ISR entry
+    TRACE_DMA_END,
+    TRACE_SLEEP,                // entering LPM3
+    TRACE_WAKE,                 // back from LPM3
+    TRACE_QUEUE                 // arg: song started from the playlist
+} TraceEvent;
+
+typedef struct _TraceRecord {
+    uint32_t time;              // DWT->CYCCNT
+    uint16_t event;
+    uint16_t arg;
+} TraceRecord;
+
+extern TraceRecord traceBuffer[TRACE_BUFFER_SIZE];
+extern volatile uint32_t traceHead;
+extern volatile uint8_t traceEnabled;
+
+#if TRACE_ENABLED
+#define TRACE(event, arg)   traceRecord((event), (arg))
+#else
+#define TRACE(event, arg)
+#endif
+
+/*!
+ * \brief This function records one event
+ *
+ * Safe from any context. Use through TRACE() so it compiles out when
+ *  TRACE_ENABLED is 0.
+ *
+ * \param event is the TraceEvent ID
+ * \param arg is the event argument
+ *
+ * \return None
+ */
+static inline void traceRecord(uint16_t event, uint16_t arg) {
+    TraceRecord *record;
+    uint32_t primask;
+    uint32_t slot;
+
+    if (!traceEnabled) {
+        return;
+    }
+    // claim a slot, a preempting ISR gets the next one
+    primask = __get_PRIMASK();
+    __disable_irq();
+    slot = traceHead++;
+    __set_PRIMASK(primask);
+
+    record = &traceBuffer[slot & (TRACE_BUFFER_SIZE - 1)];
+    record->time = DWT->CYCCNT;
+    record->event = event;
+    record->arg = arg;
+}
+
+/*!
+ * \brief This function starts the cycle counter and enables recording
+ *
+ * Records a TRACE_CLOCK event now and on every clock change so the
+ *  decoder can convert cycles to time.
+ *
+ * \return None
+ */
+extern void initTrace(void);
+
+/*!
+ * \brief This function sends the ring over UART
+ *
+ * Recording pauses during the dump. Output, oldest record first:
+ *  "X:BEGIN <records> <MCLK in MHz at the first record>\n", one
+ *  "X:<time> <event> <arg>\n" line per record in hex, then "X:END\n".
+ *
+ * \return None
+ */
+extern void traceDump(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRACE_H_ */
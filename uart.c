@@ -1,42 +1,115 @@
 #include "msp.h"
 #include "uart.h"
+#include "clockManager.h"
+#include "profiler.h"
+#include "trace.h"
 #include "stdio.h"
 
+/* RX ring buffer filled by EUSCIA0_IRQHandler, size must be a power of 2 */
+static volatile uint8_t rxBuffer[UART_RX_BUFFER_SIZE];
+static volatile uint8_t rxHead = 0;
+static volatile uint8_t rxTail = 0;
+
+/* Partial command line assembled by uartReadLine() */
+static char lineBuffer[UART_LINE_MAX];
+static uint8_t lineLength = 0;
+
+/* Modulation pattern for the fractional part of SMCLK / baud, from the
+ *  eUSCI_A BRS lookup table in the TRM. Fractions are in 1/10000 units. */
+static const struct {
+    uint16_t fraction;
+    uint8_t brs;
+} brsTable[] = {
+    {    0, 0x00 }, {  529, 0x01 }, {  715, 0x02 }, {  835, 0x04 },
+    { 1001, 0x08 }, { 1252, 0x10 }, { 1430, 0x20 }, { 1670, 0x11 },
+    { 2147, 0x21 }, { 2224, 0x22 }, { 2503, 0x44 }, { 3000, 0x25 },
+    { 3335, 0x49 }, { 3575, 0x4A }, { 3753, 0x52 }, { 4003, 0x92 },
+    { 4286, 0x53 }, { 4378, 0x55 }, { 5002, 0xAA }, { 5715, 0x6B },
+    { 6003, 0xAD }, { 6254, 0xB5 }, { 6432, 0xB6 }, { 6667, 0xD6 },
+    { 7001, 0xB7 }, { 7147, 0xBB }, { 7503, 0xDD }, { 7861, 0xED },
+    { 8004, 0xEE }, { 8333, 0xBF }, { 8464, 0xDF }, { 8572, 0xEF },
+    { 8751, 0xF7 }, { 9004, 0xFB }, { 9170, 0xFD }, { 9288, 0xFE }
+};
+
+void uartSetBaudRate(uint32_t clkFreq, uint32_t baud) {
+    uint32_t nX10000;
+    uint16_t fraction;
+    uint8_t brs = 0;
+    uint8_t i;
+
+    // N = clkFreq / baud, kept with 4 decimal places
+    nX10000 = (uint32_t)((uint64_t)clkFreq * 10000 / baud);
+    fraction = nX10000 % 10000;
+    for (i = 0; i < sizeof(brsTable) / sizeof(brsTable[0]); i++) {
+        if (brsTable[i].fraction <= fraction) {
+            brs = brsTable[i].brs;
+        }
+    }
+
+    EUSCI_A0->CTLW0 |= EUSCI_A_CTLW0_SWRST;
+    if (nX10000 >= 16 * 10000) {
+        // oversampling: BRW = N / 16, BRF = fractional part of N / 16
+        EUSCI_A0->BRW = nX10000 / (16 * 10000);
+        EUSCI_A0->MCTLW = (((nX10000 / 10000) % 16) << EUSCI_A_MCTLW_BRF_OFS)
+                          | ((uint16_t)brs << EUSCI_A_MCTLW_BRS_OFS)
+                          | EUSCI_A_MCTLW_OS16;
+    } else {
+        EUSCI_A0->BRW = nX10000 / 10000;
+        EUSCI_A0->MCTLW = (uint16_t)brs << EUSCI_A_MCTLW_BRS_OFS;
+    }
+    EUSCI_A0->CTLW0 &= ~EUSCI_A_CTLW0_SWRST;
+    // reset clears IE, restore RX interrupt
+    EUSCI_A0->IE |= EUSCI_A_IE_RXIE;
+}
+
+/* Finish the byte on the wire before SMCLK moves, then retune the divider */
+static void uartClockChanged(ClockEvent event) {
+    if (event == CLOCK_PRE_CHANGE) {
+        while (EUSCI_A0->STATW & EUSCI_A_STATW_BUSY);
+    } else {
+        uartSetBaudRate(getSMCLKFrequency(), UART_BAUD_RATE);
+    }
+}
+
 void initUART(void) {
-    CS->KEY = CS_KEY_VAL;         // Unlock CS registers
-    CS->CTL0 = CS_CTL0_DCORSEL_3; // Set DCO to 12MHz
-    CS->CTL1 = CS_CTL1_SELA_2 |   // Set ACLK = REFOCLK
-               CS_CTL1_SELS_3 |   // Set SMCLK = DCO (12MHz)
-               CS_CTL1_SELM_3;    // Set MCLK = DCO (12MHz)
-    CS->KEY = 0;                  // Lock CS registers
     // Put eUSCI_A0 in reset
     EUSCI_A0->CTLW0 = EUSCI_A_CTLW0_SWRST;
 
     EUSCI_A0->CTLW0 |= EUSCI_A_CTLW0_SSEL__SMCLK;
-    EUSCI_A0->BRW = 6;
-    EUSCI_A0->MCTLW = (8 << EUSCI_A_MCTLW_BRF_OFS) | (0x20 << EUSCI_A_MCTLW_BRS_OFS) | EUSCI_A_MCTLW_OS16;
+    EUSCI_A0->BRW = 1;
+    EUSCI_A0->MCTLW = 0;
 
     // Configure TX (P1.3) and RX (P1.2)
     P1->SEL0 |= BIT2 | BIT3;
     P1->SEL1 &= ~(BIT2 | BIT3);
 
-    // Enable UART Interrupts (Better than polling)
-    EUSCI_A0->IE |= EUSCI_A_IE_RXIE; // Enable RX interrupt
+    // Divider for current SMCLK, releases from reset and enables RX interrupt
+    uartSetBaudRate(getSMCLKFrequency(), UART_BAUD_RATE);
+    clockRegisterListener(uartClockChanged);
 
-    // Release from reset
-    EUSCI_A0->CTLW0 &= ~EUSCI_A_CTLW0_SWRST;
+    // Enable UART Interrupts (Better than polling)
+    NVIC_EnableIRQ(EUSCIA0_IRQn);
+    // RX edge wakes the CPU from LPM3, uartWake() clears it before a handler
+    NVIC_EnableIRQ(PORT1_IRQn);
 }
 
+// Not profiled: a blocking send takes a byte time per character, and the
+// overrun report itself goes out through here
 void sendString(const char *str) {
+    TRACE(TRACE_UART_TX, (uint8_t)*str);
     while (*str) {
         sendByte(*str++);  // Send each character one by one
     }
 }
 
 
+int formatPlaybackStatus(char *buffer, uint8_t isPlaying, uint8_t songIndex, uint8_t isReset) {
+    return sprintf(buffer, "P:%u S:%u R:%u\n", isPlaying, songIndex, isReset);
+}
+
 void sendPlaybackStatus(uint8_t isPlaying, uint8_t songIndex, uint8_t isReset) { // Sends UART command to ESP32
     char buffer[25];
-    sprintf(buffer, "P:%u S:%u R:%u\n", isPlaying, songIndex, isReset);
+    formatPlaybackStatus(buffer, isPlaying, songIndex, isReset);
     sendString(buffer);
 }
 
@@ -49,8 +122,78 @@ void sendByte(uint8_t data) {
 
 // Read a single byte (Blocking)
 uint8_t readByte(void) {
-    while (!(EUSCI_A0->IFG & EUSCI_A_IFG_RXIFG));  // Wait for RX buffer
-    return EUSCI_A0->RXBUF;  // Read received byte
+    uint8_t data;
+    while (rxHead == rxTail);  // Wait for RX interrupt to queue a byte
+    data = rxBuffer[rxTail];
+    rxTail = (rxTail + 1) & (UART_RX_BUFFER_SIZE - 1);
+    return data;
+}
+
+uint8_t uartReadLine(char *line, uint8_t size) {
+    uint8_t data;
+    uint8_t i;
+
+    while (rxHead != rxTail) {
+        data = rxBuffer[rxTail];
+        rxTail = (rxTail + 1) & (UART_RX_BUFFER_SIZE - 1);
+
+        if (data == '\r' || data == UART_WAKE_BYTE) {
+            continue;
+        }
+        if (data == '\n') {
+            // hand over complete line, truncated to caller's buffer
+            for (i = 0; i < lineLength && i < size - 1; i++) {
+                line[i] = lineBuffer[i];
+            }
+            line[i] = '\0';
+            lineLength = 0;
+            return 1;
+        }
+        if (lineLength < UART_LINE_MAX) {
+            lineBuffer[lineLength++] = data;
+        }
+    }
+    return 0;
+}
+
+uint8_t uartIsIdle(void) {
+    return rxHead == rxTail && lineLength == 0
+            && !(EUSCI_A0->STATW & EUSCI_A_STATW_BUSY);
+}
+
+void uartSleep(void) {
+    // setting IES can raise the flag, clear it once the pin is a GPIO
+    P1->IES |= BIT2;
+    P1->SEL0 &= ~BIT2;
+    P1->IFG &= ~BIT2;
+    P1->IE |= BIT2;
+}
+
+uint8_t uartWake(void) {
+    uint8_t woke = (P1->IFG & BIT2) != 0;
+
+    P1->IE &= ~BIT2;
+    P1->SEL0 |= BIT2;
+    P1->IFG &= ~BIT2;
+    NVIC_ClearPendingIRQ(PORT1_IRQn);   // latched while PRIMASK was set
+    return woke;
+}
+
+// eUSCI_A0 interrupt: queue received bytes for the main loop
+void EUSCIA0_IRQHandler(void) {
+    uint8_t next;
+    uint8_t data;
+    PROFILE_BEGIN(PROF_UART);
+
+    if (EUSCI_A0->IFG & EUSCI_A_IFG_RXIFG) {
+        data = EUSCI_A0->RXBUF;  // Reading RXBUF clears the flag
+        next = (rxHead + 1) & (UART_RX_BUFFER_SIZE - 1);
+        if (next != rxTail) {    // Drop byte if main loop fell behind
+            rxBuffer[rxHead] = data;
+            rxHead = next;
+        }
+    }
+    PROFILE_END(PROF_UART);
 }
 
 void uartEcho(void) {
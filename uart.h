@@ -3,11 +3,29 @@
 
 #include <stdint.h>
 
+#define UART_RX_BUFFER_SIZE 64  // must be a power of 2
+#define UART_LINE_MAX       32
+#define UART_BAUD_RATE      115200
+#define UART_WAKE_BYTE      0xFF    // only its start bit is low, ignored if received
+
 /**
- * @brief Initializes UART (e.g., eUSCI_A0) at 115200 baud (for 48MHz MCLK).
+ * @brief Initializes UART (e.g., eUSCI_A0) at UART_BAUD_RATE from SMCLK.
+ *
+ * The baud divider follows SMCLK changes made through clockManager.
  */
 void initUART(void);
 
+/**
+ * @brief Programs the eUSCI_A0 baud rate divider and modulation.
+ *
+ * Computes BRW, BRF and BRS for any clock per the eUSCI_A baud rate
+ * procedure in the TRM, using oversampling when clkFreq / baud >= 16.
+ *
+ * @param clkFreq Frequency of the BRCLK source (SMCLK) in Hz.
+ * @param baud Desired baud rate.
+ */
+void uartSetBaudRate(uint32_t clkFreq, uint32_t baud);
+
 /**
  * @brief Sends one byte over UART.
  *
@@ -22,6 +40,49 @@ void sendByte(uint8_t data);
  */
 uint8_t readByte(void);
 
+/**
+ * @brief Collects received bytes into '\n' terminated command lines.
+ *
+ * Non-blocking; call from the main loop. '\r' and UART_WAKE_BYTE are
+ * ignored.
+ *
+ * @param line Destination for the completed line (null terminated).
+ * @param size Size of the destination buffer.
+ * @return 1 if a complete line was copied to line, 0 otherwise.
+ */
+uint8_t uartReadLine(char *line, uint8_t size);
+
+/**
+ * @brief Arms the RX pin as a wake source before LPM3.
+ *
+ * eUSCI_A0 cannot receive in LPM3, so P1.2 is switched to a GPIO with a
+ * falling edge interrupt: the start bit of the next byte ends the sleep
+ * but the byte itself is lost. A host that may find the MSP432 asleep
+ * sends UART_WAKE_BYTE and waits a few milliseconds before a command.
+ * Call with interrupts masked.
+ */
+void uartSleep(void);
+
+/**
+ * @brief Hands the RX pin back to eUSCI_A0 after LPM3.
+ *
+ * Call with interrupts still masked; clears the pin interrupt so no
+ * handler runs for it.
+ *
+ * @return 1 if a start bit on RX ended the sleep, 0 otherwise.
+ */
+uint8_t uartWake(void);
+
+/**
+ * @brief Reports whether the UART can be left without losing data.
+ *
+ * eUSCI_A0 runs from SMCLK, which stops in LPM3.
+ *
+ * @return 1 if nothing is being sent or received and no partial line is
+ *         buffered, 0 otherwise.
+ */
+uint8_t uartIsIdle(void);
+
 /**
  * @brief UART Echo Function (Debugging).
  */
@@ -29,6 +90,14 @@ void uartEcho(void);
 
 void sendPlaybackStatus(uint8_t isPlaying, uint8_t songIndex, uint8_t isReset);
 
+/**
+ * @brief Formats the playback status message sent to the ESP32.
+ *
+ * @param buffer Destination, at least 25 bytes.
+ * @return Number of characters written, excluding the terminator.
+ */
+int formatPlaybackStatus(char *buffer, uint8_t isPlaying, uint8_t songIndex, uint8_t isReset);
+
 void sendString(const char *str);
 
 